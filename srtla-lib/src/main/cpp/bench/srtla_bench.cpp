@@ -0,0 +1,1099 @@
+/*
+ * srtla_bench.cpp - Host replay benchmark for the bonding engine
+ *
+ * Drives the sender's scheduling and ACK path (srtla_scheduler + srtla_seq_ring)
+ * against N emulated links in a discrete-event simulation, fed either by a
+ * recorded SRT pcap or by a synthetic constant-bitrate source. Reports engine
+ * throughput (pps, CPU ns/packet), delivery, latency and reorder depth at the
+ * receiver, and per-link utilization, so scheduler or ACK-path changes can be
+ * compared before a build goes to a phone.
+ *
+ * Everything here is a model: the engine modules it drives are not what the
+ * fork's srtla_send.c runs, and neither the fork nor the JNI wrapper is
+ * linked, so it cannot catch a regression in the shipped sender. That is
+ * srtla_sender_bench, which runs srtla_send.c itself over loopback.
+ *
+ * Link model: serialization at the link bandwidth with a bounded queue,
+ * one-way delay rtt/2 plus uniform jitter, Bernoulli loss. The receiver
+ * returns SRTLA ACKs over the carrying link in batches (srtla_rec style) and
+ * NAKs lost packets; the sender applies srtla-style window growth/backoff.
+ *
+ * Capacity: every CAPACITY_SAMPLE_US of simulated time the links are fed to
+ * srtla_capacity as the sender's housekeeping would, and the estimate is
+ * compared with the links' real bandwidth (how often the recommended bitrate
+ * was above it).
+ *
+ * FEC: --fec xor:K or rs:K:M runs srtla_fec on the send path (the source
+ * packets are synthesized SRT datagrams), sends the parity over the links
+ * like any packet and feeds a receiver-side decoder, reporting overhead,
+ * how many link losses were rebuilt and how long that took.
+ *
+ * Radio: --radio-trace IDX:FILE replays the signal metrics Android reported
+ * for a link into srtla_radio at each housekeeping pass; with --radio-prior
+ * every policy runs twice, without and with the radio quality applied to
+ * the scheduler, so the two can be compared on the same link traces.
+ *
+ * Trace: --trace FILE records the run of the first selected policy with
+ * srtla_trace (pick, ACK, NAK and window changes, on the simulated clock)
+ * for bench/srtla_trace_decode, and keeps the tracer on the measured path.
+ *
+ * Heap use: every operator new made from inside an engine call after a warm-up
+ * period is counted, as are srtla_pool heap fallbacks; packet buffers come
+ * from srtla_pool as on the device. --assert-zero-alloc fails the run if
+ * either is non-zero, i.e. if forwarding a packet touched the heap.
+ *
+ * Usage:
+ *   srtla_bench [--pcap FILE [--port N]] [--rate-kbps N] [--duration-s N]
+ *               [--link BW_KBPS:RTT_MS[:JITTER_MS[:LOSS_PCT]]]...
+ *               [--link-trace IDX:FILE]... [--policy NAME|all]
+ *               [--ack-batch N] [--seed N] [--fec xor:K|rs:K:M] [--trace FILE]
+ *               [--radio-trace IDX:FILE]... [--radio-prior] [--assert-zero-alloc]
+ *
+ * Trace files hold "time_ms bw_kbps rtt_ms jitter_ms loss_pct" lines ('#'
+ * comments allowed); each line replaces the link parameters from that time on.
+ * Radio traces hold "time_ms cell RSRP_DBM SINR_DB" or "time_ms wifi RSSI_DBM
+ * LINK_MBPS" lines, '-' for a metric not reported.
+ *
+ * Built with cmake -DSRTLA_BUILD_BENCH=ON (see CMakeLists.txt).
+ */
+
+#include "srtla_capacity.h"
+#include "srtla_fec.h"
+#include "srtla_metrics.h"
+#include "srtla_pool.h"
+#include "srtla_radio.h"
+#include "srtla_scheduler.h"
+#include "srtla_seq_ring.h"
+#include "srtla_trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+// srtla_send.c window constants, in milli-packets
+const int WINDOW_MULT = 1000;
+const int WINDOW_DEF = 20 * WINDOW_MULT;
+const int WINDOW_MIN = 1 * WINDOW_MULT;
+const int WINDOW_MAX = 60 * WINDOW_MULT;
+const int WINDOW_INCR = 30;
+const int WINDOW_DECR = 100;
+
+const uint64_t MAX_QUEUE_US = 500000;   // tail-drop beyond 500 ms of queued data
+const uint64_t ACK_FLUSH_US = 20000;    // receiver flushes a partial ACK batch after 20 ms
+const uint64_t NAK_DELAY_US = 20000;    // time for the receiver to notice a gap
+const int SEQ_RING_SIZE = 1 << 16;
+const uint64_t WARMUP_US = 2000000;     // allocations before this are start-up cost
+const uint64_t CAPACITY_SAMPLE_US = 100000; // sender housekeeping interval
+
+// Heap allocations made inside engine calls once counting is enabled
+bool in_engine = false;
+bool count_allocs = false;
+uint64_t engine_heap_allocs = 0;
+
+struct EngineScope {
+    EngineScope() { in_engine = true; }
+    ~EngineScope() { in_engine = false; }
+};
+
+struct LinkParams {
+    double bw_kbps = 10000;
+    double rtt_ms = 50;
+    double jitter_ms = 0;
+    double loss_pct = 0;
+};
+
+struct TracePoint {
+    uint64_t t_us;
+    LinkParams params;
+};
+
+struct RadioPoint {
+    uint64_t t_us;
+    srtla_radio_sample_t sample;
+};
+
+struct LinkSpec {
+    LinkParams initial;
+    std::vector<TracePoint> trace;
+    std::vector<RadioPoint> radio;
+};
+
+struct SourcePacket {
+    uint64_t t_us;
+    uint32_t len;
+};
+
+enum EventType { EV_ARRIVE, EV_ACK, EV_NAK, EV_ACK_FLUSH, EV_PARITY };
+
+struct Event {
+    uint64_t t_us;
+    uint64_t order;
+    EventType type;
+    int link;
+    uint32_t seq;
+    uint64_t sent_us;
+    bool operator>(const Event& o) const {
+        return t_us != o.t_us ? t_us > o.t_us : order > o.order;
+    }
+};
+
+struct LinkState {
+    LinkParams params;
+    size_t trace_pos = 0;
+    size_t radio_pos = 0;
+    double quality_sum = 0;   // radio quality summed over housekeeping passes
+    uint64_t busy_until = 0;
+    int window = WINDOW_DEF;
+    int in_flight = 0;
+    std::vector<uint32_t> ack_batch;
+    bool flush_pending = false;
+
+    uint64_t pkts_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t pkts_lost = 0;
+    uint64_t pkts_acked = 0;
+};
+
+// From srtla_metrics, as the device would export them
+struct LinkQuantiles {
+    uint32_t rtt_p50_us, rtt_p99_us;
+    uint32_t ack_gap_p50_us;
+    uint32_t run_p50, run_p99;
+};
+
+struct Result {
+    std::string policy;
+    bool radio_prior = false;
+    uint64_t offered = 0;
+    uint64_t no_link = 0;
+    uint64_t delivered = 0;
+    uint64_t lost = 0;
+    double wall_s = 0;
+    double cpu_ns_per_pkt = 0;
+    double sim_s = 0;
+    double latency_mean_ms = 0;
+    double latency_p99_ms = 0;
+    uint32_t reorder_max = 0;
+    double reorder_mean = 0;
+    double reorder_p99 = 0;
+    double reordered_pct = 0;
+    uint64_t counted_packets = 0;
+    uint64_t engine_heap_allocs = 0;
+    uint64_t pool_heap_fallbacks = 0;
+    uint64_t capacity_samples = 0;
+    double capacity_mean_kbps = 0;
+    double recommended_mean_kbps = 0;
+    double true_mean_kbps = 0;
+    double recommended_over_pct = 0;
+    int fec_mode = SRTLA_FEC_OFF;
+    int fec_k = 0;
+    int fec_m = 0;
+    uint64_t fec_source_bytes = 0;
+    uint64_t fec_parity_bytes = 0;
+    uint64_t fec_recovered = 0;
+    double fec_delay_mean_ms = 0;
+    std::vector<LinkState> links;
+    std::vector<LinkQuantiles> link_quantiles;
+    std::vector<LinkParams> link_initial;
+};
+
+uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = (size_t)(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+bool parse_link(const char* s, LinkParams* out) {
+    LinkParams p;
+    int n = sscanf(s, "%lf:%lf:%lf:%lf", &p.bw_kbps, &p.rtt_ms, &p.jitter_ms, &p.loss_pct);
+    if (n < 2 || p.bw_kbps <= 0 || p.rtt_ms < 0) return false;
+    *out = p;
+    return true;
+}
+
+int parse_metric(const char* s) {
+    return strcmp(s, "-") == 0 ? SRTLA_RADIO_UNKNOWN : atoi(s);
+}
+
+bool load_radio_trace(const char* path, std::vector<RadioPoint>* out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open radio trace %s\n", path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        double t_ms;
+        char kind[16], v1[16], v2[16];
+        if (sscanf(line, "%lf %15s %15s %15s", &t_ms, kind, v1, v2) != 4) continue;
+        srtla_radio_sample_t r = {0, SRTLA_RADIO_UNKNOWN, SRTLA_RADIO_UNKNOWN,
+                                  SRTLA_RADIO_UNKNOWN, SRTLA_RADIO_UNKNOWN, 0, 0};
+        if (strcmp(kind, "cell") == 0) {
+            r.network_type = SRTLA_RADIO_NET_CELLULAR;
+            r.rsrp_dbm = parse_metric(v1);
+            r.sinr_db = parse_metric(v2);
+        } else if (strcmp(kind, "wifi") == 0) {
+            r.network_type = SRTLA_RADIO_NET_WIFI;
+            r.rssi_dbm = parse_metric(v1);
+            r.link_mbps = parse_metric(v2);
+        } else {
+            continue;
+        }
+        out->push_back(RadioPoint{(uint64_t)(t_ms * 1000), r});
+    }
+    fclose(f);
+    std::sort(out->begin(), out->end(),
+              [](const RadioPoint& a, const RadioPoint& b) { return a.t_us < b.t_us; });
+    return true;
+}
+
+bool load_trace(const char* path, std::vector<TracePoint>* out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open trace %s\n", path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        double t_ms;
+        LinkParams p;
+        if (sscanf(line, "%lf %lf %lf %lf %lf", &t_ms, &p.bw_kbps, &p.rtt_ms,
+                   &p.jitter_ms, &p.loss_pct) == 5) {
+            out->push_back(TracePoint{(uint64_t)(t_ms * 1000), p});
+        }
+    }
+    fclose(f);
+    std::sort(out->begin(), out->end(),
+              [](const TracePoint& a, const TracePoint& b) { return a.t_us < b.t_us; });
+    return true;
+}
+
+uint32_t rd32(const uint8_t* p, bool swap) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+// Extracts UDP payloads (optionally only those to/from `port`) from a classic
+// libpcap file. Supports Ethernet, Linux cooked, raw IP and BSD loopback.
+bool load_pcap(const char* path, int port, std::vector<SourcePacket>* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open pcap %s\n", path);
+        return false;
+    }
+    uint8_t gh[24];
+    if (fread(gh, 1, sizeof(gh), f) != sizeof(gh)) {
+        fclose(f);
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, gh, 4);
+    bool swap = magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1;
+    bool nanos = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+    if (!swap && magic != 0xa1b2c3d4 && magic != 0xa1b23c4d) {
+        fprintf(stderr, "%s: not a pcap file (pcapng is not supported)\n", path);
+        fclose(f);
+        return false;
+    }
+    uint32_t linktype = rd32(gh + 20, swap);
+
+    uint64_t first_us = UINT64_MAX;
+    std::vector<uint8_t> buf;
+    uint8_t rh[16];
+    while (fread(rh, 1, sizeof(rh), f) == sizeof(rh)) {
+        uint64_t ts = (uint64_t)rd32(rh, swap) * 1000000ull +
+                      (nanos ? rd32(rh + 4, swap) / 1000 : rd32(rh + 4, swap));
+        uint32_t caplen = rd32(rh + 8, swap);
+        buf.resize(caplen);
+        if (fread(buf.data(), 1, caplen, f) != caplen) break;
+
+        size_t off;
+        switch (linktype) {
+            case 1: off = 14; break;     // Ethernet (no VLAN)
+            case 113: off = 16; break;   // Linux cooked (SLL)
+            case 0: off = 4; break;      // BSD loopback
+            case 101: case 228: off = 0; break;  // raw IPv4/IPv6
+            default:
+                fprintf(stderr, "%s: unsupported link type %u\n", path, linktype);
+                fclose(f);
+                return false;
+        }
+        if (caplen < off + 1) continue;
+        const uint8_t* ip = buf.data() + off;
+        size_t ip_len = caplen - off;
+        size_t udp_off;
+        if ((ip[0] >> 4) == 4) {
+            if (ip_len < 20 || ip[9] != 17) continue;
+            udp_off = (ip[0] & 0x0f) * 4;
+        } else if ((ip[0] >> 4) == 6) {
+            if (ip_len < 40 || ip[6] != 17) continue;
+            udp_off = 40;
+        } else {
+            continue;
+        }
+        if (ip_len < udp_off + 8) continue;
+        const uint8_t* udp = ip + udp_off;
+        int sport = (udp[0] << 8) | udp[1];
+        int dport = (udp[2] << 8) | udp[3];
+        if (port > 0 && sport != port && dport != port) continue;
+        uint32_t len = ((udp[4] << 8) | udp[5]);
+        if (len < 8) continue;
+
+        if (first_us == UINT64_MAX) first_us = ts;
+        out->push_back(SourcePacket{ts >= first_us ? ts - first_us : 0, len - 8});
+    }
+    fclose(f);
+    return !out->empty();
+}
+
+void synth_source(double rate_kbps, double duration_s, std::vector<SourcePacket>* out) {
+    const uint32_t len = 1316;  // 7 TS packets, the usual SRT payload
+    double interval_us = len * 8.0 * 1000.0 / rate_kbps;
+    for (double t = 0; t < duration_s * 1e6; t += interval_us) {
+        out->push_back(SourcePacket{(uint64_t)t, len});
+    }
+}
+
+class Simulation {
+public:
+    Simulation(const std::vector<LinkSpec>& specs, const std::vector<SourcePacket>& source,
+               int policy, bool radio_prior, int ack_batch, uint32_t seed)
+        : specs_(specs), source_(source), policy_(policy), radio_prior_(radio_prior),
+          ack_batch_(ack_batch), rng_(seed) {}
+
+    Result run() {
+        srtla_sched_set_policy(policy_);
+        sched_ = srtla_sched_create();
+        ring_ = srtla_seq_ring_create(SEQ_RING_SIZE);
+        srtla_metrics_reset();
+        srtla_capacity_reset();
+        srtla_fec_reset();
+        srtla_radio_reset();
+        srtla_radio_set_enabled(radio_prior_ ? 1 : 0);
+        srtla_fec_get_config(&fec_mode_, nullptr, nullptr, nullptr);
+        if (fec_mode_ != SRTLA_FEC_OFF) {
+            decoder_ = srtla_fec_decoder_create();
+            rx_packet_.assign(SRTLA_FEC_MAX_PACKET, 0);
+            sent_.reserve(source_.size());
+        }
+        links_.assign(specs_.size(), LinkState());
+        for (size_t i = 0; i < specs_.size(); i++) {
+            links_[i].params = specs_[i].initial;
+            update_sched(i);
+        }
+
+        count_allocs = false;
+        engine_heap_allocs = 0;
+        uint64_t fallbacks0 = 0;
+        size_t counted_from = source_.size();
+
+        uint64_t wall0 = clock_ns(CLOCK_MONOTONIC);
+        uint64_t cpu0 = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+        size_t next = 0;
+        uint64_t now = 0;
+        while (next < source_.size() || !events_.empty()) {
+            if (next < source_.size() &&
+                (events_.empty() || source_[next].t_us <= events_.top().t_us)) {
+                now = source_[next].t_us;
+                if (!count_allocs && now >= WARMUP_US) {
+                    count_allocs = true;
+                    fallbacks0 = srtla_pool_heap_fallbacks();
+                    counted_from = next;
+                }
+                sample_capacity(now);
+                poll_fec(now);
+                send(now, source_[next].len);
+                next++;
+            } else {
+                Event ev = events_.top();
+                events_.pop();
+                now = ev.t_us;
+                sample_capacity(now);
+                poll_fec(now);
+                handle(ev);
+            }
+        }
+
+        Result r;
+        r.cpu_ns_per_pkt = source_.empty() ? 0 :
+            (double)(clock_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu0) / source_.size();
+        r.wall_s = (clock_ns(CLOCK_MONOTONIC) - wall0) / 1e9;
+        r.policy = srtla_sched_policy_name(policy_);
+        r.radio_prior = radio_prior_;
+        r.offered = source_.size();
+        r.no_link = no_link_;
+        r.delivered = delivered_;
+        r.lost = lost_;
+        r.sim_s = now / 1e6;
+        r.links = links_;
+        r.capacity_samples = capacity_samples_;
+        for (const LinkSpec& s : specs_) r.link_initial.push_back(s.initial);
+        for (size_t i = 0; i < specs_.size(); i++) {
+            int c = (int)i;
+            r.link_quantiles.push_back(LinkQuantiles{
+                srtla_metrics_quantile(c, SRTLA_HIST_RTT_US, 0.5),
+                srtla_metrics_quantile(c, SRTLA_HIST_RTT_US, 0.99),
+                srtla_metrics_quantile(c, SRTLA_HIST_ACK_INTERVAL_US, 0.5),
+                srtla_metrics_quantile(c, SRTLA_HIST_PKTS_PER_DECISION, 0.5),
+                srtla_metrics_quantile(c, SRTLA_HIST_PKTS_PER_DECISION, 0.99)});
+        }
+
+        if (!latency_ms_.empty()) {
+            double sum = 0;
+            for (double v : latency_ms_) sum += v;
+            r.latency_mean_ms = sum / latency_ms_.size();
+            r.latency_p99_ms = percentile(latency_ms_, 0.99);
+        }
+        r.reorder_max = reorder_max_;
+        if (!reorder_depth_.empty()) {
+            double sum = 0;
+            for (double v : reorder_depth_) sum += v;
+            r.reorder_mean = sum / reorder_depth_.size();
+            r.reorder_p99 = percentile(reorder_depth_, 0.99);
+        }
+        r.reordered_pct = delivered_ ? 100.0 * reorder_depth_.size() / delivered_ : 0;
+        r.counted_packets = source_.size() - counted_from;
+        r.engine_heap_allocs = engine_heap_allocs;
+        if (capacity_samples_ > 0) {
+            double n = (double)capacity_samples_;
+            r.capacity_mean_kbps = capacity_sum_kbps_ / n;
+            r.recommended_mean_kbps = recommended_sum_kbps_ / n;
+            r.true_mean_kbps = true_sum_kbps_ / n;
+            r.recommended_over_pct = 100.0 * recommended_over_ / n;
+        }
+        r.pool_heap_fallbacks = count_allocs ? srtla_pool_heap_fallbacks() - fallbacks0 : 0;
+        count_allocs = false;
+        if (decoder_ != nullptr) {
+            srtla_fec_stats_t fs;
+            srtla_fec_get_stats(&fs);
+            srtla_fec_get_config(&r.fec_mode, &r.fec_k, &r.fec_m, nullptr);
+            r.fec_source_bytes = fs.source_bytes;
+            r.fec_parity_bytes = fs.parity_bytes;
+            r.fec_recovered = fec_recovered_;
+            r.fec_delay_mean_ms = fec_recovered_ ? fec_delay_sum_ms_ / fec_recovered_ : 0;
+            srtla_fec_decoder_destroy(decoder_);
+            decoder_ = nullptr;
+        }
+
+        srtla_seq_ring_destroy(ring_);
+        srtla_sched_destroy(sched_);
+        return r;
+    }
+
+private:
+    void push(uint64_t t, EventType type, int link, uint32_t seq, uint64_t sent_us) {
+        events_.push(Event{t, order_++, type, link, seq, sent_us});
+    }
+
+    void apply_trace(size_t i, uint64_t now) {
+        const std::vector<TracePoint>& trace = specs_[i].trace;
+        LinkState& l = links_[i];
+        while (l.trace_pos < trace.size() && trace[l.trace_pos].t_us <= now) {
+            l.params = trace[l.trace_pos].params;
+            l.trace_pos++;
+        }
+    }
+
+    void update_sched(size_t i) {
+        EngineScope engine;
+        uint32_t srtt = 0;
+        srtla_seq_ring_link_rtt(ring_, (int)i, &srtt, nullptr);
+        const LinkState& l = links_[i];
+        srtla_sched_update_link(sched_, (int)i, l.window / WINDOW_MULT, l.in_flight, srtt);
+    }
+
+    // What the sender's housekeeping does every pass, plus the comparison with
+    // the links' real bandwidth once past the warm-up
+    void sample_capacity(uint64_t now) {
+        if (now < next_capacity_us_) return;
+        next_capacity_us_ = now + CAPACITY_SAMPLE_US;
+
+        uint64_t bytes = 0, pkts = 0;
+        double true_kbps = 0;
+        {
+            EngineScope engine;
+            for (size_t i = 0; i < links_.size(); i++) {
+                const LinkState& l = links_[i];
+                uint32_t srtt = 0;
+                srtla_seq_ring_link_rtt(ring_, (int)i, &srtt, nullptr);
+                srtla_capacity_link_sample((int)i, l.window / WINDOW_MULT, srtt, l.pkts_acked, now);
+                apply_radio(i, now);
+                bytes += l.bytes_sent;
+                pkts += l.pkts_sent;
+                true_kbps += l.params.bw_kbps;
+            }
+            srtla_capacity_commit(now, bytes, pkts);
+        }
+        if (now < WARMUP_US) return;
+
+        srtla_capacity_t c;
+        srtla_capacity_get(&c);
+        capacity_samples_++;
+        capacity_sum_kbps_ += c.total_bps / 1000.0;
+        recommended_sum_kbps_ += c.recommended_bps / 1000.0;
+        true_sum_kbps_ += true_kbps;
+        if (c.recommended_bps / 1000.0 > true_kbps) recommended_over_++;
+    }
+
+    // Java's reports up to now, then the scheduler prior as housekeeping sets it
+    void apply_radio(size_t i, uint64_t now) {
+        const std::vector<RadioPoint>& radio = specs_[i].radio;
+        LinkState& l = links_[i];
+        int64_t now_ms = (int64_t)(now / 1000);
+        while (l.radio_pos < radio.size() && radio[l.radio_pos].t_us <= now) {
+            srtla_radio_update((int)i, &radio[l.radio_pos].sample,
+                               (int64_t)(radio[l.radio_pos].t_us / 1000));
+            l.radio_pos++;
+        }
+        double q = srtla_radio_quality((int)i, now_ms);
+        srtla_sched_set_link_quality(sched_, (int)i, q);
+        if (now >= WARMUP_US) {
+            double e = srtla_radio_estimate((int)i, now_ms);
+            l.quality_sum += e < 0 ? 1.0 : e;
+        }
+    }
+
+    uint64_t one_way_us(const LinkParams& p) {
+        double jitter = p.jitter_ms > 0
+            ? std::uniform_real_distribution<double>(-p.jitter_ms, p.jitter_ms)(rng_) : 0;
+        return (uint64_t)(std::max(0.0, p.rtt_ms / 2 + jitter) * 1000);
+    }
+
+    void send(uint64_t now, uint32_t len) {
+        for (size_t i = 0; i < links_.size(); i++) apply_trace(i, now);
+
+        int c;
+        uint32_t seq = next_seq_;
+        {
+            // What the sender does per packet: take a buffer, pick a link,
+            // record the sequence, hand the buffer to the socket
+            EngineScope engine;
+            uint8_t* buffer = static_cast<uint8_t*>(srtla_pool_alloc(SRTLA_POOL_PACKET, len));
+            c = srtla_sched_pick(sched_);
+            srtla_metrics_picked(c);
+            if (c >= 0) {
+                srtla_seq_ring_record(ring_, seq, c, now);
+                srtla_sched_on_send(sched_, c);
+                srtla_metrics_sent(c, len);
+                srtla_trace_emit_at((int64_t)now * 1000, SRTLA_TRACE_PICK, c, seq, len, 0);
+                if (fec_mode_ != SRTLA_FEC_OFF) {
+                    fill_packet(buffer, seq, len);
+                    if (srtla_fec_on_source(buffer, len, c, now) > 0) take_parities();
+                }
+            }
+            srtla_pool_free(SRTLA_POOL_PACKET, buffer);
+        }
+        if (c < 0) {
+            no_link_++;
+            return;
+        }
+        next_seq_++;
+        LinkState& l = links_[c];
+        l.in_flight++;
+        l.pkts_sent++;
+        l.bytes_sent += len;
+
+        uint64_t arrive = 0;
+        bool lost = !transmit(l, now, len, &arrive);
+        if (fec_mode_ != SRTLA_FEC_OFF) {
+            sent_.push_back(SentPacket{now, len, lost});
+        }
+        if (lost) {
+            l.pkts_lost++;
+            lost_++;
+            push(now + (uint64_t)(l.params.rtt_ms * 1000) + NAK_DELAY_US, EV_NAK, c, seq, now);
+        } else {
+            push(arrive, EV_ARRIVE, c, seq, now);
+        }
+        send_parities(now);
+    }
+
+    // Serialization behind the link's queue, tail drop and random loss.
+    // Returns false if the packet is lost.
+    bool transmit(LinkState& l, uint64_t now, uint32_t len, uint64_t* arrive) {
+        uint64_t start = std::max(now, l.busy_until);
+        bool lost = start - now > MAX_QUEUE_US ||
+                    std::uniform_real_distribution<double>(0, 100)(rng_) < l.params.loss_pct;
+        if (start - now <= MAX_QUEUE_US) {
+            l.busy_until = start + (uint64_t)(len * 8.0 * 1000.0 / l.params.bw_kbps);
+        }
+        if (!lost) *arrive = l.busy_until + one_way_us(l.params);
+        return !lost;
+    }
+
+    // An SRT data packet the receiver can check byte for byte: sequence
+    // number, no flags, payload derived from the sequence
+    static void fill_packet(uint8_t* p, uint32_t seq, uint32_t len) {
+        p[0] = (uint8_t)((seq >> 24) & 0x7f);
+        p[1] = (uint8_t)(seq >> 16);
+        p[2] = (uint8_t)(seq >> 8);
+        p[3] = (uint8_t)seq;
+        for (uint32_t i = 4; i < len; i++) p[i] = (uint8_t)(seq * 131 + i);
+        p[4] = 0;
+    }
+
+    // Engine side, in the caller's EngineScope: pick a link for each parity
+    // packet and stage it; send_parities() puts them on the links
+    void take_parities() {
+        srtla_fec_parity_t p;
+        while (staged_count_ < SRTLA_FEC_MAX_M && srtla_fec_take_parity(&p)) {
+            StagedParity& sp = staged_[staged_count_++];
+            sp.link = srtla_fec_parity_link(sched_, &p);
+            sp.len = p.len;
+            memcpy(sp.data, p.data, p.len);
+        }
+    }
+
+    void poll_fec(uint64_t now) {
+        if (fec_mode_ == SRTLA_FEC_OFF) return;
+        {
+            EngineScope engine;
+            if (srtla_fec_poll(now) > 0) take_parities();
+        }
+        send_parities(now);
+    }
+
+    // Parity is fire-and-forget: it takes link capacity but no window slot
+    void send_parities(uint64_t now) {
+        for (int i = 0; i < staged_count_; i++) {
+            const StagedParity& sp = staged_[i];
+            if (sp.link < 0) continue;
+            srtla_fec_parity_sent(sp.len);
+            LinkState& l = links_[sp.link];
+            l.bytes_sent += sp.len;
+            uint64_t arrive = 0;
+            if (!transmit(l, now, (uint32_t)sp.len, &arrive)) continue;
+            parity_store_.emplace_back(sp.data, sp.data + sp.len);
+            push(arrive, EV_PARITY, sp.link, (uint32_t)(parity_store_.size() - 1), now);
+        }
+        staged_count_ = 0;
+    }
+
+    static void on_recovered(const uint8_t* pkt, size_t len, void* arg) {
+        (void)len;
+        Simulation* sim = static_cast<Simulation*>(arg);
+        uint32_t seq = ((uint32_t)pkt[0] << 24) | ((uint32_t)pkt[1] << 16) |
+                       ((uint32_t)pkt[2] << 8) | pkt[3];
+        if (seq < sim->sent_.size() && sim->sent_[seq].lost) {
+            sim->fec_recovered_++;
+            sim->fec_delay_sum_ms_ += (sim->rx_now_us_ - sim->sent_[seq].t_us) / 1000.0;
+        }
+    }
+
+    void handle(const Event& ev) {
+        LinkState& l = links_[ev.link];
+        switch (ev.type) {
+            case EV_ARRIVE: {
+                delivered_++;
+                if (decoder_ != nullptr && sent_[ev.seq].len <= rx_packet_.size()) {
+                    uint32_t len = sent_[ev.seq].len;
+                    fill_packet(rx_packet_.data(), ev.seq, len);
+                    rx_now_us_ = ev.t_us;
+                    srtla_fec_decoder_on_source(decoder_, rx_packet_.data(), len, on_recovered, this);
+                }
+                latency_ms_.push_back((ev.t_us - ev.sent_us) / 1000.0);
+                if (delivered_ > 1 && ev.seq < highest_seq_) {
+                    uint32_t depth = highest_seq_ - ev.seq;
+                    reorder_depth_.push_back(depth);
+                    reorder_max_ = std::max(reorder_max_, depth);
+                } else {
+                    highest_seq_ = ev.seq;
+                }
+                l.ack_batch.push_back(ev.seq);
+                if ((int)l.ack_batch.size() >= ack_batch_) {
+                    flush_acks(ev.link, ev.t_us);
+                } else if (!l.flush_pending) {
+                    l.flush_pending = true;
+                    push(ev.t_us + ACK_FLUSH_US, EV_ACK_FLUSH, ev.link, 0, 0);
+                }
+                break;
+            }
+            case EV_PARITY: {
+                std::vector<uint8_t>& parity = parity_store_[ev.seq];
+                rx_now_us_ = ev.t_us;
+                srtla_fec_decoder_on_parity(decoder_, parity.data(), parity.size(), on_recovered, this);
+                std::vector<uint8_t>().swap(parity);
+                break;
+            }
+            case EV_ACK_FLUSH:
+                l.flush_pending = false;
+                flush_acks(ev.link, ev.t_us);
+                break;
+            case EV_ACK:
+                if (resolve(ev, true) == ev.link) {
+                    if (l.in_flight * WINDOW_MULT > l.window) {
+                        set_window(ev.link, std::min(WINDOW_MAX, l.window + WINDOW_INCR - 1), ev.t_us);
+                    }
+                    l.in_flight--;
+                    l.pkts_acked++;
+                    update_sched(ev.link);
+                }
+                break;
+            case EV_NAK:
+                // NAKs carry no useful RTT sample; only the in-flight slot is released
+                if (resolve(ev, false) == ev.link) {
+                    set_window(ev.link, std::max(WINDOW_MIN, l.window - WINDOW_DECR), ev.t_us);
+                    l.in_flight--;
+                    update_sched(ev.link);
+                }
+                break;
+        }
+    }
+
+    int resolve(const Event& ev, bool acked) {
+        EngineScope engine;
+        uint32_t rtt_us = 0;
+        int c = srtla_seq_ring_resolve(ring_, ev.seq, ev.t_us, &rtt_us);
+        if (c >= 0 && acked) {
+            srtla_metrics_rtt(c, rtt_us);
+            srtla_metrics_ack(c, ev.t_us);
+            srtla_trace_emit_at((int64_t)ev.t_us * 1000, SRTLA_TRACE_ACK, c, ev.seq, rtt_us, 0);
+        } else if (c >= 0) {
+            srtla_metrics_nak(c, 1);
+            srtla_trace_emit_at((int64_t)ev.t_us * 1000, SRTLA_TRACE_NAK, c, ev.seq, 0, 0);
+        }
+        return c;
+    }
+
+    // Traced in packets, as srtla_send.c reports windows
+    void set_window(int link, int window, uint64_t now) {
+        LinkState& l = links_[link];
+        if (window / WINDOW_MULT != l.window / WINDOW_MULT) {
+            EngineScope engine;
+            srtla_trace_emit_at((int64_t)now * 1000, SRTLA_TRACE_WINDOW, link,
+                                (uint32_t)(l.window / WINDOW_MULT), (uint32_t)(window / WINDOW_MULT), 0);
+        }
+        l.window = window;
+    }
+
+    void flush_acks(int link, uint64_t now) {
+        LinkState& l = links_[link];
+        if (l.ack_batch.empty()) return;
+        uint64_t t = now + one_way_us(l.params);
+        for (uint32_t seq : l.ack_batch) push(t, EV_ACK, link, seq, 0);
+        l.ack_batch.clear();
+    }
+
+    const std::vector<LinkSpec>& specs_;
+    const std::vector<SourcePacket>& source_;
+    int policy_;
+    bool radio_prior_;
+    int ack_batch_;
+    std::mt19937 rng_;
+
+    srtla_sched_t* sched_ = nullptr;
+    srtla_seq_ring_t* ring_ = nullptr;
+    std::vector<LinkState> links_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    uint64_t order_ = 0;
+    uint32_t next_seq_ = 0;
+
+    uint64_t no_link_ = 0;
+    uint64_t delivered_ = 0;
+    uint64_t lost_ = 0;
+    uint32_t highest_seq_ = 0;
+    uint32_t reorder_max_ = 0;
+    std::vector<double> latency_ms_;
+    std::vector<double> reorder_depth_;
+
+    uint64_t next_capacity_us_ = 0;
+    uint64_t capacity_samples_ = 0;
+    uint64_t recommended_over_ = 0;
+    double capacity_sum_kbps_ = 0;
+    double recommended_sum_kbps_ = 0;
+    double true_sum_kbps_ = 0;
+
+    struct StagedParity {
+        int link;
+        size_t len;
+        uint8_t data[SRTLA_FEC_MAX_PARITY];
+    };
+    int fec_mode_ = SRTLA_FEC_OFF;
+    srtla_fec_decoder_t* decoder_ = nullptr;
+    StagedParity staged_[SRTLA_FEC_MAX_M];
+    int staged_count_ = 0;
+    std::vector<std::vector<uint8_t>> parity_store_;
+    struct SentPacket {
+        uint64_t t_us;
+        uint32_t len;
+        bool lost;
+    };
+    std::vector<uint8_t> rx_packet_;
+    std::vector<SentPacket> sent_;   // by sequence number
+    uint64_t rx_now_us_ = 0;
+    uint64_t fec_recovered_ = 0;
+    double fec_delay_sum_ms_ = 0;
+};
+
+void print_result(const Result& r) {
+    double sim = r.sim_s > 0 ? r.sim_s : 1;
+    printf("policy %s%s\n", r.policy.c_str(), r.radio_prior ? " (radio prior)" : "");
+    printf("  engine:    %.0f pps, %.0f ns CPU/packet (%llu packets in %.3f s wall)\n",
+           r.wall_s > 0 ? r.offered / r.wall_s : 0, r.cpu_ns_per_pkt,
+           (unsigned long long)r.offered, r.wall_s);
+    printf("  delivery:  %.2f%% delivered, %llu lost, %llu no link available\n",
+           r.offered ? 100.0 * r.delivered / r.offered : 0,
+           (unsigned long long)r.lost, (unsigned long long)r.no_link);
+    printf("  latency:   mean %.1f ms, p99 %.1f ms\n", r.latency_mean_ms, r.latency_p99_ms);
+    printf("  reorder:   %.2f%% of packets, depth mean %.1f p99 %.0f max %u\n",
+           r.reordered_pct, r.reorder_mean, r.reorder_p99, r.reorder_max);
+    uint64_t total_bytes = 0;
+    for (const LinkState& l : r.links) total_bytes += l.bytes_sent;
+    for (size_t i = 0; i < r.links.size(); i++) {
+        const LinkState& l = r.links[i];
+        const LinkParams& p = r.link_initial[i];
+        printf("  link %zu (%.0f kbps, %.0f ms): %5.1f%% of traffic, %5.1f%% utilized, "
+               "%llu lost, final window %d\n",
+               i, p.bw_kbps, p.rtt_ms,
+               total_bytes ? 100.0 * l.bytes_sent / total_bytes : 0,
+               100.0 * (l.bytes_sent * 8.0 / 1000.0 / sim) / p.bw_kbps,
+               (unsigned long long)l.pkts_lost, l.window / WINDOW_MULT);
+        const LinkQuantiles& q = r.link_quantiles[i];
+        printf("             rtt p50 %.1f ms p99 %.1f ms, ack gap p50 %.1f ms, "
+               "pkts/decision p50 %u p99 %u\n",
+               q.rtt_p50_us / 1000.0, q.rtt_p99_us / 1000.0, q.ack_gap_p50_us / 1000.0,
+               q.run_p50, q.run_p99);
+        if (l.radio_pos > 0 && r.capacity_samples > 0) {
+            printf("             radio quality mean %.2f over %zu samples\n",
+                   l.quality_sum / r.capacity_samples, l.radio_pos);
+        }
+    }
+    printf("  capacity:  estimate mean %.0f kbps, recommended %.0f kbps, links %.0f kbps; "
+           "recommended above link capacity in %.1f%% of %llu samples\n",
+           r.capacity_mean_kbps, r.recommended_mean_kbps, r.true_mean_kbps,
+           r.recommended_over_pct, (unsigned long long)r.capacity_samples);
+    if (r.fec_mode != SRTLA_FEC_OFF) {
+        uint64_t delivered = r.delivered + r.fec_recovered;
+        printf("  fec:       %s %d+%d, %.1f%% overhead, rebuilt %llu of %llu lost (%.1f%%) "
+               "after mean %.1f ms; %.2f%% delivered with FEC\n",
+               r.fec_mode == SRTLA_FEC_XOR ? "xor" : "rs", r.fec_k, r.fec_m,
+               r.fec_source_bytes ? 100.0 * r.fec_parity_bytes / r.fec_source_bytes : 0,
+               (unsigned long long)r.fec_recovered, (unsigned long long)r.lost,
+               r.lost ? 100.0 * r.fec_recovered / r.lost : 0, r.fec_delay_mean_ms,
+               r.offered ? 100.0 * delivered / r.offered : 0);
+    }
+    printf("  heap:      %llu engine allocations, %llu pool fallbacks over %llu steady-state packets\n",
+           (unsigned long long)r.engine_heap_allocs, (unsigned long long)r.pool_heap_fallbacks,
+           (unsigned long long)r.counted_packets);
+}
+
+// xor:K or rs:K:M
+bool parse_fec(const char* s) {
+    int k = 0, m = 1;
+    if (sscanf(s, "xor:%d", &k) == 1) {
+        return srtla_fec_configure(SRTLA_FEC_XOR, k, 1, SRTLA_FEC_DEFAULT_MAX_DELAY_MS) == 0;
+    }
+    if (sscanf(s, "rs:%d:%d", &k, &m) == 2) {
+        return srtla_fec_configure(SRTLA_FEC_RS, k, m, SRTLA_FEC_DEFAULT_MAX_DELAY_MS) == 0;
+    }
+    return false;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: srtla_bench [--pcap FILE [--port N]] [--rate-kbps N] [--duration-s N]\n"
+            "                   [--link BW_KBPS:RTT_MS[:JITTER_MS[:LOSS_PCT]]]...\n"
+            "                   [--link-trace IDX:FILE]... [--policy window|earliest-delivery|weighted-rr|all]\n"
+            "                   [--ack-batch N] [--seed N] [--fec xor:K|rs:K:M] [--trace FILE]\n"
+            "                   [--radio-trace IDX:FILE]... [--radio-prior] [--assert-zero-alloc]\n");
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    if (in_engine && count_allocs) engine_heap_allocs++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+int main(int argc, char** argv) {
+    const char* pcap = nullptr;
+    int port = 0;
+    double rate_kbps = 8000;
+    double duration_s = 30;
+    int ack_batch = 10;
+    uint32_t seed = 1;
+    std::string policy = "all";
+    bool assert_zero_alloc = false;
+    bool radio_prior = false;
+    const char* trace = nullptr;
+    const char* fec = nullptr;
+    std::vector<LinkSpec> links;
+    std::vector<std::pair<int, std::string>> traces;
+    std::vector<std::pair<int, std::string>> radio_traces;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (a == "--help" || a == "-h") {
+            usage();
+            return 0;
+        }
+        if (a == "--assert-zero-alloc") {
+            assert_zero_alloc = true;
+            continue;
+        }
+        if (a == "--radio-prior") {
+            radio_prior = true;
+            continue;
+        }
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if (a == "--pcap") {
+            pcap = v;
+        } else if (a == "--port") {
+            port = atoi(v);
+        } else if (a == "--rate-kbps") {
+            rate_kbps = atof(v);
+        } else if (a == "--duration-s") {
+            duration_s = atof(v);
+        } else if (a == "--ack-batch") {
+            ack_batch = std::max(1, atoi(v));
+        } else if (a == "--seed") {
+            seed = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (a == "--fec") {
+            fec = v;
+        } else if (a == "--trace") {
+            trace = v;
+        } else if (a == "--policy") {
+            policy = v;
+        } else if (a == "--link") {
+            LinkSpec spec;
+            if (!parse_link(v, &spec.initial)) {
+                fprintf(stderr, "Bad --link %s\n", v);
+                return 2;
+            }
+            links.push_back(spec);
+        } else if (a == "--link-trace") {
+            const char* colon = strchr(v, ':');
+            if (!colon) {
+                fprintf(stderr, "Bad --link-trace %s\n", v);
+                return 2;
+            }
+            traces.emplace_back(atoi(v), colon + 1);
+        } else if (a == "--radio-trace") {
+            const char* colon = strchr(v, ':');
+            if (!colon) {
+                fprintf(stderr, "Bad --radio-trace %s\n", v);
+                return 2;
+            }
+            radio_traces.emplace_back(atoi(v), colon + 1);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (links.empty()) {
+        // Default scenario: fast Wi-Fi plus a slower, lossier LTE link
+        LinkSpec wifi, lte;
+        wifi.initial = LinkParams{12000, 40, 5, 0.1};
+        lte.initial = LinkParams{6000, 180, 30, 1.0};
+        links.push_back(wifi);
+        links.push_back(lte);
+    }
+    for (const auto& t : traces) {
+        if (t.first < 0 || (size_t)t.first >= links.size()) {
+            fprintf(stderr, "--link-trace index %d out of range\n", t.first);
+            return 2;
+        }
+        if (!load_trace(t.second.c_str(), &links[t.first].trace)) return 1;
+    }
+    for (const auto& t : radio_traces) {
+        if (t.first < 0 || (size_t)t.first >= links.size()) {
+            fprintf(stderr, "--radio-trace index %d out of range\n", t.first);
+            return 2;
+        }
+        if (!load_radio_trace(t.second.c_str(), &links[t.first].radio)) return 1;
+    }
+
+    std::vector<SourcePacket> source;
+    if (pcap) {
+        if (!load_pcap(pcap, port, &source)) {
+            fprintf(stderr, "No UDP packets read from %s\n", pcap);
+            return 1;
+        }
+        printf("source: %s, %zu packets\n", pcap, source.size());
+    } else {
+        synth_source(rate_kbps, duration_s, &source);
+        printf("source: synthetic %.0f kbps for %.0f s, %zu packets\n",
+               rate_kbps, duration_s, source.size());
+    }
+
+    std::vector<int> policies;
+    if (policy == "all") {
+        for (int p = 0; p < SRTLA_SCHED_POLICY_COUNT; p++) policies.push_back(p);
+    } else {
+        for (int p = 0; p < SRTLA_SCHED_POLICY_COUNT; p++) {
+            if (policy == srtla_sched_policy_name(p)) policies.push_back(p);
+        }
+        if (policies.empty()) {
+            fprintf(stderr, "Unknown policy %s\n", policy.c_str());
+            return 2;
+        }
+    }
+
+    srtla_pool_config_t pool_config;
+    srtla_pool_default_config(&pool_config);
+    srtla_pool_init(&pool_config);
+
+    if (fec && !parse_fec(fec)) {
+        fprintf(stderr, "Bad --fec %s\n", fec);
+        return 2;
+    }
+    if (trace && srtla_trace_start(trace, SRTLA_TRACE_MAX_RECORDS) != 0) {
+        fprintf(stderr, "Cannot start trace %s: %s\n", trace, strerror(errno));
+        return 1;
+    }
+
+    bool allocated = false;
+    for (int p : policies) {
+        for (int prior = 0; prior <= (radio_prior ? 1 : 0); prior++) {
+            Simulation sim(links, source, p, prior != 0, ack_batch, seed);
+            Result r = sim.run();
+            if (srtla_trace_active()) {
+                printf("trace: %s, %llu records (%s)\n", trace,
+                       (unsigned long long)srtla_trace_count(), r.policy.c_str());
+                srtla_trace_stop();
+            }
+            print_result(r);
+            allocated |= r.engine_heap_allocs != 0 || r.pool_heap_fallbacks != 0;
+        }
+    }
+    if (assert_zero_alloc && allocated) {
+        fprintf(stderr, "FAIL: the packet path allocated from the heap in steady state\n");
+        return 1;
+    }
+    return 0;
+}
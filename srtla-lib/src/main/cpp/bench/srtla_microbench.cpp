@@ -0,0 +1,701 @@
+/*
+ * srtla_microbench.cpp - Host microbenchmarks for single engine modules
+ *
+ * srtla_bench replays whole sessions; this times one hot path at a time, in
+ * isolation, so a change to that module can be quoted in numbers. Every
+ * scenario prints one row per configuration it compares.
+ *
+ *   publish   Forwarding loop (srtla_sched_pick + on_send per packet, a
+ *             window update every ACK_EVERY packets) on one thread while a
+ *             second publishes the stats block (srtla_stats_publish.h) at the
+ *             dispatcher's fastest cadence, PUBLISH_INTERVAL_MS, and a third
+ *             copies it with srtla_stats_read(): not at all, at 10 Hz (the UI)
+ *             and flat out. Reports forwarding pps and CPU ns/packet, and the
+ *             cost of a publish and of a read.
+ *   batch-io  Loopback forwarding: a generator paces --rate-pps SRT-sized
+ *             datagrams into a listen socket and the forwarding thread moves
+ *             them to --links link sockets (runs of LINK_RUN packets per
+ *             link, as the scheduler tends to pick), once with poll() +
+ *             recvfrom()/sendto() per packet, once with srtla_batch_recv() +
+ *             srtla_tx_enqueue()/flush() (srtla_batch_io.h) and once more
+ *             with UDP GSO/GRO enabled on the sockets. Reports forwarded pps,
+ *             syscalls per packet, and the forwarding thread's CPU ns/packet
+ *             and CPU load.
+ *   reactor   Per-wakeup cost of the loop's wait at 2 and 10 link sockets
+ *             (local interfaces + Moblink relays): one datagram is queued on
+ *             one of the sockets and the loop waits, dispatches and reads it
+ *             until EAGAIN, with the fork's original select() (fd_set
+ *             rebuilt and scanned every wakeup) and with srtla_reactor
+ *             (epoll + timerfd). Reports ns per wakeup (the wait and the
+ *             dispatch, queuing the datagram excluded).
+ *   conn-table
+ *             Link selection at 4, 16 and 32 links: every packet scores
+ *             every link (window vs in flight, receive timeout) and copies a
+ *             1316-byte payload through a PACKET_RING-slot ring, as the
+ *             forwarding path does, over the fork's conn_t list (hot fields
+ *             next to a CONN_PKT_LOG-entry packet log and the strings, one
+ *             malloc per conn) and over srtla_conn_table's hot array. A row
+ *             with the copy alone is the baseline. Also times a publish and
+ *             a srtla_stats_read() of that many links, the JNI stats path.
+ *
+ * Rates are wall clock, CPU costs are per-thread CPU time, so runs on hosts
+ * with fewer cores than threads still compare by CPU cost.
+ *
+ * Usage:
+ *   srtla_microbench SCENARIO [--duration-s N] [--links N] [--rate-pps N]
+ *
+ * Built with cmake -DSRTLA_BUILD_BENCH=ON (see CMakeLists.txt).
+ */
+
+#include "srtla_events.h"
+#include "srtla_reactor.h"
+#include "srtla_scheduler.h"
+#include "srtla_stats_publish.h"
+
+#include "srtla_batch_io.h"
+#include "srtla_conn_table.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// srtla_stats_publish_end() wakes the JNI event dispatcher, which is not
+// part of the host build (srtla_events.h, SRTLA_HOST_BENCH)
+extern "C" void srtla_events_notify(void) {}
+
+// Native logging goes to logcat on the device (srtla_log.h, SRTLA_HOST_BENCH)
+extern "C" int __android_log_write(int, const char* tag, const char* text) {
+    return fprintf(stderr, "%s: %s\n", tag, text);
+}
+
+namespace {
+
+const int ACK_EVERY = 16;
+const int PUBLISH_INTERVAL_MS = 50;  // SRTLA_EVENTS_COALESCE_MS
+const int DEFAULT_LINKS = 4;
+const int DEFAULT_RATE_PPS = 50000;
+const int LINK_RUN = 16;
+const int SRT_PACKET_LEN = 1316 + 16;
+
+uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void sleep_ns(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull)};
+    nanosleep(&ts, nullptr);
+}
+
+void usage() {
+    fprintf(stderr,
+            "Usage: srtla_microbench SCENARIO [--duration-s N] [--links N] [--rate-pps N]\n"
+            "Scenarios: publish, batch-io, reactor, conn-table\n");
+}
+
+struct Options {
+    double duration_s = 3;
+    int links = DEFAULT_LINKS;
+    int rate_pps = DEFAULT_RATE_PPS;
+};
+
+// --- publish ---
+
+struct PublishResult {
+    uint64_t packets = 0;
+    uint64_t forward_cpu_ns = 0;
+    uint64_t publishes = 0;
+    uint64_t publish_cpu_ns = 0;
+    uint64_t reads = 0;
+    uint64_t failed_reads = 0;
+    uint64_t read_wall_ns = 0;
+    uint64_t max_read_ns = 0;
+};
+
+// reader_hz: 0 = no reader, < 0 = flat out
+PublishResult run_publish(const Options& opt, int reader_hz) {
+    PublishResult r;
+    std::atomic<bool> running(true);
+    srtla_stats_reset();
+
+    std::thread publisher([&] {
+        std::vector<srtla_conn_stats_t> conns(opt.links);
+        for (int i = 0; i < opt.links; i++) {
+            srtla_conn_stats_t& c = conns[i];
+            memset(&c, 0, sizeof(c));
+            snprintf(c.type, sizeof(c.type), i % 2 ? "WiFi" : "Cellular");
+            snprintf(c.ip, sizeof(c.ip), "10.0.0.%d", i + 1);
+            c.rtt_ms = -1;
+        }
+        srtla_group_stats_t group = {opt.links, 0};
+        uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+        while (running.load(std::memory_order_relaxed)) {
+            srtla_stats_publish_begin();
+            for (srtla_conn_stats_t& c : conns) {
+                c.window_size += 1;
+                c.in_flight = c.window_size / 2;
+                srtla_stats_publish_conn(&c);
+            }
+            srtla_stats_publish_end(&group);
+            r.publishes++;
+            sleep_ns(PUBLISH_INTERVAL_MS * 1000000ull);
+        }
+        r.publish_cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    });
+
+    std::thread reader;
+    if (reader_hz != 0) {
+        reader = std::thread([&] {
+            srtla_stats_view view;
+            while (running.load(std::memory_order_relaxed)) {
+                uint64_t t = clock_ns(CLOCK_MONOTONIC);
+                if (!srtla_stats_read(&view)) r.failed_reads++;
+                uint64_t d = clock_ns(CLOCK_MONOTONIC) - t;
+                r.reads++;
+                r.read_wall_ns += d;
+                r.max_read_ns = std::max(r.max_read_ns, d);
+                if (reader_hz > 0) sleep_ns(1000000000ull / reader_hz);
+            }
+        });
+    }
+
+    srtla_sched_t* s = srtla_sched_create();
+    std::vector<int> in_flight(opt.links, 0);
+    for (int i = 0; i < opt.links; i++) {
+        srtla_sched_update_link(s, i, 20 + 10 * i, 0, 30000 + 5000 * i);
+    }
+    uint64_t end = clock_ns(CLOCK_MONOTONIC) + (uint64_t)(opt.duration_s * 1e9);
+    uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    while (clock_ns(CLOCK_MONOTONIC) < end) {
+        for (int n = 0; n < 1024; n++) {
+            int id = srtla_sched_pick(s);
+            if (id < 0) id = 0;
+            srtla_sched_on_send(s, id);
+            in_flight[id]++;
+            if (++r.packets % ACK_EVERY == 0) {
+                for (int i = 0; i < opt.links; i++) {
+                    in_flight[i] = in_flight[i] / 2;
+                    srtla_sched_update_link(s, i, 20 + 10 * i, in_flight[i], 30000 + 5000 * i);
+                }
+            }
+        }
+    }
+    r.forward_cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    srtla_sched_destroy(s);
+
+    running.store(false);
+    publisher.join();
+    if (reader.joinable()) reader.join();
+    return r;
+}
+
+int scenario_publish(const Options& opt) {
+    printf("publish: %d links, publish every %d ms, %.1f s per row\n", opt.links,
+           PUBLISH_INTERVAL_MS, opt.duration_s);
+    printf("%-10s %12s %12s %12s %10s %10s %10s %8s\n", "reader", "fwd_pps", "fwd_ns/pkt",
+           "publish_ns", "reads", "read_ns", "max_read", "failed");
+    const struct {
+        const char* name;
+        int hz;
+    } readers[] = {{"none", 0}, {"10 Hz", 10}, {"flat out", -1}};
+    for (const auto& rd : readers) {
+        PublishResult r = run_publish(opt, rd.hz);
+        printf("%-10s %12.0f %12.1f %12.0f %10llu %10.0f %10llu %8llu\n", rd.name,
+               r.packets / opt.duration_s,
+               r.packets ? (double)r.forward_cpu_ns / r.packets : 0.0,
+               r.publishes ? (double)r.publish_cpu_ns / r.publishes : 0.0,
+               (unsigned long long)r.reads, r.reads ? (double)r.read_wall_ns / r.reads : 0.0,
+               (unsigned long long)r.max_read_ns, (unsigned long long)r.failed_reads);
+    }
+    return 0;
+}
+
+// --- batch-io ---
+
+enum BatchMode { PER_PACKET, BATCH, BATCH_OFFLOAD };
+
+struct BatchResult {
+    uint64_t sent = 0;
+    uint64_t forwarded = 0;
+    uint64_t syscalls = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t wall_ns = 0;
+    int offload = 0;
+};
+
+int udp_socket(int rcvbuf) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (rcvbuf > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (bind(fd, (struct sockaddr*)&a, sizeof(a)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct sockaddr_in local_addr(int fd) {
+    struct sockaddr_in a = {};
+    socklen_t len = sizeof(a);
+    getsockname(fd, (struct sockaddr*)&a, &len);
+    return a;
+}
+
+bool run_batch_io(const Options& opt, BatchMode mode, BatchResult* out) {
+    int listen_fd = udp_socket(4 << 20);
+    int sink_fd = udp_socket(4 << 20);
+    int gen_fd = udp_socket(0);
+    std::vector<int> link_fds;
+    for (int i = 0; i < opt.links; i++) link_fds.push_back(udp_socket(0));
+    bool ok = listen_fd >= 0 && sink_fd >= 0 && gen_fd >= 0 &&
+              std::find(link_fds.begin(), link_fds.end(), -1) == link_fds.end();
+
+    BatchResult& r = *out;
+    if (ok && mode == BATCH_OFFLOAD) {
+        r.offload = srtla_batch_enable_offload(listen_fd, SRTLA_OFFLOAD_GRO);
+        for (int fd : link_fds) {
+            if (!(srtla_batch_enable_offload(fd, SRTLA_OFFLOAD_GSO) & SRTLA_OFFLOAD_GSO)) {
+                r.offload &= ~SRTLA_OFFLOAD_GSO;
+            } else if (fd == link_fds.front()) {
+                r.offload |= SRTLA_OFFLOAD_GSO;
+            }
+        }
+    }
+
+    struct sockaddr_in listen_addr = ok ? local_addr(listen_fd) : sockaddr_in{};
+    struct sockaddr_in sink_addr = ok ? local_addr(sink_fd) : sockaddr_in{};
+    std::atomic<bool> running(ok);
+
+    // Paced in bursts of SRTLA_BATCH_MAX, one sendmmsg() each
+    std::thread generator([&] {
+        if (!ok) return;
+        static uint8_t payload[SRT_PACKET_LEN];
+        struct mmsghdr msgs[SRTLA_BATCH_MAX];
+        struct iovec iov = {payload, sizeof(payload)};
+        memset(msgs, 0, sizeof(msgs));
+        for (struct mmsghdr& m : msgs) {
+            m.msg_hdr.msg_name = &listen_addr;
+            m.msg_hdr.msg_namelen = sizeof(listen_addr);
+            m.msg_hdr.msg_iov = &iov;
+            m.msg_hdr.msg_iovlen = 1;
+        }
+        uint64_t burst_ns = 1000000000ull * SRTLA_BATCH_MAX / opt.rate_pps;
+        uint64_t next = clock_ns(CLOCK_MONOTONIC);
+        uint64_t end = next + (uint64_t)(opt.duration_s * 1e9);
+        while (next < end) {
+            int n = sendmmsg(gen_fd, msgs, SRTLA_BATCH_MAX, 0);
+            if (n > 0) r.sent += n;
+            next += burst_ns;
+            struct timespec ts = {(time_t)(next / 1000000000ull), (long)(next % 1000000000ull)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        }
+        // Let the forwarder drain what is still queued
+        sleep_ns(100000000ull);
+        running.store(false);
+    });
+
+    // Drains the links' destination so the receive path stays in steady
+    // state; plain recvmmsg() keeps it out of the srtla_batch_io counters
+    std::thread sink([&] {
+        if (!ok) return;
+        static uint8_t bufs[SRTLA_BATCH_MAX][SRTLA_BATCH_PKT_SIZE];
+        struct mmsghdr msgs[SRTLA_BATCH_MAX];
+        struct iovec iovs[SRTLA_BATCH_MAX];
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < SRTLA_BATCH_MAX; i++) {
+            iovs[i] = {bufs[i], sizeof(bufs[i])};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        while (running.load(std::memory_order_relaxed)) {
+            struct pollfd p = {sink_fd, POLLIN, 0};
+            if (poll(&p, 1, 50) <= 0) continue;
+            while (recvmmsg(sink_fd, msgs, SRTLA_BATCH_MAX, MSG_DONTWAIT, nullptr) > 0) {
+            }
+        }
+    });
+
+    static srtla_rx_batch_t rx;
+    static srtla_tx_queue_t tx;
+    static uint8_t buf[SRTLA_BATCH_PKT_SIZE];
+    uint64_t rx_sys0, tx_sys0, unused;
+    srtla_batch_io_counters(&rx_sys0, &unused, &tx_sys0, &unused);
+    uint64_t wall_start = clock_ns(CLOCK_MONOTONIC);
+    uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t seq = 0;
+    uint64_t own_syscalls = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        struct pollfd p = {listen_fd, POLLIN, 0};
+        own_syscalls++;
+        if (poll(&p, 1, 50) <= 0) continue;
+        if (mode == PER_PACKET) {
+            for (;;) {
+                ssize_t n = recvfrom(listen_fd, buf, sizeof(buf), MSG_DONTWAIT, nullptr, nullptr);
+                own_syscalls++;
+                if (n <= 0) break;
+                int fd = link_fds[(seq++ / LINK_RUN) % link_fds.size()];
+                own_syscalls++;
+                if (sendto(fd, buf, n, MSG_DONTWAIT, (struct sockaddr*)&sink_addr,
+                           sizeof(sink_addr)) == n) {
+                    r.forwarded++;
+                }
+            }
+        } else {
+            while (srtla_batch_recv(listen_fd, &rx) > 0) {
+                for (int i = 0; i < rx.count; i++) {
+                    int fd = link_fds[(seq++ / LINK_RUN) % link_fds.size()];
+                    srtla_tx_enqueue(&tx, fd, (struct sockaddr*)&sink_addr, sizeof(sink_addr),
+                                     rx.pkts[i].data, rx.pkts[i].len);
+                }
+                r.forwarded += srtla_tx_flush(&tx);
+            }
+        }
+    }
+    r.cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    r.wall_ns = clock_ns(CLOCK_MONOTONIC) - wall_start;
+    uint64_t rx_sys1, tx_sys1;
+    srtla_batch_io_counters(&rx_sys1, &unused, &tx_sys1, &unused);
+    r.syscalls = own_syscalls + (rx_sys1 - rx_sys0) + (tx_sys1 - tx_sys0);
+
+    generator.join();
+    sink.join();
+    if (mode == BATCH_OFFLOAD) {
+        srtla_batch_forget_offload(listen_fd);
+        for (int fd : link_fds) srtla_batch_forget_offload(fd);
+    }
+    for (int fd : link_fds) {
+        if (fd >= 0) close(fd);
+    }
+    for (int fd : {listen_fd, sink_fd, gen_fd}) {
+        if (fd >= 0) close(fd);
+    }
+    return ok;
+}
+
+int scenario_batch_io(const Options& opt) {
+    printf("batch-io: %d links, %d pps offered, %d-byte datagrams, %.1f s per row\n",
+           opt.links, opt.rate_pps, SRT_PACKET_LEN, opt.duration_s);
+    printf("%-14s %10s %10s %10s %10s %12s %8s\n", "mode", "sent_pps", "fwd_pps", "fwd_pct",
+           "sys/pkt", "cpu_ns/pkt", "cpu_pct");
+    const struct {
+        const char* name;
+        BatchMode mode;
+    } modes[] = {{"per-packet", PER_PACKET}, {"mmsg", BATCH}, {"mmsg+gso/gro", BATCH_OFFLOAD}};
+    for (const auto& m : modes) {
+        BatchResult r;
+        if (!run_batch_io(opt, m.mode, &r)) {
+            fprintf(stderr, "Cannot set up loopback sockets\n");
+            return 1;
+        }
+        printf("%-14s %10.0f %10.0f %9.1f%% %10.2f %12.0f %7.1f%%", m.name,
+               r.sent / opt.duration_s, r.forwarded / opt.duration_s,
+               r.sent ? 100.0 * r.forwarded / r.sent : 0.0,
+               r.forwarded ? (double)r.syscalls / r.forwarded : 0.0,
+               r.forwarded ? (double)r.cpu_ns / r.forwarded : 0.0,
+               r.wall_ns ? 100.0 * r.cpu_ns / r.wall_ns : 0.0);
+        if (m.mode == BATCH_OFFLOAD) {
+            printf("  (GSO %s, GRO %s)", (r.offload & SRTLA_OFFLOAD_GSO) ? "on" : "off",
+                   (r.offload & SRTLA_OFFLOAD_GRO) ? "on" : "off");
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+// --- reactor ---
+
+const int REACTOR_SOCKETS[] = {2, 10};
+const int HOUSEKEEPING_INTERVAL_MS = 1000;
+
+// Returns ns per wakeup, or -1 if the sockets cannot be set up
+double run_reactor(const Options& opt, int sockets, bool use_epoll) {
+    int out_fd = udp_socket(0);
+    std::vector<int> fds;
+    std::vector<struct sockaddr_in> addrs;
+    for (int i = 0; i < sockets; i++) {
+        int fd = udp_socket(0);
+        if (fd < 0) break;
+        fds.push_back(fd);
+        addrs.push_back(local_addr(fd));
+    }
+    double result = -1;
+    if (out_fd >= 0 && (int)fds.size() == sockets &&
+        (!use_epoll || srtla_reactor_init(HOUSEKEEPING_INTERVAL_MS) == 0)) {
+        if (use_epoll) {
+            for (int fd : fds) srtla_reactor_add(fd, nullptr);
+        }
+        int max_fd = *std::max_element(fds.begin(), fds.end());
+        uint8_t buf[SRTLA_BATCH_PKT_SIZE];
+        uint8_t payload[64] = {};
+        srtla_reactor_event_t events[16];
+        uint64_t wakeups = 0;
+        uint64_t wait_ns = 0;
+        uint64_t end = clock_ns(CLOCK_MONOTONIC) + (uint64_t)(opt.duration_s * 1e9);
+        while (clock_ns(CLOCK_MONOTONIC) < end) {
+            int k = (int)(wakeups * 7 % sockets);
+            sendto(out_fd, payload, sizeof(payload), 0, (struct sockaddr*)&addrs[k],
+                   sizeof(addrs[k]));
+            // Wait until the datagram is queued, outside the measured part
+            struct pollfd p = {fds[k], POLLIN, 0};
+            poll(&p, 1, 100);
+
+            uint64_t t = clock_ns(CLOCK_MONOTONIC);
+            if (use_epoll) {
+                int n = srtla_reactor_wait(events, 16, 100);
+                for (int i = 0; i < n; i++) {
+                    if (events[i].type != SRTLA_EV_SOCKET) continue;
+                    while (recv(events[i].fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+                    }
+                }
+            } else {
+                fd_set set;
+                FD_ZERO(&set);
+                for (int fd : fds) FD_SET(fd, &set);
+                struct timeval tv = {0, 100000};
+                if (select(max_fd + 1, &set, nullptr, nullptr, &tv) > 0) {
+                    for (int fd : fds) {
+                        if (!FD_ISSET(fd, &set)) continue;
+                        while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+                        }
+                    }
+                }
+            }
+            wait_ns += clock_ns(CLOCK_MONOTONIC) - t;
+            wakeups++;
+        }
+        if (use_epoll) srtla_reactor_destroy();
+        result = wakeups ? (double)wait_ns / wakeups : 0.0;
+    }
+    for (int fd : fds) close(fd);
+    if (out_fd >= 0) close(out_fd);
+    return result;
+}
+
+int scenario_reactor(const Options& opt) {
+    printf("reactor: one datagram per wakeup, %.1f s per row\n", opt.duration_s);
+    printf("%-8s %10s %14s\n", "sockets", "loop", "ns/wakeup");
+    for (int sockets : REACTOR_SOCKETS) {
+        for (bool use_epoll : {false, true}) {
+            double ns = run_reactor(opt, sockets, use_epoll);
+            if (ns < 0) {
+                fprintf(stderr, "Cannot set up loopback sockets\n");
+                return 1;
+            }
+            printf("%-8d %10s %14.0f\n", sockets, use_epoll ? "epoll" : "select", ns);
+        }
+    }
+    return 0;
+}
+
+// --- conn-table ---
+
+const int CONN_TABLE_LINKS[] = {4, 16, 32};
+const int CONN_PKT_LOG = 256;       // the fork's PKT_LOG_SZ
+const int CONN_TIMEOUT_MS = 4000;
+const int PACKET_RING = 256;
+const int PACKET_PAYLOAD = 1316;
+
+// Layout of the fork's conn_t: the per-packet fields are spread around the
+// packet log, and each conn is its own allocation
+struct ForkConn {
+    ForkConn* next;
+    int fd;
+    int64_t last_rcvd_ms;
+    int64_t last_ack_ms;
+    int window;
+    int in_flight_pkts;
+    int pkt_idx;
+    int pkt_log[CONN_PKT_LOG];
+    char type[SRTLA_CONN_TYPE_LEN];
+    char ip[SRTLA_CONN_IP_LEN];
+    char name[SRTLA_CONN_NAME_LEN];
+};
+
+enum SelectMode { COPY_ONLY, FORK_LIST, HOT_TABLE };
+
+struct ConnTableResult {
+    double ns_per_packet = 0;
+    uint64_t checksum = 0;
+};
+
+ConnTableResult run_conn_select(const Options& opt, int links, SelectMode mode) {
+    const int64_t now_ms = 100000;
+    ForkConn* head = nullptr;
+    std::vector<void*> spacers;
+    srtla_conn_table_t table;
+    srtla_conn_table_init(&table);
+    for (int i = 0; i < links; i++) {
+        int window = 20 + (i * 37) % 200;
+        int64_t last_rcvd = now_ms - (i % 7 == 6 ? CONN_TIMEOUT_MS + 1 : 10);
+        ForkConn* c = (ForkConn*)calloc(1, sizeof(ForkConn));
+        c->fd = i;
+        c->window = window;
+        c->last_rcvd_ms = last_rcvd;
+        c->next = head;
+        head = c;
+        spacers.push_back(malloc(512));  // other allocations between conns
+        int idx = srtla_conn_table_add(&table);
+        table.hot[idx].fd = i;
+        table.hot[idx].window = window;
+        table.hot[idx].last_rcvd_ms = last_rcvd;
+    }
+
+    static uint8_t ring[PACKET_RING][PACKET_PAYLOAD];
+    static uint8_t payload[PACKET_PAYLOAD];
+    ConnTableResult r;
+    uint64_t packets = 0;
+    uint64_t end = clock_ns(CLOCK_MONOTONIC) + (uint64_t)(opt.duration_s * 1e9);
+    uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    while (clock_ns(CLOCK_MONOTONIC) < end) {
+        for (int n = 0; n < 1024; n++, packets++) {
+            payload[0] = (uint8_t)packets;
+            memcpy(ring[packets % PACKET_RING], payload, sizeof(payload));
+            int best_fd = -1;
+            if (mode == FORK_LIST) {
+                double best = -1;
+                ForkConn* pick = nullptr;
+                for (ForkConn* c = head; c; c = c->next) {
+                    if (now_ms - c->last_rcvd_ms > CONN_TIMEOUT_MS) continue;
+                    double score = (double)c->window / (c->in_flight_pkts + 1);
+                    if (score > best) {
+                        best = score;
+                        pick = c;
+                    }
+                }
+                if (pick) {
+                    pick->pkt_log[pick->pkt_idx] = (int)packets;
+                    pick->pkt_idx = (pick->pkt_idx + 1) % CONN_PKT_LOG;
+                    if (++pick->in_flight_pkts > pick->window) pick->in_flight_pkts = 0;
+                    best_fd = pick->fd;
+                }
+            } else if (mode == HOT_TABLE) {
+                double best = -1;
+                int pick = -1;
+                for (int i = 0; i < table.count; i++) {
+                    const srtla_conn_hot_t& h = table.hot[i];
+                    if (now_ms - h.last_rcvd_ms > CONN_TIMEOUT_MS) continue;
+                    double score = (double)h.window / (h.in_flight + 1);
+                    if (score > best) {
+                        best = score;
+                        pick = i;
+                    }
+                }
+                if (pick >= 0) {
+                    srtla_conn_hot_t& h = table.hot[pick];
+                    if (++h.in_flight > h.window) h.in_flight = 0;
+                    best_fd = h.fd;
+                }
+            }
+            r.checksum += (uint64_t)(best_fd + 1) + ring[(packets + 1) % PACKET_RING][n % 64];
+        }
+    }
+    uint64_t cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    r.ns_per_packet = packets ? (double)cpu_ns / packets : 0.0;
+
+    while (head) {
+        ForkConn* next = head->next;
+        free(head);
+        head = next;
+    }
+    for (void* p : spacers) free(p);
+    srtla_conn_table_free(&table);
+    return r;
+}
+
+// ns per publish pass and per read of that many links
+void run_conn_stats(int links, double* publish_ns, double* read_ns) {
+    const int PASSES = 100000;
+    srtla_stats_reset();
+    srtla_conn_stats_t c;
+    memset(&c, 0, sizeof(c));
+    srtla_group_stats_t group = {links, 0};
+    srtla_stats_view view;
+    uint64_t t = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    for (int p = 0; p < PASSES; p++) {
+        srtla_stats_publish_begin();
+        for (int i = 0; i < links; i++) {
+            c.window_size = p + i;
+            srtla_stats_publish_conn(&c);
+        }
+        srtla_stats_publish_end(&group);
+    }
+    uint64_t mid = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    for (int p = 0; p < PASSES; p++) srtla_stats_read(&view);
+    uint64_t done = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    *publish_ns = (double)(mid - t) / PASSES;
+    *read_ns = (double)(done - mid) / PASSES;
+}
+
+int scenario_conn_table(const Options& opt) {
+    printf("conn-table: link selection per packet, %.1f s per row\n", opt.duration_s);
+    printf("%-6s %12s %12s %12s %12s %12s\n", "links", "copy_ns", "list_ns", "table_ns",
+           "publish_ns", "read_ns");
+    uint64_t checksum = 0;
+    for (int links : CONN_TABLE_LINKS) {
+        ConnTableResult copy = run_conn_select(opt, links, COPY_ONLY);
+        ConnTableResult list = run_conn_select(opt, links, FORK_LIST);
+        ConnTableResult table = run_conn_select(opt, links, HOT_TABLE);
+        checksum += copy.checksum + list.checksum + table.checksum;
+        double publish_ns, read_ns;
+        run_conn_stats(links, &publish_ns, &read_ns);
+        printf("%-6d %12.1f %12.1f %12.1f %12.0f %12.0f\n", links, copy.ns_per_packet,
+               list.ns_per_packet, table.ns_per_packet, publish_ns, read_ns);
+    }
+    // Keeps the selection loops from being optimized away
+    if (checksum == 0) printf("\n");
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
+        usage();
+        return argc < 2 ? 2 : 0;
+    }
+    std::string scenario = argv[1];
+    Options opt;
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if (a == "--duration-s") {
+            opt.duration_s = std::max(0.1, atof(v));
+        } else if (a == "--links") {
+            opt.links = std::max(1, atoi(v));
+        } else if (a == "--rate-pps") {
+            opt.rate_pps = std::max(SRTLA_BATCH_MAX, atoi(v));
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (scenario == "publish") return scenario_publish(opt);
+    if (scenario == "batch-io") return scenario_batch_io(opt);
+    if (scenario == "reactor") return scenario_reactor(opt);
+    if (scenario == "conn-table") return scenario_conn_table(opt);
+    fprintf(stderr, "Unknown scenario %s\n", scenario.c_str());
+    usage();
+    return 2;
+}
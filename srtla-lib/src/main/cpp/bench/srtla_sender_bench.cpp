@@ -0,0 +1,283 @@
+/*
+ * srtla_sender_bench.cpp - Host benchmark of the real sender
+ *
+ * srtla_bench simulates the scheduler and ACK path; it cannot see a
+ * regression in the fork's srtla_send.c. This runs srtla_send.c itself, the
+ * code srtla_android links, the way the on-device self-test does
+ * (SrtlaSelfTest.kt): the sender is started on its own thread against the
+ * loopback echo receiver of srtla_selftest.h, with --links loopback link
+ * sockets registered through srtla_set_network_socket() as setNetworkSocket
+ * registers them, and synthetic SRT packets are paced into its listen port
+ * at each --rates step. A first step sent straight to the echo port is the
+ * harness baseline.
+ *
+ * Per step it prints delivery, duplicates, transit p50/p99/max, jitter, and
+ * the sender thread's CPU ns per delivered packet.
+ *
+ * The JNI wrapper itself is not linked, since it needs a JavaVM. The two hooks
+ * the fork calls back into are provided here with the JNI's meaning:
+ * srtla_is_java_owned_fd() reports the bench's link sockets, which the bench
+ * closes itself, and srtla_on_connection_established() marks the session
+ * connected.
+ *
+ * Exits 1 if the links do not register within REGISTER_TIMEOUT_MS, if the
+ * sender returns on its own, or if a step at or below --assert-pps is not
+ * sustained, so a build can be gated on it.
+ *
+ * Usage:
+ *   srtla_sender_bench [--links N] [--rates PPS,PPS,...] [--step-ms N]
+ *                      [--listen-port N] [--assert-pps N]
+ *
+ * Built with cmake -DSRTLA_BUILD_BENCH=ON when the srtla submodule is
+ * checked out (see CMakeLists.txt).
+ */
+
+#include "srtla_selftest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// The fork's Android entry points (srtla_send.c), as srtla_android_jni.cpp
+// declares them
+extern "C" {
+int srtla_start_android(const char* listen_port, const char* srtla_host,
+                        const char* srtla_port, const char* ips_file);
+void srtla_stop_android();
+void srtla_set_network_socket(const char* virtual_ip, const char* real_ip,
+                              int network_type, int socket_fd);
+void srtla_clear_all_sockets();
+void srtla_clear_reconnecting(void);
+}
+
+namespace {
+
+const int DEFAULT_LINKS = 2;
+const int DEFAULT_STEP_MS = 3000;
+const int DEFAULT_LISTEN_PORT = 6099;
+const int REGISTER_TIMEOUT_MS = 10000;
+const int STOP_TIMEOUT_MS = 5000;
+const int POLL_INTERVAL_MS = 100;
+
+std::mutex g_fds_mutex;
+std::set<int> g_link_fds;
+
+std::atomic<bool> g_connected(false);
+std::atomic<bool> g_sender_returned(false);
+std::atomic<int> g_sender_result(0);
+std::atomic<int> g_sender_tid(0);
+
+struct Options {
+    int links = DEFAULT_LINKS;
+    std::vector<int> rates = {500, 1000, 2000, 4000, 8000, 16000};  // SrtlaSelfTest
+    int step_ms = DEFAULT_STEP_MS;
+    int listen_port = DEFAULT_LISTEN_PORT;
+    int assert_pps = 0;
+};
+
+void usage() {
+    fprintf(stderr,
+            "usage: srtla_sender_bench [--links N] [--rates PPS,PPS,...] [--step-ms N]\n"
+            "                          [--listen-port N] [--assert-pps N]\n");
+}
+
+bool parse_rates(const char* s, std::vector<int>* out) {
+    out->clear();
+    for (const char* p = s; *p;) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v <= 0) return false;
+        if (*end != ',' && *end != '\0') return false;
+        out->push_back((int)v);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return !out->empty();
+}
+
+// Waits for cond up to timeout_ms, polling as SrtlaSelfTest does
+template <typename F>
+bool wait_for(F cond, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+    }
+    return cond();
+}
+
+void print_step(const char* path, const srtla_selftest_step_t& s) {
+    printf("%-8s %7d %8llu %9llu %5llu %8llu %8llu %8llu %8llu %8lld %s\n", path, s.target_pps,
+           (unsigned long long)s.sent, (unsigned long long)s.delivered,
+           (unsigned long long)s.duplicates, (unsigned long long)s.p50_us,
+           (unsigned long long)s.p99_us, (unsigned long long)s.max_us,
+           (unsigned long long)s.jitter_us, (long long)s.cpu_ns_per_packet,
+           s.sustained ? "yes" : "no");
+}
+
+}  // namespace
+
+// Hooks srtla_send.c calls into the JNI wrapper (srtla_android_jni.cpp)
+extern "C" int srtla_is_java_owned_fd(int fd) {
+    std::lock_guard<std::mutex> lock(g_fds_mutex);
+    return g_link_fds.count(fd) ? 1 : 0;
+}
+
+extern "C" void srtla_on_connection_established() {
+    g_connected.store(true);
+    srtla_clear_reconnecting();
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--help" || a == "-h") {
+            usage();
+            return 0;
+        }
+        const char* v = i + 1 < argc ? argv[++i] : nullptr;
+        if (!v) {
+            usage();
+            return 2;
+        }
+        if (a == "--links") {
+            o.links = atoi(v);
+            if (o.links < 1 || o.links > SRTLA_SELFTEST_MAX_LINKS) {
+                fprintf(stderr, "Bad --links %s\n", v);
+                return 2;
+            }
+        } else if (a == "--rates") {
+            if (!parse_rates(v, &o.rates)) {
+                fprintf(stderr, "Bad --rates %s\n", v);
+                return 2;
+            }
+        } else if (a == "--step-ms") {
+            o.step_ms = atoi(v);
+        } else if (a == "--listen-port") {
+            o.listen_port = atoi(v);
+        } else if (a == "--assert-pps") {
+            o.assert_pps = atoi(v);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    int echo_port = srtla_selftest_echo_start();
+    if (echo_port < 0) {
+        fprintf(stderr, "Cannot start the echo receiver\n");
+        return 1;
+    }
+
+    // Loopback links to the echo, registered like network sockets
+    char ips_path[] = "/tmp/srtla_sender_bench_ips.XXXXXX";
+    int ips_fd = mkstemp(ips_path);
+    if (ips_fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    std::string ips;
+    for (int i = 0; i < o.links; i++) {
+        std::string virtual_ip = "10.0.99." + std::to_string(i + 1);
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            perror("socket");
+            return 1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(g_fds_mutex);
+            g_link_fds.insert(fd);
+        }
+        srtla_set_network_socket(virtual_ip.c_str(), "127.0.0.1", 1 + i % 2, fd);
+        ips += virtual_ip + "\n";
+    }
+    bool ips_written = write(ips_fd, ips.data(), ips.size()) == (ssize_t)ips.size();
+    close(ips_fd);
+    if (!ips_written) {
+        fprintf(stderr, "Cannot write %s\n", ips_path);
+        unlink(ips_path);
+        return 1;
+    }
+
+    std::string listen_port = std::to_string(o.listen_port);
+    std::string srtla_port = std::to_string(echo_port);
+    std::thread sender([&] {
+        g_sender_tid.store((int)syscall(SYS_gettid));
+        g_sender_result.store(srtla_start_android(listen_port.c_str(), "127.0.0.1",
+                                                  srtla_port.c_str(), ips_path));
+        g_sender_returned.store(true);
+    });
+
+    int status = 0;
+    bool registered = wait_for([&] {
+        return g_sender_returned.load() ||
+               (g_connected.load() && srtla_selftest_echo_links() >= o.links);
+    }, REGISTER_TIMEOUT_MS);
+    if (g_sender_returned.load()) {
+        fprintf(stderr, "srtla_start_android() returned %d before the run\n",
+                g_sender_result.load());
+        status = 1;
+    } else if (!registered) {
+        fprintf(stderr, "%d of %d links registered with the echo receiver\n",
+                srtla_selftest_echo_links(), o.links);
+        status = 1;
+    }
+
+    if (status == 0) {
+        printf("srtla_send.c, %d links, %d ms steps\n", o.links, o.step_ms);
+        printf("%-8s %7s %8s %9s %5s %8s %8s %8s %8s %8s %s\n", "path", "pps", "sent",
+               "delivered", "dups", "p50_us", "p99_us", "max_us", "jitter", "cpu_ns", "sustained");
+        srtla_selftest_step_t step;
+        if (srtla_selftest_run_step(echo_port, o.rates.front(), o.step_ms, 0, &step) == 0) {
+            print_step("baseline", step);
+        }
+        for (int pps : o.rates) {
+            if (srtla_selftest_run_step(o.listen_port, pps, o.step_ms, g_sender_tid.load(),
+                                        &step) != 0) {
+                fprintf(stderr, "Step at %d pps out of range\n", pps);
+                status = 2;
+                break;
+            }
+            print_step("sender", step);
+            if (pps <= o.assert_pps && !step.sustained) {
+                fprintf(stderr, "Step at %d pps not sustained\n", pps);
+                status = 1;
+            }
+            if (g_sender_returned.load()) {
+                fprintf(stderr, "srtla_start_android() returned %d during the run\n",
+                        g_sender_result.load());
+                status = 1;
+                break;
+            }
+        }
+    }
+
+    srtla_stop_android();
+    srtla_clear_all_sockets();
+    if (wait_for([] { return g_sender_returned.load(); }, STOP_TIMEOUT_MS)) {
+        sender.join();
+    } else {
+        fprintf(stderr, "Sender did not return within %d ms of srtla_stop_android()\n",
+                STOP_TIMEOUT_MS);
+        sender.detach();
+        status = 1;
+    }
+    srtla_selftest_echo_stop();
+    {
+        std::lock_guard<std::mutex> lock(g_fds_mutex);
+        for (int fd : g_link_fds) close(fd);
+        g_link_fds.clear();
+    }
+    unlink(ips_path);
+    return status;
+}
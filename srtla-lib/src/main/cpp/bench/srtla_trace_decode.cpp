@@ -0,0 +1,343 @@
+/*
+ * srtla_trace_decode.cpp - Decoder for srtla_trace session files
+ *
+ * Reads a ring file written by srtla_trace (pulled from the device's app
+ * storage, or written by srtla_bench --trace) and prints it either as a
+ * chronological event list or as per-link timelines: for each bucket of
+ * --timeline MS, how many packets each link was picked for, ACKs and NAKs,
+ * mean and max RTT and the window range (srtla_bench traces only; device
+ * traces carry no per-link records, see srtla_trace.h). Records whose slot was being
+ * rewritten when the file was taken are skipped and counted.
+ *
+ * Usage:
+ *   srtla_trace_decode FILE [--link N] [--from-ms N] [--to-ms N]
+ *                           [--timeline MS] [--csv]
+ *
+ * Built with cmake -DSRTLA_BUILD_BENCH=ON (see CMakeLists.txt).
+ */
+
+#include "srtla_trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// On-disk header; see the layout in srtla_trace.h
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t capacity;
+    uint64_t next;
+    int64_t start_mono_ns;
+    int64_t start_real_ns;
+};
+
+struct Options {
+    const char* path = nullptr;
+    int link = -1;
+    double from_ms = -1;
+    double to_ms = -1;
+    double timeline_ms = 0;
+    bool csv = false;
+};
+
+struct Bucket {
+    uint64_t picks = 0;
+    uint64_t bytes = 0;
+    uint64_t acks = 0;
+    uint64_t naks = 0;
+    uint64_t rtt_sum_us = 0;
+    uint32_t rtt_max_us = 0;
+    uint32_t window_min = UINT32_MAX;
+    uint32_t window_max = 0;
+};
+
+const char* type_name(int type) {
+    switch (type) {
+        case SRTLA_TRACE_SESSION: return "session";
+        case SRTLA_TRACE_PICK: return "pick";
+        case SRTLA_TRACE_ACK: return "ack";
+        case SRTLA_TRACE_NAK: return "nak";
+        case SRTLA_TRACE_WINDOW: return "window";
+        case SRTLA_TRACE_RETRY: return "retry";
+        case SRTLA_TRACE_SOCKET: return "socket";
+        case SRTLA_TRACE_IDLE: return "idle";
+    }
+    return "unknown";
+}
+
+void describe(const srtla_trace_record_t& r, char* buf, size_t len) {
+    switch (r.type) {
+        case SRTLA_TRACE_SESSION:
+            snprintf(buf, len, "%s", r.a ? "start" : "stop");
+            break;
+        case SRTLA_TRACE_PICK:
+            snprintf(buf, len, "seq %u len %u", r.a, r.b);
+            break;
+        case SRTLA_TRACE_ACK:
+            snprintf(buf, len, "seq %u rtt %.1f ms", r.a, r.b / 1000.0);
+            break;
+        case SRTLA_TRACE_NAK:
+            snprintf(buf, len, "seq %u", r.a);
+            break;
+        case SRTLA_TRACE_WINDOW:
+            snprintf(buf, len, "%u -> %u", r.a, r.b);
+            break;
+        case SRTLA_TRACE_RETRY:
+            switch (r.a) {
+                case SRTLA_TRACE_RETRY_ATTEMPT:
+                    snprintf(buf, len, "attempt (retry %u%s)", r.b, r.c ? ", reconnect" : "");
+                    break;
+                case SRTLA_TRACE_RETRY_RETURNED:
+                    snprintf(buf, len, "sender returned %" PRId64 " (retry %u)", r.c, r.b);
+                    break;
+                case SRTLA_TRACE_RETRY_CONNECTED:
+                    snprintf(buf, len, "connected (retry %u)", r.b);
+                    break;
+                case SRTLA_TRACE_RETRY_WAIT:
+                    snprintf(buf, len, "wait %" PRId64 " ms (retry %u)", r.c, r.b);
+                    break;
+                default:
+                    snprintf(buf, len, "kind %u", r.a);
+            }
+            break;
+        case SRTLA_TRACE_SOCKET:
+            switch (r.a) {
+                case SRTLA_TRACE_SOCKET_ADD:
+                    snprintf(buf, len, "add fd %u (type %" PRId64 ")", r.b, r.c);
+                    break;
+                case SRTLA_TRACE_SOCKET_SUPERSEDE:
+                    snprintf(buf, len, "fd %" PRId64 " superseded by %u", r.c, r.b);
+                    break;
+                case SRTLA_TRACE_SOCKET_RESCAN:
+                    snprintf(buf, len, "network change");
+                    break;
+                default:
+                    snprintf(buf, len, "kind %u", r.a);
+            }
+            break;
+        case SRTLA_TRACE_IDLE:
+            switch (r.a) {
+                case SRTLA_TRACE_IDLE_ENTER:
+                    snprintf(buf, len, "enter (%" PRId64 " ms without packets)", r.c);
+                    break;
+                case SRTLA_TRACE_IDLE_LEAVE:
+                    snprintf(buf, len, "leave after %" PRId64 " ms", r.c);
+                    break;
+                case SRTLA_TRACE_IDLE_FORWARD:
+                    snprintf(buf, len, "first packet forwarded in %" PRId64 " us", r.c);
+                    break;
+                default:
+                    snprintf(buf, len, "kind %u", r.a);
+            }
+            break;
+        default:
+            snprintf(buf, len, "a %u b %u c %" PRId64, r.a, r.b, r.c);
+    }
+}
+
+bool load(const char* path, FileHeader* header, std::vector<srtla_trace_record_t>* out,
+          uint64_t* skipped) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> page(SRTLA_TRACE_HEADER_SIZE);
+    if (fread(page.data(), 1, page.size(), f) != page.size()) {
+        fprintf(stderr, "%s: truncated header\n", path);
+        fclose(f);
+        return false;
+    }
+    memcpy(header, page.data(), sizeof(*header));
+    if (header->magic != SRTLA_TRACE_MAGIC || header->version != SRTLA_TRACE_VERSION ||
+        header->record_size != sizeof(srtla_trace_record_t) || header->capacity == 0 ||
+        (header->capacity & (header->capacity - 1)) != 0) {
+        fprintf(stderr, "%s: not an srtla trace (version %u)\n", path, header->version);
+        fclose(f);
+        return false;
+    }
+
+    std::vector<srtla_trace_record_t> ring(header->capacity);
+    size_t got = fread(ring.data(), sizeof(srtla_trace_record_t), ring.size(), f);
+    fclose(f);
+
+    // Oldest surviving record first; slots beyond what was read count as lost
+    uint64_t end = header->next;
+    uint64_t begin = end > header->capacity ? end - header->capacity : 0;
+    *skipped = 0;
+    for (uint64_t i = begin; i < end; i++) {
+        size_t slot = (size_t)(i & (header->capacity - 1));
+        if (slot >= got || ring[slot].seq != (uint32_t)i + 1) {
+            (*skipped)++;
+            continue;
+        }
+        out->push_back(ring[slot]);
+    }
+    return true;
+}
+
+bool in_range(const Options& o, const srtla_trace_record_t& r) {
+    double ms = r.t_ns / 1e6;
+    if (o.from_ms >= 0 && ms < o.from_ms) return false;
+    if (o.to_ms >= 0 && ms > o.to_ms) return false;
+    // Session-wide records stay in a per-link view for context
+    return o.link < 0 || r.link == o.link || r.link == SRTLA_TRACE_NO_LINK;
+}
+
+void print_events(const Options& o, const std::vector<srtla_trace_record_t>& records) {
+    char text[128];
+    if (o.csv) printf("t_ms,link,type,a,b,c\n");
+    for (const srtla_trace_record_t& r : records) {
+        if (!in_range(o, r)) continue;
+        if (o.csv) {
+            printf("%.3f,%d,%s,%u,%u,%" PRId64 "\n", r.t_ns / 1e6,
+                   r.link == SRTLA_TRACE_NO_LINK ? -1 : r.link, type_name(r.type), r.a, r.b, r.c);
+            continue;
+        }
+        describe(r, text, sizeof(text));
+        if (r.link == SRTLA_TRACE_NO_LINK) {
+            printf("%12.3f  -   %-8s %s\n", r.t_ns / 1e6, type_name(r.type), text);
+        } else {
+            printf("%12.3f  %-3u %-8s %s\n", r.t_ns / 1e6, r.link, type_name(r.type), text);
+        }
+    }
+}
+
+void print_timeline(const Options& o, const std::vector<srtla_trace_record_t>& records) {
+    // (bucket, link) -> counters; std::map keeps the output ordered
+    std::map<std::pair<int64_t, int>, Bucket> buckets;
+    for (const srtla_trace_record_t& r : records) {
+        if (!in_range(o, r) || r.link == SRTLA_TRACE_NO_LINK) continue;
+        int64_t index = (int64_t)(r.t_ns / 1e6 / o.timeline_ms);
+        Bucket& b = buckets[{index, r.link}];
+        switch (r.type) {
+            case SRTLA_TRACE_PICK:
+                b.picks++;
+                b.bytes += r.b;
+                break;
+            case SRTLA_TRACE_ACK:
+                b.acks++;
+                b.rtt_sum_us += r.b;
+                b.rtt_max_us = std::max(b.rtt_max_us, r.b);
+                break;
+            case SRTLA_TRACE_NAK:
+                b.naks++;
+                break;
+            case SRTLA_TRACE_WINDOW:
+                b.window_min = std::min(b.window_min, std::min(r.a, r.b));
+                b.window_max = std::max(b.window_max, std::max(r.a, r.b));
+                break;
+        }
+    }
+
+    if (o.csv) {
+        printf("t_ms,link,picks,kbps,acks,naks,rtt_mean_ms,rtt_max_ms,window_min,window_max\n");
+    } else {
+        printf("%10s %4s %7s %9s %6s %5s %8s %8s %11s\n", "t_ms", "link", "picks", "kbps",
+               "acks", "naks", "rtt_ms", "rtt_max", "window");
+    }
+    for (const auto& entry : buckets) {
+        double t_ms = entry.first.first * o.timeline_ms;
+        const Bucket& b = entry.second;
+        double kbps = b.bytes * 8.0 / o.timeline_ms;
+        double rtt_ms = b.acks ? b.rtt_sum_us / 1000.0 / b.acks : 0;
+        char window[24] = "-";
+        if (b.window_max > 0 || b.window_min != UINT32_MAX) {
+            snprintf(window, sizeof(window), "%u..%u", b.window_min, b.window_max);
+        }
+        if (o.csv) {
+            char range[24] = ",";
+            if (window[0] != '-') snprintf(range, sizeof(range), "%u,%u", b.window_min, b.window_max);
+            printf("%.0f,%d,%" PRIu64 ",%.0f,%" PRIu64 ",%" PRIu64 ",%.2f,%.2f,%s\n",
+                   t_ms, entry.first.second, b.picks, kbps, b.acks, b.naks, rtt_ms,
+                   b.rtt_max_us / 1000.0, range);
+            continue;
+        }
+        printf("%10.0f %4d %7" PRIu64 " %9.0f %6" PRIu64 " %5" PRIu64 " %8.1f %8.1f %11s\n",
+               t_ms, entry.first.second, b.picks, kbps, b.acks, b.naks, rtt_ms,
+               b.rtt_max_us / 1000.0, window);
+    }
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: srtla_trace_decode FILE [--link N] [--from-ms N] [--to-ms N]\n"
+            "                               [--timeline MS] [--csv]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (a == "--help" || a == "-h") {
+            usage();
+            return 0;
+        }
+        if (a == "--csv") {
+            o.csv = true;
+            continue;
+        }
+        if (a[0] != '-') {
+            o.path = argv[i];
+            continue;
+        }
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if (a == "--link") {
+            o.link = atoi(v);
+        } else if (a == "--from-ms") {
+            o.from_ms = atof(v);
+        } else if (a == "--to-ms") {
+            o.to_ms = atof(v);
+        } else if (a == "--timeline") {
+            o.timeline_ms = atof(v);
+            if (o.timeline_ms <= 0) {
+                fprintf(stderr, "Bad --timeline %s\n", v);
+                return 2;
+            }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!o.path) {
+        usage();
+        return 2;
+    }
+
+    FileHeader header;
+    std::vector<srtla_trace_record_t> records;
+    uint64_t skipped = 0;
+    if (!load(o.path, &header, &records, &skipped)) return 1;
+
+    time_t started = (time_t)(header.start_real_ns / 1000000000LL);
+    char when[32] = "";
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", gmtime(&started));
+    fprintf(stderr, "%s: started %s UTC, %" PRIu64 " records emitted, %zu decoded, %" PRIu64
+            " skipped, ring of %u\n",
+            o.path, when, header.next, records.size(), skipped, header.capacity);
+
+    if (o.timeline_ms > 0) {
+        print_timeline(o, records);
+    } else {
+        print_events(o, records);
+    }
+    return 0;
+}
@@ -7,7 +7,6 @@
 
 #include <jni.h>
 #include <pthread.h>
-#include <android/log.h>
 #include <cstring>  // For strncpy
 #include <cstdio>   // For snprintf
 #include <unistd.h>  // For sleep
@@ -16,8 +15,23 @@
 #include <errno.h>
 #include <atomic>
 #include <chrono>  // Add this include for std::chrono
+#include <condition_variable>
+#include <map>
 #include <set>
+#include <string>
 #include <mutex>
+#include <time.h>
+#include <vector>
+#include "srtla_events.h"
+#include "srtla_log.h"
+#include "srtla_reconnect.h"
+#include "srtla_relay.h"
+#include "srtla_selftest.h"
+#include "srtla_sock_profile.h"
+#include "srtla_stats_publish.h"
+#include "srtla_stats_snapshot.h"
+#include "srtla_thread.h"
+#include "srtla_trace.h"
 
 // Forward declarations for all SRTLA C functions we call
 extern "C" {
@@ -66,11 +80,35 @@ static std::atomic<int> srtla_retry_count(0);
 static std::atomic<bool> srtla_connected(false);
 static std::atomic<bool> srtla_has_ever_connected(false);
 
+// The retry wait sleeps on this instead of polling srtla_should_stop, so a
+// sender waiting for its receiver does not wake every 50 ms; stop notifies it
+static std::mutex retry_wait_mutex;
+static std::condition_variable retry_wait_cv;
+
 // File descriptor tracking to prevent leaks
 // Java-owned FDs (from network callbacks) should not be closed by native code
 static std::set<int> java_owned_fds;
 static std::mutex java_fds_mutex;
 
+// Current fd registered for each virtual IP. An fd superseded by a later
+// registration of the same virtual IP stays Java-owned: a conn may still be
+// pinned to it and only the srtla loop thread could safely drop it (see
+// docs/STALE_VIRTUAL_CONNECTION_ANALYSIS.md), so native code never closes it.
+// Guarded by java_fds_mutex.
+static std::map<std::string, int> virtual_ip_fds;
+
+// Upper bound when growing buffers for the legacy (non-published) getters,
+// only to stop a misbehaving sender from making us allocate without limit
+static const int MAX_LEGACY_CONNECTIONS = 1024;
+
+// Room for one connection's section in the getAllStats() text
+static const size_t DETAILS_BYTES_PER_CONNECTION = 192;
+
+// State messages from the stats getters (polled every second by the UI) are
+// rate-limited to one per site per interval; per-call value traces are VERBOSE
+// and compiled out unless SRTLA_LOG_MIN_LEVEL is lowered (srtla_log.h)
+static const int POLL_LOG_INTERVAL_MS = 10000;
+
 struct SrtlaParams {
     char listen_port[16];
     char srtla_host[256];
@@ -78,19 +116,46 @@ struct SrtlaParams {
     char ips_file[512];
 };
 
+// Only one SRTLA thread runs at a time (start refuses while one runs, and while
+// one detached by stop has not exited yet), so its parameters live in static
+// storage instead of a per-start heap allocation
+static SrtlaParams srtla_params;
+// From before pthread_create until the thread function's last statement; stop
+// resets srtla_running even for a thread it had to detach
+static std::atomic<bool> srtla_thread_alive(false);
+
+// Stats change detector for the event dispatcher (defined with the stats getters)
+static void reset_stats_event_state();
+static int detect_stats_events();
+
+JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+    srtla_events_init(vm, env);
+    return JNI_VERSION_1_6;
+}
+
 // Thread function to run SRTLA with retry logic
 static void* srtla_thread_func(void* args) {
     SrtlaParams* params = (SrtlaParams*)args;
-    const int RETRY_DELAY_MS = 3000;  // 3 seconds between retries
     const int INITIAL_CONNECTION_TIMEOUT_MS = 5000;  // 5 seconds for initial connection
+    srtla_thread_enter(SRTLA_THREAD_FORWARD, "srtla-forward");
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Starting SRTLA thread with params: host=%s port=%s", 
+    SRTLA_LOGI("SRTLA-JNI", "Starting SRTLA thread with params: host=%s port=%s", 
                        params->srtla_host, params->srtla_port);
     
     // Reset ALL state at thread start to ensure clean slate
+    srtla_stats_reset();
     srtla_retry_count.store(0);
     srtla_connected.store(false);
     srtla_has_ever_connected.store(false);
+
+    // Retry delay grows from a few hundred ms instead of a fixed 3 s
+    // (see srtla_reconnect.h)
+    srtla_backoff_t backoff;
+    srtla_backoff_init(&backoff, SRTLA_RECONNECT_INITIAL_MS, SRTLA_RECONNECT_MAX_MS);
     
     // Track when we started for timeout detection (local to this thread)
     auto thread_start_time = std::chrono::steady_clock::now();
@@ -99,31 +164,39 @@ static void* srtla_thread_func(void* args) {
         // Log current attempt
         if (srtla_has_ever_connected.load()) {
             // We had a connection before, this is a reconnection attempt
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Reconnection attempt %d after disconnect", 
+            SRTLA_LOGI("SRTLA-JNI", "Reconnection attempt %d after disconnect", 
                               srtla_retry_count.load() + 1);
+            srtla_events_post(SRTLA_EVENT_RECONNECT);
         } else if (srtla_retry_count.load() > 0) {
             // Never connected but retrying
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Initial connection retry attempt %d", 
+            SRTLA_LOGI("SRTLA-JNI", "Initial connection retry attempt %d", 
                               srtla_retry_count.load());
+            srtla_events_post(SRTLA_EVENT_RECONNECT);
         } else {
             // Very first attempt
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Initial connection attempt");
+            SRTLA_LOGI("SRTLA-JNI", "Initial connection attempt");
         }
+        srtla_trace_emit(SRTLA_TRACE_RETRY, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_RETRY_ATTEMPT,
+                         (uint32_t)srtla_retry_count.load(), srtla_has_ever_connected.load());
         
         // Call the Android-patched SRTLA function
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Calling srtla_start_android()...");
+        SRTLA_LOGI("SRTLA-JNI", "Calling srtla_start_android()...");
         int result = srtla_start_android(params->listen_port, params->srtla_host,
                                        params->srtla_port, params->ips_file);
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "srtla_start_android() returned: %d", result);
+        SRTLA_LOGI("SRTLA-JNI", "srtla_start_android() returned: %d", result);
+        srtla_trace_emit(SRTLA_TRACE_RETRY, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_RETRY_RETURNED,
+                         (uint32_t)srtla_retry_count.load(), result);
         
         // Check if we should stop
         if (srtla_should_stop.load()) {
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "SRTLA stopped by user");
+            SRTLA_LOGI("SRTLA-JNI", "SRTLA stopped by user");
             break;
         }
         
         // Mark as disconnected since srtla_start_android returned
-        srtla_connected.store(false);
+        if (srtla_connected.exchange(false)) {
+            srtla_backoff_reset(&backoff);
+        }
         
         // Determine if we should retry based on the result and connection history
         bool shouldRetry = false;
@@ -154,7 +227,7 @@ static void* srtla_thread_func(void* args) {
         }
         
         if (!shouldRetry) {
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Not retrying, exiting thread");
+            SRTLA_LOGI("SRTLA-JNI", "Not retrying, exiting thread");
             break;
         }
         
@@ -163,24 +236,30 @@ static void* srtla_thread_func(void* args) {
             srtla_retry_count.fetch_add(1);
         }
         
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", 
+        int retry_delay_ms = srtla_backoff_next(&backoff);
+        SRTLA_LOGI("SRTLA-JNI", 
             "Will retry in %dms (attempt %d) - reason: %s", 
-            RETRY_DELAY_MS, srtla_retry_count.load(), failureReason);
+            retry_delay_ms, srtla_retry_count.load(), failureReason);
+        srtla_trace_emit(SRTLA_TRACE_RETRY, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_RETRY_WAIT,
+                         (uint32_t)srtla_retry_count.load(), retry_delay_ms);
         
-        // Sleep with interruption check
-        for (int i = 0; i < RETRY_DELAY_MS / 100 && !srtla_should_stop.load(); i++) {
-            usleep(100 * 1000);
+        // Sleep until the delay is up or stop is requested
+        {
+            std::unique_lock<std::mutex> lock(retry_wait_mutex);
+            retry_wait_cv.wait_for(lock, std::chrono::milliseconds(retry_delay_ms),
+                                   [] { return srtla_should_stop.load(); });
         }
     }
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "SRTLA thread exiting, cleaning up");
-    delete params;
+    SRTLA_LOGI("SRTLA-JNI", "SRTLA thread exiting, cleaning up");
     
     // Reset state when thread exits
     srtla_running.store(false);
     srtla_retry_count.store(0);
     srtla_connected.store(false);
     srtla_has_ever_connected.store(false);
+    srtla_thread_leave(SRTLA_THREAD_FORWARD);
+    srtla_thread_alive.store(false);
     
     return nullptr;
 }
@@ -190,9 +269,14 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_startSrtlaNative(JNIEnv *env, jclass
                                                      jstring listen_port, jstring srtla_host,
                                                      jstring srtla_port, jstring ips_file) {
     if (srtla_running.load()) {
-        __android_log_print(ANDROID_LOG_WARN, "SRTLA-JNI", "SRTLA already running, ignoring start request");
+        SRTLA_LOGW("SRTLA-JNI", "SRTLA already running, ignoring start request");
         return -1; // Already running
     }
+    if (srtla_thread_alive.load()) {
+        // A detached sender still reads srtla_params and the shared state
+        SRTLA_LOGE("SRTLA-JNI", "Previous SRTLA thread has not exited yet, refusing start request");
+        return -2; // NativeSrtlaJni.START_PREVIOUS_NOT_EXITED
+    }
     
     // Convert Java strings to C strings
     const char* c_listen_port = env->GetStringUTFChars(listen_port, nullptr);
@@ -200,8 +284,9 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_startSrtlaNative(JNIEnv *env, jclass
     const char* c_srtla_port = env->GetStringUTFChars(srtla_port, nullptr);
     const char* c_ips_file = env->GetStringUTFChars(ips_file, nullptr);
     
-    // Create parameter struct for thread
-    SrtlaParams* params = new SrtlaParams();
+    // Fill the parameter struct for the thread
+    SrtlaParams* params = &srtla_params;
+    memset(params, 0, sizeof(*params));
     strncpy(params->listen_port, c_listen_port, sizeof(params->listen_port) - 1);
     strncpy(params->srtla_host, c_srtla_host, sizeof(params->srtla_host) - 1);
     strncpy(params->srtla_port, c_srtla_port, sizeof(params->srtla_port) - 1);
@@ -219,39 +304,52 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_startSrtlaNative(JNIEnv *env, jclass
     srtla_connected.store(false);
     srtla_has_ever_connected.store(false);
     srtla_running.store(true);
+
+    srtla_thread_reset_stats();
     
     // Start SRTLA in background thread with retry logic
+    srtla_thread_alive.store(true);
     if (pthread_create(&srtla_thread, nullptr, srtla_thread_func, params) != 0) {
+        srtla_thread_alive.store(false);
         srtla_running.store(false);
-        delete params;
-        __android_log_print(ANDROID_LOG_ERROR, "SRTLA-JNI", "Failed to create SRTLA thread");
+        SRTLA_LOGE("SRTLA-JNI", "Failed to create SRTLA thread");
         return -1;
     }
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "SRTLA thread started successfully");
+    SRTLA_LOGI("SRTLA-JNI", "SRTLA thread started successfully");
+
+    reset_stats_event_state();
+    if (srtla_events_start(detect_stats_events) != 0) {
+        SRTLA_LOGW("SRTLA-JNI", "Stats events unavailable, Java falls back to polling");
+    }
     return 0;
 }
 
 extern "C" JNIEXPORT jint JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_stopSrtlaNative(JNIEnv *env, jclass clazz) {
     if (!srtla_running.load()) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "SRTLA not running, nothing to stop");
+        SRTLA_LOGI("SRTLA-JNI", "SRTLA not running, nothing to stop");
         return 0;
     }
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Stopping SRTLA process...");
+    SRTLA_LOGI("SRTLA-JNI", "Stopping SRTLA process...");
     
     // Signal the SRTLA process to stop
-    srtla_should_stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(retry_wait_mutex);
+        srtla_should_stop.store(true);
+    }
+    retry_wait_cv.notify_all();
     srtla_stop_android();
     
     // IMPORTANT: Clear any virtual IP socket mappings in the native SRTLA code
     // This ensures we don't try to use stale FDs after restart
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Clearing virtual IP socket mappings");
+    SRTLA_LOGI("SRTLA-JNI", "Clearing virtual IP socket mappings");
     srtla_clear_all_sockets();
+    srtla_relay_clear();
     
     // Wait for thread to actually exit with a reasonable timeout
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Waiting for thread to exit...");
+    SRTLA_LOGI("SRTLA-JNI", "Waiting for thread to exit...");
     
     // Use a loop to check if thread is still running with timeout
     int wait_count = 0;
@@ -262,32 +360,38 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_stopSrtlaNative(JNIEnv *env, jclass c
         wait_count++;
     }
     
-    if (wait_count >= max_wait) {
-        __android_log_print(ANDROID_LOG_WARN, "SRTLA-JNI", "Thread did not exit in time, detaching thread");
+    bool joined = wait_count < max_wait;
+    if (!joined) {
+        SRTLA_LOGW("SRTLA-JNI", "Thread did not exit in time, detaching thread");
         pthread_detach(srtla_thread);
     } else {
         // Thread exited, join it
         void* thread_result;
         pthread_join(srtla_thread, &thread_result);
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Thread joined successfully after %d ms", wait_count * 100);
+        SRTLA_LOGI("SRTLA-JNI", "Thread joined successfully after %d ms", wait_count * 100);
     }
     
     // Force reset ALL state after stopping - ensure clean slate for next start
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Force resetting all state after stop");
+    SRTLA_LOGI("SRTLA-JNI", "Force resetting all state after stop");
     srtla_running.store(false);
     srtla_should_stop.store(false);
     srtla_retry_count.store(0);
     srtla_connected.store(false);
     srtla_has_ever_connected.store(false);
     srtla_retry_enabled.store(false);
+    srtla_stats_reset();
     
     // Clear Java FD tracking
     {
         std::lock_guard<std::mutex> lock(java_fds_mutex);
         java_owned_fds.clear();
+        virtual_ip_fds.clear();
     }
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "SRTLA fully stopped and state completely reset");
+    // Delivers the final STOPPED event once state is reset
+    srtla_events_stop();
+
+    SRTLA_LOGI("SRTLA-JNI", "SRTLA fully stopped and state completely reset");
     
     return 0;
 }
@@ -305,13 +409,15 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getRetryCount(JNIEnv *env, jclass cla
 
 // Add a callback that SRTLA can call when connection is established
 extern "C" void srtla_on_connection_established() {
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Connection established callback from SRTLA");
+    SRTLA_LOGI("SRTLA-JNI", "Connection established callback from SRTLA");
     
     bool wasConnected = srtla_connected.load();
     bool hadEverConnected = srtla_has_ever_connected.load();
     
     srtla_connected.store(true);
     srtla_has_ever_connected.store(true);
+    srtla_trace_emit(SRTLA_TRACE_RETRY, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_RETRY_CONNECTED,
+                     (uint32_t)srtla_retry_count.load(), 0);
     
     // Clear the is_reconnecting flag from native SRTLA code
     extern void srtla_clear_reconnecting(void);
@@ -320,14 +426,15 @@ extern "C" void srtla_on_connection_established() {
     // Only reset retry count if this is a new connection or reconnection
     if (!wasConnected) {
         srtla_retry_count.store(0);
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Connection established, retry count reset and reconnecting flag cleared");
+        SRTLA_LOGI("SRTLA-JNI", "Connection established, retry count reset and reconnecting flag cleared");
     } else {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Connection established, reconnecting flag cleared");
+        SRTLA_LOGI("SRTLA-JNI", "Connection established, reconnecting flag cleared");
     }
     
     if (!hadEverConnected) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "First successful connection achieved");
+        SRTLA_LOGI("SRTLA-JNI", "First successful connection achieved");
     }
+    srtla_events_post(SRTLA_EVENT_CONNECTED);
 }
 
 // Function to check if an FD is owned by Java (exported for srtla_send.c)
@@ -336,24 +443,233 @@ extern "C" int srtla_is_java_owned_fd(int fd) {
     return java_owned_fds.find(fd) != java_owned_fds.end() ? 1 : 0;
 }
 
+// Record fd as the current (Java-owned) socket for virtual_ip, logging a
+// re-registration that supersedes a different fd (probe 1 in
+// docs/STALE_VIRTUAL_CONNECTION_ANALYSIS.md); the superseded fd stays
+// Java-owned. Caller holds java_fds_mutex.
+static void track_virtual_ip_fd_locked(const char* virtual_ip, int socket_fd) {
+    int old_fd = -1;
+    auto it = virtual_ip_fds.find(virtual_ip);
+    if (it != virtual_ip_fds.end() && it->second != socket_fd) {
+        old_fd = it->second;
+    }
+    virtual_ip_fds[virtual_ip] = socket_fd;
+    java_owned_fds.insert(socket_fd);
+    if (old_fd >= 0) {
+        SRTLA_LOGW("SRTLA-JNI",
+                          "Re-registration of %s: FD %d supersedes FD %d",
+                          virtual_ip, socket_fd, old_fd);
+        srtla_trace_emit(SRTLA_TRACE_SOCKET, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_SOCKET_SUPERSEDE,
+                         (uint32_t)socket_fd, old_fd);
+    }
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_notifyNetworkChange(JNIEnv *env, jclass clazz) {
     if (srtla_running) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Network change notification received");
+        SRTLA_LOGI("SRTLA-JNI", "Network change notification received");
+        srtla_trace_emit(SRTLA_TRACE_SOCKET, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_SOCKET_RESCAN, 0, 0);
         schedule_update_conns(0);  // Pass 0 as dummy signal parameter
+        srtla_events_notify();
     } else {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Network change notification ignored - SRTLA not running");
+        SRTLA_LOGI("SRTLA-JNI", "Network change notification ignored - SRTLA not running");
+    }
+}
+
+// Per-connection data as seen by the JNI readers. Filled from the published block
+// (srtla_stats_publish.h) when available, so readers never walk the live
+// connection list; falls back to the direct srtla_get_* getters otherwise.
+// Sized to the current connection count (no fixed cap); one instance per thread
+// keeps its capacity so steady-state polls do not allocate.
+struct ConnectionData {
+    int count = 0;
+    bool published = false;
+    int active_count = 0;
+    bool reconnecting = false;
+    std::vector<double> bitrates;
+    std::vector<char> types;   // count * SRTLA_STATS_TYPE_LEN
+    std::vector<char> ips;     // count * SRTLA_STATS_IP_LEN
+    std::vector<int> loads;
+    std::vector<int> windows;
+    std::vector<int> inflight;
+    std::vector<int> rtt_ms;
+    std::vector<jboolean> active;
+
+    void reserve(int n) {
+        if ((int)bitrates.size() >= n) return;
+        bitrates.resize(n);
+        types.resize((size_t)n * SRTLA_STATS_TYPE_LEN);
+        ips.resize((size_t)n * SRTLA_STATS_IP_LEN);
+        loads.resize(n);
+        windows.resize(n);
+        inflight.resize(n);
+        rtt_ms.resize(n);
+        active.resize(n);
+    }
+    const char* type(int i) const { return &types[(size_t)i * SRTLA_STATS_TYPE_LEN]; }
+    const char* ip(int i) const { return &ips[(size_t)i * SRTLA_STATS_IP_LEN]; }
+};
+
+// The legacy getters only report RTT in the srtla_get_connection_details()
+// text, one "\n\n"-separated section per connection after the total, in the
+// same order as srtla_get_connection_window_data(). Left at -1 if the text
+// does not line up with data.count.
+static void read_legacy_rtt(ConnectionData& data) {
+    thread_local std::vector<char> text;
+    size_t size = 1024 + (size_t)data.count * DETAILS_BYTES_PER_CONNECTION;
+    if (text.size() < size) {
+        text.resize(size);
     }
+    if (data.count == 0 || srtla_get_connection_details(text.data(), (int)text.size()) <= 0) {
+        return;
+    }
+    text.back() = '\0';
+
+    int sections = 0;
+    for (const char* p = strstr(text.data(), "\n\n"); p != nullptr; p = strstr(p + 2, "\n\n")) {
+        sections++;
+    }
+    if (sections != data.count) {
+        return;
+    }
+    const char* section = text.data();
+    for (int i = 0; i < data.count; i++) {
+        section = strstr(section, "\n\n") + 2;
+        const char* end = strstr(section, "\n\n");
+        const char* rtt = strstr(section, "RTT: ");
+        int ms;
+        if (rtt != nullptr && (end == nullptr || rtt < end) && sscanf(rtt + 5, "%d ms", &ms) == 1) {
+            data.rtt_ms[i] = ms;
+        }
+    }
+}
+
+// One walk of the live connection list through the fork's getters
+static void collect_legacy_connection_data(ConnectionData& data) {
+    // The legacy getter truncates at max_connections; grow until it fits
+    int capacity = data.bitrates.size() > 0 ? (int)data.bitrates.size() : 16;
+    int count = 0;
+    for (;;) {
+        data.reserve(capacity);
+        count = srtla_get_connection_window_data(
+            data.bitrates.data(),
+            reinterpret_cast<char (*)[SRTLA_STATS_TYPE_LEN]>(data.types.data()),
+            reinterpret_cast<char (*)[SRTLA_STATS_IP_LEN]>(data.ips.data()),
+            data.loads.data(), data.windows.data(), data.inflight.data(),
+            capacity);
+        if (count < capacity || capacity >= MAX_LEGACY_CONNECTIONS) break;
+        capacity *= 2;
+    }
+    data.count = count > 0 ? count : 0;
+    data.published = false;
+    data.active_count = srtla_get_active_connection_count();
+    data.reconnecting = srtla_is_reconnecting() != 0;
+    for (int i = 0; i < data.count; i++) {
+        data.rtt_ms[i] = -1;
+    }
+    read_legacy_rtt(data);
+}
+
+// Readers use the published block; the live list is only walked (racily, see
+// publish_legacy_stats) before the first publication of a session
+static ConnectionData& collect_connection_data() {
+    thread_local ConnectionData data;
+    thread_local srtla_stats_view view;
+
+    if (srtla_stats_read(&view)) {
+        data.reserve(view.conn_count);
+        data.count = view.conn_count;
+        data.published = true;
+        data.active_count = view.group.active_conn_count;
+        data.reconnecting = view.group.is_reconnecting != 0;
+        for (int i = 0; i < view.conn_count; i++) {
+            const srtla_conn_stats_t& c = view.conns[i];
+            char* type = &data.types[(size_t)i * SRTLA_STATS_TYPE_LEN];
+            char* ip = &data.ips[(size_t)i * SRTLA_STATS_IP_LEN];
+            data.bitrates[i] = c.bitrate_mbps;
+            memcpy(type, c.type, SRTLA_STATS_TYPE_LEN);
+            memcpy(ip, c.ip, SRTLA_STATS_IP_LEN);
+            type[SRTLA_STATS_TYPE_LEN - 1] = '\0';
+            ip[SRTLA_STATS_IP_LEN - 1] = '\0';
+            data.loads[i] = c.load_percent;
+            data.windows[i] = c.window_size;
+            data.inflight[i] = c.in_flight;
+            data.rtt_ms[i] = c.rtt_ms;
+        }
+        return data;
+    }
+
+    collect_legacy_connection_data(data);
+    return data;
+}
+
+#ifndef SRTLA_SENDER_PUBLISHES_STATS
+// The stats writer while the fork's loop does not publish itself
+// (srtla_stats_publish.h): one legacy walk per dispatcher pass, published for
+// every JNI reader. Dispatcher thread only. The walk still reads the fork's
+// live conn list unsynchronised, so it is as racy as the getters were from the
+// JNI threads; the seqlock only keeps the readers consistent with each other.
+static void publish_legacy_stats() {
+    thread_local ConnectionData data;
+    collect_legacy_connection_data(data);
+
+    srtla_stats_publish_begin();
+    for (int i = 0; i < data.count; i++) {
+        srtla_conn_stats_t conn{};
+        memcpy(conn.type, data.type(i), SRTLA_STATS_TYPE_LEN);
+        memcpy(conn.ip, data.ip(i), SRTLA_STATS_IP_LEN);
+        conn.bitrate_mbps = data.bitrates[i];
+        conn.load_percent = data.loads[i];
+        conn.window_size = data.windows[i];
+        conn.in_flight = data.inflight[i];
+        conn.rtt_ms = data.rtt_ms[i];
+        srtla_stats_publish_conn(&conn);
+    }
+    srtla_group_stats_t group{};
+    group.active_conn_count = data.active_count;
+    group.is_reconnecting = data.reconnecting ? 1 : 0;
+    srtla_stats_publish_end(&group);
+}
+#endif
+
+// Connection is active if it has bitrate > 0.1 Mbps OR in-flight packets > 0
+static bool is_connection_active(const ConnectionData& data, int i) {
+    return (data.bitrates[i] > 0.1) || (data.inflight[i] > 0);
+}
+
+// Format connection data in the same text layout srtla_get_connection_details()
+// produces, which is what getAllStats() callers parse.
+static int format_connection_details(const ConnectionData& data, char* buffer, int buffer_size) {
+    double total = 0;
+    for (int i = 0; i < data.count; i++) {
+        total += data.bitrates[i];
+    }
+
+    int len = snprintf(buffer, buffer_size, "Total bitrate: %.2f Mbps", total);
+    for (int i = 0; i < data.count && len < buffer_size; i++) {
+        char rtt[16];
+        if (data.rtt_ms[i] >= 0) {
+            snprintf(rtt, sizeof(rtt), "%d ms", data.rtt_ms[i]);
+        } else {
+            snprintf(rtt, sizeof(rtt), "N/A");
+        }
+        len += snprintf(buffer + len, buffer_size - len,
+                        "\n\n%s\n  Bitrate: %.2f Mbps %d%%\n  Window: %d\n  Packets in-flight: %d\n  RTT: %s",
+                        data.type(i), data.bitrates[i], data.loads[i],
+                        data.windows[i], data.inflight[i], rtt);
+    }
+    return len < buffer_size ? len : buffer_size - 1;
 }
 
 extern "C" JNIEXPORT jint JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionCount(JNIEnv *env, jclass clazz) {
     if (!srtla_running) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "getConnectionCount: SRTLA not running");
+        SRTLA_LOGV("SRTLA-JNI", "getConnectionCount: SRTLA not running");
         return 0;
     }
-    int count = srtla_get_connection_count();
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "getConnectionCount: %d", count);
+    thread_local srtla_stats_view view;
+    int count = srtla_stats_read(&view) ? view.conn_count : srtla_get_connection_count();
+    SRTLA_LOGV("SRTLA-JNI", "getConnectionCount: %d", count);
     return count;
 }
 
@@ -362,8 +678,10 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getActiveConnectionCount(JNIEnv *env,
     if (!srtla_running) {
         return 0;
     }
-    int count = srtla_get_active_connection_count();
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "getActiveConnectionCount: %d", count);
+    thread_local srtla_stats_view view;
+    int count = srtla_stats_read(&view) ? view.group.active_conn_count
+                                        : srtla_get_active_connection_count();
+    SRTLA_LOGV("SRTLA-JNI", "getActiveConnectionCount: %d", count);
     return count;
 }
 
@@ -372,13 +690,56 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getTotalInFlightPackets(JNIEnv *env,
     if (!srtla_running) {
         return 0;
     }
-    int count = srtla_get_total_in_flight_packets();
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "getTotalInFlightPackets: %d", count);
+    int count = 0;
+    thread_local srtla_stats_view view;
+    if (srtla_stats_read(&view)) {
+        for (int i = 0; i < view.conn_count; i++) {
+            count += view.conns[i].in_flight;
+        }
+    } else {
+        count = srtla_get_total_in_flight_packets();
+    }
+    SRTLA_LOGV("SRTLA-JNI", "getTotalInFlightPackets: %d", count);
     return count;
 }
 
 
 
+// If we have active connections but are not marked as connected, update the
+// state (the established callback can lag the first ACKs). Shared by every
+// stats getter so they agree. Returns true if the state changed.
+static bool mark_connected_if_active(int activeConnections) {
+    if (srtla_connected.load() || activeConnections <= 0) {
+        return false;
+    }
+    SRTLA_LOGI("SRTLA-JNI", "Detected active connections, marking as connected");
+    srtla_connected.store(true);
+    srtla_has_ever_connected.store(true);
+    srtla_retry_count.store(0);
+    return true;
+}
+
+// Why there are no stats to show in this state, or nullptr if there are.
+// Don't treat a temporary drop of activeConnections to 0 as disconnected; the
+// srtla_on_connection_established() callback and reconnection logic handle
+// state properly.
+static const char* stats_hidden_reason(int retryCount, bool isConnected, bool isReconnecting,
+                                       bool hasEverConnected, int activeConnections) {
+    if (!hasEverConnected && retryCount == 0) {
+        // Initial connection attempt, show "Connecting..."
+        return "Initial connection attempt in progress";
+    }
+    // Only hide stats if we're reconnecting AND have NO active connections
+    // This allows partial connectivity to show stats (e.g., WiFi down but Cellular still working)
+    if ((isReconnecting || (!isConnected && hasEverConnected)) && activeConnections == 0) {
+        return "Reconnecting with no active connections";
+    }
+    if (!isConnected && retryCount > 0 && activeConnections == 0) {
+        return "In retry mode, no active connections";
+    }
+    return nullptr;
+}
+
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getAllStats(JNIEnv *env, jclass clazz) {
     if (!srtla_running.load()) {
@@ -386,65 +747,49 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getAllStats(JNIEnv *env, jclass clazz
     }
     
     // Get connection counts
-    int totalConnections = srtla_get_connection_count();
-    int activeConnections = srtla_get_active_connection_count();
+    ConnectionData& data = collect_connection_data();
+    int totalConnections = data.count;
+    int activeConnections = data.active_count;
     int retryCount = srtla_retry_count.load();
     bool isConnected = srtla_connected.load();
     bool hasEverConnected = srtla_has_ever_connected.load();
-    bool isReconnecting = srtla_is_reconnecting();
+    bool isReconnecting = data.reconnecting;
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", 
+    SRTLA_LOGV("SRTLA-JNI",
         "getAllStats: total=%d, active=%d, retry_count=%d, connected=%d, ever_connected=%d, reconnecting=%d", 
         totalConnections, activeConnections, retryCount, isConnected, hasEverConnected, isReconnecting);
     
-    // If we have active connections but not marked as connected, update state
-    if (!isConnected && activeConnections > 0) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Detected active connections, marking as connected");
-        srtla_connected.store(true);
-        srtla_has_ever_connected.store(true);
-        srtla_retry_count.store(0);
+    if (mark_connected_if_active(activeConnections)) {
         isConnected = true;  // Update local variable
         retryCount = 0;      // Update local variable
     }
     
-    // Don't mark as disconnected just because activeConnections temporarily dropped to 0
-    // Only mark disconnected if we're actually reconnecting or have errors
-    // The srtla_on_connection_established() callback and reconnection logic handle state properly
-    
     // Determine what to show based on state
-    if (!hasEverConnected && retryCount == 0) {
-        // Initial connection attempt, show "Connecting..."
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Initial connection attempt in progress");
-        return env->NewStringUTF("");
-    }
-    
-    // Only hide stats if we're reconnecting AND have NO active connections
-    // This allows partial connectivity to show stats (e.g., WiFi down but Cellular still working)
-    if ((isReconnecting || (!isConnected && hasEverConnected)) && activeConnections == 0) {
-        // We're reconnecting and all connections are down
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Reconnecting with no active connections");
-        return env->NewStringUTF("");
-    }
-    
-    if (!isConnected && retryCount > 0 && activeConnections == 0) {
-        // We're in retry mode with no active connections
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "In retry mode (attempt %d), no active connections", retryCount);
+    const char* hidden = stats_hidden_reason(retryCount, isConnected, isReconnecting,
+                                             hasEverConnected, activeConnections);
+    if (hidden != nullptr) {
+        SRTLA_LOG_EVERY(POLL_LOG_INTERVAL_MS, ANDROID_LOG_INFO, "SRTLA-JNI", "%s", hidden);
         return env->NewStringUTF("");
     }
     
     // Get detailed per-connection stats
-    char detailsBuffer[1024];
-    int detailsLen = srtla_get_connection_details(detailsBuffer, sizeof(detailsBuffer));
+    thread_local std::vector<char> detailsStorage;
+    size_t detailsSize = 1024 + (size_t)totalConnections * DETAILS_BYTES_PER_CONNECTION;
+    if (detailsStorage.size() < detailsSize) {
+        detailsStorage.resize(detailsSize);
+    }
+    char* detailsBuffer = detailsStorage.data();
+    int detailsLen = format_connection_details(data, detailsBuffer, (int)detailsStorage.size());
     
     // If we have no stats data yet
     if (detailsLen <= 0 || strlen(detailsBuffer) == 0) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "No stats data available yet");
+        SRTLA_LOG_EVERY(POLL_LOG_INTERVAL_MS, ANDROID_LOG_INFO, "SRTLA-JNI", "No stats data available yet");
         return env->NewStringUTF("");
     }
     
     // If we're reconnecting but have active connections, add indicator to stats
     if (isReconnecting && activeConnections > 0) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", 
+        SRTLA_LOG_EVERY(POLL_LOG_INTERVAL_MS, ANDROID_LOG_INFO, "SRTLA-JNI",
             "Showing stats during partial reconnection (active: %d, total: %d)", 
             activeConnections, totalConnections);
     }
@@ -452,6 +797,17 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getAllStats(JNIEnv *env, jclass clazz
     return env->NewStringUTF(detailsBuffer);
 }
 
+// We're retrying/reconnecting if:
+// 1. retry count > 0 AND not connected (initial connection attempts)
+// 2. is_reconnecting flag is set (lost connection and attempting to reconnect)
+// 3. not connected but has ever connected (detected disconnection)
+static bool compute_is_retrying(int retryCount, bool isConnected, bool isReconnecting,
+                                bool hasEverConnected, int activeCount) {
+    return ((retryCount > 0) && !isConnected) ||
+           (isReconnecting && !isConnected) ||
+           (!isConnected && hasEverConnected && activeCount == 0);
+}
+
 // Update isRetrying to check both retry count and reconnecting flag
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_isRetrying(JNIEnv *env, jclass clazz) {
@@ -459,22 +815,18 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_isRetrying(JNIEnv *env, jclass clazz)
         return JNI_FALSE;
     }
     
+    thread_local srtla_stats_view view;
+    bool published = srtla_stats_read(&view);
     int retryCount = srtla_retry_count.load();
     bool isConnected = srtla_connected.load();
-    bool isReconnecting = srtla_is_reconnecting();
-    int activeCount = srtla_get_active_connection_count();
-    
-    // We're retrying/reconnecting if:
-    // 1. retry count > 0 AND not connected (initial connection attempts)
-    // 2. is_reconnecting flag is set (lost connection and attempting to reconnect)
-    // 3. not connected but has ever connected (detected disconnection)
+    bool isReconnecting = published ? view.group.is_reconnecting != 0 : srtla_is_reconnecting() != 0;
+    int activeCount = published ? view.group.active_conn_count : srtla_get_active_connection_count();
     bool hasEverConnected = srtla_has_ever_connected.load();
-    bool isRetrying = ((retryCount > 0) && !isConnected) || 
-                      (isReconnecting && !isConnected) || 
-                      (!isConnected && hasEverConnected && activeCount == 0);
+    bool isRetrying = compute_is_retrying(retryCount, isConnected, isReconnecting,
+                                          hasEverConnected, activeCount);
     
     if (isRetrying) {
-        __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", 
+        SRTLA_LOG_EVERY(POLL_LOG_INTERVAL_MS, ANDROID_LOG_INFO, "SRTLA-JNI",
                           "isRetrying: true (retry_count=%d, connected=%d, reconnecting=%d, active=%d)", 
                           retryCount, isConnected, isReconnecting, activeCount);
     }
@@ -482,6 +834,89 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_isRetrying(JNIEnv *env, jclass clazz)
     return isRetrying ? JNI_TRUE : JNI_FALSE;
 }
 
+// Last state seen by detect_stats_events(). Only touched by the event dispatcher
+// thread, and reset before it starts.
+struct StatsEventState {
+    struct Link {
+        bool active;
+        int window;
+    };
+    std::map<std::string, Link> links;
+    double reported_bitrate = 0.0;
+    bool connected = false;
+    bool reconnecting = false;
+    int retry_count = 0;
+};
+static StatsEventState stats_event_state;
+
+// Throughput events fire when the total moves by more than both thresholds
+static const double EVENT_BITRATE_DELTA_MBPS = 0.5;
+static const double EVENT_BITRATE_DELTA_RATIO = 0.2;
+// A window collapse is a drop to half or less, by at least this much
+static const int EVENT_WINDOW_COLLAPSE_MIN_DROP = 5000;
+
+static void reset_stats_event_state() {
+    stats_event_state = StatsEventState();
+}
+
+static int detect_stats_events() {
+    if (!srtla_running.load()) {
+        return 0;
+    }
+#ifndef SRTLA_SENDER_PUBLISHES_STATS
+    publish_legacy_stats();
+#endif
+    StatsEventState& prev = stats_event_state;
+    ConnectionData& data = collect_connection_data();
+    int events = 0;
+
+    std::map<std::string, StatsEventState::Link> links;
+    double total_bitrate = 0.0;
+    for (int i = 0; i < data.count; i++) {
+        StatsEventState::Link link = { is_connection_active(data, i), data.windows[i] };
+        total_bitrate += data.bitrates[i];
+
+        auto it = prev.links.find(data.ip(i));
+        if (it == prev.links.end()) {
+            if (link.active) events |= SRTLA_EVENT_CONNECTION_UP;
+        } else {
+            if (link.active && !it->second.active) events |= SRTLA_EVENT_CONNECTION_UP;
+            if (!link.active && it->second.active) events |= SRTLA_EVENT_CONNECTION_DOWN;
+            if (link.window * 2 <= it->second.window &&
+                it->second.window - link.window >= EVENT_WINDOW_COLLAPSE_MIN_DROP) {
+                events |= SRTLA_EVENT_WINDOW_COLLAPSE;
+            }
+        }
+        links[data.ip(i)] = link;
+    }
+    for (const auto& entry : prev.links) {
+        if (entry.second.active && links.find(entry.first) == links.end()) {
+            events |= SRTLA_EVENT_CONNECTION_DOWN;
+        }
+    }
+    prev.links.swap(links);
+
+    double delta = total_bitrate - prev.reported_bitrate;
+    if (delta < 0) delta = -delta;
+    if (delta > EVENT_BITRATE_DELTA_MBPS && delta > prev.reported_bitrate * EVENT_BITRATE_DELTA_RATIO) {
+        events |= SRTLA_EVENT_THROUGHPUT;
+        prev.reported_bitrate = total_bitrate;
+    }
+
+    bool connected = srtla_connected.load();
+    bool reconnecting = data.reconnecting;
+    int retry_count = srtla_retry_count.load();
+    if (connected && !prev.connected) events |= SRTLA_EVENT_CONNECTED;
+    if ((reconnecting && !prev.reconnecting) || retry_count > prev.retry_count) {
+        events |= SRTLA_EVENT_RECONNECT;
+    }
+    prev.connected = connected;
+    prev.reconnecting = reconnecting;
+    prev.retry_count = retry_count;
+
+    return events;
+}
+
 // Virtual IP JNI function
 extern "C" JNIEXPORT void JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_setNetworkSocket(JNIEnv *env, jclass clazz,
@@ -493,13 +928,17 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_setNetworkSocket(JNIEnv *env, jclass
     // Track this as a Java-owned FD
     {
         std::lock_guard<std::mutex> lock(java_fds_mutex);
-        java_owned_fds.insert(socket_fd);
-        __android_log_print(ANDROID_LOG_DEBUG, "SRTLA-JNI", 
+        track_virtual_ip_fd_locked(virtual_ip_str, socket_fd);
+        SRTLA_LOGD("SRTLA-JNI", 
                           "Tracking Java-owned FD %d for %s->%s", 
                           socket_fd, virtual_ip_str, real_ip_str);
     }
+    srtla_trace_emit(SRTLA_TRACE_SOCKET, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_SOCKET_ADD,
+                     (uint32_t)socket_fd, network_type);
     
+    srtla_sock_apply_profile(socket_fd, network_type);
     srtla_set_network_socket(virtual_ip_str, real_ip_str, network_type, socket_fd);
+    srtla_events_notify();
     
     env->ReleaseStringUTFChars(virtual_ip, virtual_ip_str);
     env->ReleaseStringUTFChars(real_ip, real_ip_str);
@@ -519,21 +958,218 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_setRelaySocket(JNIEnv *env, jclass cl
     // Track this as a Java-owned FD so native code never closes it.
     {
         std::lock_guard<std::mutex> lock(java_fds_mutex);
-        java_owned_fds.insert(socket_fd);
-        __android_log_print(ANDROID_LOG_DEBUG, "SRTLA-JNI",
+        track_virtual_ip_fd_locked(virtual_ip_str, socket_fd);
+        SRTLA_LOGD("SRTLA-JNI",
                           "Tracking Java-owned relay FD %d for %s->%s:%d '%s'",
                           socket_fd, virtual_ip_str, relay_ip_str, relay_port,
                           name_str ? name_str : "RELAY");
     }
 
+    srtla_sock_apply_profile(socket_fd, SRTLA_LINK_RELAY);
     srtla_set_relay_socket(virtual_ip_str, relay_ip_str, relay_port, socket_fd,
                            name_str ? name_str : "");
+    srtla_events_notify();
 
     env->ReleaseStringUTFChars(virtual_ip, virtual_ip_str);
     env->ReleaseStringUTFChars(relay_ip, relay_ip_str);
     if (name_str) env->ReleaseStringUTFChars(name, name_str);
 }
 
+// Native relay manager (srtla_relay.h): the virtual IP is assigned here; the
+// caller still rewrites the IPs file and calls notifyNetworkChange(). Returns
+// the virtual IP, or null when every relay slot is taken (the socket is then
+// not adopted).
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_addRelay(JNIEnv *env, jclass clazz, jstring relay_id,
+                                                   jstring name, jstring relay_ip,
+                                                   jint relay_port, jint socket_fd) {
+    const char *id_str = env->GetStringUTFChars(relay_id, nullptr);
+    const char *name_str = name ? env->GetStringUTFChars(name, nullptr) : nullptr;
+    const char *relay_ip_str = env->GetStringUTFChars(relay_ip, nullptr);
+
+    jstring result = nullptr;
+    char virtual_ip[SRTLA_RELAY_VIP_LEN];
+    if (srtla_relay_add(id_str, name_str, relay_ip_str, relay_port, socket_fd,
+                        virtual_ip, sizeof(virtual_ip)) == 0) {
+        {
+            // A re-added relay's previous socket is superseded like any re-registration
+            std::lock_guard<std::mutex> lock(java_fds_mutex);
+            track_virtual_ip_fd_locked(virtual_ip, socket_fd);
+        }
+        srtla_sock_apply_profile(socket_fd, SRTLA_LINK_RELAY);
+        srtla_set_relay_socket(virtual_ip, relay_ip_str, relay_port, socket_fd,
+                               name_str ? name_str : "");
+        SRTLA_LOGI("SRTLA-JNI", "Relay '%s' added as %s -> %s:%d (FD %d)",
+                   id_str, virtual_ip, relay_ip_str, relay_port, socket_fd);
+        srtla_events_notify();
+        result = env->NewStringUTF(virtual_ip);
+    }
+
+    env->ReleaseStringUTFChars(relay_id, id_str);
+    if (name_str) env->ReleaseStringUTFChars(name, name_str);
+    env->ReleaseStringUTFChars(relay_ip, relay_ip_str);
+    return result;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_removeRelay(JNIEnv *env, jclass clazz, jstring relay_id) {
+    const char *id_str = env->GetStringUTFChars(relay_id, nullptr);
+    char virtual_ip[SRTLA_RELAY_VIP_LEN];
+    bool removed = srtla_relay_remove(id_str, virtual_ip, sizeof(virtual_ip)) == 0;
+    if (removed) {
+        SRTLA_LOGI("SRTLA-JNI", "Relay '%s' (%s) removed", id_str, virtual_ip);
+        srtla_events_notify();
+    }
+    env->ReleaseStringUTFChars(relay_id, id_str);
+    return removed ? JNI_TRUE : JNI_FALSE;
+}
+
+// Battery percent and ThermalState ordinal from the relay's status report; -1 = unknown
+extern "C" JNIEXPORT void JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_setRelayStatus(JNIEnv *env, jclass clazz, jstring relay_id,
+                                                         jint battery, jint thermal) {
+    const char *id_str = env->GetStringUTFChars(relay_id, nullptr);
+    srtla_relay_set_status(id_str, battery, thermal);
+    env->ReleaseStringUTFChars(relay_id, id_str);
+}
+
+// Self-test (srtla_selftest.h): loopback echo receiver the sender is started
+// against, and one paced step of synthetic SRT traffic at a time
+extern "C" JNIEXPORT jint JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_startSelfTestEcho(JNIEnv *env, jclass clazz) {
+    int port = srtla_selftest_echo_start();
+    if (port < 0) {
+        SRTLA_LOGE("SRTLA-JNI", "Self-test echo failed to start: %s", strerror(errno));
+    } else {
+        SRTLA_LOGI("SRTLA-JNI", "Self-test echo listening on 127.0.0.1:%d", port);
+    }
+    return port;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_stopSelfTestEcho(JNIEnv *env, jclass clazz) {
+    srtla_selftest_echo_stop();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_getSelfTestEchoLinks(JNIEnv *env, jclass clazz) {
+    return srtla_selftest_echo_links();
+}
+
+// Blocks for the step; the forwarding thread's CPU is charged unless the step
+// goes straight to the echo (baseline)
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_runSelfTestStep(JNIEnv *env, jclass clazz, jint port,
+                                                           jint pps, jint duration_ms,
+                                                           jboolean through_sender) {
+    int tid = 0;
+    if (through_sender) {
+        srtla_thread_stats_t thread_stats;
+        srtla_thread_get_stats(SRTLA_THREAD_FORWARD, &thread_stats);
+        tid = thread_stats.tid;
+    }
+    srtla_selftest_step_t step;
+    if (srtla_selftest_run_step(port, pps, duration_ms, tid, &step) != 0) {
+        SRTLA_LOGW("SRTLA-JNI", "Self-test step rejected: port %d, %d pps, %d ms",
+                   port, pps, duration_ms);
+        return nullptr;
+    }
+    SRTLA_LOGI("SRTLA-JNI", "Self-test %d pps: %llu/%llu delivered, p99 %llu us, %s",
+               pps, (unsigned long long)step.delivered, (unsigned long long)step.sent,
+               (unsigned long long)step.p99_us, step.sustained ? "sustained" : "not sustained");
+    jlong values[] = {
+        step.target_pps,
+        step.duration_ms,
+        (jlong)step.sent,
+        (jlong)step.delivered,
+        (jlong)step.duplicates,
+        (jlong)step.achieved_pps,
+        (jlong)step.delivered_pps,
+        (jlong)step.p50_us,
+        (jlong)step.p99_us,
+        (jlong)step.max_us,
+        (jlong)step.jitter_us,
+        (jlong)step.max_send_late_us,
+        step.cpu_ns_per_packet,
+        step.sustained,
+    };
+    jsize count = (jsize)(sizeof(values) / sizeof(values[0]));
+    jlongArray result = env->NewLongArray(count);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_getCoreClusters(JNIEnv *env, jclass clazz) {
+    uint64_t little = 0, big = 0;
+    int clusters = srtla_selftest_core_masks(&little, &big);
+    jlong values[] = {clusters, (jlong)little, (jlong)big};
+    jsize count = (jsize)(sizeof(values) / sizeof(values[0]));
+    jlongArray result = env->NewLongArray(count);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count, values);
+    }
+    return result;
+}
+
+// Priority and affinity of a native thread role (srtla_thread.h); applied at
+// once if the thread runs, otherwise when it starts
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_setThreadConfig(JNIEnv *env, jclass clazz, jint role,
+                                                          jint nice, jint fifo_priority,
+                                                          jlong cpu_mask) {
+    return srtla_thread_configure(role, nice, fifo_priority, (uint64_t)cpu_mask) == 0
+        ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_getThreadStats(JNIEnv *env, jclass clazz, jint role) {
+    srtla_thread_stats_t stats;
+    srtla_thread_get_stats(role, &stats);
+    jlong values[] = {
+        stats.tid, stats.nice, stats.fifo_priority, stats.fifo_refused,
+        (jlong)stats.cpu_mask, stats.last_cpu, (jlong)stats.migrations, (jlong)stats.samples,
+        stats.samples > 0 ? (jlong)(stats.total_us / stats.samples) : 0,
+        (jlong)srtla_thread_latency_quantile(&stats, 0.5),
+        (jlong)srtla_thread_latency_quantile(&stats, 0.99),
+        (jlong)stats.max_us,
+    };
+#ifndef SRTLA_SENDER_USES_REACTOR
+    // Forwarding latency is sampled by the reactor, which only a loop built on
+    // it (srtla_reactor.h) waits in; for the fork's own loop it is not measured
+    if (role == SRTLA_THREAD_FORWARD) {
+        for (int i = 7; i < 12; i++) values[i] = -1;
+    }
+#endif
+    jsize count = (jsize)(sizeof(values) / sizeof(values[0]));
+    jlongArray result = env->NewLongArray(count);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count, values);
+    }
+    return result;
+}
+
+// Recent native log events (srtla_log ring), oldest first. Non-ASCII bytes are
+// replaced so the text is always valid modified UTF-8 for NewStringUTF.
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_dumpNativeLog(JNIEnv *env, jclass clazz) {
+    std::vector<char> buffer(64 * 1024);
+    size_t len = srtla_log_dump(buffer.data(), buffer.size());
+    for (size_t i = 0; i < len; i++) {
+        if ((unsigned char)buffer[i] >= 0x80) buffer[i] = '?';
+    }
+    return env->NewStringUTF(buffer.data());
+}
+
+// Minimum level forwarded to logcat (android.util.Log priority). Lower levels
+// are still recorded in the ring for dumpNativeLog().
+extern "C" JNIEXPORT void JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_setNativeLogLevel(JNIEnv *env, jclass clazz, jint level) {
+    srtla_log_set_level(level);
+}
+
 // Add a new JNI method to check if connected
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_isConnected(JNIEnv *env, jclass clazz) {
@@ -545,80 +1181,94 @@ extern "C" JNIEXPORT jint JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_createUdpSocketNative(JNIEnv *env, jclass clazz) {
     int sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
     if (sockfd < 0) {
-        __android_log_print(ANDROID_LOG_ERROR, "SRTLA-JNI", "Failed to create UDP socket: %s", strerror(errno));
+        SRTLA_LOGE("SRTLA-JNI", "Failed to create UDP socket: %s", strerror(errno));
         return -1;
     }
     
-    // Set socket options
+    // Baseline buffers; srtla_sock_apply_profile() re-sizes them for the link
+    // type once the socket is registered
     int bufsize = 212992;
     if (setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize)) != 0) {
-        __android_log_print(ANDROID_LOG_WARN, "SRTLA-JNI", "Failed to set send buffer size: %s", strerror(errno));
+        SRTLA_LOGW("SRTLA-JNI", "Failed to set send buffer size: %s", strerror(errno));
     }
     if (setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize)) != 0) {
-        __android_log_print(ANDROID_LOG_WARN, "SRTLA-JNI", "Failed to set recv buffer size: %s", strerror(errno));
+        SRTLA_LOGW("SRTLA-JNI", "Failed to set recv buffer size: %s", strerror(errno));
     }
     
-    __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Created native UDP socket with FD: %d", sockfd);
+    SRTLA_LOGI("SRTLA-JNI", "Created native UDP socket with FD: %d", sockfd);
     return sockfd;
 }
 
+// Session trace into a memory-mapped ring file (srtla_trace.h); records <= 0
+// takes the default size. Off until started.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_startTrace(JNIEnv *env, jclass clazz,
+                                                      jstring path, jint records) {
+    const char* path_str = env->GetStringUTFChars(path, nullptr);
+    bool started = srtla_trace_start(path_str, records) == 0;
+    if (started) {
+        SRTLA_LOGI("SRTLA-JNI", "Session trace started: %s", path_str);
+    } else {
+        SRTLA_LOGW("SRTLA-JNI", "Session trace to %s failed: %s", path_str, strerror(errno));
+    }
+    env->ReleaseStringUTFChars(path, path_str);
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_stopTrace(JNIEnv *env, jclass clazz) {
+    if (!srtla_trace_active()) return;
+    uint64_t count = srtla_trace_count();
+    srtla_trace_stop();
+    SRTLA_LOGI("SRTLA-JNI", "Session trace stopped after %llu records", (unsigned long long)count);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_isTraceActive(JNIEnv *env, jclass clazz) {
+    return srtla_trace_active() ? JNI_TRUE : JNI_FALSE;
+}
+
+// SO_BUSY_POLL for sockets registered from now on (srtla_sock_profile.h); 0 = off
+extern "C" JNIEXPORT void JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_setSocketBusyPoll(JNIEnv *env, jclass clazz, jint usec) {
+    srtla_sock_set_busy_poll(usec);
+}
+
 // Native socket close (used by SrtlaSender)
 extern "C" JNIEXPORT void JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_closeSocketNative(JNIEnv *env, jclass clazz, jint sockfd) {
     if (sockfd >= 0) {
         if (close(sockfd) == 0) {
-            __android_log_print(ANDROID_LOG_INFO, "SRTLA-JNI", "Successfully closed socket FD: %d", sockfd);
+            SRTLA_LOGI("SRTLA-JNI", "Successfully closed socket FD: %d", sockfd);
         } else {
-            __android_log_print(ANDROID_LOG_ERROR, "SRTLA-JNI", "Failed to close socket FD %d: %s", sockfd, strerror(errno));
+            SRTLA_LOGE("SRTLA-JNI", "Failed to close socket FD %d: %s", sockfd, strerror(errno));
         }
     } else {
-        __android_log_print(ANDROID_LOG_WARN, "SRTLA-JNI", "Attempted to close invalid socket FD: %d", sockfd);
+        SRTLA_LOGW("SRTLA-JNI", "Attempted to close invalid socket FD: %d", sockfd);
     }
 }
 
 // Per-connection bitrate JNI functions
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionBitrates(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    
-    int conn_count = srtla_get_connection_bitrates(bitrates, connection_types, 
-                                                  connection_ips, load_percentages, 
-                                                  MAX_CONNECTIONS);
+    ConnectionData& data = collect_connection_data();
     
-    if (conn_count <= 0) {
-        return env->NewDoubleArray(0);
+    jdoubleArray result = env->NewDoubleArray(data.count);
+    if (data.count > 0) {
+        env->SetDoubleArrayRegion(result, 0, data.count, data.bitrates.data());
     }
-    
-    jdoubleArray result = env->NewDoubleArray(conn_count);
-    env->SetDoubleArrayRegion(result, 0, conn_count, bitrates);
     return result;
 }
 
 extern "C" JNIEXPORT jobjectArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionTypes(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    
-    int conn_count = srtla_get_connection_bitrates(bitrates, connection_types, 
-                                                  connection_ips, load_percentages, 
-                                                  MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewObjectArray(0, env->FindClass("java/lang/String"), nullptr);
-    }
+    ConnectionData& data = collect_connection_data();
     
     jclass stringClass = env->FindClass("java/lang/String");
-    jobjectArray result = env->NewObjectArray(conn_count, stringClass, nullptr);
+    jobjectArray result = env->NewObjectArray(data.count, stringClass, nullptr);
     
-    for (int i = 0; i < conn_count; i++) {
-        env->SetObjectArrayElement(result, i, env->NewStringUTF(connection_types[i]));
+    for (int i = 0; i < data.count; i++) {
+        env->SetObjectArrayElement(result, i, env->NewStringUTF(data.type(i)));
     }
     
     return result;
@@ -626,25 +1276,13 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionTypes(JNIEnv *env, jclas
 
 extern "C" JNIEXPORT jobjectArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionIPs(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    
-    int conn_count = srtla_get_connection_bitrates(bitrates, connection_types, 
-                                                  connection_ips, load_percentages, 
-                                                  MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewObjectArray(0, env->FindClass("java/lang/String"), nullptr);
-    }
+    ConnectionData& data = collect_connection_data();
     
     jclass stringClass = env->FindClass("java/lang/String");
-    jobjectArray result = env->NewObjectArray(conn_count, stringClass, nullptr);
+    jobjectArray result = env->NewObjectArray(data.count, stringClass, nullptr);
     
-    for (int i = 0; i < conn_count; i++) {
-        env->SetObjectArrayElement(result, i, env->NewStringUTF(connection_ips[i]));
+    for (int i = 0; i < data.count; i++) {
+        env->SetObjectArrayElement(result, i, env->NewStringUTF(data.ip(i)));
     }
     
     return result;
@@ -652,103 +1290,165 @@ Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionIPs(JNIEnv *env, jclass
 
 extern "C" JNIEXPORT jintArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionLoadPercentages(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
+    ConnectionData& data = collect_connection_data();
     
-    int conn_count = srtla_get_connection_bitrates(bitrates, connection_types, 
-                                                  connection_ips, load_percentages, 
-                                                  MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewIntArray(0);
+    jintArray result = env->NewIntArray(data.count);
+    if (data.count > 0) {
+        env->SetIntArrayRegion(result, 0, data.count, data.loads.data());
     }
-    
-    jintArray result = env->NewIntArray(conn_count);
-    env->SetIntArrayRegion(result, 0, conn_count, load_percentages);
     return result;
 }
 
 // New JNI functions for comprehensive window data
 extern "C" JNIEXPORT jintArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionWindowSizes(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    int window_sizes[MAX_CONNECTIONS];
-    int inflight_packets[MAX_CONNECTIONS];
+    ConnectionData& data = collect_connection_data();
     
-    int conn_count = srtla_get_connection_window_data(bitrates, connection_types, 
-                                                     connection_ips, load_percentages,
-                                                     window_sizes, inflight_packets,
-                                                     MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewIntArray(0);
+    jintArray result = env->NewIntArray(data.count);
+    if (data.count > 0) {
+        env->SetIntArrayRegion(result, 0, data.count, data.windows.data());
     }
-    
-    jintArray result = env->NewIntArray(conn_count);
-    env->SetIntArrayRegion(result, 0, conn_count, window_sizes);
     return result;
 }
 
 extern "C" JNIEXPORT jintArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionInFlightPackets(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    int window_sizes[MAX_CONNECTIONS];
-    int inflight_packets[MAX_CONNECTIONS];
+    ConnectionData& data = collect_connection_data();
     
-    int conn_count = srtla_get_connection_window_data(bitrates, connection_types, 
-                                                     connection_ips, load_percentages,
-                                                     window_sizes, inflight_packets,
-                                                     MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewIntArray(0);
+    jintArray result = env->NewIntArray(data.count);
+    if (data.count > 0) {
+        env->SetIntArrayRegion(result, 0, data.count, data.inflight.data());
     }
-    
-    jintArray result = env->NewIntArray(conn_count);
-    env->SetIntArrayRegion(result, 0, conn_count, inflight_packets);
     return result;
 }
 
 extern "C" JNIEXPORT jbooleanArray JNICALL
 Java_com_dimadesu_bondbunny_NativeSrtlaJni_getConnectionActiveStatus(JNIEnv *env, jclass clazz) {
-    const int MAX_CONNECTIONS = 10;
-    double bitrates[MAX_CONNECTIONS];
-    char connection_types[MAX_CONNECTIONS][16];
-    char connection_ips[MAX_CONNECTIONS][64];
-    int load_percentages[MAX_CONNECTIONS];
-    int window_sizes[MAX_CONNECTIONS];
-    int inflight_packets[MAX_CONNECTIONS];
-    int active_status[MAX_CONNECTIONS];
-    
-    int conn_count = srtla_get_connection_window_data(bitrates, connection_types, 
-                                                     connection_ips, load_percentages,
-                                                     window_sizes, inflight_packets,
-                                                     MAX_CONNECTIONS);
-    
-    if (conn_count <= 0) {
-        return env->NewBooleanArray(0);
-    }
-    
-    // Determine active status based on available data
-    jbooleanArray result = env->NewBooleanArray(conn_count);
-    jboolean* statusArray = new jboolean[conn_count];
-    for (int i = 0; i < conn_count; i++) {
-        // Connection is active if it has bitrate > 0.1 Mbps OR in-flight packets > 0
-        bool isActive = (bitrates[i] > 0.1) || (inflight_packets[i] > 0);
-        statusArray[i] = isActive ? JNI_TRUE : JNI_FALSE;
+    ConnectionData& data = collect_connection_data();
+    
+    jbooleanArray result = env->NewBooleanArray(data.count);
+    for (int i = 0; i < data.count; i++) {
+        data.active[i] = is_connection_active(data, i) ? JNI_TRUE : JNI_FALSE;
+    }
+    if (data.count > 0) {
+        env->SetBooleanArrayRegion(result, 0, data.count, data.active.data());
     }
-    env->SetBooleanArrayRegion(result, 0, conn_count, statusArray);
-    delete[] statusArray;
     return result;
-}
\ No newline at end of file
+}
+
+// Single-call stats snapshot: fills a caller-owned direct ByteBuffer with the
+// layout described in srtla_stats_snapshot.h. All per-connection arrays come
+// from one published block (or one srtla_get_connection_window_data() walk),
+// so they always agree with each other and with the totals derived from them.
+//
+// Returns the number of bytes written, 0 if the buffer is not a direct buffer,
+// or -(required size) if the buffer is too small for the current connection count.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_dimadesu_bondbunny_NativeSrtlaJni_getStatsSnapshot(JNIEnv *env, jclass clazz, jobject buffer) {
+    using namespace srtla_snapshot;
+
+    uint8_t* out = buffer ? static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer)) : nullptr;
+    jlong capacity = buffer ? env->GetDirectBufferCapacity(buffer) : -1;
+    if (out == nullptr || capacity < (jlong)SNAPSHOT_HEADER_SIZE) {
+        return 0;
+    }
+
+    SnapshotHeader header{};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    header.timestamp_ms = (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+
+    ConnectionData* data = nullptr;
+    if (srtla_running.load()) {
+        data = &collect_connection_data();
+
+        int activeCount = data->active_count;
+        mark_connected_if_active(activeCount);
+        bool isConnected = srtla_connected.load();
+        bool hasEverConnected = srtla_has_ever_connected.load();
+        bool isReconnecting = data->reconnecting;
+        int retryCount = srtla_retry_count.load();
+
+        header.active_conn_count = activeCount;
+        header.retry_count = retryCount;
+
+        header.flags = SNAPSHOT_FLAG_RUNNING;
+        if (isConnected) header.flags |= SNAPSHOT_FLAG_CONNECTED;
+        if (hasEverConnected) header.flags |= SNAPSHOT_FLAG_EVER_CONNECTED;
+        if (isReconnecting) header.flags |= SNAPSHOT_FLAG_RECONNECTING;
+        if (compute_is_retrying(retryCount, isConnected, isReconnecting,
+                                hasEverConnected, activeCount)) {
+            header.flags |= SNAPSHOT_FLAG_RETRYING;
+        }
+        if (data->count > 0 && stats_hidden_reason(retryCount, isConnected, isReconnecting,
+                                                    hasEverConnected, activeCount) == nullptr) {
+            header.flags |= SNAPSHOT_FLAG_HAS_STATS;
+        }
+    }
+
+    const int conn_count = data ? data->count : 0;
+    // SRTLA_RELAY_MAX entries are ~37 KB: too much for the caller's stack
+    static thread_local srtla_relay_info_t relays[SRTLA_RELAY_MAX];
+    int relay_count = srtla_relay_list(relays, SRTLA_RELAY_MAX);
+    if (relay_count > SRTLA_RELAY_MAX) relay_count = SRTLA_RELAY_MAX;
+    SnapshotLayout layout = SnapshotLayout::for_count(conn_count, relay_count);
+    if (capacity < (jlong)layout.total) {
+        return -(jint)layout.total;
+    }
+
+    double* out_bitrate = reinterpret_cast<double*>(out + layout.bitrate);
+    int32_t* out_load = reinterpret_cast<int32_t*>(out + layout.load);
+    int32_t* out_window = reinterpret_cast<int32_t*>(out + layout.window);
+    int32_t* out_in_flight = reinterpret_cast<int32_t*>(out + layout.in_flight);
+    int32_t* out_rtt = reinterpret_cast<int32_t*>(out + layout.rtt);
+    uint8_t* out_active = out + layout.active;
+    char* out_type = reinterpret_cast<char*>(out + layout.type);
+    char* out_ip = reinterpret_cast<char*>(out + layout.ip);
+
+    memset(out + SNAPSHOT_HEADER_SIZE, 0, layout.total - SNAPSHOT_HEADER_SIZE);
+    for (int i = 0; i < conn_count; i++) {
+        out_bitrate[i] = data->bitrates[i];
+        out_load[i] = data->loads[i];
+        out_window[i] = data->windows[i];
+        out_in_flight[i] = data->inflight[i];
+        out_rtt[i] = data->rtt_ms[i];
+        out_active[i] = is_connection_active(*data, i);
+        strncpy(out_type + i * SNAPSHOT_TYPE_LEN, data->type(i), SNAPSHOT_TYPE_LEN - 1);
+        strncpy(out_ip + i * SNAPSHOT_IP_LEN, data->ip(i), SNAPSHOT_IP_LEN - 1);
+
+        header.total_bitrate_mbps += data->bitrates[i];
+        header.total_in_flight += data->inflight[i];
+        header.total_window += data->windows[i];
+    }
+
+    uint32_t relay_header[2] = {(uint32_t)relay_count, (uint32_t)SNAPSHOT_RELAY_SIZE};
+    memcpy(out + layout.relays, relay_header, sizeof(relay_header));
+    SnapshotRelay* out_relays = reinterpret_cast<SnapshotRelay*>(out + layout.relays + sizeof(relay_header));
+    for (int r = 0; r < relay_count; r++) {
+        const srtla_relay_info_t& info = relays[r];
+        SnapshotRelay& rec = out_relays[r];
+        strncpy(rec.id, info.id, sizeof(rec.id) - 1);
+        strncpy(rec.name, info.name, sizeof(rec.name) - 1);
+        strncpy(rec.virtual_ip, info.virtual_ip, sizeof(rec.virtual_ip) - 1);
+        rec.battery = info.battery;
+        rec.thermal = info.thermal;
+        rec.status_age_ms = info.status_age_ms;
+        rec.conn_index = -1;
+        for (int i = 0; i < conn_count; i++) {
+            if (strcmp(data->ip(i), info.virtual_ip) == 0) {
+                rec.conn_index = i;
+                if (out_active[i]) rec.flags |= SNAPSHOT_RELAY_LINKED;
+                break;
+            }
+        }
+        if (info.alive) rec.flags |= SNAPSHOT_RELAY_ALIVE;
+    }
+
+    header.conn_count = conn_count;
+    header.total_size = layout.total;
+    memcpy(out, &header, sizeof(header));
+    return (jint)layout.total;
+}
@@ -0,0 +1,448 @@
+/*
+ * srtla_batch_io.cpp - recvmmsg/sendmmsg batched forwarding helpers
+ *
+ * See srtla_batch_io.h for usage.
+ */
+
+#include "srtla_batch_io.h"
+#include "srtla_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/uio.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// recvmmsg()/sendmmsg() are available in bionic from API 21
+#if defined(__ANDROID_API__) && __ANDROID_API__ < 21
+#define SRTLA_HAVE_MMSG 0
+#else
+#define SRTLA_HAVE_MMSG 1
+#endif
+
+namespace {
+
+std::atomic<uint64_t> rx_syscalls(0);
+std::atomic<uint64_t> rx_packets(0);
+std::atomic<uint64_t> tx_syscalls(0);
+std::atomic<uint64_t> tx_packets(0);
+
+std::atomic<uint64_t> gso_sends(0);
+std::atomic<uint64_t> gso_segments(0);
+std::atomic<uint64_t> gro_reads(0);
+std::atomic<uint64_t> gro_segments(0);
+
+// Cleared the first time the kernel reports ENOSYS
+std::atomic<bool> mmsg_supported(SRTLA_HAVE_MMSG != 0);
+
+// Kernel limits for one UDP_SEGMENT send (UDP_MAX_SEGMENTS, 16-bit IP length)
+const int GSO_MAX_SEGMENTS = 64;
+const int GSO_MAX_BYTES = 65000;
+
+// Offload state, loop thread only. Sockets at or above MAX_OFFLOAD_FD simply
+// never get offload.
+const int MAX_OFFLOAD_FD = 1024;
+uint8_t offload_flags[MAX_OFFLOAD_FD];
+
+// A GRO read can return up to 64 segments, more than a batch holds, so each
+// GRO socket keeps its last coalesced buffer until it has been handed out.
+const int GRO_SLOTS = 8;
+const int GRO_BUF_SIZE = 65536;
+
+struct GroSlot {
+    bool used;
+    int fd;
+    int off;    // next segment
+    int end;    // bytes in buf
+    int seg;    // segment size of the buffer
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    uint8_t buf[GRO_BUF_SIZE];
+};
+
+GroSlot gro_slots[GRO_SLOTS];
+
+union CmsgSpace {
+    char buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+};
+
+void count(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+GroSlot* find_gro_slot(int fd) {
+    for (GroSlot& g : gro_slots) {
+        if (g.used && g.fd == fd) return &g;
+    }
+    return nullptr;
+}
+
+// Read one (possibly coalesced) buffer into g. Returns recvmsg()'s result.
+ssize_t gro_read(GroSlot& g, int fd) {
+    struct iovec iov;
+    iov.iov_base = g.buf;
+    iov.iov_len = sizeof(g.buf);
+    CmsgSpace ctrl;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &g.addr;
+    msg.msg_namelen = sizeof(g.addr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    ssize_t r = recvmsg(fd, &msg, MSG_DONTWAIT);
+    count(rx_syscalls, 1);
+    if (r < 0) return r;
+
+    int seg = 0;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO) {
+            memcpy(&seg, CMSG_DATA(c), sizeof(seg));
+        }
+    }
+    if (seg <= 0 || seg > r) seg = (int)r;
+    if (r > seg) {
+        count(gro_reads, 1);
+        count(gro_segments, (r + seg - 1) / seg);
+    }
+    g.addr_len = msg.msg_namelen;
+    g.off = 0;
+    g.end = (int)r;
+    g.seg = seg;
+    return r;
+}
+
+int recv_gro(GroSlot& g, int fd, srtla_rx_batch_t* batch) {
+    int n = 0;
+    while (n < SRTLA_BATCH_MAX) {
+        if (g.off >= g.end && gro_read(g, fd) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || n > 0) break;
+            return -1;
+        }
+        if (g.off >= g.end) continue;  // empty datagram
+
+        srtla_batch_pkt_t& pkt = batch->pkts[n++];
+        int len = g.end - g.off < g.seg ? g.end - g.off : g.seg;
+        // Oversized datagrams are truncated, as recvmmsg() into a slot would
+        if (len > SRTLA_BATCH_PKT_SIZE) len = SRTLA_BATCH_PKT_SIZE;
+        memcpy(pkt.data, g.buf + g.off, len);
+        pkt.len = len;
+        memcpy(&pkt.addr, &g.addr, g.addr_len);
+        pkt.addr_len = g.addr_len;
+        g.off += g.seg;
+    }
+    batch->count = n;
+    count(rx_packets, n);
+    return n;
+}
+
+bool same_dst(const srtla_tx_entry_t* a, const srtla_tx_entry_t* b) {
+    return a->dst_len == b->dst_len &&
+           (a->dst == b->dst || memcmp(a->dst, b->dst, a->dst_len) == 0);
+}
+
+// Datagrams from e[0] on that can leave as one UDP_SEGMENT message: same
+// destination, same length, only the last one allowed to be shorter
+int gso_run(const srtla_tx_entry_t* const* e, int avail) {
+    int seg = e[0]->len;
+    int bytes = seg;
+    int run = 1;
+    if (seg <= 0) return 1;
+    while (run < avail && run < GSO_MAX_SEGMENTS) {
+        const srtla_tx_entry_t* next = e[run];
+        if (!same_dst(e[0], next) || next->len <= 0 || next->len > seg ||
+            bytes + next->len > GSO_MAX_BYTES) {
+            break;
+        }
+        bytes += next->len;
+        run++;
+        if (next->len < seg) break;
+    }
+    return run;
+}
+
+// Errors that mean this socket's path cannot segment, rather than congestion
+bool gso_rejected(int err) {
+    return err == EIO || err == EINVAL || err == ENOPROTOOPT || err == EOPNOTSUPP;
+}
+
+int recv_fallback(int fd, srtla_rx_batch_t* batch) {
+    int n = 0;
+    while (n < SRTLA_BATCH_MAX) {
+        srtla_batch_pkt_t& pkt = batch->pkts[n];
+        pkt.addr_len = sizeof(pkt.addr);
+        ssize_t r = recvfrom(fd, pkt.data, sizeof(pkt.data), MSG_DONTWAIT,
+                             (struct sockaddr*)&pkt.addr, &pkt.addr_len);
+        count(rx_syscalls, 1);
+        if (r < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || n > 0) break;
+            return -1;
+        }
+        pkt.len = (int)r;
+        n++;
+    }
+    return n;
+}
+
+int send_fallback(int fd, const srtla_tx_entry_t* const* entries, int n) {
+    int sent = 0;
+    for (int i = 0; i < n; i++) {
+        ssize_t r = sendto(fd, entries[i]->data, entries[i]->len, MSG_DONTWAIT,
+                           entries[i]->dst, entries[i]->dst_len);
+        count(tx_syscalls, 1);
+        if (r >= 0) sent++;
+    }
+    return sent;
+}
+
+#if SRTLA_HAVE_MMSG
+// One sendmmsg() pass over the datagrams queued for fd, as GSO runs where
+// allowed. Returns the number of datagrams sent, or -1 if the kernel has no
+// sendmmsg().
+int send_mmsg(int fd, const srtla_tx_entry_t* const* group, int n, bool gso) {
+    struct mmsghdr msgs[SRTLA_BATCH_MAX];
+    struct iovec iovs[SRTLA_BATCH_MAX];
+    CmsgSpace ctrl[SRTLA_BATCH_MAX];
+    int first[SRTLA_BATCH_MAX + 1];  // first datagram of each message
+    int m = 0;
+
+    memset(msgs, 0, sizeof(struct mmsghdr) * n);
+    for (int i = 0; i < n; i++) {
+        iovs[i].iov_base = const_cast<uint8_t*>(group[i]->data);
+        iovs[i].iov_len = group[i]->len;
+    }
+    for (int i = 0; i < n; m++) {
+        int run = gso ? gso_run(group + i, n - i) : 1;
+        struct msghdr& h = msgs[m].msg_hdr;
+        h.msg_iov = &iovs[i];
+        h.msg_iovlen = run;
+        h.msg_name = const_cast<struct sockaddr*>(group[i]->dst);
+        h.msg_namelen = group[i]->dst_len;
+        if (run > 1) {
+            h.msg_control = ctrl[m].buf;
+            h.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            struct cmsghdr* c = CMSG_FIRSTHDR(&h);
+            c->cmsg_level = SOL_UDP;
+            c->cmsg_type = UDP_SEGMENT;
+            c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t seg = (uint16_t)group[i]->len;
+            memcpy(CMSG_DATA(c), &seg, sizeof(seg));
+        }
+        first[m] = i;
+        i += run;
+    }
+    first[m] = n;
+
+    int done = 0;
+    while (done < m) {
+        int r = sendmmsg(fd, msgs + done, m - done, MSG_DONTWAIT);
+        count(tx_syscalls, 1);
+        if (r > 0) {
+            for (int k = done; k < done + r; k++) {
+                int segs = first[k + 1] - first[k];
+                if (segs > 1) {
+                    count(gso_sends, 1);
+                    count(gso_segments, segs);
+                }
+            }
+            done += r;
+            continue;
+        }
+        if (r < 0 && errno == ENOSYS && done == 0) {
+            mmsg_supported.store(false, std::memory_order_relaxed);
+            return -1;
+        }
+        if (r < 0 && first[done + 1] - first[done] > 1 && gso_rejected(errno)) {
+            offload_flags[fd] &= ~SRTLA_OFFLOAD_GSO;
+            SRTLA_LOGI("SRTLA-JNI", "FD %d: UDP GSO rejected (%s), sending unsegmented",
+                       fd, strerror(errno));
+            int rest = send_mmsg(fd, group + first[done], n - first[done], false);
+            return first[done] + (rest > 0 ? rest : 0);
+        }
+        // EAGAIN/ENOBUFS: socket buffer full, drop the rest like sendto() would
+        break;
+    }
+    return first[done];
+}
+#endif
+
+}  // namespace
+
+extern "C" int srtla_batch_recv(int fd, srtla_rx_batch_t* batch) {
+    batch->count = 0;
+
+    if (fd >= 0 && fd < MAX_OFFLOAD_FD && (offload_flags[fd] & SRTLA_OFFLOAD_GRO)) {
+        GroSlot* g = find_gro_slot(fd);
+        if (g) return recv_gro(*g, fd, batch);
+    }
+
+#if SRTLA_HAVE_MMSG
+    if (mmsg_supported.load(std::memory_order_relaxed)) {
+        struct mmsghdr msgs[SRTLA_BATCH_MAX];
+        struct iovec iovs[SRTLA_BATCH_MAX];
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < SRTLA_BATCH_MAX; i++) {
+            iovs[i].iov_base = batch->pkts[i].data;
+            iovs[i].iov_len = sizeof(batch->pkts[i].data);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &batch->pkts[i].addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(batch->pkts[i].addr);
+        }
+
+        int n = recvmmsg(fd, msgs, SRTLA_BATCH_MAX, MSG_DONTWAIT, nullptr);
+        count(rx_syscalls, 1);
+        if (n >= 0) {
+            for (int i = 0; i < n; i++) {
+                batch->pkts[i].len = (int)msgs[i].msg_len;
+                batch->pkts[i].addr_len = msgs[i].msg_hdr.msg_namelen;
+            }
+            batch->count = n;
+            count(rx_packets, n);
+            return n;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno != ENOSYS) {
+            return -1;
+        }
+        mmsg_supported.store(false, std::memory_order_relaxed);
+    }
+#endif
+
+    int n = recv_fallback(fd, batch);
+    if (n > 0) {
+        batch->count = n;
+        count(rx_packets, n);
+    }
+    return n;
+}
+
+extern "C" void srtla_tx_enqueue(srtla_tx_queue_t* q, int fd, const struct sockaddr* dst,
+                                 socklen_t dst_len, const uint8_t* data, int len) {
+    if (q->count >= SRTLA_BATCH_MAX) {
+        srtla_tx_flush(q);
+    }
+    srtla_tx_entry_t& e = q->entries[q->count++];
+    e.fd = fd;
+    e.dst = dst;
+    e.dst_len = dst_len;
+    e.data = data;
+    e.len = len;
+}
+
+extern "C" int srtla_tx_flush(srtla_tx_queue_t* q) {
+    int total_sent = 0;
+    bool done[SRTLA_BATCH_MAX] = {false};
+
+    for (int first = 0; first < q->count; first++) {
+        if (done[first]) continue;
+
+        // Gather every queued datagram for this fd, preserving order
+        int fd = q->entries[first].fd;
+        const srtla_tx_entry_t* group[SRTLA_BATCH_MAX];
+        int n = 0;
+        for (int i = first; i < q->count; i++) {
+            if (!done[i] && q->entries[i].fd == fd) {
+                group[n++] = &q->entries[i];
+                done[i] = true;
+            }
+        }
+
+        int sent = -1;
+#if SRTLA_HAVE_MMSG
+        if (mmsg_supported.load(std::memory_order_relaxed)) {
+            bool gso = fd >= 0 && fd < MAX_OFFLOAD_FD && (offload_flags[fd] & SRTLA_OFFLOAD_GSO);
+            sent = send_mmsg(fd, group, n, gso);
+        }
+#endif
+        if (sent < 0) {
+            sent = send_fallback(fd, group, n);
+        }
+        total_sent += sent;
+    }
+
+    count(tx_packets, total_sent);
+    q->count = 0;
+    return total_sent;
+}
+
+extern "C" void srtla_batch_io_counters(uint64_t* out_rx_syscalls, uint64_t* out_rx_packets,
+                                        uint64_t* out_tx_syscalls, uint64_t* out_tx_packets) {
+    if (out_rx_syscalls) *out_rx_syscalls = rx_syscalls.load(std::memory_order_relaxed);
+    if (out_rx_packets) *out_rx_packets = rx_packets.load(std::memory_order_relaxed);
+    if (out_tx_syscalls) *out_tx_syscalls = tx_syscalls.load(std::memory_order_relaxed);
+    if (out_tx_packets) *out_tx_packets = tx_packets.load(std::memory_order_relaxed);
+}
+
+extern "C" int srtla_batch_enable_offload(int fd, int flags) {
+    if (fd < 0 || fd >= MAX_OFFLOAD_FD) return 0;
+    srtla_batch_forget_offload(fd);
+
+    int enabled = 0;
+    if (flags & SRTLA_OFFLOAD_GSO) {
+        // Readable exactly when the kernel knows UDP_SEGMENT (4.18+)
+        int seg = 0;
+        socklen_t len = sizeof(seg);
+        if (getsockopt(fd, SOL_UDP, UDP_SEGMENT, &seg, &len) == 0) {
+            enabled |= SRTLA_OFFLOAD_GSO;
+        }
+    }
+    if (flags & SRTLA_OFFLOAD_GRO) {
+        GroSlot* g = nullptr;
+        for (GroSlot& s : gro_slots) {
+            if (!s.used) {
+                g = &s;
+                break;
+            }
+        }
+        int on = 1;
+        if (g && setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0) {
+            g->used = true;
+            g->fd = fd;
+            g->off = 0;
+            g->end = 0;
+            enabled |= SRTLA_OFFLOAD_GRO;
+        }
+    }
+    offload_flags[fd] = (uint8_t)enabled;
+    SRTLA_LOGI("SRTLA-JNI", "FD %d: UDP GSO %s, GRO %s", fd,
+               (enabled & SRTLA_OFFLOAD_GSO) ? "on" : "off",
+               (enabled & SRTLA_OFFLOAD_GRO) ? "on" : "off");
+    return enabled;
+}
+
+extern "C" void srtla_batch_forget_offload(int fd) {
+    if (fd < 0 || fd >= MAX_OFFLOAD_FD) return;
+    if (offload_flags[fd] & SRTLA_OFFLOAD_GRO) {
+        // The fd may stay open; plain reads must not see coalesced buffers
+        int off = 0;
+        setsockopt(fd, SOL_UDP, UDP_GRO, &off, sizeof(off));
+    }
+    GroSlot* g = find_gro_slot(fd);
+    if (g) g->used = false;
+    offload_flags[fd] = 0;
+}
+
+extern "C" void srtla_batch_offload_counters(uint64_t* out_gso_sends, uint64_t* out_gso_segments,
+                                             uint64_t* out_gro_reads, uint64_t* out_gro_segments) {
+    if (out_gso_sends) *out_gso_sends = gso_sends.load(std::memory_order_relaxed);
+    if (out_gso_segments) *out_gso_segments = gso_segments.load(std::memory_order_relaxed);
+    if (out_gro_reads) *out_gro_reads = gro_reads.load(std::memory_order_relaxed);
+    if (out_gro_segments) *out_gro_segments = gro_segments.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,122 @@
+/*
+ * srtla_batch_io.h - recvmmsg/sendmmsg batched forwarding helpers
+ *
+ * Lets the send loop drain the local SRT listen socket with one syscall,
+ * choose a link for every datagram in the batch, then flush each bonded
+ * socket (native or Java-owned) with one sendmmsg() per distinct fd.
+ *
+ * Falls back to plain recvfrom()/sendto() loops at compile time when the
+ * target API level has no mmsg support, and at runtime if the kernel
+ * returns ENOSYS.
+ *
+ * UDP segmentation offload, per socket, once srtla_batch_enable_offload()
+ * has found it supported:
+ *   - GSO (UDP_SEGMENT): a run of consecutive datagrams queued for the same
+ *     fd and destination with the same length (the last may be shorter)
+ *     leaves as one segmented message, up to 64 segments or 64 KB. The
+ *     payloads are passed by iovec straight from the caller's buffers. A
+ *     socket whose send path rejects it later (EIO from a driver without
+ *     checksum offload, or EINVAL on vendor bound-socket paths) loses the
+ *     flag and the rest of the run is re-sent unsegmented.
+ *   - GRO (UDP_GRO): the kernel may hand back one coalesced buffer of many
+ *     same-size datagrams; srtla_batch_recv() splits it into batch slots,
+ *     holding what does not fit for the next call on that fd.
+ * Sockets without offload behave exactly as before.
+ *
+ * The offload calls and srtla_batch_recv() on a GRO socket are loop-thread
+ * only.
+ *
+ * Typical use from srtla_send.c:
+ *
+ *     int n = srtla_batch_recv(listen_fd, &rx);
+ *     for (int i = 0; i < n; i++) {
+ *         conn_t* c = select_conn();
+ *         srtla_tx_enqueue(&tx, c->fd, &srtla_addr, addr_len,
+ *                          rx.pkts[i].data, rx.pkts[i].len);
+ *     }
+ *     srtla_tx_flush(&tx);
+ *
+ * Fork call sites for offload (loop thread):
+ *   - after creating the listen socket and when a conn gets its fd
+ *     (register):
+ *       srtla_batch_enable_offload(fd, SRTLA_OFFLOAD_GSO | SRTLA_OFFLOAD_GRO)
+ *   - before closing an fd (teardown):
+ *       srtla_batch_forget_offload(fd)
+ */
+
+#ifndef SRTLA_BATCH_IO_H
+#define SRTLA_BATCH_IO_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRTLA_BATCH_MAX 32
+#define SRTLA_BATCH_PKT_SIZE 1500
+
+#define SRTLA_OFFLOAD_GSO 0x1
+#define SRTLA_OFFLOAD_GRO 0x2
+
+typedef struct {
+    uint8_t data[SRTLA_BATCH_PKT_SIZE];
+    int len;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+} srtla_batch_pkt_t;
+
+typedef struct {
+    srtla_batch_pkt_t pkts[SRTLA_BATCH_MAX];
+    int count;
+} srtla_rx_batch_t;
+
+typedef struct {
+    int fd;
+    const struct sockaddr* dst;
+    socklen_t dst_len;
+    const uint8_t* data;
+    int len;
+} srtla_tx_entry_t;
+
+typedef struct {
+    srtla_tx_entry_t entries[SRTLA_BATCH_MAX];
+    int count;
+} srtla_tx_queue_t;
+
+/* Receive up to SRTLA_BATCH_MAX datagrams without blocking.
+ * Returns the number received (0 if none were pending) or -1 on error. */
+int srtla_batch_recv(int fd, srtla_rx_batch_t* batch);
+
+/* Queue a datagram for fd. The data and dst pointers must stay valid until the
+ * next srtla_tx_flush(). Flushes automatically when the queue is full. */
+void srtla_tx_enqueue(srtla_tx_queue_t* q, int fd, const struct sockaddr* dst,
+                      socklen_t dst_len, const uint8_t* data, int len);
+
+/* Send everything queued, one sendmmsg() per distinct fd.
+ * Returns the number of datagrams handed to the kernel. */
+int srtla_tx_flush(srtla_tx_queue_t* q);
+
+/* Cumulative counters since load, for pps / syscall-per-packet reporting */
+void srtla_batch_io_counters(uint64_t* rx_syscalls, uint64_t* rx_packets,
+                             uint64_t* tx_syscalls, uint64_t* tx_packets);
+
+/* Probe and enable the requested SRTLA_OFFLOAD_* flags on fd.
+ * Returns the subset the kernel accepted (0 for none). */
+int srtla_batch_enable_offload(int fd, int flags);
+
+/* Forget fd's offload state, including GRO segments not yet returned. */
+void srtla_batch_forget_offload(int fd);
+
+/* Cumulative offload counters: segmented sends and the datagrams they
+ * carried, GRO reads that returned more than one datagram and the
+ * datagrams they carried. Any pointer may be NULL. */
+void srtla_batch_offload_counters(uint64_t* gso_sends, uint64_t* gso_segments,
+                                  uint64_t* gro_reads, uint64_t* gro_segments);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_BATCH_IO_H
@@ -0,0 +1,313 @@
+/*
+ * srtla_capacity.cpp - Smoothed estimate of the bonded links' usable capacity
+ *
+ * See srtla_capacity.h for usage.
+ */
+
+#include "srtla_capacity.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+const double ACK_ALPHA = 0.25;
+const double DOWN_ALPHA = 0.5;
+const double UP_ALPHA = 0.125;
+const double HEADROOM = 1.25;
+const double CONGESTED_RTT_FACTOR = 1.5;
+const uint32_t CONGESTED_RTT_SLACK_US = 10000;
+const uint64_t TREND_INTERVAL_US = 1000000;
+const double TREND_THRESHOLD = 0.10;
+const double DEFAULT_PKT_BYTES = 1316.0;
+
+// Loop thread only
+struct Link {
+    bool used;
+    int conn_id;
+    uint64_t pass;              // last commit pass that sampled this link
+    uint64_t last_acked;
+    uint64_t last_us;
+    double ack_pps;
+    int window;
+    int prev_window;
+    double window_pps;
+    uint32_t srtt_us;
+    uint32_t min_rtt_us;
+    uint64_t min_rtt_since_us;
+};
+
+Link links[SRTLA_CAPACITY_MAX_LINKS];
+uint64_t pass = 1;
+double smoothed_pps = 0;
+double pkt_bytes = DEFAULT_PKT_BYTES;
+uint64_t last_bytes = 0;
+uint64_t last_pkts = 0;
+double trend_ref_pps = 0;
+uint64_t trend_ref_us = 0;
+int trend = 0;
+
+// Published estimate: seq is odd while the loop thread updates it
+struct Published {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint64_t> total_bps{0};
+    std::atomic<uint64_t> recommended_bps{0};
+    std::atomic<uint64_t> delivered_bps{0};
+    std::atomic<int32_t> links{0};
+    std::atomic<int32_t> congested_links{0};
+    std::atomic<int32_t> trend{0};
+    std::atomic<int64_t> updated_ms{0};
+};
+Published published;
+
+// Side channel
+std::mutex channel_mutex;
+std::condition_variable channel_cv;
+std::thread channel_thread;
+bool channel_running = false;
+bool channel_stopping = false;
+
+int64_t monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+Link* find_link(int conn_id) {
+    Link* free_slot = nullptr;
+    for (Link& l : links) {
+        if (l.used && l.conn_id == conn_id) return &l;
+        if (!l.used && free_slot == nullptr) free_slot = &l;
+    }
+    if (free_slot == nullptr) return nullptr;
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->conn_id = conn_id;
+    return free_slot;
+}
+
+bool congested(const Link& l) {
+    if (l.min_rtt_us == 0 || l.srtt_us == 0) return false;
+    if (l.srtt_us > (uint32_t)(l.min_rtt_us * CONGESTED_RTT_FACTOR) + CONGESTED_RTT_SLACK_US) {
+        return true;
+    }
+    return l.window < l.prev_window;
+}
+
+double link_estimate_pps(const Link& l, bool is_congested) {
+    if (is_congested) {
+        double scale = (double)l.min_rtt_us / (double)l.srtt_us;
+        if (scale < 0.5) scale = 0.5;
+        if (scale > 1.0) scale = 1.0;
+        return l.ack_pps * scale;
+    }
+    double probe = l.ack_pps * HEADROOM;
+    if (probe < l.ack_pps + SRTLA_CAPACITY_PROBE_PPS) probe = l.ack_pps + SRTLA_CAPACITY_PROBE_PPS;
+    // No RTT yet: nothing bounds the probe but the delivered rate
+    if (l.window_pps > 0 && probe > l.window_pps) probe = l.window_pps;
+    return probe;
+}
+
+void publish(uint64_t total_bps, uint64_t delivered_bps, int n, int n_congested,
+             int64_t updated_ms) {
+    published.seq.store(published.seq.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published.total_bps.store(total_bps, std::memory_order_relaxed);
+    published.recommended_bps.store(total_bps * SRTLA_CAPACITY_RECOMMEND_PCT / 100,
+                                    std::memory_order_relaxed);
+    published.delivered_bps.store(delivered_bps, std::memory_order_relaxed);
+    published.links.store(n, std::memory_order_relaxed);
+    published.congested_links.store(n_congested, std::memory_order_relaxed);
+    published.trend.store(trend, std::memory_order_relaxed);
+    published.updated_ms.store(updated_ms, std::memory_order_relaxed);
+    published.seq.store(published.seq.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+}
+
+void channel_main(int fd, int port, int interval_ms) {
+    pthread_setname_np(pthread_self(), "srtla-capacity");
+
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons((uint16_t)port);
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    char line[256];
+    std::unique_lock<std::mutex> lock(channel_mutex);
+    while (!channel_stopping) {
+        lock.unlock();
+        srtla_capacity_t c;
+        srtla_capacity_get(&c);
+        if (c.updated_ms > 0) {
+            int len = snprintf(line, sizeof(line),
+                "{\"total_kbps\":%llu,\"recommended_kbps\":%llu,\"delivered_kbps\":%llu,"
+                "\"links\":%d,\"congested_links\":%d,\"trend\":%d,\"age_ms\":%lld}\n",
+                (unsigned long long)(c.total_bps / 1000),
+                (unsigned long long)(c.recommended_bps / 1000),
+                (unsigned long long)(c.delivered_bps / 1000), c.links, c.congested_links,
+                c.trend, (long long)(monotonic_ms() - c.updated_ms));
+            // Nobody listening is normal (encoder not started yet): ECONNREFUSED is ignored
+            sendto(fd, line, (size_t)len, MSG_DONTWAIT, (struct sockaddr*)&dst, sizeof(dst));
+        }
+        lock.lock();
+        channel_cv.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                            [] { return channel_stopping; });
+    }
+    lock.unlock();
+    close(fd);
+}
+
+}  // namespace
+
+extern "C" void srtla_capacity_link_sample(int conn_id, int window, uint32_t srtt_us,
+                                           uint64_t acked_pkts_total, uint64_t now_us) {
+    Link* l = find_link(conn_id);
+    if (l == nullptr) return;
+
+    if (l->pass != 0 && now_us > l->last_us && acked_pkts_total >= l->last_acked) {
+        double dt = (double)(now_us - l->last_us) / 1e6;
+        double pps = (double)(acked_pkts_total - l->last_acked) / dt;
+        l->ack_pps += ACK_ALPHA * (pps - l->ack_pps);
+    }
+    l->last_acked = acked_pkts_total;
+    l->last_us = now_us;
+
+    l->prev_window = l->pass != 0 ? l->window : window;
+    l->window = window;
+    l->srtt_us = srtt_us;
+    l->window_pps = srtt_us > 0 ? (double)window * 1e6 / (double)srtt_us : 0;
+
+    // Windowed minimum: restart from the current sample once the window is
+    // over, so a route change to a longer path is not flagged forever
+    if (srtt_us > 0) {
+        if (l->min_rtt_us == 0 || srtt_us < l->min_rtt_us ||
+            now_us - l->min_rtt_since_us > (uint64_t)SRTLA_CAPACITY_MIN_RTT_WINDOW_MS * 1000) {
+            l->min_rtt_us = srtt_us;
+            l->min_rtt_since_us = now_us;
+        }
+    }
+    l->pass = pass;
+}
+
+extern "C" void srtla_capacity_commit(uint64_t now_us, uint64_t bytes_sent_total,
+                                      uint64_t pkts_sent_total) {
+    if (pkts_sent_total > last_pkts && bytes_sent_total > last_bytes) {
+        double size = (double)(bytes_sent_total - last_bytes) / (double)(pkts_sent_total - last_pkts);
+        pkt_bytes += ACK_ALPHA * (size - pkt_bytes);
+    }
+    last_bytes = bytes_sent_total;
+    last_pkts = pkts_sent_total;
+
+    double total_pps = 0;
+    double delivered_pps = 0;
+    int n = 0;
+    int n_congested = 0;
+    for (Link& l : links) {
+        if (!l.used) continue;
+        if (l.pass != pass) {
+            l.used = false;  // gone since the last pass
+            continue;
+        }
+        bool is_congested = congested(l);
+        total_pps += link_estimate_pps(l, is_congested);
+        delivered_pps += l.ack_pps;
+        n++;
+        if (is_congested) n_congested++;
+    }
+    pass++;
+
+    double alpha = total_pps < smoothed_pps ? DOWN_ALPHA : UP_ALPHA;
+    smoothed_pps += alpha * (total_pps - smoothed_pps);
+    if (n == 0) smoothed_pps = 0;
+
+    if (trend_ref_us == 0 || now_us < trend_ref_us) {
+        trend_ref_us = now_us;
+        trend_ref_pps = smoothed_pps;
+    } else if (now_us - trend_ref_us >= TREND_INTERVAL_US) {
+        if (smoothed_pps > trend_ref_pps * (1 + TREND_THRESHOLD)) {
+            trend = 1;
+        } else if (smoothed_pps < trend_ref_pps * (1 - TREND_THRESHOLD)) {
+            trend = -1;
+        } else {
+            trend = 0;
+        }
+        trend_ref_us = now_us;
+        trend_ref_pps = smoothed_pps;
+    }
+
+    double bits = pkt_bytes * 8;
+    publish((uint64_t)(smoothed_pps * bits), (uint64_t)(delivered_pps * bits), n, n_congested,
+            monotonic_ms());
+}
+
+extern "C" void srtla_capacity_get(srtla_capacity_t* out) {
+    memset(out, 0, sizeof(*out));
+    for (;;) {
+        uint32_t seq = published.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        out->total_bps = published.total_bps.load(std::memory_order_relaxed);
+        out->recommended_bps = published.recommended_bps.load(std::memory_order_relaxed);
+        out->delivered_bps = published.delivered_bps.load(std::memory_order_relaxed);
+        out->links = published.links.load(std::memory_order_relaxed);
+        out->congested_links = published.congested_links.load(std::memory_order_relaxed);
+        out->trend = published.trend.load(std::memory_order_relaxed);
+        out->updated_ms = published.updated_ms.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (published.seq.load(std::memory_order_relaxed) == seq) return;
+    }
+}
+
+extern "C" void srtla_capacity_reset(void) {
+    // Called from the JNI thread before the send loop starts
+    memset(links, 0, sizeof(links));
+    pass = 1;
+    smoothed_pps = 0;
+    pkt_bytes = DEFAULT_PKT_BYTES;
+    last_bytes = 0;
+    last_pkts = 0;
+    trend_ref_pps = 0;
+    trend_ref_us = 0;
+    trend = 0;
+    publish(0, 0, 0, 0, 0);
+}
+
+extern "C" int srtla_capacity_channel_start(int port, int interval_ms) {
+    if (port <= 0 || port > 65535 || interval_ms <= 0) return -1;
+    srtla_capacity_channel_stop();
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    std::lock_guard<std::mutex> lock(channel_mutex);
+    channel_stopping = false;
+    channel_running = true;
+    channel_thread = std::thread(channel_main, fd, port, interval_ms);
+    return 0;
+}
+
+extern "C" void srtla_capacity_channel_stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex);
+        if (!channel_running) return;
+        channel_stopping = true;
+        channel_running = false;
+    }
+    channel_cv.notify_one();
+    channel_thread.join();
+}
@@ -0,0 +1,89 @@
+/*
+ * srtla_capacity.h - Smoothed estimate of the bonded links' usable capacity
+ *
+ * The encoder pushing SRT into the listen port cannot see what the bonded
+ * links carry, so a capacity drop only reaches it as queue build-up and then
+ * loss. This module turns per-link state the sender already has into one
+ * number a co-located encoder can follow before buffers overflow.
+ *
+ * Per link, every housekeeping pass:
+ *   - delivered rate: SRTLA-ACKed packets per second (EWMA)
+ *   - window bound: window / srtt, what the link could carry if saturated
+ *   - RTT trend: srtt against the link's recent minimum; a link whose RTT
+ *     has grown by half (plus 10 ms) is queueing, i.e. congested
+ * A congested link is worth its delivered rate scaled by min_rtt / srtt (the
+ * queue is growing, so back off). An uncongested one gets its delivered rate
+ * plus 25% headroom (at least SRTLA_CAPACITY_PROBE_PPS), capped by its window
+ * bound, so the estimate can rise while the encoder probes upwards.
+ *
+ * The sum over usable links is smoothed asymmetrically: a drop is followed
+ * within a pass or two (alpha 1/2), a rise only slowly (alpha 1/8). The
+ * recommended bitrate is SRTLA_CAPACITY_RECOMMEND_PCT of it, leaving room for
+ * SRT overhead and retransmissions. Packets are converted to bits with the
+ * average packet size seen by the sender.
+ *
+ * Writer: send loop thread only. srtla_capacity_get() is lock-free (seqlock)
+ * from any thread, which is what lets JNI and the side channel poll at high
+ * rate.
+ *
+ * Side channel: srtla_capacity_channel_start(port, interval_ms) pushes one
+ * JSON datagram per interval to 127.0.0.1:port for encoders that cannot link
+ * against the app:
+ *   {"total_kbps":N,"recommended_kbps":N,"delivered_kbps":N,"links":N,
+ *    "congested_links":N,"trend":-1|0|1,"age_ms":N}
+ *
+ * Fork call sites (srtla_send.c, loop thread):
+ *   - connection_housekeeping(), per conn:
+ *       srtla_capacity_link_sample(id, window, srtt_us, acked_pkts_total, now_us)
+ *     then once: srtla_capacity_commit(now_us, bytes_sent_total, pkts_sent_total)
+ *   - conn removed: nothing; links not sampled in a pass stop counting
+ *
+ * Until those exist only srtla_bench links this; the JNI estimate and the
+ * side channel return with the fork change.
+ */
+
+#ifndef SRTLA_CAPACITY_H
+#define SRTLA_CAPACITY_H
+
+#include <stdint.h>
+
+#define SRTLA_CAPACITY_MAX_LINKS       32
+#define SRTLA_CAPACITY_RECOMMEND_PCT   80
+#define SRTLA_CAPACITY_PROBE_PPS       50     /* ~0.5 Mbps at 1316 B */
+#define SRTLA_CAPACITY_MIN_RTT_WINDOW_MS 10000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t total_bps;          /* smoothed usable capacity */
+    uint64_t recommended_bps;    /* what the encoder should send */
+    uint64_t delivered_bps;      /* currently ACKed, all links */
+    int32_t links;               /* links counted */
+    int32_t congested_links;
+    int32_t trend;               /* -1 falling, 0 steady, 1 rising (vs 1 s ago) */
+    int32_t reserved;
+    int64_t updated_ms;          /* CLOCK_MONOTONIC of the last commit; 0 = never */
+} srtla_capacity_t;
+
+void srtla_capacity_link_sample(int conn_id, int window, uint32_t srtt_us,
+                                uint64_t acked_pkts_total, uint64_t now_us);
+void srtla_capacity_commit(uint64_t now_us, uint64_t bytes_sent_total,
+                           uint64_t pkts_sent_total);
+
+/* Latest estimate; thread-safe, never blocks. */
+void srtla_capacity_get(srtla_capacity_t* out);
+
+void srtla_capacity_reset(void);
+
+/* Local UDP side channel. Returns 0, or -1 (bad arguments or socket error).
+ * Starting again moves it to the new port / interval. */
+int srtla_capacity_channel_start(int port, int interval_ms);
+void srtla_capacity_channel_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_CAPACITY_H
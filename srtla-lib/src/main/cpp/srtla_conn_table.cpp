@@ -0,0 +1,66 @@
+/*
+ * srtla_conn_table.cpp - Growable, cache-friendly connection table
+ *
+ * See srtla_conn_table.h for the layout rationale.
+ */
+
+#include "srtla_conn_table.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static_assert(sizeof(srtla_conn_hot_t) == 32, "hot record should stay half a cache line");
+
+namespace {
+
+const int INITIAL_CAPACITY = 8;
+
+bool grow(srtla_conn_table_t* t) {
+    int new_capacity = t->capacity > 0 ? t->capacity * 2 : INITIAL_CAPACITY;
+    void* hot = realloc(t->hot, new_capacity * sizeof(srtla_conn_hot_t));
+    if (hot == nullptr) return false;
+    t->hot = static_cast<srtla_conn_hot_t*>(hot);
+
+    void* cold = realloc(t->cold, new_capacity * sizeof(srtla_conn_cold_t));
+    if (cold == nullptr) return false;
+    t->cold = static_cast<srtla_conn_cold_t*>(cold);
+
+    t->capacity = new_capacity;
+    return true;
+}
+
+}  // namespace
+
+extern "C" void srtla_conn_table_init(srtla_conn_table_t* t) {
+    memset(t, 0, sizeof(*t));
+}
+
+extern "C" void srtla_conn_table_free(srtla_conn_table_t* t) {
+    free(t->hot);
+    free(t->cold);
+    memset(t, 0, sizeof(*t));
+}
+
+extern "C" int srtla_conn_table_add(srtla_conn_table_t* t) {
+    if (t->count >= t->capacity && !grow(t)) {
+        return -1;
+    }
+    int index = t->count++;
+    memset(&t->hot[index], 0, sizeof(srtla_conn_hot_t));
+    memset(&t->cold[index], 0, sizeof(srtla_conn_cold_t));
+    t->hot[index].fd = -1;
+    return index;
+}
+
+extern "C" int srtla_conn_table_remove(srtla_conn_table_t* t, int index) {
+    if (index < 0 || index >= t->count) {
+        return -1;
+    }
+    int last = --t->count;
+    if (index == last) {
+        return -1;
+    }
+    t->hot[index] = t->hot[last];
+    t->cold[index] = t->cold[last];
+    return last;
+}
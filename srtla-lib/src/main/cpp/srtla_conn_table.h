@@ -0,0 +1,67 @@
+/*
+ * srtla_conn_table.h - Growable, cache-friendly connection table
+ *
+ * Replaces fixed-size per-connection arrays with a table that grows on demand
+ * and splits each connection into two parallel records:
+ *
+ *   hot  - fields the forwarding path touches per packet/ACK (window,
+ *          in-flight, last ACK/receive time). 32 bytes, two per cache line,
+ *          so scoring every link walks a handful of contiguous lines.
+ *   cold - strings used only for registration, stats and logging.
+ *
+ * A connection is identified by its index, which stays valid until it is
+ * removed. Removal swaps the last entry into the hole and returns its old
+ * index so the owner can fix up the moved connection's back-reference.
+ * The table is owned by the send loop thread.
+ */
+
+#ifndef SRTLA_CONN_TABLE_H
+#define SRTLA_CONN_TABLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRTLA_CONN_TYPE_LEN 16
+#define SRTLA_CONN_IP_LEN 64
+#define SRTLA_CONN_NAME_LEN 64
+
+typedef struct {
+    int32_t window;
+    int32_t in_flight;
+    int64_t last_ack_ms;
+    int64_t last_rcvd_ms;
+    int32_t fd;
+    uint32_t flags;
+} srtla_conn_hot_t;
+
+typedef struct {
+    char type[SRTLA_CONN_TYPE_LEN];
+    char ip[SRTLA_CONN_IP_LEN];
+    char name[SRTLA_CONN_NAME_LEN];
+} srtla_conn_cold_t;
+
+typedef struct {
+    srtla_conn_hot_t* hot;
+    srtla_conn_cold_t* cold;
+    int count;
+    int capacity;
+} srtla_conn_table_t;
+
+void srtla_conn_table_init(srtla_conn_table_t* t);
+void srtla_conn_table_free(srtla_conn_table_t* t);
+
+/* Append a zeroed connection. Returns its index, or -1 on allocation failure. */
+int srtla_conn_table_add(srtla_conn_table_t* t);
+
+/* Remove the connection at index. Returns the old index of the entry moved into
+ * its place, or -1 if nothing moved (the removed entry was last). */
+int srtla_conn_table_remove(srtla_conn_table_t* t, int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_CONN_TABLE_H
@@ -0,0 +1,133 @@
+/*
+ * srtla_dup.cpp - Redundant sending of high-priority packets
+ *
+ * See srtla_dup.h for usage.
+ */
+
+#include "srtla_dup.h"
+
+#include <atomic>
+
+namespace {
+
+const size_t SRT_HEADER_LEN = 16;
+const size_t TS_PACKET_LEN = 188;
+const uint8_t TS_SYNC = 0x47;
+// Token bucket cap: enough for the start of one large keyframe
+const int64_t MAX_TOKENS = 64 * 1024;
+
+std::atomic<bool> enabled(false);
+std::atomic<int> overhead_pct(SRTLA_DUP_DEFAULT_OVERHEAD_PCT);
+std::atomic<int> keyframe_packets(SRTLA_DUP_DEFAULT_KEYFRAME_PACKETS);
+
+// Loop thread only
+int keyframe_remaining = 0;
+// Bytes * 100, so the earn rate needs no division. Starts full so the first
+// keyframe of a stream is covered.
+int64_t tokens_x100 = MAX_TOKENS * 100;
+
+// Single writer (loop thread), read from JNI
+struct Stats {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> control_copies{0};
+    std::atomic<uint64_t> keyframe_copies{0};
+    std::atomic<uint64_t> copy_bytes{0};
+    std::atomic<uint64_t> budget_skips{0};
+} stats;
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Any TS packet in the payload with random_access_indicator set
+bool starts_keyframe(const uint8_t* payload, size_t len) {
+    for (size_t off = 0; off + TS_PACKET_LEN <= len; off += TS_PACKET_LEN) {
+        const uint8_t* ts = payload + off;
+        if (ts[0] != TS_SYNC) return false;  // not TS-aligned; don't guess
+        bool has_adaptation = (ts[3] & 0x20) != 0;
+        if (has_adaptation && ts[4] > 0 && (ts[5] & 0x40) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+extern "C" void srtla_dup_set_enabled(int value) {
+    enabled.store(value != 0, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_dup_get_enabled(void) {
+    return enabled.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+extern "C" int srtla_dup_set_budget(int max_overhead_pct, int packets) {
+    if (max_overhead_pct < 0 || max_overhead_pct > 100 || packets < 0 || packets > 1024) {
+        return -1;
+    }
+    overhead_pct.store(max_overhead_pct, std::memory_order_relaxed);
+    keyframe_packets.store(packets, std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" int srtla_dup_check(const uint8_t* pkt, size_t len) {
+    if (!enabled.load(std::memory_order_relaxed) || len < SRT_HEADER_LEN) {
+        return SRTLA_DUP_NONE;
+    }
+    bump(stats.packets, 1);
+    bump(stats.bytes, len);
+
+    if (pkt[0] & 0x80) {
+        return SRTLA_DUP_CONTROL;
+    }
+
+    tokens_x100 += (int64_t)len * overhead_pct.load(std::memory_order_relaxed);
+    if (tokens_x100 > MAX_TOKENS * 100) tokens_x100 = MAX_TOKENS * 100;
+
+    if (starts_keyframe(pkt + SRT_HEADER_LEN, len - SRT_HEADER_LEN)) {
+        keyframe_remaining = keyframe_packets.load(std::memory_order_relaxed);
+    }
+    if (keyframe_remaining <= 0) {
+        return SRTLA_DUP_NONE;
+    }
+    keyframe_remaining--;
+    if (tokens_x100 < (int64_t)len * 100) {
+        bump(stats.budget_skips, 1);
+        return SRTLA_DUP_NONE;
+    }
+    tokens_x100 -= (int64_t)len * 100;
+    return SRTLA_DUP_KEYFRAME;
+}
+
+extern "C" void srtla_dup_sent(int reason, size_t len) {
+    if (reason == SRTLA_DUP_CONTROL) {
+        bump(stats.control_copies, 1);
+    } else if (reason == SRTLA_DUP_KEYFRAME) {
+        bump(stats.keyframe_copies, 1);
+    } else {
+        return;
+    }
+    bump(stats.copy_bytes, len);
+}
+
+extern "C" void srtla_dup_get_stats(srtla_dup_stats_t* out) {
+    out->packets = stats.packets.load(std::memory_order_relaxed);
+    out->bytes = stats.bytes.load(std::memory_order_relaxed);
+    out->control_copies = stats.control_copies.load(std::memory_order_relaxed);
+    out->keyframe_copies = stats.keyframe_copies.load(std::memory_order_relaxed);
+    out->copy_bytes = stats.copy_bytes.load(std::memory_order_relaxed);
+    out->budget_skips = stats.budget_skips.load(std::memory_order_relaxed);
+}
+
+extern "C" void srtla_dup_reset_stats(void) {
+    stats.packets.store(0, std::memory_order_relaxed);
+    stats.bytes.store(0, std::memory_order_relaxed);
+    stats.control_copies.store(0, std::memory_order_relaxed);
+    stats.keyframe_copies.store(0, std::memory_order_relaxed);
+    stats.copy_bytes.store(0, std::memory_order_relaxed);
+    stats.budget_skips.store(0, std::memory_order_relaxed);
+    keyframe_remaining = 0;
+    tokens_x100 = MAX_TOKENS * 100;
+}
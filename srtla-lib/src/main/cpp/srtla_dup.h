@@ -0,0 +1,81 @@
+/*
+ * srtla_dup.h - Redundant sending of high-priority packets
+ *
+ * When one link stalls, a lost SRT control packet (handshake, ACK, NAK,
+ * keepalive) or the start of a keyframe costs a visible glitch. Far more
+ * than sending those packets twice would. With duplication enabled the
+ * sender classifies each outgoing packet by header inspection and sends the
+ * ones that matter on the two best links (srtla_sched_pick() and
+ * srtla_sched_pick_backup()). The receiver drops the copy it sees second,
+ * exactly as it does for a retransmission.
+ *
+ * Classification:
+ *   - SRT control packets (F bit set): always duplicated; they are small
+ *   - data packets starting a keyframe (an MPEG-TS packet in the payload with
+ *     random_access_indicator set) and the next keyframe_packets - 1 data
+ *     packets, within the byte budget
+ *
+ * Keyframe copies are metered by a token bucket that earns max_overhead_pct
+ * of every data byte seen; copies the bucket cannot pay for are skipped and
+ * counted in budget_skips. Control copies are counted in the overhead but
+ * are not metered.
+ *
+ * Only the primary copy is recorded in srtla_seq_ring and counted in flight;
+ * the backup copy is fire-and-forget, so ACK accounting is unchanged.
+ *
+ * Config may be changed from any thread; srtla_dup_check() is loop-thread only.
+ *
+ * Fork call sites (srtla_send.c, data path from the SRT socket):
+ *     int why = srtla_dup_check(buf, len);
+ *     c = srtla_sched_pick(s) ... send on c as usual
+ *     if (why && (b = srtla_sched_pick_backup(s, c)) >= 0 && sendto(b, ...) == len)
+ *         srtla_dup_sent(why, len);
+ */
+
+#ifndef SRTLA_DUP_H
+#define SRTLA_DUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SRTLA_DUP_NONE      0
+#define SRTLA_DUP_CONTROL   1
+#define SRTLA_DUP_KEYFRAME  2
+
+#define SRTLA_DUP_DEFAULT_OVERHEAD_PCT      5
+#define SRTLA_DUP_DEFAULT_KEYFRAME_PACKETS  8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t packets;             /* packets checked */
+    uint64_t bytes;               /* bytes checked */
+    uint64_t control_copies;
+    uint64_t keyframe_copies;
+    uint64_t copy_bytes;          /* bytes sent as duplicates */
+    uint64_t budget_skips;        /* keyframe packets not copied: budget spent */
+} srtla_dup_stats_t;
+
+/* Off by default. Thread-safe. */
+void srtla_dup_set_enabled(int enabled);
+int srtla_dup_get_enabled(void);
+
+/* Returns 0, or -1 if out of range (overhead 0..100, keyframe packets 0..1024). */
+int srtla_dup_set_budget(int max_overhead_pct, int keyframe_packets);
+
+/* Classify an outgoing SRT packet; returns SRTLA_DUP_* (NONE when disabled). */
+int srtla_dup_check(const uint8_t* pkt, size_t len);
+
+/* A copy was actually sent on the backup link. */
+void srtla_dup_sent(int reason, size_t len);
+
+void srtla_dup_get_stats(srtla_dup_stats_t* out);
+void srtla_dup_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_DUP_H
@@ -0,0 +1,209 @@
+/*
+ * srtla_events.cpp - Push-based stats events from native to Java
+ *
+ * See srtla_events.h for usage.
+ */
+
+#include "srtla_events.h"
+#include "srtla_log.h"
+#include "srtla_thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+JavaVM* g_vm = nullptr;
+jclass g_callback_class = nullptr;
+jmethodID g_callback_method = nullptr;
+
+std::mutex g_mutex;
+std::condition_variable g_cv;
+std::thread g_thread;
+bool g_running = false;
+// From thread creation until dispatcher_main() returns. A dispatcher detached
+// by a stop from its own callback is still alive after g_running is cleared
+bool g_alive = false;
+bool g_stopping = false;
+bool g_wake = false;
+int g_pending = 0;
+srtla_events_detect_fn g_detect = nullptr;
+// Set by notify() until the dispatcher consumes the wakeup, so the send loop
+// takes the mutex at most once per coalescing cycle
+std::atomic<bool> g_notified(false);
+// True on the dispatcher thread while the detector runs; a notify from there
+// (e.g. the dispatcher's own stats publication) would only queue another pass
+thread_local bool t_detecting = false;
+thread_local bool t_dispatcher = false;
+
+// How long start waits for a detached dispatcher to deliver STOPPED and exit
+const auto RESTART_WAIT = std::chrono::milliseconds(1000);
+
+void deliver(JNIEnv* env, int mask) {
+    env->CallStaticVoidMethod(g_callback_class, g_callback_method, (jint)mask);
+    if (env->ExceptionCheck()) {
+        SRTLA_LOGE("SRTLA-Events", "Exception in onNativeStatsEvent(0x%x)", mask);
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+void record_late(std::chrono::steady_clock::time_point deadline) {
+    auto late = std::chrono::steady_clock::now() - deadline;
+    srtla_thread_record_latency(SRTLA_THREAD_HOUSEKEEPING,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(late).count());
+}
+
+void dispatcher_main() {
+    t_dispatcher = true;
+    JNIEnv* env = nullptr;
+    JavaVMAttachArgs args;
+    args.version = JNI_VERSION_1_6;
+    args.name = "srtla-events";
+    args.group = nullptr;
+    if (g_vm->AttachCurrentThread(&env, &args) != JNI_OK) {
+        SRTLA_LOGE("SRTLA-Events", "Failed to attach event thread to the VM");
+        return;
+    }
+
+    srtla_thread_enter(SRTLA_THREAD_HOUSEKEEPING, nullptr);
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+    for (;;) {
+        // Timed waits that run out are dated against their deadline for the
+        // housekeeping role's scheduling latency
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(SRTLA_EVENTS_IDLE_CHECK_MS);
+        if (!g_cv.wait_until(lock, deadline, [] { return g_wake || g_stopping; })) {
+            record_late(deadline);
+        }
+        if (g_wake && !g_stopping) {
+            // Let a burst of changes (link drop + re-register) land in one callback
+            deadline = std::chrono::steady_clock::now() +
+                       std::chrono::milliseconds(SRTLA_EVENTS_COALESCE_MS);
+            if (!g_cv.wait_until(lock, deadline, [] { return g_stopping; })) {
+                record_late(deadline);
+            }
+        }
+        g_wake = false;
+        g_notified.store(false, std::memory_order_relaxed);
+        int mask = g_pending;
+        g_pending = 0;
+        bool stopping = g_stopping;
+        srtla_events_detect_fn detect = g_detect;
+        lock.unlock();
+
+        if (stopping) {
+            mask |= SRTLA_EVENT_STOPPED;
+        } else if (detect != nullptr) {
+            t_detecting = true;
+            mask |= detect();
+            t_detecting = false;
+        }
+        if (mask != 0) {
+            deliver(env, mask);
+        }
+
+        lock.lock();
+        if (stopping) break;
+    }
+    lock.unlock();
+
+    srtla_thread_leave(SRTLA_THREAD_HOUSEKEEPING);
+    g_vm->DetachCurrentThread();
+}
+
+void dispatcher_thread() {
+    dispatcher_main();
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_alive = false;
+    }
+    g_cv.notify_all();
+}
+
+}  // namespace
+
+extern "C" jint srtla_events_init(JavaVM* vm, JNIEnv* env) {
+    g_vm = vm;
+    jclass cls = env->FindClass("com/dimadesu/bondbunny/NativeSrtlaJni");
+    if (cls == nullptr) {
+        env->ExceptionClear();
+        SRTLA_LOGW("SRTLA-Events", "NativeSrtlaJni not found, stats events disabled");
+        return JNI_OK;
+    }
+    jmethodID method = env->GetStaticMethodID(cls, "onNativeStatsEvent", "(I)V");
+    if (method == nullptr) {
+        env->ExceptionClear();
+        env->DeleteLocalRef(cls);
+        SRTLA_LOGW("SRTLA-Events", "onNativeStatsEvent not found, stats events disabled");
+        return JNI_OK;
+    }
+    g_callback_class = (jclass)env->NewGlobalRef(cls);
+    g_callback_method = method;
+    env->DeleteLocalRef(cls);
+    return JNI_OK;
+}
+
+extern "C" int srtla_events_start(srtla_events_detect_fn detect) {
+    if (g_vm == nullptr || g_callback_method == nullptr) {
+        return -1;
+    }
+    std::unique_lock<std::mutex> lock(g_mutex);
+    if (g_running) {
+        return 0;
+    }
+    // A dispatcher detached by a stop from its callback still reads g_stopping
+    // and g_detect; starting over it would leave two running
+    if (g_alive && (t_dispatcher ||
+                    !g_cv.wait_for(lock, RESTART_WAIT, [] { return !g_alive; }))) {
+        SRTLA_LOGW("SRTLA-Events", "Previous dispatcher has not exited, not starting another");
+        return -1;
+    }
+    g_detect = detect;
+    g_stopping = false;
+    g_wake = false;
+    g_pending = 0;
+    g_notified.store(false, std::memory_order_relaxed);
+    g_running = true;
+    g_alive = true;
+    g_thread = std::thread(dispatcher_thread);
+    return 0;
+}
+
+extern "C" void srtla_events_stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_running) return;
+        g_stopping = true;
+        g_running = false;
+    }
+    g_cv.notify_one();
+
+    // A listener may stop the service from inside a callback
+    if (g_thread.get_id() == std::this_thread::get_id()) {
+        g_thread.detach();
+    } else {
+        g_thread.join();
+    }
+}
+
+extern "C" void srtla_events_post(int mask) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_running) return;
+        g_pending |= mask;
+        g_wake = true;
+    }
+    g_cv.notify_one();
+}
+
+extern "C" void srtla_events_notify(void) {
+    if (t_detecting) return;
+    if (!g_notified.exchange(true, std::memory_order_relaxed)) {
+        srtla_events_post(0);
+    }
+}
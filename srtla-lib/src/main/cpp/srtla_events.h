@@ -0,0 +1,72 @@
+/*
+ * srtla_events.h - Push-based stats events from native to Java
+ *
+ * A single dispatcher thread, attached to the JavaVM once, delivers coalesced
+ * change events to NativeSrtlaJni.onNativeStatsEvent(int) through a method ID
+ * resolved in JNI_OnLoad. Java no longer has to poll to notice that a link
+ * died or came back.
+ *
+ * Events reach the dispatcher two ways:
+ *   - srtla_events_post(mask): an explicit event from any thread (connection
+ *     established, reconnect attempt, ...)
+ *   - srtla_events_notify(): "state may have changed" (called on every stats
+ *     publication); the dispatcher then runs the detector passed to
+ *     srtla_events_start(), which diffs current state against the last look.
+ *     Notifies from the detector itself are ignored
+ *
+ * Wakeups within SRTLA_EVENTS_COALESCE_MS are merged into one callback. With no
+ * wakeups the detector still runs every SRTLA_EVENTS_IDLE_CHECK_MS, which
+ * covers senders that do not publish stats. The fork's loop neither publishes
+ * nor notifies, so with it that tick is how a link change is noticed, up to
+ * a second late, and the UI keeps its own 1 s refresh.
+ */
+
+#ifndef SRTLA_EVENTS_H
+#define SRTLA_EVENTS_H
+
+/* Host bench builds (SRTLA_HOST_BENCH) only get notify, for the stats
+ * publisher; it does nothing there. */
+#ifndef SRTLA_HOST_BENCH
+#include <jni.h>
+#endif
+
+/* Event bits; keep in sync with NativeSrtlaJni.EVENT_* */
+#define SRTLA_EVENT_CONNECTION_UP    0x01
+#define SRTLA_EVENT_CONNECTION_DOWN  0x02
+#define SRTLA_EVENT_WINDOW_COLLAPSE  0x04
+#define SRTLA_EVENT_RECONNECT        0x08
+#define SRTLA_EVENT_THROUGHPUT       0x10
+#define SRTLA_EVENT_CONNECTED        0x20
+#define SRTLA_EVENT_STOPPED          0x40
+
+#define SRTLA_EVENTS_COALESCE_MS     50
+#define SRTLA_EVENTS_IDLE_CHECK_MS   1000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SRTLA_HOST_BENCH
+/* Returns a mask of SRTLA_EVENT_* bits for changes since its previous call.
+ * Runs on the dispatcher thread only. */
+typedef int (*srtla_events_detect_fn)(void);
+
+/* From JNI_OnLoad: caches the VM and the callback method ID. */
+jint srtla_events_init(JavaVM* vm, JNIEnv* env);
+
+/* Start / stop the dispatcher thread. Stop delivers SRTLA_EVENT_STOPPED; from
+ * a callback it detaches the dispatcher, and start then returns -1 until that
+ * thread has exited (waiting up to a second, except from the callback itself). */
+int srtla_events_start(srtla_events_detect_fn detect);
+void srtla_events_stop(void);
+
+/* Thread-safe, non-blocking. */
+void srtla_events_post(int mask);
+#endif
+void srtla_events_notify(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_EVENTS_H
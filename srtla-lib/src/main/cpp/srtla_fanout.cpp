@@ -0,0 +1,275 @@
+/*
+ * srtla_fanout.cpp - Several SRTLA receivers fed from one SRT source
+ *
+ * See srtla_fanout.h for usage.
+ */
+
+#include "srtla_fanout.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+
+namespace {
+
+// Registry, guarded by registry_mutex
+struct Slot {
+    bool used;
+    char host[SRTLA_FANOUT_HOST_LEN];
+    char port[SRTLA_FANOUT_PORT_LEN];
+    uint8_t group_id[SRTLA_FANOUT_GROUP_ID_LEN];
+    bool group_id_valid;
+};
+
+// Counters: written by the loop thread (or under registry_mutex), read anywhere
+struct Counters {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> drops{0};
+    std::atomic<uint64_t> connects{0};
+    std::atomic<int32_t> connected{0};
+    std::atomic<int32_t> active_links{0};
+};
+
+// What the loop knows about a group; loop-thread only
+struct LoopGroup {
+    bool present;
+    srtla_addr_list_t addrs;
+};
+
+std::mutex registry_mutex;
+Slot slots[SRTLA_FANOUT_MAX_GROUPS];
+srtla_fanout_op_t ops[SRTLA_FANOUT_MAX_OPS];
+int ops_head = 0;
+int ops_count = 0;
+
+Counters counters[SRTLA_FANOUT_MAX_GROUPS];
+LoopGroup loop_groups[SRTLA_FANOUT_MAX_GROUPS];
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+bool valid_group(int group) {
+    return group >= 0 && group < SRTLA_FANOUT_MAX_GROUPS;
+}
+
+bool copy_field(char* dst, size_t dst_len, const char* src) {
+    if (src == nullptr || src[0] == '\0') return false;
+    size_t len = strlen(src);
+    if (len >= dst_len) return false;
+    memcpy(dst, src, len + 1);
+    return true;
+}
+
+// Keeps the newest ops if the loop is not draining them; a new session
+// replays the registry anyway
+void queue_op_locked(int op, int group) {
+    if (ops_count == SRTLA_FANOUT_MAX_OPS) {
+        ops_head = (ops_head + 1) % SRTLA_FANOUT_MAX_OPS;
+        ops_count--;
+    }
+    srtla_fanout_op_t& o = ops[(ops_head + ops_count) % SRTLA_FANOUT_MAX_OPS];
+    memset(&o, 0, sizeof(o));
+    o.op = op;
+    o.group = group;
+    memcpy(o.host, slots[group].host, sizeof(o.host));
+    memcpy(o.port, slots[group].port, sizeof(o.port));
+    ops_count++;
+}
+
+void reset_counters(Counters& c) {
+    c.packets.store(0, std::memory_order_relaxed);
+    c.bytes.store(0, std::memory_order_relaxed);
+    c.drops.store(0, std::memory_order_relaxed);
+    c.connects.store(0, std::memory_order_relaxed);
+    c.connected.store(0, std::memory_order_relaxed);
+    c.active_links.store(0, std::memory_order_relaxed);
+}
+
+// IPv4 address and port of addr, also when it arrives v4-mapped on a
+// dual-stack socket; false for a native IPv6 address
+bool as_v4(const struct sockaddr* addr, socklen_t len, uint32_t* ip, uint16_t* port) {
+    if (addr->sa_family == AF_INET && len >= (socklen_t)sizeof(struct sockaddr_in)) {
+        const struct sockaddr_in* in = reinterpret_cast<const struct sockaddr_in*>(addr);
+        *ip = in->sin_addr.s_addr;
+        *port = in->sin_port;
+        return true;
+    }
+    if (addr->sa_family == AF_INET6 && len >= (socklen_t)sizeof(struct sockaddr_in6)) {
+        const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+        if (IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr)) {
+            memcpy(ip, &in6->sin6_addr.s6_addr[12], 4);
+            *port = in6->sin6_port;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool same_endpoint(const struct sockaddr* a, socklen_t a_len, const struct sockaddr* b,
+                   socklen_t b_len) {
+    uint32_t ip_a = 0, ip_b = 0;
+    uint16_t port_a = 0, port_b = 0;
+    bool v4_a = as_v4(a, a_len, &ip_a, &port_a);
+    bool v4_b = as_v4(b, b_len, &ip_b, &port_b);
+    if (v4_a || v4_b) return v4_a && v4_b && ip_a == ip_b && port_a == port_b;
+    if (a->sa_family != AF_INET6 || b->sa_family != AF_INET6 ||
+        a_len < (socklen_t)sizeof(struct sockaddr_in6) ||
+        b_len < (socklen_t)sizeof(struct sockaddr_in6)) {
+        return false;
+    }
+    const struct sockaddr_in6* a6 = reinterpret_cast<const struct sockaddr_in6*>(a);
+    const struct sockaddr_in6* b6 = reinterpret_cast<const struct sockaddr_in6*>(b);
+    return a6->sin6_port == b6->sin6_port &&
+           memcmp(&a6->sin6_addr, &b6->sin6_addr, sizeof(a6->sin6_addr)) == 0;
+}
+
+}  // namespace
+
+extern "C" void srtla_fanout_start(const char* host, const char* port) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    Slot& primary = slots[0];
+    primary.used = copy_field(primary.host, sizeof(primary.host), host) &&
+                   copy_field(primary.port, sizeof(primary.port), port);
+    primary.group_id_valid = false;
+
+    // The loop is not running yet: its view starts from group 0 alone
+    ops_head = 0;
+    ops_count = 0;
+    for (int g = 0; g < SRTLA_FANOUT_MAX_GROUPS; g++) {
+        reset_counters(counters[g]);
+        loop_groups[g].present = g == 0 && primary.used;
+        loop_groups[g].addrs.count = 0;
+        if (g > 0 && slots[g].used) queue_op_locked(SRTLA_FANOUT_OP_ADD, g);
+    }
+}
+
+extern "C" int srtla_fanout_add(const char* host, const char* port) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (int g = 1; g < SRTLA_FANOUT_MAX_GROUPS; g++) {
+        Slot& s = slots[g];
+        if (s.used) continue;
+        if (!copy_field(s.host, sizeof(s.host), host) ||
+            !copy_field(s.port, sizeof(s.port), port)) {
+            return -1;
+        }
+        s.used = true;
+        s.group_id_valid = false;
+        reset_counters(counters[g]);
+        queue_op_locked(SRTLA_FANOUT_OP_ADD, g);
+        return g;
+    }
+    return -1;
+}
+
+extern "C" int srtla_fanout_remove(int group) {
+    if (group <= 0 || group >= SRTLA_FANOUT_MAX_GROUPS) return -1;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (!slots[group].used) return -1;
+    queue_op_locked(SRTLA_FANOUT_OP_REMOVE, group);
+    slots[group].used = false;
+    return 0;
+}
+
+extern "C" int srtla_fanout_take_op(srtla_fanout_op_t* out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (ops_count == 0) return 0;
+    *out = ops[ops_head];
+    ops_head = (ops_head + 1) % SRTLA_FANOUT_MAX_OPS;
+    ops_count--;
+
+    LoopGroup& lg = loop_groups[out->group];
+    lg.present = out->op == SRTLA_FANOUT_OP_ADD;
+    lg.addrs.count = 0;
+    if (!lg.present) {
+        counters[out->group].connected.store(0, std::memory_order_relaxed);
+        counters[out->group].active_links.store(0, std::memory_order_relaxed);
+    }
+    return 1;
+}
+
+extern "C" int srtla_fanout_count(void) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    int n = 0;
+    for (const Slot& s : slots) n += s.used ? 1 : 0;
+    return n;
+}
+
+extern "C" int srtla_fanout_get_stats(int group, srtla_fanout_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!valid_group(group)) return -1;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        if (!slots[group].used) return -1;
+    }
+    const Counters& c = counters[group];
+    out->packets = c.packets.load(std::memory_order_relaxed);
+    out->bytes = c.bytes.load(std::memory_order_relaxed);
+    out->drops = c.drops.load(std::memory_order_relaxed);
+    out->connects = c.connects.load(std::memory_order_relaxed);
+    out->connected = c.connected.load(std::memory_order_relaxed);
+    out->active_links = c.active_links.load(std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" int srtla_fanout_dispatch(uint8_t* data, int len, srtla_fanout_send_fn fn, void* arg) {
+    if (data == nullptr || len <= 0 || fn == nullptr) return 0;
+    int taken = 0;
+    for (int g = 0; g < SRTLA_FANOUT_MAX_GROUPS; g++) {
+        const LoopGroup& lg = loop_groups[g];
+        if (!lg.present || lg.addrs.count == 0) continue;
+        Counters& c = counters[g];
+        if (fn(g, data, len, arg) < 0) {
+            bump(c.drops, 1);
+            continue;
+        }
+        bump(c.packets, 1);
+        bump(c.bytes, (uint64_t)len);
+        taken++;
+    }
+    return taken;
+}
+
+extern "C" void srtla_fanout_set_addrs(int group, const srtla_addr_list_t* addrs) {
+    if (!valid_group(group) || addrs == nullptr) return;
+    loop_groups[group].addrs = *addrs;
+}
+
+extern "C" int srtla_fanout_group_for_addr(const struct sockaddr* addr, socklen_t len) {
+    if (addr == nullptr) return -1;
+    for (int g = 0; g < SRTLA_FANOUT_MAX_GROUPS; g++) {
+        const LoopGroup& lg = loop_groups[g];
+        if (!lg.present) continue;
+        for (int i = 0; i < lg.addrs.count; i++) {
+            const struct sockaddr* candidate =
+                reinterpret_cast<const struct sockaddr*>(&lg.addrs.addrs[i]);
+            if (same_endpoint(addr, len, candidate, lg.addrs.lens[i])) return g;
+        }
+    }
+    return -1;
+}
+
+extern "C" void srtla_fanout_set_state(int group, int connected, int active_links) {
+    if (!valid_group(group)) return;
+    Counters& c = counters[group];
+    if (connected && !c.connected.load(std::memory_order_relaxed)) bump(c.connects, 1);
+    c.connected.store(connected ? 1 : 0, std::memory_order_relaxed);
+    c.active_links.store(active_links, std::memory_order_relaxed);
+}
+
+extern "C" void srtla_fanout_save_group_id(int group, const uint8_t* id) {
+    if (group <= 0 || group >= SRTLA_FANOUT_MAX_GROUPS || id == nullptr) return;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    memcpy(slots[group].group_id, id, SRTLA_FANOUT_GROUP_ID_LEN);
+    slots[group].group_id_valid = true;
+}
+
+extern "C" int srtla_fanout_load_group_id(int group, uint8_t* id) {
+    if (group <= 0 || group >= SRTLA_FANOUT_MAX_GROUPS || id == nullptr) return 0;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (!slots[group].used || !slots[group].group_id_valid) return 0;
+    memcpy(id, slots[group].group_id, SRTLA_FANOUT_GROUP_ID_LEN);
+    return 1;
+}
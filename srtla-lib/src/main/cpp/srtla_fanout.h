@@ -0,0 +1,142 @@
+/*
+ * srtla_fanout.h - Several SRTLA receivers fed from one SRT source
+ *
+ * startSrtlaNative bonds to one receiver, so a hot-standby ingest (primary
+ * cloud ingest plus a backup receiver) meant a second app instance reading
+ * the encoder's stream again. A receiver group is one SRTLA destination with
+ * its own bonding state; group 0 is the receiver given to startSrtlaNative,
+ * further groups are added with srtla_fanout_add():
+ *
+ *   - the send loop reads each SRT packet from the listener once, into a
+ *     shared pool buffer (srtla_pool_shared_alloc), and
+ *     srtla_fanout_dispatch() hands it to every active group; a group that
+ *     queues it takes a reference (srtla_sendq_push_shared()) instead of a
+ *     copy, and the buffer returns to the pool after the last send
+ *   - every group has its own scheduler, sequence ring, windows and
+ *     registration (group ID), so one receiver being slow or down never
+ *     stalls the others; only the read and the buffer are shared
+ *   - the Java-owned link sockets are shared too: a UDP socket can send to
+ *     several receivers, and replies are told apart by their source address
+ *     (srtla_fanout_group_for_addr())
+ *   - counters are per group (srtla_fanout_get_stats), next to the per-link
+ *     stats of group 0 that the UI already shows
+ *
+ * Groups outlive a session, like the other settings: added groups are
+ * replayed as ADD ops when the next session starts. Group 0 is replaced at
+ * every start and cannot be removed.
+ *
+ * add/remove/stats are thread-safe (one mutex) and reach the loop through an
+ * op queue; dispatch, the address table and the state setters are
+ * loop-thread only and lock-free. Nothing drains the queue until the fork's
+ * loop does, so adding groups is not exposed to Java yet.
+ *
+ * Fork call sites (srtla_send.c, loop thread):
+ *   - on SRTLA_EV_WAKEUP and in housekeeping:
+ *         while (srtla_fanout_take_op(&op)) {
+ *             ADD:    create the group's scheduler / seq ring, resolve
+ *                     op.host:op.port and srtla_fanout_set_addrs(), REG1
+ *             REMOVE: drop the group's state (its queued packets unref)
+ *         }
+ *   - listener readable: buf = srtla_pool_shared_alloc(MTU), recv into it,
+ *         srtla_fanout_dispatch(buf, n, group_send, ctx),
+ *         srtla_pool_shared_unref(buf)
+ *     where group_send picks a conn with that group's scheduler and returns
+ *     srtla_sendq_push_shared(link, buf, n, now_us)
+ *   - SRTLA packet received on a link socket:
+ *         g = srtla_fanout_group_for_addr(&from, fromlen); route to group g
+ *   - connection state: srtla_fanout_set_state(g, connected, active_links);
+ *     REG2 accepted for g > 0: srtla_fanout_save_group_id(g, id)
+ *
+ * Built into the bench only, with srtla_fanout_start() and the rest: it joins
+ * srtla_android with the fork change that makes these calls.
+ */
+
+#ifndef SRTLA_FANOUT_H
+#define SRTLA_FANOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "srtla_inet.h"
+
+#define SRTLA_FANOUT_MAX_GROUPS  4
+#define SRTLA_FANOUT_GROUP_ID_LEN 256  /* SRTLA_ID_LEN in the fork */
+#define SRTLA_FANOUT_HOST_LEN    256
+#define SRTLA_FANOUT_PORT_LEN    16
+#define SRTLA_FANOUT_MAX_OPS     32
+
+#define SRTLA_FANOUT_OP_ADD     1
+#define SRTLA_FANOUT_OP_REMOVE  2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int op;                                /* SRTLA_FANOUT_OP_* */
+    int group;
+    char host[SRTLA_FANOUT_HOST_LEN];
+    char port[SRTLA_FANOUT_PORT_LEN];
+} srtla_fanout_op_t;
+
+typedef struct {
+    uint64_t packets;          /* SRT packets handed to the group */
+    uint64_t bytes;
+    uint64_t drops;            /* refused by the group (no link, queue full) */
+    uint64_t connects;         /* sessions that reached connected */
+    int32_t connected;         /* 1 while registered with its receiver */
+    int32_t active_links;
+} srtla_fanout_stats_t;
+
+/* Session start (startSrtlaNative): group 0 becomes host:port, every group's
+ * counters and addresses are cleared and the added groups are queued as ADD
+ * ops again. */
+void srtla_fanout_start(const char* host, const char* port);
+
+/* Add a receiver group. Returns its id (1..SRTLA_FANOUT_MAX_GROUPS-1), or -1
+ * if host/port is empty or too long, or every group is in use. */
+int srtla_fanout_add(const char* host, const char* port);
+
+/* Remove an added group. Returns 0, or -1 for group 0 or an unused id. */
+int srtla_fanout_remove(int group);
+
+/* Next pending op for the loop; 0 when none is left. */
+int srtla_fanout_take_op(srtla_fanout_op_t* out);
+
+/* Groups in use, group 0 included once a session started. */
+int srtla_fanout_count(void);
+
+/* Stats of a group. Returns 0, or -1 if the id is not in use. */
+int srtla_fanout_get_stats(int group, srtla_fanout_stats_t* out);
+
+/* Loop thread */
+
+/* Called for each active group; returns 0 if the packet was sent or queued
+ * (a queue takes its own reference), < 0 if it was dropped. */
+typedef int (*srtla_fanout_send_fn)(int group, uint8_t* data, int len, void* arg);
+
+/* Hand one packet (a srtla_pool_shared buffer) to every active group, in
+ * group order. The caller keeps its reference and drops it afterwards.
+ * Returns the number of groups that took it. */
+int srtla_fanout_dispatch(uint8_t* data, int len, srtla_fanout_send_fn fn, void* arg);
+
+/* Receiver addresses of a group, once resolved; a group without addresses
+ * is not dispatched to. */
+void srtla_fanout_set_addrs(int group, const srtla_addr_list_t* addrs);
+
+/* Group whose receiver sent from addr, or -1. Ports are compared too. */
+int srtla_fanout_group_for_addr(const struct sockaddr* addr, socklen_t len);
+
+void srtla_fanout_set_state(int group, int connected, int active_links);
+
+/* Last REG2-confirmed group ID of an added group (SRTLA_FANOUT_GROUP_ID_LEN
+ * bytes), for warm restarts. load returns 1 if one is kept. */
+void srtla_fanout_save_group_id(int group, const uint8_t* id);
+int srtla_fanout_load_group_id(int group, uint8_t* id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_FANOUT_H
@@ -0,0 +1,650 @@
+/*
+ * srtla_fec.cpp - Forward error correction across bonded links
+ *
+ * See srtla_fec.h for usage.
+ */
+
+#include "srtla_fec.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SRTLA_FEC_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SRTLA_FEC_SSSE3 1
+#endif
+
+namespace {
+
+const size_t SRT_HEADER_LEN = 16;
+const uint32_t SEQ_MASK = 0x7fffffff;
+const uint8_t FEC_VERSION = 1;
+
+// GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d), generator 2
+struct Gf {
+    uint8_t exp[512];
+    uint8_t log[256];
+    // Parity row i, source j; row 0 is all ones (the XOR parity)
+    uint8_t coef[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_K];
+
+    Gf() {
+        int x = 1;
+        for (int i = 0; i < 255; i++) {
+            exp[i] = (uint8_t)x;
+            log[x] = (uint8_t)i;
+            x <<= 1;
+            if (x & 0x100) x ^= 0x11d;
+        }
+        for (int i = 255; i < 512; i++) exp[i] = exp[i - 255];
+        log[0] = 0;
+
+        // Cauchy matrix 1 / (x_i + y_j), x_i = 64 + i, y_j = j, with each
+        // column scaled so row 0 becomes ones. Column scaling keeps every
+        // square submatrix non-singular, so the code stays MDS.
+        for (int i = 0; i < SRTLA_FEC_MAX_M; i++) {
+            for (int j = 0; j < SRTLA_FEC_MAX_K; j++) {
+                coef[i][j] = mul((uint8_t)(64 ^ j), inv((uint8_t)((64 + i) ^ j)));
+            }
+        }
+    }
+
+    uint8_t mul(uint8_t a, uint8_t b) const {
+        return a && b ? exp[log[a] + log[b]] : 0;
+    }
+
+    uint8_t inv(uint8_t a) const {
+        return exp[255 - log[a]];
+    }
+};
+
+const Gf gf;
+
+inline uint32_t read_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+inline uint16_t read_be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+inline void write_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+inline void write_be16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+inline uint32_t seq_diff(uint32_t a, uint32_t b) {
+    return (a - b) & SEQ_MASK;
+}
+
+void xor_into(uint8_t* dst, const uint8_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t d, s;
+        memcpy(&d, dst + i, 8);
+        memcpy(&s, src + i, 8);
+        d ^= s;
+        memcpy(dst + i, &d, 8);
+    }
+    for (; i < n; i++) dst[i] ^= src[i];
+}
+
+// dst ^= c * src over GF(2^8). The product is looked up per nibble:
+// c*s = lo[s & 15] ^ hi[s >> 4], 16-entry tables that fit one vector register.
+void mul_add(uint8_t* dst, const uint8_t* src, uint8_t c, size_t n) {
+    if (c == 0) return;
+    if (c == 1) {
+        xor_into(dst, src, n);
+        return;
+    }
+    uint8_t lo[16], hi[16];
+    for (int x = 0; x < 16; x++) {
+        lo[x] = gf.mul(c, (uint8_t)x);
+        hi[x] = gf.mul(c, (uint8_t)(x << 4));
+    }
+    size_t i = 0;
+#if defined(SRTLA_FEC_NEON) && defined(__aarch64__)
+    uint8x16_t tlo = vld1q_u8(lo);
+    uint8x16_t thi = vld1q_u8(hi);
+    uint8x16_t nibble = vdupq_n_u8(0x0f);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t s = vld1q_u8(src + i);
+        uint8x16_t p = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(s, nibble)),
+                                vqtbl1q_u8(thi, vshrq_n_u8(s, 4)));
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), p));
+    }
+#elif defined(SRTLA_FEC_NEON)
+    uint8x8x2_t tlo = {{vld1_u8(lo), vld1_u8(lo + 8)}};
+    uint8x8x2_t thi = {{vld1_u8(hi), vld1_u8(hi + 8)}};
+    uint8x8_t nibble = vdup_n_u8(0x0f);
+    for (; i + 8 <= n; i += 8) {
+        uint8x8_t s = vld1_u8(src + i);
+        uint8x8_t p = veor_u8(vtbl2_u8(tlo, vand_u8(s, nibble)), vtbl2_u8(thi, vshr_n_u8(s, 4)));
+        vst1_u8(dst + i, veor_u8(vld1_u8(dst + i), p));
+    }
+#elif defined(SRTLA_FEC_SSSE3)
+    __m128i tlo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+    __m128i thi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+    __m128i nibble = _mm_set1_epi8(0x0f);
+    for (; i + 16 <= n; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i p = _mm_xor_si128(_mm_shuffle_epi8(tlo, _mm_and_si128(s, nibble)),
+                                  _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi16(s, 4), nibble)));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, p));
+    }
+#endif
+    for (; i < n; i++) dst[i] ^= lo[src[i] & 15] ^ hi[src[i] >> 4];
+}
+
+// Symbol j of a group is [u16 len][packet], zero-padded; the padding adds nothing
+void add_symbol(uint8_t* symbol, const uint8_t* pkt, size_t len, uint8_t c) {
+    uint8_t prefix[2];
+    write_be16(prefix, (uint16_t)len);
+    mul_add(symbol, prefix, c, 2);
+    mul_add(symbol + 2, pkt, c, len);
+}
+
+bool is_data(const uint8_t* pkt, size_t len) {
+    return len >= SRT_HEADER_LEN && (pkt[0] & 0x80) == 0;
+}
+
+std::atomic<int> cfg_mode(SRTLA_FEC_OFF);
+std::atomic<int> cfg_k(SRTLA_FEC_DEFAULT_K);
+std::atomic<int> cfg_m(SRTLA_FEC_DEFAULT_M);
+std::atomic<int> cfg_delay_ms(SRTLA_FEC_DEFAULT_MAX_DELAY_MS);
+
+// Parity of one group. Two banks, so a closed group's parity can be handed
+// out while the next group accumulates into the other.
+struct Bank {
+    uint8_t parity[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_PARITY];
+    size_t symbol_len;   // longest symbol so far; beyond it the bank is zero
+    uint8_t link_sources[SRTLA_FEC_MAX_LINKS];
+    uint32_t base;
+    int mode;
+    int k;
+    int m;
+};
+
+// Loop thread only
+struct Encoder {
+    Bank banks[2];
+    int open_bank = 0;
+    bool group_open = false;
+    int count = 0;
+    uint32_t next_seq = 0;
+    uint64_t started_us = 0;
+    const Bank* ready = nullptr;
+    int ready_next = 0;
+    int ready_count = 0;
+};
+
+Encoder enc;
+
+// Single writer (loop thread), read from JNI
+struct Stats {
+    std::atomic<uint64_t> sources{0};
+    std::atomic<uint64_t> source_bytes{0};
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> groups{0};
+    std::atomic<uint64_t> short_groups{0};
+    std::atomic<uint64_t> parity_packets{0};
+    std::atomic<uint64_t> parity_sent{0};
+    std::atomic<uint64_t> parity_bytes{0};
+} stats;
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void open_group(uint32_t seq, uint64_t now_us, int mode) {
+    Bank& b = enc.banks[enc.open_bank];
+    for (int i = 0; i < b.m; i++) memset(b.parity[i] + SRTLA_FEC_HEADER_LEN, 0, b.symbol_len);
+    memset(b.link_sources, 0, sizeof(b.link_sources));
+    b.symbol_len = 0;
+    b.base = seq;
+    b.mode = mode;
+    b.k = cfg_k.load(std::memory_order_relaxed);
+    b.m = mode == SRTLA_FEC_XOR ? 1 : cfg_m.load(std::memory_order_relaxed);
+    enc.group_open = true;
+    enc.count = 0;
+    enc.started_us = now_us;
+}
+
+// Seal the open group and make its parity ready. A single packet is left
+// unprotected: its "parity" would just be a copy.
+int close_group(bool early) {
+    enc.group_open = false;
+    if (enc.count < 2) return 0;
+
+    Bank& b = enc.banks[enc.open_bank];
+    for (int i = 0; i < b.m; i++) {
+        uint8_t* h = b.parity[i];
+        write_be16(h, SRTLA_TYPE_FEC);
+        h[2] = FEC_VERSION;
+        h[3] = (uint8_t)b.mode;
+        write_be32(h + 4, b.base);
+        h[8] = (uint8_t)enc.count;
+        h[9] = (uint8_t)b.m;
+        h[10] = (uint8_t)i;
+        h[11] = 0;
+        write_be16(h + 12, (uint16_t)b.symbol_len);
+        write_be16(h + 14, 0);
+    }
+    b.k = enc.count;
+    enc.ready = &b;
+    enc.ready_next = 0;
+    enc.ready_count = b.m;
+    enc.open_bank ^= 1;
+
+    bump(stats.groups, 1);
+    if (early) bump(stats.short_groups, 1);
+    bump(stats.parity_packets, (uint64_t)b.m);
+    return b.m;
+}
+
+}  // namespace
+
+extern "C" int srtla_fec_configure(int mode, int k, int m, int max_delay_ms) {
+    if (mode < SRTLA_FEC_OFF || mode > SRTLA_FEC_RS || k < 2 || k > SRTLA_FEC_MAX_K ||
+        m < 1 || m > SRTLA_FEC_MAX_M || (mode == SRTLA_FEC_XOR && m != 1) ||
+        max_delay_ms < 1 || max_delay_ms > 1000) {
+        return -1;
+    }
+    cfg_k.store(k, std::memory_order_relaxed);
+    cfg_m.store(m, std::memory_order_relaxed);
+    cfg_delay_ms.store(max_delay_ms, std::memory_order_relaxed);
+    cfg_mode.store(mode, std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" void srtla_fec_get_config(int* mode, int* k, int* m, int* max_delay_ms) {
+    if (mode) *mode = cfg_mode.load(std::memory_order_relaxed);
+    if (k) *k = cfg_k.load(std::memory_order_relaxed);
+    if (m) *m = cfg_m.load(std::memory_order_relaxed);
+    if (max_delay_ms) *max_delay_ms = cfg_delay_ms.load(std::memory_order_relaxed);
+}
+
+extern "C" int srtla_fec_on_source(const uint8_t* pkt, size_t len, int link, uint64_t now_us) {
+    int mode = cfg_mode.load(std::memory_order_relaxed);
+    if (mode == SRTLA_FEC_OFF) {
+        enc.group_open = false;
+        return 0;
+    }
+    if (pkt == nullptr || !is_data(pkt, len)) return 0;
+    // Retransmissions (R flag) would only repeat protection the group had
+    if (len > SRTLA_FEC_MAX_PACKET || (pkt[4] & 0x04) != 0) {
+        bump(stats.skipped, 1);
+        return 0;
+    }
+
+    uint32_t seq = read_be32(pkt) & SEQ_MASK;
+    int ready = 0;
+    if (enc.group_open && seq != enc.next_seq) ready = close_group(true);
+    if (!enc.group_open) open_group(seq, now_us, mode);
+
+    Bank& b = enc.banks[enc.open_bank];
+    for (int i = 0; i < b.m; i++) {
+        add_symbol(b.parity[i] + SRTLA_FEC_HEADER_LEN, pkt, len, gf.coef[i][enc.count]);
+    }
+    if (len + 2 > b.symbol_len) b.symbol_len = len + 2;
+    if (link >= 0 && link < SRTLA_FEC_MAX_LINKS && b.link_sources[link] < 255) {
+        b.link_sources[link]++;
+    }
+    enc.count++;
+    enc.next_seq = (seq + 1) & SEQ_MASK;
+    bump(stats.sources, 1);
+    bump(stats.source_bytes, len);
+
+    if (enc.count >= b.k) ready = close_group(false);
+    return ready;
+}
+
+extern "C" int srtla_fec_poll(uint64_t now_us) {
+    if (!enc.group_open) return 0;
+    uint64_t delay_us = (uint64_t)cfg_delay_ms.load(std::memory_order_relaxed) * 1000;
+    if (now_us < enc.started_us + delay_us) return 0;
+    return close_group(true);
+}
+
+extern "C" int srtla_fec_take_parity(srtla_fec_parity_t* out) {
+    if (enc.ready == nullptr || enc.ready_next >= enc.ready_count) return 0;
+    const Bank& b = *enc.ready;
+    out->data = b.parity[enc.ready_next];
+    out->len = SRTLA_FEC_HEADER_LEN + b.symbol_len;
+    out->base_seq = b.base;
+    out->index = enc.ready_next;
+    out->link_sources = b.link_sources;
+    enc.ready_next++;
+    return 1;
+}
+
+extern "C" int srtla_fec_parity_link(srtla_sched_t* s, const srtla_fec_parity_t* p) {
+    int primary = srtla_sched_pick(s);
+    if (primary < 0) return -1;
+    auto carried = [p](int link) {
+        return link < SRTLA_FEC_MAX_LINKS ? p->link_sources[link] : 0;
+    };
+    if (carried(primary) == 0) return primary;
+    int backup = srtla_sched_pick_backup(s, primary);
+    return backup >= 0 && carried(backup) < carried(primary) ? backup : primary;
+}
+
+extern "C" void srtla_fec_parity_sent(size_t len) {
+    bump(stats.parity_sent, 1);
+    bump(stats.parity_bytes, len);
+}
+
+extern "C" void srtla_fec_get_stats(srtla_fec_stats_t* out) {
+    out->sources = stats.sources.load(std::memory_order_relaxed);
+    out->source_bytes = stats.source_bytes.load(std::memory_order_relaxed);
+    out->skipped = stats.skipped.load(std::memory_order_relaxed);
+    out->groups = stats.groups.load(std::memory_order_relaxed);
+    out->short_groups = stats.short_groups.load(std::memory_order_relaxed);
+    out->parity_packets = stats.parity_packets.load(std::memory_order_relaxed);
+    out->parity_sent = stats.parity_sent.load(std::memory_order_relaxed);
+    out->parity_bytes = stats.parity_bytes.load(std::memory_order_relaxed);
+}
+
+extern "C" void srtla_fec_reset(void) {
+    enc.group_open = false;
+    enc.ready = nullptr;
+    enc.ready_next = enc.ready_count = 0;
+    stats.sources.store(0, std::memory_order_relaxed);
+    stats.source_bytes.store(0, std::memory_order_relaxed);
+    stats.skipped.store(0, std::memory_order_relaxed);
+    stats.groups.store(0, std::memory_order_relaxed);
+    stats.short_groups.store(0, std::memory_order_relaxed);
+    stats.parity_packets.store(0, std::memory_order_relaxed);
+    stats.parity_sent.store(0, std::memory_order_relaxed);
+    stats.parity_bytes.store(0, std::memory_order_relaxed);
+}
+
+/* Receiver side */
+
+namespace {
+
+// Recent sources by sequence number, for rebuilding; must cover the groups
+// still waiting for parity
+const uint32_t SOURCE_SLOTS = 1024;
+const int GROUP_SLOTS = 32;
+
+struct SourceSlot {
+    uint32_t seq_plus1;   // 0 = empty
+    uint16_t len;
+    uint8_t data[SRTLA_FEC_MAX_PACKET];
+};
+
+struct Group {
+    bool used;
+    bool done;
+    uint32_t base;
+    int k;
+    int m;
+    size_t symbol_len;
+    uint32_t have;        // bit per parity index received
+    uint64_t order;
+    uint8_t parity[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_SYMBOL];
+};
+
+}  // namespace
+
+struct srtla_fec_decoder {
+    std::vector<SourceSlot> sources;
+    std::vector<Group> groups;
+    uint64_t order = 0;
+    uint32_t newest = 0;
+    bool have_newest = false;
+    srtla_fec_decoder_stats_t stats;
+    uint8_t residual[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_SYMBOL];
+    uint8_t rebuilt[SRTLA_FEC_MAX_SYMBOL];
+};
+
+namespace {
+
+const SourceSlot* find_source(const srtla_fec_decoder_t* d, uint32_t seq) {
+    const SourceSlot& s = d->sources[seq % SOURCE_SLOTS];
+    return s.seq_plus1 == seq + 1 ? &s : nullptr;
+}
+
+void store_source(srtla_fec_decoder_t* d, uint32_t seq, const uint8_t* pkt, size_t len) {
+    SourceSlot& s = d->sources[seq % SOURCE_SLOTS];
+    s.seq_plus1 = seq + 1;
+    s.len = (uint16_t)len;
+    memcpy(s.data, pkt, len);
+    if (!d->have_newest || seq_diff(seq, d->newest) < SEQ_MASK / 2) {
+        d->newest = seq;
+        d->have_newest = true;
+    }
+}
+
+int missing_of(const srtla_fec_decoder_t* d, const Group& g, int* missing) {
+    int n = 0;
+    for (int j = 0; j < g.k; j++) {
+        if (find_source(d, (g.base + (uint32_t)j) & SEQ_MASK) == nullptr) {
+            if (missing) missing[n] = j;
+            n++;
+        }
+    }
+    return n;
+}
+
+// A group leaving the table is settled: whatever is still missing is lost
+void retire(srtla_fec_decoder_t* d, Group& g) {
+    if (g.used && !g.done) {
+        if (missing_of(d, g, nullptr) == 0) {
+            d->stats.groups_complete++;
+        } else {
+            d->stats.groups_failed++;
+        }
+    }
+    g.used = false;
+}
+
+// Invert the n x n matrix a in place (Gauss-Jordan). False if singular.
+bool invert(uint8_t a[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_M], int n) {
+    uint8_t inv[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_M];
+    memset(inv, 0, sizeof(inv));
+    for (int i = 0; i < n; i++) inv[i][i] = 1;
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        while (pivot < n && a[pivot][col] == 0) pivot++;
+        if (pivot == n) return false;
+        if (pivot != col) {
+            for (int j = 0; j < n; j++) {
+                uint8_t t = a[col][j]; a[col][j] = a[pivot][j]; a[pivot][j] = t;
+                t = inv[col][j]; inv[col][j] = inv[pivot][j]; inv[pivot][j] = t;
+            }
+        }
+        uint8_t scale = gf.inv(a[col][col]);
+        for (int j = 0; j < n; j++) {
+            a[col][j] = gf.mul(a[col][j], scale);
+            inv[col][j] = gf.mul(inv[col][j], scale);
+        }
+        for (int row = 0; row < n; row++) {
+            uint8_t f = a[row][col];
+            if (row == col || f == 0) continue;
+            for (int j = 0; j < n; j++) {
+                a[row][j] ^= gf.mul(f, a[col][j]);
+                inv[row][j] ^= gf.mul(f, inv[col][j]);
+            }
+        }
+    }
+    memcpy(a, inv, sizeof(inv));
+    return true;
+}
+
+int try_recover(srtla_fec_decoder_t* d, Group& g, srtla_fec_recovered_fn cb, void* arg) {
+    int missing[SRTLA_FEC_MAX_K];
+    int e = missing_of(d, g, missing);
+    if (e == 0) {
+        g.done = true;
+        d->stats.groups_complete++;
+        return 0;
+    }
+    int rows[SRTLA_FEC_MAX_M];
+    int p = 0;
+    for (int i = 0; i < g.m && p < e; i++) {
+        if (g.have & (1u << i)) rows[p++] = i;
+    }
+    if (p < e) return 0;
+
+    // residual_a = parity_{rows[a]} minus the sources we have
+    for (int a = 0; a < e; a++) {
+        memcpy(d->residual[a], g.parity[rows[a]], g.symbol_len);
+    }
+    for (int j = 0; j < g.k; j++) {
+        const SourceSlot* s = find_source(d, (g.base + (uint32_t)j) & SEQ_MASK);
+        if (s == nullptr) continue;
+        if ((size_t)s->len + 2 > g.symbol_len) {
+            // Not the packet the sender protected (a wrapped sequence); give up
+            g.done = true;
+            d->stats.groups_failed++;
+            return 0;
+        }
+        for (int a = 0; a < e; a++) {
+            add_symbol(d->residual[a], s->data, s->len, gf.coef[rows[a]][j]);
+        }
+    }
+
+    uint8_t matrix[SRTLA_FEC_MAX_M][SRTLA_FEC_MAX_M];
+    for (int a = 0; a < e; a++) {
+        for (int b = 0; b < e; b++) matrix[a][b] = gf.coef[rows[a]][missing[b]];
+    }
+    g.done = true;
+    if (!invert(matrix, e)) {
+        d->stats.groups_failed++;
+        return 0;
+    }
+
+    int recovered = 0;
+    for (int b = 0; b < e; b++) {
+        memset(d->rebuilt, 0, g.symbol_len);
+        for (int a = 0; a < e; a++) mul_add(d->rebuilt, d->residual[a], matrix[b][a], g.symbol_len);
+        size_t len = read_be16(d->rebuilt);
+        uint32_t seq = (g.base + (uint32_t)missing[b]) & SEQ_MASK;
+        if (len < SRT_HEADER_LEN || len + 2 > g.symbol_len ||
+            (read_be32(d->rebuilt + 2) & SEQ_MASK) != seq) {
+            d->stats.groups_failed++;
+            return recovered;
+        }
+        store_source(d, seq, d->rebuilt + 2, len);
+        d->stats.recovered++;
+        recovered++;
+        if (cb) cb(d->rebuilt + 2, len, arg);
+    }
+    d->stats.groups_recovered++;
+    return recovered;
+}
+
+}  // namespace
+
+extern "C" int srtla_fec_is_parity(const uint8_t* pkt, size_t len) {
+    return pkt != nullptr && len >= SRTLA_FEC_HEADER_LEN && read_be16(pkt) == SRTLA_TYPE_FEC;
+}
+
+extern "C" srtla_fec_decoder_t* srtla_fec_decoder_create(void) {
+    srtla_fec_decoder_t* d = new srtla_fec_decoder_t();
+    d->sources.assign(SOURCE_SLOTS, SourceSlot{});
+    d->groups.assign(GROUP_SLOTS, Group{});
+    memset(&d->stats, 0, sizeof(d->stats));
+    return d;
+}
+
+extern "C" void srtla_fec_decoder_destroy(srtla_fec_decoder_t* d) {
+    delete d;
+}
+
+extern "C" int srtla_fec_decoder_on_source(srtla_fec_decoder_t* d, const uint8_t* pkt, size_t len,
+                                           srtla_fec_recovered_fn cb, void* arg) {
+    if (!is_data(pkt, len) || len > SRTLA_FEC_MAX_PACKET) return 0;
+    uint32_t seq = read_be32(pkt) & SEQ_MASK;
+    if (find_source(d, seq) != nullptr) return 0;  // duplicate or already rebuilt
+    store_source(d, seq, pkt, len);
+    d->stats.sources++;
+
+    int recovered = 0;
+    for (Group& g : d->groups) {
+        if (g.used && !g.done && seq_diff(seq, g.base) < (uint32_t)g.k) {
+            recovered += try_recover(d, g, cb, arg);
+        }
+    }
+    return recovered;
+}
+
+extern "C" int srtla_fec_decoder_on_parity(srtla_fec_decoder_t* d, const uint8_t* pkt, size_t len,
+                                           srtla_fec_recovered_fn cb, void* arg) {
+    d->stats.parities++;
+    if (!srtla_fec_is_parity(pkt, len) || pkt[2] != FEC_VERSION) {
+        d->stats.malformed++;
+        return 0;
+    }
+    int mode = pkt[3];
+    uint32_t base = read_be32(pkt + 4) & SEQ_MASK;
+    int k = pkt[8];
+    int m = pkt[9];
+    int index = pkt[10];
+    size_t symbol_len = read_be16(pkt + 12);
+    if ((mode != SRTLA_FEC_XOR && mode != SRTLA_FEC_RS) || (mode == SRTLA_FEC_XOR && m != 1) ||
+        k < 2 || k > SRTLA_FEC_MAX_K || m < 1 || m > SRTLA_FEC_MAX_M || index >= m ||
+        symbol_len != len - SRTLA_FEC_HEADER_LEN || symbol_len < SRT_HEADER_LEN + 2 ||
+        symbol_len > SRTLA_FEC_MAX_SYMBOL) {
+        d->stats.malformed++;
+        return 0;
+    }
+
+    Group* g = nullptr;
+    Group* free_slot = nullptr;
+    Group* oldest = nullptr;
+    for (Group& c : d->groups) {
+        // Groups whose sources are falling out of the ring can't be rebuilt
+        if (c.used && d->have_newest && seq_diff(d->newest, c.base) < SEQ_MASK / 2 &&
+            seq_diff(d->newest, c.base) > SOURCE_SLOTS / 2) {
+            retire(d, c);
+        }
+        if (c.used && c.base == base) {
+            g = &c;
+        } else if (!c.used) {
+            if (!free_slot) free_slot = &c;
+        } else if (!oldest || c.order < oldest->order) {
+            oldest = &c;
+        }
+    }
+    if (g == nullptr) {
+        if (free_slot == nullptr) {
+            retire(d, *oldest);
+            free_slot = oldest;
+        }
+        g = free_slot;
+        g->used = true;
+        g->done = false;
+        g->base = base;
+        g->k = k;
+        g->m = m;
+        g->symbol_len = symbol_len;
+        g->have = 0;
+        g->order = d->order++;
+    } else if (g->k != k || g->m != m || g->symbol_len != symbol_len) {
+        d->stats.malformed++;
+        return 0;
+    }
+    if (g->done || (g->have & (1u << index))) return 0;
+    memcpy(g->parity[index], pkt + SRTLA_FEC_HEADER_LEN, symbol_len);
+    g->have |= 1u << index;
+    return try_recover(d, *g, cb, arg);
+}
+
+extern "C" void srtla_fec_decoder_get_stats(const srtla_fec_decoder_t* d,
+                                            srtla_fec_decoder_stats_t* out) {
+    *out = d->stats;
+}
@@ -0,0 +1,179 @@
+/*
+ * srtla_fec.h - Forward error correction across bonded links
+ *
+ * A NAK-driven retransmission over a 150 ms cellular link costs at least one
+ * more RTT, which often misses the SRT latency budget. With FEC enabled the
+ * sender adds parity packets over groups of K consecutive SRT data packets,
+ * so the receiver can rebuild up to M lost packets of a group without a
+ * retransmission, at an overhead of M/K:
+ *
+ *   SRTLA_FEC_XOR  one XOR parity per group (M = 1)
+ *   SRTLA_FEC_RS   M Reed-Solomon parities over GF(2^8): systematic code
+ *                  with a Cauchy matrix scaled so parity 0 is the XOR, so
+ *                  any M losses out of K + M packets are recoverable
+ *
+ * Each source symbol is the whole SRT datagram prefixed with its 16-bit
+ * length and zero-padded to the longest in the group; the rebuilt packet is
+ * byte-identical to the lost one and the receiver just forwards it.
+ * Retransmissions (SRT R flag) and control packets are not protected. A group
+ * ends after K packets, at a gap in the SRT sequence, or after max_delay_ms,
+ * so parity never waits behind a stalled encoder.
+ *
+ * Parities are built incrementally as sources go out (no copy of the group
+ * is kept), into static buffers: no allocation on the send path. The
+ * multiply-accumulate kernel uses split-nibble table lookups on NEON
+ * (vqtbl1q_u8 / vtbl2_u8) and SSSE3 (pshufb), with a scalar fallback.
+ *
+ * Parity packets go to the link carrying the fewest of the group's sources
+ * (srtla_fec_parity_link(): the scheduler's pick or its backup), so one
+ * stalled link does not take out the sources and their protection together.
+ * Like duplicate copies they are fire-and-forget: not recorded in
+ * srtla_seq_ring and not counted in flight.
+ *
+ * Parity wire format (big-endian), SRTLA_FEC_HEADER_LEN bytes then the
+ * parity symbol:
+ *    0  u16  SRTLA_TYPE_FEC
+ *    2  u8   version (1)
+ *    3  u8   mode
+ *    4  u32  SRT sequence number of the group's first source
+ *    8  u8   k (sources in this group)
+ *    9  u8   m (parities in this group)
+ *   10  u8   index of this parity (0 .. m-1)
+ *   11  u8   reserved
+ *   12  u16  symbol length
+ *   14  u16  reserved
+ *
+ * The receiver side (srtla_fec_decoder_*) does not depend on Android and is
+ * meant to be built into srtla_rec as well. A receiver without it sees an
+ * unknown SRTLA type, so enable FEC only against a receiver that has it.
+ *
+ * Config may be changed from any thread and applies from the next group;
+ * the encoder is loop-thread only. A decoder object is single-threaded.
+ * Until the fork's data path calls the encoder, FEC is not exposed to Java;
+ * the host bench drives it directly.
+ *
+ * Fork call sites (srtla_send.c):
+ *   - data path, after the packet went out on conn c:
+ *         if (srtla_fec_on_source(buf, len, c, now_us) > 0) send_parities();
+ *   - housekeeping / reactor timeout: if (srtla_fec_poll(now_us) > 0) send_parities();
+ *   - send_parities():
+ *         srtla_fec_parity_t p;
+ *         while (srtla_fec_take_parity(&p)) {
+ *             int l = srtla_fec_parity_link(sched, &p);
+ *             if (l >= 0 && sendto(conns[l]->fd, p.data, p.len, ...) == p.len)
+ *                 srtla_fec_parity_sent(p.len);
+ *         }
+ * Receiver call sites (srtla_rec.c): SRT data from a sender goes through
+ * srtla_fec_decoder_on_source() as it is forwarded; packets with
+ * srtla_fec_is_parity() go to srtla_fec_decoder_on_parity() instead of the SRT
+ * server. Recovered packets arrive in the callback and are forwarded as if
+ * received.
+ */
+
+#ifndef SRTLA_FEC_H
+#define SRTLA_FEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "srtla_scheduler.h"
+
+#define SRTLA_TYPE_FEC 0x9300
+
+#define SRTLA_FEC_OFF  0
+#define SRTLA_FEC_XOR  1
+#define SRTLA_FEC_RS   2
+
+#define SRTLA_FEC_MAX_K        64
+#define SRTLA_FEC_MAX_M        8
+#define SRTLA_FEC_MAX_LINKS    32
+#define SRTLA_FEC_MAX_PACKET   1454   /* parity then fits a 1472-byte UDP payload */
+#define SRTLA_FEC_HEADER_LEN   16
+#define SRTLA_FEC_MAX_SYMBOL   (SRTLA_FEC_MAX_PACKET + 2)
+#define SRTLA_FEC_MAX_PARITY   (SRTLA_FEC_HEADER_LEN + SRTLA_FEC_MAX_SYMBOL)
+
+#define SRTLA_FEC_DEFAULT_K             10
+#define SRTLA_FEC_DEFAULT_M             1
+#define SRTLA_FEC_DEFAULT_MAX_DELAY_MS  20
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t sources;          /* data packets protected */
+    uint64_t source_bytes;
+    uint64_t skipped;          /* retransmissions and oversized packets */
+    uint64_t groups;           /* groups closed with parity */
+    uint64_t short_groups;     /* of those, closed early (gap or max delay) */
+    uint64_t parity_packets;   /* parity packets handed out */
+    uint64_t parity_sent;
+    uint64_t parity_bytes;     /* bytes of parity sent */
+} srtla_fec_stats_t;
+
+typedef struct {
+    const uint8_t* data;                 /* valid until the next on_source/poll */
+    size_t len;
+    uint32_t base_seq;
+    int index;
+    const uint8_t* link_sources;         /* group sources per link, SRTLA_FEC_MAX_LINKS */
+} srtla_fec_parity_t;
+
+/* mode SRTLA_FEC_OFF/XOR/RS; k 2..SRTLA_FEC_MAX_K; m 1..SRTLA_FEC_MAX_M (1 for
+ * XOR); max_delay_ms 1..1000. Returns 0, or -1 if out of range. */
+int srtla_fec_configure(int mode, int k, int m, int max_delay_ms);
+void srtla_fec_get_config(int* mode, int* k, int* m, int* max_delay_ms);
+
+/* Encoder (loop thread). Returns the number of parity packets ready. */
+int srtla_fec_on_source(const uint8_t* pkt, size_t len, int link, uint64_t now_us);
+int srtla_fec_poll(uint64_t now_us);
+
+/* Next ready parity packet; 0 when none is left. */
+int srtla_fec_take_parity(srtla_fec_parity_t* out);
+
+/* Link for a parity packet: the scheduler's pick, or its backup if that
+ * carried fewer of the group's sources. -1 if no link is usable. */
+int srtla_fec_parity_link(srtla_sched_t* s, const srtla_fec_parity_t* p);
+
+void srtla_fec_parity_sent(size_t len);
+
+void srtla_fec_get_stats(srtla_fec_stats_t* out);
+
+/* Drop the open group and zero the stats, for a new session. */
+void srtla_fec_reset(void);
+
+/* Receiver side */
+
+typedef struct {
+    uint64_t sources;          /* data packets seen */
+    uint64_t parities;         /* parity packets seen */
+    uint64_t recovered;        /* packets rebuilt */
+    uint64_t groups_complete;  /* groups with nothing lost */
+    uint64_t groups_recovered; /* groups with losses, all rebuilt */
+    uint64_t groups_failed;    /* groups with more losses than parities */
+    uint64_t malformed;        /* parity packets rejected */
+} srtla_fec_decoder_stats_t;
+
+typedef struct srtla_fec_decoder srtla_fec_decoder_t;
+
+typedef void (*srtla_fec_recovered_fn)(const uint8_t* pkt, size_t len, void* arg);
+
+int srtla_fec_is_parity(const uint8_t* pkt, size_t len);
+
+srtla_fec_decoder_t* srtla_fec_decoder_create(void);
+void srtla_fec_decoder_destroy(srtla_fec_decoder_t* d);
+
+/* Feed every SRT data packet received, in arrival order, and every parity
+ * packet. Returns the number of packets recovered by this call. */
+int srtla_fec_decoder_on_source(srtla_fec_decoder_t* d, const uint8_t* pkt, size_t len,
+                                srtla_fec_recovered_fn cb, void* arg);
+int srtla_fec_decoder_on_parity(srtla_fec_decoder_t* d, const uint8_t* pkt, size_t len,
+                                srtla_fec_recovered_fn cb, void* arg);
+
+void srtla_fec_decoder_get_stats(const srtla_fec_decoder_t* d, srtla_fec_decoder_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_FEC_H
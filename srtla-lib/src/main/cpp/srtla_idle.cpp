@@ -0,0 +1,191 @@
+/*
+ * srtla_idle.cpp - Parked sender while no SRT source is connected
+ *
+ * See srtla_idle.h for usage.
+ */
+
+#include "srtla_idle.h"
+#include "srtla_trace.h"
+
+#include <atomic>
+#include <time.h>
+
+namespace {
+
+// Config, any thread
+std::atomic<bool> enabled(true);
+std::atomic<int> enter_ms(SRTLA_IDLE_ENTER_MS);
+std::atomic<int> keepalive_ms(SRTLA_IDLE_KEEPALIVE_MS);
+std::atomic<int> slack_ms(SRTLA_IDLE_SLACK_MS);
+
+// State: written by the loop thread, read anywhere
+std::atomic<bool> idle(false);
+std::atomic<int64_t> entered_ns(0);
+
+// Loop thread only
+int64_t last_packet_ns = 0;
+int64_t wake_ns = 0;       // recv time of the packet that ended idle; 0 = none
+int64_t cpu_mark_ns = 0;   // loop thread CPU time when last accounted
+
+// Stats
+std::atomic<uint64_t> entries(0);
+std::atomic<uint64_t> idle_total_ns(0);
+std::atomic<uint64_t> wakeups(0);
+std::atomic<uint64_t> cpu_ns(0);
+std::atomic<int64_t> current_sum_ua(0);
+std::atomic<uint64_t> current_samples(0);
+std::atomic<uint64_t> wakes(0);
+std::atomic<uint64_t> last_wake_us(0);
+std::atomic<uint64_t> max_wake_us(0);
+std::atomic<uint64_t> total_wake_us(0);
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+int64_t thread_cpu_ns() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Charge the loop thread's CPU since the last mark to idle time
+void account_cpu() {
+    int64_t now = thread_cpu_ns();
+    if (now > cpu_mark_ns) bump(cpu_ns, (uint64_t)(now - cpu_mark_ns));
+    cpu_mark_ns = now;
+}
+
+void enter(int64_t now_ns) {
+    cpu_mark_ns = thread_cpu_ns();
+    entered_ns.store(now_ns, std::memory_order_relaxed);
+    idle.store(true, std::memory_order_relaxed);
+    bump(entries, 1);
+    srtla_trace_emit(SRTLA_TRACE_IDLE, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_IDLE_ENTER, 0,
+                     (now_ns - last_packet_ns) / 1000000);
+}
+
+void leave(int64_t now_ns) {
+    account_cpu();
+    int64_t period = now_ns - entered_ns.load(std::memory_order_relaxed);
+    if (period > 0) bump(idle_total_ns, (uint64_t)period);
+    idle.store(false, std::memory_order_relaxed);
+    srtla_trace_emit(SRTLA_TRACE_IDLE, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_IDLE_LEAVE, 0,
+                     period / 1000000);
+}
+
+}  // namespace
+
+extern "C" int srtla_idle_configure(int on, int enter, int keepalive, int slack) {
+    if (enter < 1000 || keepalive < SRTLA_IDLE_ACTIVE_KEEPALIVE_MS ||
+        keepalive > SRTLA_IDLE_RECEIVER_TIMEOUT_MS / 2 || slack < 0 || slack > 1000) {
+        return -1;
+    }
+    enter_ms.store(enter, std::memory_order_relaxed);
+    keepalive_ms.store(keepalive, std::memory_order_relaxed);
+    slack_ms.store(slack, std::memory_order_relaxed);
+    enabled.store(on != 0, std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" void srtla_idle_reset(int64_t now_ns) {
+    idle.store(false, std::memory_order_relaxed);
+    entered_ns.store(0, std::memory_order_relaxed);
+    last_packet_ns = now_ns;
+    wake_ns = 0;
+    cpu_mark_ns = 0;
+    entries.store(0, std::memory_order_relaxed);
+    idle_total_ns.store(0, std::memory_order_relaxed);
+    wakeups.store(0, std::memory_order_relaxed);
+    cpu_ns.store(0, std::memory_order_relaxed);
+    current_sum_ua.store(0, std::memory_order_relaxed);
+    current_samples.store(0, std::memory_order_relaxed);
+    wakes.store(0, std::memory_order_relaxed);
+    last_wake_us.store(0, std::memory_order_relaxed);
+    max_wake_us.store(0, std::memory_order_relaxed);
+    total_wake_us.store(0, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_idle_active(void) {
+    return idle.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+extern "C" int srtla_idle_keepalive_ms(void) {
+    return idle.load(std::memory_order_relaxed) ? keepalive_ms.load(std::memory_order_relaxed)
+                                                : SRTLA_IDLE_ACTIVE_KEEPALIVE_MS;
+}
+
+extern "C" int srtla_idle_slack_ms(void) {
+    return idle.load(std::memory_order_relaxed) ? slack_ms.load(std::memory_order_relaxed) : 0;
+}
+
+extern "C" int srtla_idle_packet(int64_t now_ns) {
+    last_packet_ns = now_ns;
+    if (!idle.load(std::memory_order_relaxed)) return 0;
+    leave(now_ns);
+    wake_ns = now_ns;
+    return 1;
+}
+
+extern "C" void srtla_idle_forwarded(int64_t now_ns) {
+    if (wake_ns == 0) return;
+    uint64_t us = now_ns > wake_ns ? (uint64_t)(now_ns - wake_ns) / 1000 : 0;
+    wake_ns = 0;
+    bump(wakes, 1);
+    bump(total_wake_us, us);
+    last_wake_us.store(us, std::memory_order_relaxed);
+    if (us > max_wake_us.load(std::memory_order_relaxed)) {
+        max_wake_us.store(us, std::memory_order_relaxed);
+    }
+    srtla_trace_emit(SRTLA_TRACE_IDLE, SRTLA_TRACE_NO_LINK, SRTLA_TRACE_IDLE_FORWARD, 0,
+                     (int64_t)us);
+}
+
+extern "C" int srtla_idle_tick(int64_t now_ns) {
+    bool on = enabled.load(std::memory_order_relaxed);
+    if (idle.load(std::memory_order_relaxed)) {
+        if (on) {
+            account_cpu();
+            return 0;
+        }
+        leave(now_ns);
+        return -1;
+    }
+    int64_t quiet_ms = (now_ns - last_packet_ns) / 1000000;
+    if (!on || quiet_ms < enter_ms.load(std::memory_order_relaxed)) return 0;
+    enter(now_ns);
+    return 1;
+}
+
+extern "C" void srtla_idle_count_wakeup(void) {
+    if (idle.load(std::memory_order_relaxed)) bump(wakeups, 1);
+}
+
+extern "C" void srtla_idle_report_current(int64_t current_ua) {
+    if (!idle.load(std::memory_order_relaxed)) return;
+    current_sum_ua.fetch_add(current_ua, std::memory_order_relaxed);
+    current_samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" void srtla_idle_get_stats(srtla_idle_stats_t* out, int64_t now_ns) {
+    bool parked = idle.load(std::memory_order_relaxed);
+    uint64_t total_ns = idle_total_ns.load(std::memory_order_relaxed);
+    if (parked) {
+        int64_t period = now_ns - entered_ns.load(std::memory_order_relaxed);
+        if (period > 0) total_ns += (uint64_t)period;
+    }
+    uint64_t samples = current_samples.load(std::memory_order_relaxed);
+
+    out->enabled = enabled.load(std::memory_order_relaxed) ? 1 : 0;
+    out->idle = parked ? 1 : 0;
+    out->entries = entries.load(std::memory_order_relaxed);
+    out->idle_ms = total_ns / 1000000;
+    out->wakeups = wakeups.load(std::memory_order_relaxed);
+    out->cpu_us = cpu_ns.load(std::memory_order_relaxed) / 1000;
+    out->avg_current_ua =
+        samples ? current_sum_ua.load(std::memory_order_relaxed) / (int64_t)samples : 0;
+    out->wakes = wakes.load(std::memory_order_relaxed);
+    out->last_wake_us = last_wake_us.load(std::memory_order_relaxed);
+    out->max_wake_us = max_wake_us.load(std::memory_order_relaxed);
+    out->total_wake_us = total_wake_us.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,125 @@
+/*
+ * srtla_idle.h - Parked sender while no SRT source is connected
+ *
+ * The service is often started long before the encoder connects, or runs on
+ * while it is paused. The sender kept its streaming cadence meanwhile: a
+ * keepalive per link every second, housekeeping at full rate, the retry loop
+ * polling for stop, the stats dispatcher and the UI polling too. On long event
+ * days that drained the battery before the stream started.
+ *
+ * After SRTLA_IDLE_ENTER_MS without an SRT packet on the listen port the
+ * sender goes idle:
+ *
+ *   - keepalives (and housekeeping, which sends them) drop to one every
+ *     srtla_idle_keepalive_ms(): the least that keeps every link registered,
+ *     at most half the receiver's connection timeout so one lost keepalive is
+ *     survived. Registration and group ID are kept, so nothing is redone on
+ *     wake
+ *   - the loop thread's timer slack is raised (PR_SET_TIMERSLACK) and the
+ *     housekeeping timerfd is aligned to a multiple of the slack
+ *     (srtla_reactor_set_slack()), so its wakeups land together with other
+ *     timers of the process instead of each waking the CPU on its own
+ *
+ * The listen socket stays in the epoll set: readiness is not a timer and no
+ * slack applies to it, so the first packet wakes the loop at once;
+ * srtla_idle_packet() reports the wake and the caller restores the active
+ * cadence before forwarding. How long that first packet took from recv to
+ * its send is the wake-to-forward latency.
+ *
+ * Idle cost is reported as loop wakeups and loop thread CPU time while idle,
+ * plus the battery current Java samples while idle (BatteryManager), so idle
+ * draw can be compared against the active figures.
+ *
+ * The state and the stats can be read from any thread; packet/forwarded/
+ * tick/count_wakeup belong to the loop thread. Times are CLOCK_MONOTONIC ns.
+ *
+ * Built into the bench only: until the fork's loop makes the calls below the
+ * sender never goes idle, so the module joins srtla_android, and the config
+ * and stats reach Java, with that fork change.
+ *
+ * Fork call sites (srtla_send.c, loop thread):
+ *   - after each srtla_reactor_wait() return: srtla_idle_count_wakeup()
+ *   - with park() = srtla_reactor_set_slack(srtla_idle_slack_ms()),
+ *     srtla_reactor_set_interval(srtla_idle_keepalive_ms()) and unpark() =
+ *     srtla_reactor_set_slack(0), srtla_reactor_set_interval(
+ *     HOUSEKEEPING_INTERVAL_MS), srtla_events_notify():
+ *   - listener packet read: if (srtla_idle_packet(now_ns)) unpark();
+ *     and once the packet is sent: srtla_idle_forwarded(now_ns)
+ *   - housekeeping: t = srtla_idle_tick(now_ns); t > 0: park(), t < 0:
+ *     unpark(); and send a conn's keepalive once it has been quiet for
+ *     srtla_idle_keepalive_ms() instead of IDLE_TIME
+ */
+
+#ifndef SRTLA_IDLE_H
+#define SRTLA_IDLE_H
+
+#include <stdint.h>
+
+#define SRTLA_IDLE_ENTER_MS             10000  /* without SRT packets */
+#define SRTLA_IDLE_ACTIVE_KEEPALIVE_MS   1000  /* the fork's IDLE_TIME */
+#define SRTLA_IDLE_KEEPALIVE_MS          2000
+#define SRTLA_IDLE_RECEIVER_TIMEOUT_MS   4000  /* srtla_rec CONN_TIMEOUT */
+#define SRTLA_IDLE_SLACK_MS               100
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t enabled;
+    int32_t idle;             /* 1 while parked */
+    uint64_t entries;         /* times the sender went idle */
+    uint64_t idle_ms;         /* total, the current period included */
+    uint64_t wakeups;         /* loop wakeups while idle */
+    uint64_t cpu_us;          /* loop thread CPU while idle */
+    int64_t avg_current_ua;   /* battery current while idle; 0 = not sampled */
+    uint64_t wakes;           /* idle periods ended by a packet */
+    uint64_t last_wake_us;    /* wake-to-forward latency */
+    uint64_t max_wake_us;
+    uint64_t total_wake_us;
+} srtla_idle_stats_t;
+
+/* Enable switch (on by default) and timings: enter_ms >= 1000, keepalive_ms
+ * from SRTLA_IDLE_ACTIVE_KEEPALIVE_MS to half of
+ * SRTLA_IDLE_RECEIVER_TIMEOUT_MS, slack_ms 0..1000. Applies from the next
+ * idle period. Returns 0, or -1 if out of range. */
+int srtla_idle_configure(int enabled, int enter_ms, int keepalive_ms, int slack_ms);
+
+/* Session start: active, counting from now_ns, stats cleared. */
+void srtla_idle_reset(int64_t now_ns);
+
+int srtla_idle_active(void);
+
+/* Keepalive / housekeeping period and timer slack for the current state. */
+int srtla_idle_keepalive_ms(void);
+int srtla_idle_slack_ms(void);
+
+/* Loop thread */
+
+/* An SRT packet was read from the listener. Returns 1 if it ended an idle
+ * period; the caller then restores the active cadence. */
+int srtla_idle_packet(int64_t now_ns);
+
+/* The packet passed to srtla_idle_packet() was sent; after a wake this
+ * records the wake-to-forward latency, otherwise it does nothing. */
+void srtla_idle_forwarded(int64_t now_ns);
+
+/* Housekeeping. Returns 1 if the sender went idle on this tick, -1 if it
+ * left idle because idle mode was disabled, 0 otherwise. */
+int srtla_idle_tick(int64_t now_ns);
+
+void srtla_idle_count_wakeup(void);
+
+/* Any thread */
+
+/* Battery current in uA (BatteryManager.BATTERY_PROPERTY_CURRENT_NOW);
+ * averaged while idle, ignored otherwise. */
+void srtla_idle_report_current(int64_t current_ua);
+
+void srtla_idle_get_stats(srtla_idle_stats_t* out, int64_t now_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_IDLE_H
@@ -0,0 +1,208 @@
+/*
+ * srtla_inet.cpp - Dual-stack sockets and per-link receiver address choice
+ *
+ * See srtla_inet.h for usage.
+ */
+
+#include "srtla_inet.h"
+#include "srtla_log.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<bool> dual_stack(false);
+// Cleared the first time the kernel refuses AF_INET6 sockets
+std::atomic<bool> ipv6_available(true);
+
+std::atomic<uint64_t> ipv6_paths(0);
+std::atomic<uint64_t> ipv4_paths(0);
+std::atomic<uint64_t> mapped_paths(0);
+
+bool is_v4_mapped(const struct sockaddr* addr) {
+    if (addr->sa_family != AF_INET6) return false;
+    const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+    return IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr);
+}
+
+// Whether fd's network has a route to dst: a UDP connect() only does the
+// route lookup. The association is dissolved again (AF_UNSPEC).
+bool has_route(int fd, const struct sockaddr* dst, socklen_t dst_len) {
+    if (connect(fd, dst, dst_len) != 0) return false;
+    struct sockaddr unspec;
+    memset(&unspec, 0, sizeof(unspec));
+    unspec.sa_family = AF_UNSPEC;
+    connect(fd, &unspec, sizeof(unspec));
+    return true;
+}
+
+void log_path(int fd, const char* kind, const struct sockaddr* dst) {
+    char text[SRTLA_INET_ADDRSTRLEN];
+    SRTLA_LOGI("SRTLA-JNI", "FD %d: %s path to %s", fd, kind,
+               srtla_inet_ntop(dst, text, sizeof(text)));
+}
+
+}  // namespace
+
+extern "C" void srtla_inet_set_dual_stack(int enabled) {
+    dual_stack.store(enabled != 0, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_inet_dual_stack(void) {
+    return dual_stack.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+extern "C" int srtla_inet_udp_socket(int* family_out) {
+    if (dual_stack.load(std::memory_order_relaxed) &&
+        ipv6_available.load(std::memory_order_relaxed)) {
+        int fd = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd >= 0) {
+            int off = 0;
+            if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == 0) {
+                if (family_out) *family_out = AF_INET6;
+                return fd;
+            }
+            SRTLA_LOGW("SRTLA-JNI", "IPV6_V6ONLY off refused (%s), using IPv4 sockets",
+                       strerror(errno));
+            close(fd);
+        } else {
+            SRTLA_LOGW("SRTLA-JNI", "No IPv6 sockets (%s), using IPv4 sockets", strerror(errno));
+        }
+        ipv6_available.store(false, std::memory_order_relaxed);
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd >= 0 && family_out) *family_out = AF_INET;
+    return fd;
+}
+
+extern "C" int srtla_inet_socket_family(int fd) {
+    struct sockaddr_storage local;
+    socklen_t len = sizeof(local);
+    if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&local), &len) != 0) return -1;
+    return local.ss_family == AF_INET || local.ss_family == AF_INET6 ? local.ss_family : -1;
+}
+
+extern "C" int srtla_inet_pick_dst(int fd, const srtla_addr_list_t* candidates,
+                                   struct sockaddr_storage* dst, socklen_t* dst_len) {
+    int family = srtla_inet_socket_family(fd);
+    if (family < 0 || candidates == nullptr) return -1;
+
+    if (family == AF_INET6) {
+        for (int i = 0; i < candidates->count; i++) {
+            const struct sockaddr* c = reinterpret_cast<const struct sockaddr*>(&candidates->addrs[i]);
+            if (c->sa_family != AF_INET6 || is_v4_mapped(c)) continue;
+            if (!has_route(fd, c, candidates->lens[i])) continue;
+            memcpy(dst, c, candidates->lens[i]);
+            *dst_len = candidates->lens[i];
+            ipv6_paths.fetch_add(1, std::memory_order_relaxed);
+            log_path(fd, "native IPv6", c);
+            return AF_INET6;
+        }
+    }
+
+    for (int i = 0; i < candidates->count; i++) {
+        const struct sockaddr* c = reinterpret_cast<const struct sockaddr*>(&candidates->addrs[i]);
+        if (c->sa_family != AF_INET) continue;
+        const struct sockaddr_in* in = reinterpret_cast<const struct sockaddr_in*>(c);
+        memset(dst, 0, sizeof(*dst));
+        if (family == AF_INET6) {
+            srtla_inet_map_v4(in, reinterpret_cast<struct sockaddr_in6*>(dst));
+            *dst_len = sizeof(struct sockaddr_in6);
+            mapped_paths.fetch_add(1, std::memory_order_relaxed);
+            log_path(fd, "IPv4 (mapped)", c);
+        } else {
+            memcpy(dst, in, sizeof(*in));
+            *dst_len = sizeof(*in);
+            ipv4_paths.fetch_add(1, std::memory_order_relaxed);
+        }
+        return AF_INET;
+    }
+
+    SRTLA_LOGW("SRTLA-JNI", "FD %d: no receiver address reachable from an %s socket", fd,
+               family == AF_INET6 ? "IPv6" : "IPv4");
+    return -1;
+}
+
+extern "C" void srtla_inet_map_v4(const struct sockaddr_in* in, struct sockaddr_in6* out) {
+    memset(out, 0, sizeof(*out));
+    out->sin6_family = AF_INET6;
+    out->sin6_port = in->sin_port;
+    out->sin6_addr.s6_addr[10] = 0xff;
+    out->sin6_addr.s6_addr[11] = 0xff;
+    memcpy(&out->sin6_addr.s6_addr[12], &in->sin_addr, sizeof(in->sin_addr));
+}
+
+extern "C" const char* srtla_inet_ntop(const struct sockaddr* addr, char* buf, size_t len) {
+    if (len == 0) return buf;
+    buf[0] = '\0';
+    if (addr == nullptr) return buf;
+    if (addr->sa_family == AF_INET) {
+        const struct sockaddr_in* in = reinterpret_cast<const struct sockaddr_in*>(addr);
+        inet_ntop(AF_INET, &in->sin_addr, buf, (socklen_t)len);
+    } else if (is_v4_mapped(addr)) {
+        const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+        inet_ntop(AF_INET, &in6->sin6_addr.s6_addr[12], buf, (socklen_t)len);
+    } else if (addr->sa_family == AF_INET6) {
+        const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+        if (inet_ntop(AF_INET6, &in6->sin6_addr, buf, (socklen_t)len) != nullptr &&
+            in6->sin6_scope_id != 0) {
+            size_t used = strlen(buf);
+            snprintf(buf + used, len - used, "%%%u", (unsigned)in6->sin6_scope_id);
+        }
+    }
+    return buf;
+}
+
+extern "C" int srtla_inet_pton(const char* host, int port, struct sockaddr_storage* out,
+                               socklen_t* len) {
+    if (host == nullptr || port < 0 || port > 65535) return -1;
+    memset(out, 0, sizeof(*out));
+
+    struct sockaddr_in* in = reinterpret_cast<struct sockaddr_in*>(out);
+    if (inet_pton(AF_INET, host, &in->sin_addr) == 1) {
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)port);
+        *len = sizeof(*in);
+        return 0;
+    }
+
+    char text[SRTLA_INET_ADDRSTRLEN];
+    size_t n = strlen(host);
+    if (n >= 2 && host[0] == '[' && host[n - 1] == ']') {
+        host++;
+        n -= 2;
+    }
+    if (n >= sizeof(text)) return -1;
+    memcpy(text, host, n);
+    text[n] = '\0';
+
+    uint32_t scope = 0;
+    char* pct = strchr(text, '%');
+    if (pct != nullptr) {
+        *pct = '\0';
+        scope = if_nametoindex(pct + 1);
+        if (scope == 0) scope = (uint32_t)strtoul(pct + 1, nullptr, 10);
+    }
+    struct sockaddr_in6* in6 = reinterpret_cast<struct sockaddr_in6*>(out);
+    if (inet_pton(AF_INET6, text, &in6->sin6_addr) != 1) return -1;
+    in6->sin6_family = AF_INET6;
+    in6->sin6_port = htons((uint16_t)port);
+    in6->sin6_scope_id = scope;
+    *len = sizeof(*in6);
+    return 0;
+}
+
+extern "C" void srtla_inet_counters(uint64_t* ipv6, uint64_t* ipv4, uint64_t* mapped) {
+    if (ipv6) *ipv6 = ipv6_paths.load(std::memory_order_relaxed);
+    if (ipv4) *ipv4 = ipv4_paths.load(std::memory_order_relaxed);
+    if (mapped) *mapped = mapped_paths.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,100 @@
+/*
+ * srtla_inet.h - Dual-stack sockets and per-link receiver address choice
+ *
+ * Bonded sockets used to be AF_INET only, so on an IPv6-only carrier every
+ * packet went through 464XLAT: the CLAT on the phone translates it to IPv6
+ * and the operator's NAT64 translates it back, which costs latency and a
+ * per-packet rewrite even when the receiver has an AAAA record.
+ *
+ * With dual stack enabled (srtla_inet_set_dual_stack(1)):
+ *   - srtla_inet_udp_socket() creates AF_INET6 sockets with IPV6_V6ONLY off,
+ *     so one socket can reach IPv6 receivers natively and IPv4 receivers as
+ *     v4-mapped addresses (::ffff:a.b.c.d). Without kernel IPv6 it falls back
+ *     to AF_INET.
+ *   - srtla_inet_pick_dst() chooses the receiver address for one link from
+ *     every address the host resolved to (getaddrinfo() with AF_UNSPEC):
+ *     the first IPv6 address the link has a route to, probed with a UDP
+ *     connect() on the link's own (network-bound) socket, else the first
+ *     IPv4 address, mapped for AF_INET6 sockets. Each link can thus take a
+ *     native IPv6 path while another one stays on IPv4.
+ * Disabled (the default), sockets stay AF_INET and the first IPv4 address is
+ * used, as before.
+ *
+ * The route probe connects and then dissolves the association, which
+ * releases an auto-bound local port; it must run before the first packet is
+ * sent on the fd, i.e. before registration.
+ *
+ * Receiver source addresses on AF_INET6 sockets arrive v4-mapped for an IPv4
+ * receiver; the fork's conn lookup has to treat those as the IPv4 address
+ * so lookups match however the conn was registered.
+ *
+ * Thread-safe.
+ *
+ * Fork call sites (srtla_send.c):
+ *   - srtla_start_android(): keep every address getaddrinfo() returns for
+ *     the receiver in a srtla_addr_list_t, not only the first
+ *   - conn setup, before REG1/REG2 on c->fd:
+ *       srtla_inet_pick_dst(c->fd, &addrs, &c->dst, &c->dst_len)
+ *     and send on that conn with c->dst instead of the global srtla_addr
+ *   - sockets the fork creates itself: srtla_inet_udp_socket(&family)
+ *
+ * Until the fork sends per conn, dual stack would only change the socket
+ * family, so the module is not linked into libsrtla_android and Java cannot
+ * enable it; createUdpSocketNative() makes AF_INET sockets.
+ */
+
+#ifndef SRTLA_INET_H
+#define SRTLA_INET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define SRTLA_INET_MAX_ADDRS 8
+#define SRTLA_INET_ADDRSTRLEN 64   /* IPv6 with scope fits; as SRTLA_STATS_IP_LEN */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    struct sockaddr_storage addrs[SRTLA_INET_MAX_ADDRS];
+    socklen_t lens[SRTLA_INET_MAX_ADDRS];
+    int count;
+} srtla_addr_list_t;
+
+void srtla_inet_set_dual_stack(int enabled);
+int srtla_inet_dual_stack(void);
+
+/* Non-blocking UDP socket: AF_INET6 dual-stack when enabled and available,
+ * else AF_INET. family_out (may be NULL) gets the family. Returns the fd or
+ * -1 with errno set. */
+int srtla_inet_udp_socket(int* family_out);
+
+/* AF_INET / AF_INET6 of fd, or -1. */
+int srtla_inet_socket_family(int fd);
+
+/* Receiver address for the link on fd (see above). Returns the family of the
+ * chosen path (AF_INET6 for native IPv6, AF_INET for IPv4, mapped or not), or
+ * -1 if no candidate can be reached from a socket of this family. */
+int srtla_inet_pick_dst(int fd, const srtla_addr_list_t* candidates,
+                        struct sockaddr_storage* dst, socklen_t* dst_len);
+
+/* ::ffff:a.b.c.d form of an AF_INET address. */
+void srtla_inet_map_v4(const struct sockaddr_in* in, struct sockaddr_in6* out);
+
+/* Numeric address without port; v4-mapped addresses print as IPv4. */
+const char* srtla_inet_ntop(const struct sockaddr* addr, char* buf, size_t len);
+
+/* Parse a numeric IPv4 or IPv6 address ("[...]" and "%scope" accepted) and a
+ * port. Returns 0, or -1 if it is not numeric. */
+int srtla_inet_pton(const char* host, int port, struct sockaddr_storage* out, socklen_t* len);
+
+/* Paths chosen by srtla_inet_pick_dst() since load, by kind. Any may be NULL. */
+void srtla_inet_counters(uint64_t* ipv6_paths, uint64_t* ipv4_paths, uint64_t* mapped_paths);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_INET_H
@@ -0,0 +1,165 @@
+/*
+ * srtla_log.cpp - Low-overhead native logging
+ *
+ * See srtla_log.h for usage.
+ */
+
+#include "srtla_log.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+namespace {
+
+const int RING_SIZE = 256;  // power of two
+const size_t TAG_LEN = 16;
+const size_t MSG_LEN = 160;
+const size_t LINE_LEN = 512;
+
+// Per-slot seqlock: seq is odd while a writer owns the slot and 2 * index + 2
+// once entry `index` is complete, so readers can tell torn or stale slots
+struct RingEntry {
+    std::atomic<uint64_t> seq;
+    int64_t time_ms;
+    int32_t level;
+    char tag[TAG_LEN];
+    char msg[MSG_LEN];
+};
+
+RingEntry ring[RING_SIZE];
+std::atomic<uint64_t> ring_head(0);
+std::atomic<int> logcat_level(ANDROID_LOG_INFO);
+
+int64_t monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int64_t realtime_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void ring_push(int level, const char* tag, const char* msg) {
+    uint64_t index = ring_head.fetch_add(1, std::memory_order_relaxed);
+    RingEntry& e = ring[index & (RING_SIZE - 1)];
+
+    e.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.time_ms = realtime_ms();
+    e.level = level;
+    strncpy(e.tag, tag, TAG_LEN - 1);
+    e.tag[TAG_LEN - 1] = '\0';
+    strncpy(e.msg, msg, MSG_LEN - 1);
+    e.msg[MSG_LEN - 1] = '\0';
+
+    e.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+void emit(int level, const char* tag, const char* line) {
+    if (level >= logcat_level.load(std::memory_order_relaxed)) {
+        __android_log_write(level, tag, line);
+    }
+    ring_push(level, tag, line);
+}
+
+char level_char(int level) {
+    switch (level) {
+        case ANDROID_LOG_VERBOSE: return 'V';
+        case ANDROID_LOG_DEBUG: return 'D';
+        case ANDROID_LOG_INFO: return 'I';
+        case ANDROID_LOG_WARN: return 'W';
+        case ANDROID_LOG_ERROR: return 'E';
+        case ANDROID_LOG_FATAL: return 'F';
+        default: return '?';
+    }
+}
+
+}  // namespace
+
+extern "C" void srtla_log_write(int level, const char* tag, const char* fmt, ...) {
+    char line[LINE_LEN];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    emit(level, tag, line);
+}
+
+extern "C" void srtla_log_write_limited(srtla_log_site_t* site, int interval_ms, int level,
+                                        const char* tag, const char* fmt, ...) {
+    // Decide before formatting so suppressed calls cost two atomics
+    int64_t now = monotonic_ms();
+    int64_t next = __atomic_load_n(&site->next_ms, __ATOMIC_RELAXED);
+    if (now < next ||
+        !__atomic_compare_exchange_n(&site->next_ms, &next, now + interval_ms, false,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&site->suppressed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    int suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+
+    char line[LINE_LEN];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (suppressed > 0 && len >= 0 && (size_t)len < sizeof(line)) {
+        snprintf(line + len, sizeof(line) - len, " (%d similar suppressed)", suppressed);
+    }
+    emit(level, tag, line);
+}
+
+extern "C" void srtla_log_set_level(int level) {
+    logcat_level.store(level, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_log_get_level(void) {
+    return logcat_level.load(std::memory_order_relaxed);
+}
+
+extern "C" size_t srtla_log_dump(char* out, size_t out_size) {
+    if (out_size == 0) return 0;
+    out[0] = '\0';
+
+    uint64_t head = ring_head.load(std::memory_order_acquire);
+    uint64_t first = head > (uint64_t)RING_SIZE ? head - RING_SIZE : 0;
+    size_t used = 0;
+
+    for (uint64_t index = first; index < head; index++) {
+        const RingEntry& e = ring[index & (RING_SIZE - 1)];
+        uint64_t seq = e.seq.load(std::memory_order_acquire);
+        if (seq != 2 * index + 2) continue;  // in progress or already overwritten
+
+        int64_t time_ms = e.time_ms;
+        int level = e.level;
+        char tag[TAG_LEN];
+        char msg[MSG_LEN];
+        memcpy(tag, e.tag, sizeof(tag));
+        memcpy(msg, e.msg, sizeof(msg));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != seq) continue;
+        tag[TAG_LEN - 1] = '\0';
+        msg[MSG_LEN - 1] = '\0';
+
+        time_t secs = (time_t)(time_ms / 1000);
+        struct tm tm;
+        localtime_r(&secs, &tm);
+        int len = snprintf(out + used, out_size - used, "%02d-%02d %02d:%02d:%02d.%03d %c %s: %s\n",
+                           tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                           (int)(time_ms % 1000), level_char(level), tag, msg);
+        if (len < 0 || (size_t)len >= out_size - used) {
+            out[used] = '\0';
+            break;
+        }
+        used += len;
+    }
+    return used;
+}
@@ -0,0 +1,102 @@
+/*
+ * srtla_log.h - Low-overhead native logging
+ *
+ * Replaces direct __android_log_print() calls:
+ *
+ *   - Compile-time level: sites below SRTLA_LOG_MIN_LEVEL compile to nothing,
+ *     arguments included. Defaults to DEBUG, or INFO when NDEBUG is set
+ *     (release builds); pass -DSRTLA_LOG_MIN_LEVEL=ANDROID_LOG_VERBOSE to
+ *     enable per-poll tracing.
+ *   - Runtime logcat level: messages below srtla_log_set_level() (default
+ *     INFO) never reach logd, but are still kept in the ring.
+ *   - Per-site rate limiting: SRTLA_LOG_EVERY(ms, ...) emits at most once per
+ *     interval and reports how many messages it suppressed.
+ *   - Ring: every emitted message is also written to a fixed lock-free ring of
+ *     recent events, dumped on demand (srtla_log_dump, JNI dumpNativeLog).
+ *
+ * Usable from C (the srtla fork) and C++; all functions are thread-safe.
+ */
+
+#ifndef SRTLA_LOG_H
+#define SRTLA_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef SRTLA_HOST_BENCH
+/* Host bench builds: the logcat levels, and a __android_log_write() the bench
+ * provides */
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6,
+    ANDROID_LOG_FATAL = 7,
+};
+#ifdef __cplusplus
+extern "C"
+#endif
+int __android_log_write(int prio, const char* tag, const char* text);
+#else
+#include <android/log.h>
+#endif
+
+#ifndef SRTLA_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SRTLA_LOG_MIN_LEVEL ANDROID_LOG_INFO
+#else
+#define SRTLA_LOG_MIN_LEVEL ANDROID_LOG_DEBUG
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-call-site rate limiter state; zero-initialised static storage. */
+typedef struct {
+    int64_t next_ms;
+    int32_t suppressed;
+} srtla_log_site_t;
+
+void srtla_log_write(int level, const char* tag, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void srtla_log_write_limited(srtla_log_site_t* site, int interval_ms, int level,
+                             const char* tag, const char* fmt, ...)
+    __attribute__((format(printf, 5, 6)));
+
+/* Minimum level forwarded to logcat (ANDROID_LOG_*). */
+void srtla_log_set_level(int level);
+int srtla_log_get_level(void);
+
+/* Write recent ring entries, oldest first, one per line, NUL-terminated.
+ * Returns the number of bytes written (excluding the NUL). */
+size_t srtla_log_dump(char* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define SRTLA_LOG(level, tag, ...)                                  \
+    do {                                                            \
+        if ((level) >= SRTLA_LOG_MIN_LEVEL)                         \
+            srtla_log_write((level), (tag), __VA_ARGS__);           \
+    } while (0)
+
+#define SRTLA_LOG_EVERY(interval_ms, level, tag, ...)                               \
+    do {                                                                            \
+        if ((level) >= SRTLA_LOG_MIN_LEVEL) {                                       \
+            static srtla_log_site_t srtla_log_site_;                                \
+            srtla_log_write_limited(&srtla_log_site_, (interval_ms), (level), (tag), \
+                                    __VA_ARGS__);                                   \
+        }                                                                           \
+    } while (0)
+
+#define SRTLA_LOGE(tag, ...) SRTLA_LOG(ANDROID_LOG_ERROR, tag, __VA_ARGS__)
+#define SRTLA_LOGW(tag, ...) SRTLA_LOG(ANDROID_LOG_WARN, tag, __VA_ARGS__)
+#define SRTLA_LOGI(tag, ...) SRTLA_LOG(ANDROID_LOG_INFO, tag, __VA_ARGS__)
+#define SRTLA_LOGD(tag, ...) SRTLA_LOG(ANDROID_LOG_DEBUG, tag, __VA_ARGS__)
+#define SRTLA_LOGV(tag, ...) SRTLA_LOG(ANDROID_LOG_VERBOSE, tag, __VA_ARGS__)
+
+#endif  // SRTLA_LOG_H
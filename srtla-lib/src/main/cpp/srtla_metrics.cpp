@@ -0,0 +1,281 @@
+/*
+ * srtla_metrics.cpp - Per-link histograms and loss counters
+ *
+ * See srtla_metrics.h for usage and the export layout.
+ */
+
+#include "srtla_metrics.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int SUB_COUNT = 1 << SRTLA_METRICS_SUB_BITS;
+const size_t HEADER_SIZE = 16;
+const size_t HIST_HEADER_SIZE = 16;
+const size_t PAIR_SIZE = 8;
+// A link that keeps every pick still shows up: long runs are cut here
+const uint32_t MAX_RUN = 1024;
+
+// Single writer: load + store instead of a locked read-modify-write
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void bump(std::atomic<uint32_t>& v) {
+    v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+struct Histogram {
+    std::atomic<uint32_t> counts[SRTLA_METRICS_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint32_t> max;
+
+    void clear() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint32_t value) {
+        bump(counts[srtla_metrics_bucket(value)]);
+        bump(total, 1);
+        if (value > max.load(std::memory_order_relaxed)) {
+            max.store(value, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct Link {
+    Histogram hist[SRTLA_METRICS_HIST_COUNT];
+    std::atomic<uint64_t> counters[SRTLA_METRICS_COUNTER_COUNT];
+    char label[SRTLA_METRICS_LABEL_LEN];
+    bool used;
+    uint64_t last_ack_us;  // writer only
+
+    void clear() {
+        for (auto& h : hist) h.clear();
+        for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+        label[0] = '\0';
+        last_ack_us = 0;
+    }
+};
+
+// Indexed by conn id. Links are only freed by srtla_metrics_reset() (sender
+// stopped), so the writer can index without the lock; the lock covers growth
+// against concurrent exports.
+std::vector<Link*> links;
+std::mutex links_mutex;
+
+// Run length of consecutive picks of the same link (writer only)
+int last_pick = -1;
+uint32_t pick_run = 0;
+
+Link* link_for(int conn_id) {
+    if (conn_id < 0) return nullptr;
+    if ((size_t)conn_id >= links.size() || links[conn_id] == nullptr) {
+        std::lock_guard<std::mutex> lock(links_mutex);
+        if ((size_t)conn_id >= links.size()) {
+            links.resize(conn_id + 1, nullptr);
+        }
+        if (links[conn_id] == nullptr) {
+            Link* l = new Link();
+            l->clear();
+            l->used = false;
+            links[conn_id] = l;
+        }
+    }
+    Link* l = links[conn_id];
+    if (!l->used) {
+        std::lock_guard<std::mutex> lock(links_mutex);
+        l->used = true;
+    }
+    return l;
+}
+
+// Export size of a link; stores each histogram's non-zero bucket count in
+// nonzero[] so the write pass emits exactly that many pairs
+size_t link_export_size(const Link* l, uint32_t* nonzero) {
+    size_t n = sizeof(int32_t) + SRTLA_METRICS_LABEL_LEN +
+               sizeof(uint64_t) * SRTLA_METRICS_COUNTER_COUNT;
+    for (int i = 0; i < SRTLA_METRICS_HIST_COUNT; i++) {
+        nonzero[i] = 0;
+        for (const auto& c : l->hist[i].counts) {
+            if (c.load(std::memory_order_relaxed) != 0) nonzero[i]++;
+        }
+        n += HIST_HEADER_SIZE + nonzero[i] * PAIR_SIZE;
+    }
+    return n;
+}
+
+template <typename T>
+uint8_t* put(uint8_t* p, T value) {
+    memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+}  // namespace
+
+extern "C" int srtla_metrics_bucket(uint32_t value) {
+    if (value < (uint32_t)(2 * SUB_COUNT)) {
+        return (int)value;
+    }
+    int shift = 31 - __builtin_clz(value) - SRTLA_METRICS_SUB_BITS;
+    return shift * SUB_COUNT + (int)(value >> shift);
+}
+
+extern "C" uint32_t srtla_metrics_bucket_floor(int bucket) {
+    if (bucket < 2 * SUB_COUNT) {
+        return (uint32_t)bucket;
+    }
+    int shift = bucket / SUB_COUNT - 1;
+    return (uint32_t)(bucket - shift * SUB_COUNT) << shift;
+}
+
+extern "C" void srtla_metrics_reset(void) {
+    std::lock_guard<std::mutex> lock(links_mutex);
+    for (Link* l : links) delete l;
+    links.clear();
+    last_pick = -1;
+    pick_run = 0;
+}
+
+extern "C" void srtla_metrics_reset_link(int conn_id) {
+    if (conn_id < 0 || (size_t)conn_id >= links.size() || links[conn_id] == nullptr) return;
+    std::lock_guard<std::mutex> lock(links_mutex);
+    links[conn_id]->clear();
+    links[conn_id]->used = false;
+    if (last_pick == conn_id) {
+        last_pick = -1;
+        pick_run = 0;
+    }
+}
+
+extern "C" void srtla_metrics_set_label(int conn_id, const char* label) {
+    Link* l = link_for(conn_id);
+    if (l == nullptr) return;
+    std::lock_guard<std::mutex> lock(links_mutex);
+    strncpy(l->label, label ? label : "", SRTLA_METRICS_LABEL_LEN - 1);
+    l->label[SRTLA_METRICS_LABEL_LEN - 1] = '\0';
+}
+
+extern "C" void srtla_metrics_rtt(int conn_id, uint32_t rtt_us) {
+    Link* l = link_for(conn_id);
+    if (l) l->hist[SRTLA_HIST_RTT_US].record(rtt_us);
+}
+
+extern "C" void srtla_metrics_ack(int conn_id, uint64_t now_us) {
+    Link* l = link_for(conn_id);
+    if (l == nullptr) return;
+    bump(l->counters[SRTLA_METRIC_ACKS], 1);
+    if (l->last_ack_us != 0 && now_us > l->last_ack_us) {
+        uint64_t gap = now_us - l->last_ack_us;
+        l->hist[SRTLA_HIST_ACK_INTERVAL_US].record(gap > UINT32_MAX ? UINT32_MAX : (uint32_t)gap);
+    }
+    l->last_ack_us = now_us;
+}
+
+extern "C" void srtla_metrics_picked(int conn_id) {
+    if (conn_id == last_pick && pick_run < MAX_RUN) {
+        pick_run++;
+        return;
+    }
+    if (last_pick >= 0 && pick_run > 0) {
+        Link* prev = link_for(last_pick);
+        if (prev) prev->hist[SRTLA_HIST_PKTS_PER_DECISION].record(pick_run);
+    }
+    last_pick = conn_id;
+    pick_run = conn_id >= 0 ? 1 : 0;
+}
+
+extern "C" void srtla_metrics_sent(int conn_id, uint32_t bytes) {
+    Link* l = link_for(conn_id);
+    if (l == nullptr) return;
+    bump(l->counters[SRTLA_METRIC_PKTS_SENT], 1);
+    bump(l->counters[SRTLA_METRIC_BYTES_SENT], bytes);
+}
+
+extern "C" void srtla_metrics_nak(int conn_id, uint32_t lost_packets) {
+    Link* l = link_for(conn_id);
+    if (l == nullptr) return;
+    bump(l->counters[SRTLA_METRIC_NAKS], 1);
+    bump(l->counters[SRTLA_METRIC_PKTS_LOST], lost_packets);
+}
+
+extern "C" uint32_t srtla_metrics_quantile(int conn_id, int hist, double q) {
+    if (hist < 0 || hist >= SRTLA_METRICS_HIST_COUNT) return 0;
+    std::lock_guard<std::mutex> lock(links_mutex);
+    if (conn_id < 0 || (size_t)conn_id >= links.size() || links[conn_id] == nullptr) return 0;
+    const Histogram& h = links[conn_id]->hist[hist];
+    uint64_t total = h.total.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < SRTLA_METRICS_BUCKETS; b++) {
+        seen += h.counts[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return srtla_metrics_bucket_floor(b);
+    }
+    return h.max.load(std::memory_order_relaxed);
+}
+
+extern "C" long srtla_metrics_export(uint8_t* out, size_t capacity) {
+    std::lock_guard<std::mutex> lock(links_mutex);
+
+    // Counts may grow between sizing and writing; a bucket that turns non-zero
+    // after sizing is left out of this export rather than overflowing it
+    std::vector<uint32_t> nonzero(links.size() * SRTLA_METRICS_HIST_COUNT);
+    size_t total = HEADER_SIZE;
+    uint32_t link_count = 0;
+    for (size_t id = 0; id < links.size(); id++) {
+        const Link* l = links[id];
+        if (l == nullptr || !l->used) continue;
+        total += link_export_size(l, &nonzero[id * SRTLA_METRICS_HIST_COUNT]);
+        link_count++;
+    }
+    if (capacity < total) {
+        return -(long)total;
+    }
+
+    uint8_t* p = out + HEADER_SIZE;
+    for (size_t id = 0; id < links.size(); id++) {
+        const Link* l = links[id];
+        if (l == nullptr || !l->used) continue;
+        p = put<int32_t>(p, (int32_t)id);
+        memcpy(p, l->label, SRTLA_METRICS_LABEL_LEN);
+        p += SRTLA_METRICS_LABEL_LEN;
+        for (const auto& c : l->counters) {
+            p = put<uint64_t>(p, c.load(std::memory_order_relaxed));
+        }
+        for (int i = 0; i < SRTLA_METRICS_HIST_COUNT; i++) {
+            const Histogram& h = l->hist[i];
+            uint32_t budget = nonzero[id * SRTLA_METRICS_HIST_COUNT + i];
+            p = put<uint64_t>(p, h.total.load(std::memory_order_relaxed));
+            p = put<uint32_t>(p, h.max.load(std::memory_order_relaxed));
+            p = put<uint32_t>(p, budget);
+            uint32_t pairs = 0;
+            for (int b = 0; b < SRTLA_METRICS_BUCKETS && pairs < budget; b++) {
+                uint32_t count = h.counts[b].load(std::memory_order_relaxed);
+                if (count == 0) continue;
+                p = put<uint16_t>(p, (uint16_t)b);
+                p = put<uint16_t>(p, 0);
+                p = put<uint32_t>(p, count);
+                pairs++;
+            }
+            // Counts never shrink while exporting (reset_link takes the lock),
+            // so pairs == budget here
+        }
+    }
+
+    uint32_t written = (uint32_t)(p - out);
+    uint8_t* h = out;
+    h = put<uint32_t>(h, SRTLA_METRICS_MAGIC);
+    h = put<uint16_t>(h, SRTLA_METRICS_VERSION);
+    h = put<uint8_t>(h, SRTLA_METRICS_SUB_BITS);
+    h = put<uint8_t>(h, SRTLA_METRICS_HIST_COUNT);
+    h = put<uint32_t>(h, link_count);
+    put<uint32_t>(h, written);
+    return (long)written;
+}
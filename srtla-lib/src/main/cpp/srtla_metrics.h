@@ -0,0 +1,113 @@
+/*
+ * srtla_metrics.h - Per-link histograms and loss counters
+ *
+ * The stats snapshot only carries instantaneous values. That cannot tell a
+ * lossy link from a slow one. This module keeps, per connection:
+ *
+ *   - RTT (us), from SRTLA ACK / keepalive timestamps
+ *   - ACK inter-arrival time (us)
+ *   - packets per scheduling decision (run length on one link before the
+ *     scheduler picked another, cut at 1024 so a monopolising link is seen)
+ *   - counters: packets/bytes sent, SRTLA ACKs, NAKs, packets reported lost
+ *
+ * Histograms are log-linear (HDR style): values below 2^(SUB_BITS + 1) get
+ * their own bucket, above that every power of two is split into
+ * 2^SUB_BITS buckets. With SUB_BITS = 4 that is 464 buckets covering the
+ * full uint32 range at <= 6.25% relative error. Updates are a clz, a shift
+ * and one store: there is no allocation and no locking on the hot path.
+ *
+ * Writers are the send loop thread only (one writer per counter, so plain
+ * relaxed stores suffice); srtla_metrics_export() may run on any thread and
+ * sees each counter atomically, but not the set as one instant.
+ *
+ * Export layout (srtla_metrics_export(); native-endian, bump
+ * SRTLA_METRICS_VERSION on change):
+ *
+ *   Header (16 bytes)
+ *     0  u32  magic        SRTLA_METRICS_MAGIC
+ *     4  u16  version      SRTLA_METRICS_VERSION
+ *     6  u8   sub_bits     SRTLA_METRICS_SUB_BITS
+ *     7  u8   hist_count   SRTLA_METRICS_HIST_COUNT
+ *     8  u32  link_count
+ *    12  u32  total_size   bytes written, header included
+ *
+ *   Per link
+ *     i32  conn_id
+ *     char label[SRTLA_METRICS_LABEL_LEN]   NUL-terminated (IP)
+ *     u64  counters[SRTLA_METRICS_COUNTER_COUNT]   SRTLA_METRIC_*
+ *     per histogram (SRTLA_HIST_* order):
+ *       u64  total       samples recorded
+ *       u32  max         largest sample
+ *       u32  nonzero     number of (bucket, count) pairs that follow
+ *       { u16 bucket, u16 pad, u32 count } x nonzero
+ *
+ * Fork call sites (srtla_send.c):
+ *   - new conn: srtla_metrics_set_label(id, ip); removed: srtla_metrics_reset_link(id)
+ *   - every srtla_seq_ring_resolve() with an RTT sample: srtla_metrics_rtt()
+ *   - SRTLA ACK received: srtla_metrics_ack(id, now_us)
+ *   - srtla_sched_pick() result: srtla_metrics_picked(id), then
+ *     srtla_metrics_sent(id, bytes) once sent
+ *   - NAK: srtla_metrics_nak(id, lost_packets)
+ *
+ * Built into the bench only; the export goes back to Java once the fork
+ * records samples.
+ */
+
+#ifndef SRTLA_METRICS_H
+#define SRTLA_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SRTLA_METRICS_MAGIC    0x48495354  /* "HIST" */
+#define SRTLA_METRICS_VERSION  1
+#define SRTLA_METRICS_SUB_BITS 4
+#define SRTLA_METRICS_BUCKETS  ((33 - SRTLA_METRICS_SUB_BITS) << SRTLA_METRICS_SUB_BITS)
+#define SRTLA_METRICS_LABEL_LEN 64
+
+/* Histograms */
+#define SRTLA_HIST_RTT_US            0
+#define SRTLA_HIST_ACK_INTERVAL_US   1
+#define SRTLA_HIST_PKTS_PER_DECISION 2
+#define SRTLA_METRICS_HIST_COUNT     3
+
+/* Counters */
+#define SRTLA_METRIC_PKTS_SENT       0
+#define SRTLA_METRIC_BYTES_SENT      1
+#define SRTLA_METRIC_ACKS            2
+#define SRTLA_METRIC_NAKS            3
+#define SRTLA_METRIC_PKTS_LOST       4
+#define SRTLA_METRICS_COUNTER_COUNT  5
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bucket index for a value, and the smallest value that maps to a bucket. */
+int srtla_metrics_bucket(uint32_t value);
+uint32_t srtla_metrics_bucket_floor(int bucket);
+
+/* Drop every link (new session). */
+void srtla_metrics_reset(void);
+void srtla_metrics_reset_link(int conn_id);
+void srtla_metrics_set_label(int conn_id, const char* label);
+
+void srtla_metrics_rtt(int conn_id, uint32_t rtt_us);
+void srtla_metrics_ack(int conn_id, uint64_t now_us);
+void srtla_metrics_picked(int conn_id);
+void srtla_metrics_sent(int conn_id, uint32_t bytes);
+void srtla_metrics_nak(int conn_id, uint32_t lost_packets);
+
+/* Value at quantile q (0..1) of a link's histogram (bucket floor), or 0 if it
+ * has no samples. For local reporting; Java computes its own from the export. */
+uint32_t srtla_metrics_quantile(int conn_id, int hist, double q);
+
+/* Write the export layout into out. Returns bytes written, or -(required
+ * size) if capacity is too small. */
+long srtla_metrics_export(uint8_t* out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_METRICS_H
@@ -0,0 +1,243 @@
+/*
+ * srtla_pool.cpp - Fixed arena of pre-allocated blocks for the packet path
+ *
+ * See srtla_pool.h for usage.
+ */
+
+#include "srtla_pool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace {
+
+// Blocks are aligned to a cache line so packet buffers never share one
+const size_t BLOCK_ALIGN = 64;
+const uint64_t INDEX_MASK = 0xffffffffull;
+
+struct ClassPool {
+    uint8_t* base = nullptr;
+    size_t block_size = 0;
+    uint32_t block_count = 0;
+    uint32_t* next = nullptr;  // free-list link per block: index + 1, 0 = end
+
+    // Treiber stack head: (tag << 32) | (index + 1); the tag defeats ABA
+    std::atomic<uint64_t> head{0};
+
+    std::atomic<uint64_t> in_use{0};
+    std::atomic<uint64_t> high_water{0};
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> heap_fallbacks{0};
+
+    bool owns(const void* ptr) const {
+        const uint8_t* p = static_cast<const uint8_t*>(ptr);
+        return base != nullptr && p >= base && p < base + block_size * block_count;
+    }
+
+    void* pop() {
+        uint64_t h = head.load(std::memory_order_acquire);
+        while ((h & INDEX_MASK) != 0) {
+            uint32_t index = (uint32_t)(h & INDEX_MASK) - 1;
+            uint64_t next_head = ((h >> 32) + 1) << 32 | next[index];
+            if (head.compare_exchange_weak(h, next_head, std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+                return base + (size_t)index * block_size;
+            }
+        }
+        return nullptr;
+    }
+
+    void push(void* ptr) {
+        uint32_t index = (uint32_t)((static_cast<uint8_t*>(ptr) - base) / block_size);
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t new_head;
+        do {
+            next[index] = (uint32_t)(h & INDEX_MASK);
+            new_head = ((h >> 32) + 1) << 32 | (index + 1);
+        } while (!head.compare_exchange_weak(h, new_head, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+
+    void note_alloc() {
+        allocs.fetch_add(1, std::memory_order_relaxed);
+        uint64_t used = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t peak = high_water.load(std::memory_order_relaxed);
+        while (used > peak &&
+               !high_water.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+// In front of a shared buffer's data
+struct SharedHeader {
+    std::atomic<uint32_t> refs;
+};
+
+static_assert(sizeof(SharedHeader) <= SRTLA_POOL_SHARED_HEADER, "shared header too large");
+static_assert(SRTLA_POOL_SHARED_HEADER % 16 == 0, "shared data alignment");
+
+SharedHeader* shared_header(const uint8_t* data) {
+    return reinterpret_cast<SharedHeader*>(const_cast<uint8_t*>(data) - SRTLA_POOL_SHARED_HEADER);
+}
+
+ClassPool pools[SRTLA_POOL_CLASS_COUNT];
+std::atomic<uint64_t> total_heap_fallbacks(0);
+void* arena = nullptr;
+std::mutex arena_mutex;
+
+size_t align_up(size_t n) {
+    return (n + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+}
+
+bool valid_class(int cls) {
+    return cls >= 0 && cls < SRTLA_POOL_CLASS_COUNT;
+}
+
+}  // namespace
+
+extern "C" void srtla_pool_default_config(srtla_pool_config_t* config) {
+    config->block_size[SRTLA_POOL_PACKET] = 1536;
+    config->block_count[SRTLA_POOL_PACKET] = 1024;
+}
+
+extern "C" int srtla_pool_init(const srtla_pool_config_t* config) {
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    if (arena != nullptr) {
+        return 0;
+    }
+
+    size_t total = 0;
+    for (int c = 0; c < SRTLA_POOL_CLASS_COUNT; c++) {
+        total += align_up(config->block_size[c]) * config->block_count[c];
+        total += align_up(sizeof(uint32_t) * config->block_count[c]);
+    }
+    void* mem = nullptr;
+    if (posix_memalign(&mem, BLOCK_ALIGN, total) != 0) {
+        return -1;
+    }
+    // Touch every page now so the packet path never takes a first-use fault
+    memset(mem, 0, total);
+
+    uint8_t* cursor = static_cast<uint8_t*>(mem);
+    for (int c = 0; c < SRTLA_POOL_CLASS_COUNT; c++) {
+        ClassPool& pool = pools[c];
+        pool.block_size = align_up(config->block_size[c]);
+        pool.block_count = config->block_count[c];
+        pool.base = cursor;
+        cursor += pool.block_size * pool.block_count;
+        pool.next = reinterpret_cast<uint32_t*>(cursor);
+        cursor += align_up(sizeof(uint32_t) * pool.block_count);
+
+        for (uint32_t i = 0; i < pool.block_count; i++) {
+            pool.next[i] = i + 1 < pool.block_count ? i + 2 : 0;
+        }
+        pool.head.store(pool.block_count > 0 ? 1 : 0, std::memory_order_release);
+        pool.in_use.store(0, std::memory_order_relaxed);
+        pool.high_water.store(0, std::memory_order_relaxed);
+    }
+    arena = mem;
+    return 0;
+}
+
+extern "C" void srtla_pool_destroy(void) {
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    if (arena == nullptr) return;
+    for (int c = 0; c < SRTLA_POOL_CLASS_COUNT; c++) {
+        if (pools[c].in_use.load(std::memory_order_acquire) != 0) {
+            return;  // blocks still referenced; keep the arena for the next init
+        }
+    }
+    for (int c = 0; c < SRTLA_POOL_CLASS_COUNT; c++) {
+        pools[c].head.store(0, std::memory_order_relaxed);
+        pools[c].base = nullptr;
+        pools[c].next = nullptr;
+        pools[c].block_count = 0;
+    }
+    free(arena);
+    arena = nullptr;
+}
+
+extern "C" void* srtla_pool_alloc(int cls, size_t size) {
+    if (!valid_class(cls)) {
+        total_heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return malloc(size);
+    }
+    ClassPool& pool = pools[cls];
+    if (size <= pool.block_size) {
+        void* block = pool.pop();
+        if (block != nullptr) {
+            pool.note_alloc();
+            return block;
+        }
+    }
+    pool.heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    total_heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size);
+}
+
+extern "C" void* srtla_pool_zalloc(int cls, size_t size) {
+    void* ptr = srtla_pool_alloc(cls, size);
+    if (ptr != nullptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+extern "C" void srtla_pool_free(int cls, void* ptr) {
+    if (ptr == nullptr) return;
+    // The owning pool is found by address, so a wrong class hint is harmless
+    for (int c = 0; c < SRTLA_POOL_CLASS_COUNT; c++) {
+        if (pools[c].owns(ptr)) {
+            pools[c].in_use.fetch_sub(1, std::memory_order_relaxed);
+            pools[c].push(ptr);
+            return;
+        }
+    }
+    (void)cls;
+    free(ptr);
+}
+
+extern "C" uint8_t* srtla_pool_shared_alloc(size_t size) {
+    void* block = srtla_pool_alloc(SRTLA_POOL_PACKET, size + SRTLA_POOL_SHARED_HEADER);
+    if (block == nullptr) return nullptr;
+    SharedHeader* h = new (block) SharedHeader;
+    h->refs.store(1, std::memory_order_relaxed);
+    return static_cast<uint8_t*>(block) + SRTLA_POOL_SHARED_HEADER;
+}
+
+extern "C" void srtla_pool_shared_ref(uint8_t* data) {
+    if (data == nullptr) return;
+    shared_header(data)->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" void srtla_pool_shared_unref(uint8_t* data) {
+    if (data == nullptr) return;
+    SharedHeader* h = shared_header(data);
+    // Release our writes to the buffer; the last holder sees everyone's
+    if (h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        h->~SharedHeader();
+        srtla_pool_free(SRTLA_POOL_PACKET, h);
+    }
+}
+
+extern "C" uint32_t srtla_pool_shared_refs(const uint8_t* data) {
+    return data != nullptr ? shared_header(data)->refs.load(std::memory_order_relaxed) : 0;
+}
+
+extern "C" void srtla_pool_stats(int cls, srtla_pool_class_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!valid_class(cls)) return;
+    const ClassPool& pool = pools[cls];
+    out->capacity = pool.block_count;
+    out->in_use = pool.in_use.load(std::memory_order_relaxed);
+    out->high_water = pool.high_water.load(std::memory_order_relaxed);
+    out->allocs = pool.allocs.load(std::memory_order_relaxed);
+    out->heap_fallbacks = pool.heap_fallbacks.load(std::memory_order_relaxed);
+}
+
+extern "C" uint64_t srtla_pool_heap_fallbacks(void) {
+    return total_heap_fallbacks.load(std::memory_order_relaxed);
+}
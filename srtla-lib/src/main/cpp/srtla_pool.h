@@ -0,0 +1,90 @@
+/*
+ * srtla_pool.h - Fixed arena of pre-allocated blocks for the packet path
+ *
+ * One arena is allocated (and pre-faulted) at srtla_pool_init() and split into
+ * per-class pools of fixed-size blocks:
+ *
+ *   SRTLA_POOL_PACKET - packet buffers (send queues, shared fan-out buffers)
+ *
+ * Connection records are the fork's, allocated only on (re)registration; a
+ * class for them belongs with the fork change that would use it.
+ *
+ * Alloc/free are lock-free (tagged Treiber stack per class) and safe from any
+ * thread. When a class is exhausted, or a request is larger than its block
+ * size, the allocation falls back to malloc() and is counted; in steady state
+ * the heap fallback counter must stay at zero, which is what
+ * srtla_bench --assert-zero-alloc checks.
+ *
+ * Shared packet buffers (srtla_pool_shared_*) are SRTLA_POOL_PACKET blocks
+ * with a reference count in front of the data, for a packet read once and
+ * sent to several receiver groups (srtla_fanout.h): every holder takes a
+ * reference and the block goes back to the pool with the last unref. The
+ * count is atomic, so holders may be on different threads.
+ */
+
+#ifndef SRTLA_POOL_H
+#define SRTLA_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SRTLA_POOL_PACKET = 0,
+    SRTLA_POOL_CLASS_COUNT
+} srtla_pool_class_t;
+
+typedef struct {
+    size_t block_size[SRTLA_POOL_CLASS_COUNT];
+    uint32_t block_count[SRTLA_POOL_CLASS_COUNT];
+} srtla_pool_config_t;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t in_use;
+    uint64_t high_water;
+    uint64_t allocs;          /* served from the pool */
+    uint64_t heap_fallbacks;  /* served by malloc() */
+} srtla_pool_class_stats_t;
+
+/* Bytes in front of a shared buffer's data (reference count, padding). */
+#define SRTLA_POOL_SHARED_HEADER 16
+
+/* Defaults sized for a phone: 1024 x 1536 B packet blocks. */
+void srtla_pool_default_config(srtla_pool_config_t* config);
+
+/* Allocate the arena. Returns 0, or -1 if it could not be allocated (all
+ * allocations then fall back to the heap). Re-init while an arena exists is a
+ * no-op returning 0. */
+int srtla_pool_init(const srtla_pool_config_t* config);
+
+/* Release the arena if no block is in use; otherwise it is kept (and reused by
+ * the next init) so late frees stay valid. */
+void srtla_pool_destroy(void);
+
+/* Block of at least `size` bytes, or NULL if even malloc fails. alloc leaves
+ * the contents undefined (packet buffers); zalloc zero-fills (calloc users). */
+void* srtla_pool_alloc(int cls, size_t size);
+void* srtla_pool_zalloc(int cls, size_t size);
+void srtla_pool_free(int cls, void* ptr);
+
+/* Shared packet buffer of at least size bytes with one reference, or NULL.
+ * Returns the data pointer; pass it to ref/unref, never to srtla_pool_free. */
+uint8_t* srtla_pool_shared_alloc(size_t size);
+void srtla_pool_shared_ref(uint8_t* data);
+void srtla_pool_shared_unref(uint8_t* data);
+uint32_t srtla_pool_shared_refs(const uint8_t* data);
+
+void srtla_pool_stats(int cls, srtla_pool_class_stats_t* out);
+
+/* Heap fallbacks across all classes since load. */
+uint64_t srtla_pool_heap_fallbacks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_POOL_H
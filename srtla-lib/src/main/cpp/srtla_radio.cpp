@@ -0,0 +1,166 @@
+/*
+ * srtla_radio.cpp - Link quality prior from radio metrics reported by Android
+ *
+ * See srtla_radio.h for usage.
+ */
+
+#include "srtla_radio.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+// Levels mapped to score 0 and 1
+const double RSRP_BAD_DBM = -120.0, RSRP_GOOD_DBM = -95.0;
+const double SINR_BAD_DB = -5.0, SINR_GOOD_DB = 10.0;
+const double RSSI_BAD_DBM = -85.0, RSSI_GOOD_DBM = -65.0;
+const double LINK_BAD_MBPS = 6.0, LINK_GOOD_MBPS = 50.0;
+
+const double SLOPE_ALPHA = 0.3;
+// Samples closer than this only update the score, not the slope
+const int64_t MIN_SLOPE_INTERVAL_MS = 200;
+
+struct Entry {
+    int key;
+    bool used;
+    srtla_radio_sample_t sample;
+    int64_t updated_ms;
+    int64_t slope_ms;   // time of the score the slope was last taken against
+    double score;
+    double slope_score;
+    double slope_per_s;
+    bool has_slope;
+};
+
+std::mutex radio_mutex;
+Entry entries[SRTLA_RADIO_MAX_LINKS];
+std::atomic<bool> enabled(false);
+int metered_pct = 100;
+int roaming_pct = 100;
+
+double ramp(int32_t value, double bad, double good) {
+    if (value <= bad) return 0.0;
+    if (value >= good) return 1.0;
+    return ((double)value - bad) / (good - bad);
+}
+
+// Worst of the reported metrics; 1 if none applies to this network type
+double sample_score(const srtla_radio_sample_t& s) {
+    double score = 1.0;
+    auto take = [&score](int32_t value, double bad, double good) {
+        if (value == SRTLA_RADIO_UNKNOWN) return;
+        double v = ramp(value, bad, good);
+        if (v < score) score = v;
+    };
+    if (s.network_type == SRTLA_RADIO_NET_CELLULAR) {
+        take(s.rsrp_dbm, RSRP_BAD_DBM, RSRP_GOOD_DBM);
+        take(s.sinr_db, SINR_BAD_DB, SINR_GOOD_DB);
+    } else if (s.network_type == SRTLA_RADIO_NET_WIFI) {
+        take(s.rssi_dbm, RSSI_BAD_DBM, RSSI_GOOD_DBM);
+        take(s.link_mbps, LINK_BAD_MBPS, LINK_GOOD_MBPS);
+    }
+    return score;
+}
+
+Entry* find_locked(int key) {
+    for (Entry& e : entries) {
+        if (e.used && e.key == key) return &e;
+    }
+    return nullptr;
+}
+
+double estimate_locked(const Entry& e) {
+    double score = e.score;
+    if (e.has_slope) {
+        double ahead = score + e.slope_per_s * (SRTLA_RADIO_HORIZON_MS / 1000.0);
+        if (ahead < score) score = ahead;
+    }
+    if (score < 0.0) score = 0.0;
+    double q = SRTLA_RADIO_MIN_QUALITY + (1.0 - SRTLA_RADIO_MIN_QUALITY) * score;
+    if (e.sample.metered) q *= metered_pct / 100.0;
+    if (e.sample.roaming) q *= roaming_pct / 100.0;
+    return q;
+}
+
+}  // namespace
+
+extern "C" int srtla_radio_update(int key, const srtla_radio_sample_t* sample, int64_t now_ms) {
+    if (sample == nullptr) return -1;
+    std::lock_guard<std::mutex> lock(radio_mutex);
+    Entry* e = find_locked(key);
+    bool fresh = e != nullptr;
+    if (e == nullptr) {
+        for (Entry& slot : entries) {
+            if (!slot.used) {
+                e = &slot;
+                break;
+            }
+        }
+        if (e == nullptr) return -1;
+        *e = Entry{};
+        e->key = key;
+        e->used = true;
+    }
+
+    double score = sample_score(*sample);
+    fresh = fresh && now_ms - e->updated_ms <= SRTLA_RADIO_STALE_MS &&
+            e->sample.network_type == sample->network_type;
+    if (!fresh) {
+        e->has_slope = false;
+        e->slope_per_s = 0.0;
+        e->slope_ms = now_ms;
+        e->slope_score = score;
+    } else if (now_ms - e->slope_ms >= MIN_SLOPE_INTERVAL_MS) {
+        double slope = (score - e->slope_score) * 1000.0 / (double)(now_ms - e->slope_ms);
+        e->slope_per_s = e->has_slope ? e->slope_per_s + SLOPE_ALPHA * (slope - e->slope_per_s)
+                                      : slope;
+        e->has_slope = true;
+        e->slope_ms = now_ms;
+        e->slope_score = score;
+    }
+    e->sample = *sample;
+    e->score = score;
+    e->updated_ms = now_ms;
+    return 0;
+}
+
+extern "C" double srtla_radio_estimate(int key, int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(radio_mutex);
+    Entry* e = find_locked(key);
+    if (e == nullptr || now_ms - e->updated_ms > SRTLA_RADIO_STALE_MS) return -1.0;
+    return estimate_locked(*e);
+}
+
+extern "C" double srtla_radio_quality(int key, int64_t now_ms) {
+    if (!enabled.load(std::memory_order_relaxed)) return 1.0;
+    double q = srtla_radio_estimate(key, now_ms);
+    return q < 0.0 ? 1.0 : q;
+}
+
+extern "C" void srtla_radio_forget(int key) {
+    std::lock_guard<std::mutex> lock(radio_mutex);
+    Entry* e = find_locked(key);
+    if (e != nullptr) e->used = false;
+}
+
+extern "C" void srtla_radio_reset(void) {
+    std::lock_guard<std::mutex> lock(radio_mutex);
+    for (Entry& e : entries) e.used = false;
+}
+
+extern "C" void srtla_radio_set_enabled(int on) {
+    enabled.store(on != 0, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_radio_enabled(void) {
+    return enabled.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+extern "C" int srtla_radio_set_penalties(int metered, int roaming) {
+    if (metered < 1 || metered > 100 || roaming < 1 || roaming > 100) return -1;
+    std::lock_guard<std::mutex> lock(radio_mutex);
+    metered_pct = metered;
+    roaming_pct = roaming;
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * srtla_radio.h - Link quality prior from radio metrics reported by Android
+ *
+ * The sender only learns that a link is fading when packets stop being
+ * ACKed: by then a burst is lost and its window collapses. The radio knows
+ * earlier. Java pushes what ConnectivityManager / TelephonyManager report
+ * for each network (cellular RSRP and SINR, Wi-Fi RSSI and link speed,
+ * metered and roaming state), and this module turns it into a quality in
+ * [SRTLA_RADIO_MIN_QUALITY, 1] that srtla_sched_set_link_quality() applies
+ * to the link's window.
+ *
+ * Each metric maps linearly between a "bad" and a "good" level to a score in
+ * 0..1 (RSRP -120..-95 dBm, SINR -5..10 dB, RSSI -85..-65 dBm, link speed
+ * 6..50 Mbps); the link's score is the worst of the metrics it reported. The
+ * slope of the score is smoothed (EWMA) and extrapolated SRTLA_RADIO_HORIZON_MS
+ * ahead, and the lower of now and then is used, so a link whose signal is
+ * sliding loses traffic before it reaches the bad level; a recovering link
+ * is only trusted once it got there. Metered and roaming links can be
+ * weighted down on top (off by default).
+ *
+ * The signal is only a prior: the floor keeps a weak but working link in
+ * use, ACKed windows still decide, and a link with no sample younger than
+ * SRTLA_RADIO_STALE_MS gets 1. The prior as a whole is off until
+ * srtla_radio_set_enabled(1); samples are kept either way, so the quality can
+ * be shown before it is used.
+ *
+ * Links are identified by an integer key: the socket fd on the device, the
+ * link index in the bench. All calls are thread-safe (one short mutex; Java
+ * reports about once a second, the sender reads from housekeeping).
+ *
+ * Fork call sites (srtla_send.c):
+ *   - housekeeping, per conn c at index idx:
+ *         srtla_sched_set_link_quality(sched, idx, srtla_radio_quality(c->fd, now_ms));
+ *   - conn removed: srtla_radio_forget(c->fd)
+ *
+ * Built into the bench only; the Java sampler and updateRadioMetrics() come
+ * back once the fork picks links through srtla_scheduler.
+ */
+
+#ifndef SRTLA_RADIO_H
+#define SRTLA_RADIO_H
+
+#include <stdint.h>
+
+#define SRTLA_RADIO_UNKNOWN  INT32_MIN   /* metric not reported */
+
+#define SRTLA_RADIO_NET_WIFI      1      /* same ids as setNetworkSocket() */
+#define SRTLA_RADIO_NET_CELLULAR  2
+#define SRTLA_RADIO_NET_ETHERNET  3
+
+#define SRTLA_RADIO_MAX_LINKS     16
+#define SRTLA_RADIO_MIN_QUALITY   0.25
+#define SRTLA_RADIO_HORIZON_MS    2000
+#define SRTLA_RADIO_STALE_MS      10000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int network_type;   /* SRTLA_RADIO_NET_* */
+    int32_t rsrp_dbm;   /* cellular: LTE RSRP or NR SS-RSRP */
+    int32_t sinr_db;    /* cellular: LTE RSSNR or NR SS-SINR */
+    int32_t rssi_dbm;   /* Wi-Fi */
+    int32_t link_mbps;  /* Wi-Fi */
+    int metered;
+    int roaming;
+} srtla_radio_sample_t;
+
+/* Record a sample for key at now_ms (a monotonic millisecond clock, the same
+ * one passed to srtla_radio_quality: CLOCK_MONOTONIC on the device, the
+ * simulated clock in the bench). Returns 0, or -1 if the table is full. */
+int srtla_radio_update(int key, const srtla_radio_sample_t* sample, int64_t now_ms);
+
+/* Quality to give the scheduler: 1 when the prior is disabled, the key is
+ * unknown or its last sample is stale. */
+double srtla_radio_quality(int key, int64_t now_ms);
+
+/* As srtla_radio_quality() but ignoring the enable switch; -1 if there is no
+ * fresh sample. For display. */
+double srtla_radio_estimate(int key, int64_t now_ms);
+
+void srtla_radio_forget(int key);
+void srtla_radio_reset(void);
+
+void srtla_radio_set_enabled(int enabled);
+int srtla_radio_enabled(void);
+
+/* Extra factor for metered / roaming links, in percent (1..100; 100 = no
+ * penalty, the default). Returns 0, or -1 if out of range. */
+int srtla_radio_set_penalties(int metered_pct, int roaming_pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_RADIO_H
@@ -0,0 +1,224 @@
+/*
+ * srtla_reactor.cpp - epoll event loop for the native sender
+ *
+ * See srtla_reactor.h for usage.
+ */
+
+#include "srtla_reactor.h"
+#include "srtla_log.h"
+#include "srtla_thread.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::atomic<int> epoll_fd(-1);
+int timer_fd = -1;
+std::atomic<int> wakeup_fd(-1);  // read by srtla_reactor_wakeup() from other threads
+
+// Registered socket contexts, indexed by fd. Only touched by the loop thread.
+std::vector<void*> contexts;
+
+const int MAX_BATCH_EVENTS = 64;
+
+// Scheduling latency of the loop thread (srtla_thread.h): interval_ns lets a
+// timer expiry be dated, wakeup_requested_ns is when the first pending
+// srtla_reactor_wakeup() was made (0 = none pending)
+int64_t interval_ns = 0;
+std::atomic<int64_t> wakeup_requested_ns(0);
+
+// Housekeeping expiries fall on multiples of this (0 = wherever arming lands)
+int64_t align_ns = 0;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void arm_timer(int interval_ms) {
+    interval_ns = (int64_t)interval_ms * 1000000;
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    if (align_ns <= 0) {
+        spec.it_value = spec.it_interval;
+        timerfd_settime(timer_fd, 0, &spec, nullptr);
+        return;
+    }
+    // First expiry one interval out, rounded up to the alignment grid, so
+    // every period after it stays on the grid too
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t first = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec + interval_ns;
+    first = (first + align_ns - 1) / align_ns * align_ns;
+    spec.it_value.tv_sec = first / 1000000000;
+    spec.it_value.tv_nsec = (long)(first % 1000000000);
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+// Returns the last counter value read (expirations for the timerfd)
+uint64_t drain(int fd) {
+    uint64_t value;
+    uint64_t last = 0;
+    while (read(fd, &value, sizeof(value)) == sizeof(value)) {
+        last = value;
+    }
+    return last;
+}
+
+// How long ago the timer's most recent expiry was: one interval minus the
+// time left to the next, plus any whole intervals missed
+void record_timer_latency(uint64_t expirations) {
+    struct itimerspec left;
+    if (interval_ns <= 0 || timerfd_gettime(timer_fd, &left) != 0) return;
+    int64_t remaining = (int64_t)left.it_value.tv_sec * 1000000000 + left.it_value.tv_nsec;
+    int64_t late = interval_ns - remaining;
+    if (expirations > 1) late += (int64_t)(expirations - 1) * interval_ns;
+    srtla_thread_record_latency(SRTLA_THREAD_FORWARD, late);
+}
+
+}  // namespace
+
+extern "C" int srtla_reactor_init(int housekeeping_interval_ms) {
+    if (epoll_fd.load() >= 0) {
+        srtla_reactor_destroy();
+    }
+
+    int efd = epoll_create1(EPOLL_CLOEXEC);
+    if (efd < 0) {
+        SRTLA_LOGE("SRTLA-Reactor", "epoll_create1 failed: %s", strerror(errno));
+        return -1;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (timer_fd < 0 || wfd < 0) {
+        SRTLA_LOGE("SRTLA-Reactor", "timerfd/eventfd creation failed: %s", strerror(errno));
+        if (timer_fd >= 0) close(timer_fd);
+        if (wfd >= 0) close(wfd);
+        close(efd);
+        timer_fd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = timer_fd;
+    epoll_ctl(efd, EPOLL_CTL_ADD, timer_fd, &ev);
+    ev.data.fd = wfd;
+    epoll_ctl(efd, EPOLL_CTL_ADD, wfd, &ev);
+
+    // A session starts at the active cadence (srtla_idle.h)
+    srtla_reactor_set_slack(0);
+    arm_timer(housekeeping_interval_ms);
+    wakeup_fd.store(wfd);
+    epoll_fd.store(efd);
+    return 0;
+}
+
+extern "C" void srtla_reactor_destroy(void) {
+    int efd = epoll_fd.exchange(-1);
+    if (efd >= 0) close(efd);
+    int wfd = wakeup_fd.exchange(-1);
+    if (wfd >= 0) close(wfd);
+    if (timer_fd >= 0) close(timer_fd);
+    timer_fd = -1;
+    contexts.clear();
+}
+
+extern "C" int srtla_reactor_add(int fd, void* ctx) {
+    int efd = epoll_fd.load();
+    if (efd < 0 || fd < 0) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = fd;
+    if (epoll_ctl(efd, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+        !(errno == EEXIST && epoll_ctl(efd, EPOLL_CTL_MOD, fd, &ev) == 0)) {
+        return -1;
+    }
+
+    if ((size_t)fd >= contexts.size()) {
+        contexts.resize(fd + 1, nullptr);
+    }
+    contexts[fd] = ctx;
+    return 0;
+}
+
+extern "C" int srtla_reactor_remove(int fd) {
+    int efd = epoll_fd.load();
+    if (efd < 0 || fd < 0) return -1;
+    if ((size_t)fd < contexts.size()) {
+        contexts[fd] = nullptr;
+    }
+    return epoll_ctl(efd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+extern "C" void srtla_reactor_set_interval(int housekeeping_interval_ms) {
+    if (timer_fd >= 0) arm_timer(housekeeping_interval_ms);
+}
+
+extern "C" void srtla_reactor_set_slack(int slack_ms) {
+    align_ns = slack_ms > 0 ? (int64_t)slack_ms * 1000000 : 0;
+    // 0 resets the thread to the process default
+    prctl(PR_SET_TIMERSLACK, slack_ms > 0 ? (unsigned long)align_ns : 0UL, 0, 0, 0);
+}
+
+extern "C" int srtla_reactor_wait(srtla_reactor_event_t* events, int max_events, int timeout_ms) {
+    int efd = epoll_fd.load();
+    if (efd < 0) return -1;
+
+    struct epoll_event ready[MAX_BATCH_EVENTS];
+    int limit = max_events < MAX_BATCH_EVENTS ? max_events : MAX_BATCH_EVENTS;
+    int n = epoll_wait(efd, ready, limit, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int fd = ready[i].data.fd;
+        srtla_reactor_event_t& out = events[i];
+        out.fd = -1;
+        out.events = 0;
+        out.ctx = nullptr;
+        if (fd == timer_fd) {
+            record_timer_latency(drain(timer_fd));
+            out.type = SRTLA_EV_HOUSEKEEPING;
+        } else if (fd == wakeup_fd.load(std::memory_order_relaxed)) {
+            drain(fd);
+            int64_t requested = wakeup_requested_ns.exchange(0);
+            if (requested > 0) {
+                srtla_thread_record_latency(SRTLA_THREAD_FORWARD, now_ns() - requested);
+            }
+            out.type = SRTLA_EV_WAKEUP;
+        } else {
+            out.type = SRTLA_EV_SOCKET;
+            out.fd = fd;
+            out.events = ready[i].events;
+            out.ctx = (size_t)fd < contexts.size() ? contexts[fd] : nullptr;
+        }
+    }
+    return n;
+}
+
+extern "C" void srtla_reactor_wakeup(void) {
+    int wfd = wakeup_fd.load();
+    if (wfd < 0) return;
+    int64_t none = 0;
+    wakeup_requested_ns.compare_exchange_strong(none, now_ns());
+    uint64_t one = 1;
+    ssize_t r = write(wfd, &one, sizeof(one));
+    (void)r;
+}
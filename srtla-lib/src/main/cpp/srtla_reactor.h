@@ -0,0 +1,79 @@
+/*
+ * srtla_reactor.h - epoll event loop for the native sender
+ *
+ * Replaces the per-wakeup fd_set rebuild and linear scan with an
+ * edge-triggered epoll set, so a wakeup only costs the fds that are actually
+ * ready no matter how many links (local interfaces + Moblink relays) are
+ * bonded. Housekeeping runs off a timerfd instead of select() timeouts, and
+ * an eventfd lets other threads (notifyNetworkChange, stop) wake the loop
+ * immediately. How late each timer expiry and each wakeup is picked up is
+ * recorded as the forwarding thread's scheduling latency (srtla_thread.h).
+ *
+ * Sockets are added/removed incrementally as update_conns() creates or drops
+ * connections; nothing is rebuilt per iteration. init/add/remove/wait belong
+ * to the loop thread; only srtla_reactor_wakeup() may be called elsewhere.
+ * Because readiness is edge-triggered, the loop must read each ready socket
+ * until EAGAIN.
+ *
+ *     srtla_reactor_init(HOUSEKEEPING_INTERVAL_MS);
+ *     srtla_reactor_add(listen_fd, &listen_ctx);
+ *     while (running) {
+ *         int n = srtla_reactor_wait(events, MAX_EVENTS, -1);
+ *         for (i < n) switch (events[i].type) { ... }
+ *     }
+ *     srtla_reactor_destroy();
+ */
+
+#ifndef SRTLA_REACTOR_H
+#define SRTLA_REACTOR_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SRTLA_EV_SOCKET = 0,        /* a registered fd is readable/errored */
+    SRTLA_EV_HOUSEKEEPING = 1,  /* housekeeping timer fired */
+    SRTLA_EV_WAKEUP = 2,        /* srtla_reactor_wakeup() was called */
+} srtla_reactor_event_type_t;
+
+typedef struct {
+    srtla_reactor_event_type_t type;
+    int fd;           /* SRTLA_EV_SOCKET only */
+    uint32_t events;  /* EPOLL* mask, SRTLA_EV_SOCKET only */
+    void* ctx;        /* value passed to srtla_reactor_add() */
+} srtla_reactor_event_t;
+
+/* Create the epoll set and housekeeping timer. Returns 0 on success. */
+int srtla_reactor_init(int housekeeping_interval_ms);
+void srtla_reactor_destroy(void);
+
+/* Incremental registration from the loop thread (update_conns / housekeeping).
+ * Returns 0 on success. */
+int srtla_reactor_add(int fd, void* ctx);
+int srtla_reactor_remove(int fd);
+
+/* Change the housekeeping period; takes effect on the next expiry. */
+void srtla_reactor_set_interval(int housekeeping_interval_ms);
+
+/* Timer slack of the loop thread (PR_SET_TIMERSLACK, so its timed waits may
+ * be deferred that much and merged with other wakeups) and alignment of the
+ * housekeeping timer to a multiple of it on CLOCK_MONOTONIC; 0 restores the
+ * default slack and no alignment. Call from the loop thread, before
+ * srtla_reactor_set_interval(), which applies the alignment (srtla_idle.h). */
+void srtla_reactor_set_slack(int slack_ms);
+
+/* Block until at least one event or timeout_ms (-1 = forever).
+ * Returns the number of events written, 0 on timeout, -1 on error. */
+int srtla_reactor_wait(srtla_reactor_event_t* events, int max_events, int timeout_ms);
+
+/* Wake a thread blocked in srtla_reactor_wait(); safe from any thread. */
+void srtla_reactor_wakeup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_REACTOR_H
@@ -0,0 +1,41 @@
+/*
+ * srtla_reconnect.cpp - Retry backoff between sender restarts
+ *
+ * See srtla_reconnect.h for usage.
+ */
+
+#include "srtla_reconnect.h"
+
+#include <chrono>
+
+namespace {
+
+uint32_t xorshift(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+}  // namespace
+
+extern "C" void srtla_backoff_init(srtla_backoff_t* b, int initial_ms, int max_ms) {
+    b->initial_ms = initial_ms;
+    b->max_ms = max_ms;
+    b->current_ms = initial_ms;
+    b->rng = (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count() | 1;
+}
+
+extern "C" int srtla_backoff_next(srtla_backoff_t* b) {
+    int step = b->current_ms;
+    int jitter = step / 4;
+    int delay = step - jitter + (jitter > 0 ? (int)(xorshift(&b->rng) % (uint32_t)(2 * jitter + 1)) : 0);
+    b->current_ms = step * 2 < b->max_ms ? step * 2 : b->max_ms;
+    return delay < b->max_ms ? delay : b->max_ms;
+}
+
+extern "C" void srtla_backoff_reset(srtla_backoff_t* b) {
+    b->current_ms = b->initial_ms;
+}
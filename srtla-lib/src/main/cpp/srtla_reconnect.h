@@ -0,0 +1,46 @@
+/*
+ * srtla_reconnect.h - Retry backoff between sender restarts
+ *
+ * srtla_thread_func restarts srtla_start_android() after every receiver
+ * outage, and used to wait a fixed 3 s first. The delay now grows
+ * exponentially from SRTLA_RECONNECT_INITIAL_MS up to SRTLA_RECONNECT_MAX_MS
+ * with jitter, and goes back to the initial step once a session connects, so
+ * a short receiver blip costs a few hundred ms.
+ *
+ * Each restart is still cold: the fork resolves srtla_host and registers a
+ * fresh group itself.
+ */
+
+#ifndef SRTLA_RECONNECT_H
+#define SRTLA_RECONNECT_H
+
+#include <stdint.h>
+
+#define SRTLA_RECONNECT_INITIAL_MS  200
+#define SRTLA_RECONNECT_MAX_MS      3000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int initial_ms;
+    int max_ms;
+    int current_ms;
+    uint32_t rng;
+} srtla_backoff_t;
+
+void srtla_backoff_init(srtla_backoff_t* b, int initial_ms, int max_ms);
+
+/* Delay before the next attempt: the current step with up to 25% jitter,
+ * then the step doubles (capped at max_ms). */
+int srtla_backoff_next(srtla_backoff_t* b);
+
+/* Back to initial_ms, after an attempt that connected. */
+void srtla_backoff_reset(srtla_backoff_t* b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_RECONNECT_H
@@ -0,0 +1,125 @@
+/*
+ * srtla_register.cpp - Parallel link registration and startup timing
+ *
+ * See srtla_register.h for usage.
+ */
+
+#include "srtla_register.h"
+#include "srtla_log.h"
+
+#include <atomic>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+enum LinkState : uint8_t {
+    LINK_UNREGISTERED = 0,
+    LINK_CONFIRMED = 1,
+};
+
+struct LinkReg {
+    uint8_t state;
+    int64_t last_probe_ms;
+};
+
+// Indexed by fd; loop thread only
+std::vector<LinkReg> links;
+bool group_known = false;
+
+std::atomic<int64_t> start_ms(0);
+std::atomic<int32_t> first_link_ms(-1);
+std::atomic<int32_t> first_packet_ms(-1);
+std::atomic<int32_t> links_confirmed(0);
+// Cheap check for srtla_reg_packet_forwarded(), which runs per packet
+std::atomic<bool> packet_seen(false);
+
+int64_t monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int32_t since_start() {
+    return (int32_t)(monotonic_ms() - start_ms.load(std::memory_order_relaxed));
+}
+
+LinkReg* link_for(int fd) {
+    if (fd < 0) return nullptr;
+    if ((size_t)fd >= links.size()) {
+        links.resize(fd + 1, LinkReg{LINK_UNREGISTERED, 0});
+    }
+    return &links[fd];
+}
+
+}  // namespace
+
+extern "C" void srtla_reg_begin(void) {
+    start_ms.store(monotonic_ms(), std::memory_order_relaxed);
+    first_link_ms.store(-1, std::memory_order_relaxed);
+    first_packet_ms.store(-1, std::memory_order_relaxed);
+    packet_seen.store(false, std::memory_order_relaxed);
+    srtla_reg_reset_links();
+}
+
+extern "C" void srtla_reg_reset_links(void) {
+    links.clear();
+    group_known = false;
+    links_confirmed.store(0, std::memory_order_relaxed);
+}
+
+extern "C" void srtla_reg_group_known(void) {
+    if (group_known) return;
+    group_known = true;
+    // Send REG2 everywhere on the next pass instead of after the probe interval
+    for (LinkReg& l : links) {
+        l.last_probe_ms = 0;
+    }
+}
+
+extern "C" int srtla_reg_probe_due(int fd, int64_t now_ms) {
+    LinkReg* l = link_for(fd);
+    if (l == nullptr || l->state == LINK_CONFIRMED) {
+        return SRTLA_REG_SEND_NONE;
+    }
+    if (l->last_probe_ms != 0 && now_ms - l->last_probe_ms < SRTLA_REG_PROBE_INTERVAL_MS) {
+        return SRTLA_REG_SEND_NONE;
+    }
+    l->last_probe_ms = now_ms;
+    return group_known ? SRTLA_REG_SEND_REG2 : SRTLA_REG_SEND_REG1;
+}
+
+extern "C" void srtla_reg_link_confirmed(int fd) {
+    LinkReg* l = link_for(fd);
+    if (l == nullptr || l->state == LINK_CONFIRMED) return;
+    l->state = LINK_CONFIRMED;
+    links_confirmed.fetch_add(1, std::memory_order_relaxed);
+
+    int32_t expected = -1;
+    int32_t elapsed = since_start();
+    if (first_link_ms.compare_exchange_strong(expected, elapsed, std::memory_order_relaxed)) {
+        SRTLA_LOGI("SRTLA-JNI", "First link (FD %d) registered %d ms after start", fd, elapsed);
+    }
+}
+
+extern "C" void srtla_reg_link_lost(int fd) {
+    LinkReg* l = link_for(fd);
+    if (l == nullptr || l->state != LINK_CONFIRMED) return;
+    l->state = LINK_UNREGISTERED;
+    l->last_probe_ms = 0;
+    links_confirmed.fetch_sub(1, std::memory_order_relaxed);
+}
+
+extern "C" void srtla_reg_packet_forwarded(void) {
+    if (packet_seen.load(std::memory_order_relaxed)) return;
+    if (packet_seen.exchange(true, std::memory_order_relaxed)) return;
+    int32_t elapsed = since_start();
+    first_packet_ms.store(elapsed, std::memory_order_relaxed);
+    SRTLA_LOGI("SRTLA-JNI", "First packet forwarded %d ms after start", elapsed);
+}
+
+extern "C" void srtla_reg_get_timing(srtla_reg_timing_t* out) {
+    out->first_link_ms = first_link_ms.load(std::memory_order_relaxed);
+    out->first_packet_ms = first_packet_ms.load(std::memory_order_relaxed);
+    out->links_confirmed = links_confirmed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+/*
+ * srtla_register.h - Parallel link registration and startup timing
+ *
+ * At startup every registered socket is probed at once instead of bringing
+ * links up one by one through the send loop: REG1 goes out on all sockets,
+ * REG2 on all of them as soon as the first REG2 reply carries the group ID,
+ * and forwarding starts on whichever link is confirmed (REG3) first while the
+ * others join as their replies land. Unanswered links are re-probed every
+ * SRTLA_REG_PROBE_INTERVAL_MS rather than waiting for housekeeping.
+ *
+ * The tracker also records, relative to srtla_reg_begin():
+ *   - time until the first link was confirmed
+ *   - time until the first SRT packet was forwarded (time-to-first-packet)
+ * Nothing drives the tracker until the fork does, so the stats snapshot does
+ * not carry these yet.
+ *
+ * Link state is owned by the send loop thread; timings are atomics and can be
+ * read from any thread.
+ *
+ * Call sites, with the fork change:
+ *   - startSrtlaNative, before the send loop starts: srtla_reg_begin(), and
+ *     srtla_reg_get_timing() in getStatsSnapshot
+ * Fork call sites (srtla_send.c):
+ *   - start of each srtla_start_android() attempt: srtla_reg_reset_links()
+ *   - every loop pass, for each conn with a socket: if
+ *     srtla_reg_probe_due(fd, now_ms) returns SRTLA_REG_SEND_REG1/REG2, send
+ *     that packet on fd (REG2 once the group ID is known)
+ *   - REG3 received on fd: srtla_reg_link_confirmed(fd)
+ *   - first SRT packet forwarded to a link: srtla_reg_packet_forwarded()
+ *   - conn dropped or timed out: srtla_reg_link_lost(fd)
+ */
+
+#ifndef SRTLA_REGISTER_H
+#define SRTLA_REGISTER_H
+
+#include <stdint.h>
+
+#define SRTLA_REG_PROBE_INTERVAL_MS  250
+
+#define SRTLA_REG_SEND_NONE  0
+#define SRTLA_REG_SEND_REG1  1
+#define SRTLA_REG_SEND_REG2  2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t first_link_ms;    /* start -> first REG3, or -1 */
+    int32_t first_packet_ms;  /* start -> first forwarded packet, or -1 */
+    int32_t links_confirmed;  /* links currently registered */
+} srtla_reg_timing_t;
+
+/* New session (startSrtlaNative, before the send loop starts): clears timings
+ * and link state. */
+void srtla_reg_begin(void);
+
+/* New connection attempt: every link must register again; timings are kept. */
+void srtla_reg_reset_links(void);
+
+/* The group ID is known (first REG2 reply); probes switch to REG2. */
+void srtla_reg_group_known(void);
+
+/* Which registration packet, if any, is due on fd now. */
+int srtla_reg_probe_due(int fd, int64_t now_ms);
+
+void srtla_reg_link_confirmed(int fd);
+void srtla_reg_link_lost(int fd);
+void srtla_reg_packet_forwarded(void);
+
+void srtla_reg_get_timing(srtla_reg_timing_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_REGISTER_H
@@ -0,0 +1,145 @@
+/*
+ * srtla_relay.cpp - Native registry of Moblink relay links
+ *
+ * See srtla_relay.h for usage.
+ */
+
+#include "srtla_relay.h"
+#include "srtla_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+struct Relay {
+    bool used;
+    char id[SRTLA_RELAY_ID_LEN];
+    char name[SRTLA_RELAY_NAME_LEN];
+    char host[SRTLA_RELAY_HOST_LEN];
+    int port;
+    int fd;
+    int battery;
+    int thermal;
+    int64_t added_ms;
+    int64_t status_ms;  // 0 = never reported
+};
+
+// Slot i is virtual IP 10.0.100.(i + 1), matching the range SrtlaSender used
+std::mutex relay_mutex;
+Relay relays[SRTLA_RELAY_MAX];
+
+int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void copy_str(char* dst, size_t len, const char* src) {
+    strncpy(dst, src ? src : "", len - 1);
+    dst[len - 1] = '\0';
+}
+
+void format_vip(int slot, char* out, size_t len) {
+    snprintf(out, len, "10.0.100.%d", slot + 1);
+}
+
+// Caller holds relay_mutex
+int find_locked(const char* id) {
+    for (int i = 0; i < SRTLA_RELAY_MAX; i++) {
+        if (relays[i].used && strcmp(relays[i].id, id) == 0) return i;
+    }
+    return -1;
+}
+
+}  // namespace
+
+extern "C" int srtla_relay_add(const char* id, const char* name, const char* host, int port,
+                               int fd, char* virtual_ip_out, size_t virtual_ip_len) {
+    if (!id || !host || fd < 0) return -1;
+    std::lock_guard<std::mutex> lock(relay_mutex);
+
+    // A re-tunnelled relay keeps its slot and virtual IP
+    int slot = find_locked(id);
+    if (slot < 0) {
+        for (int i = 0; i < SRTLA_RELAY_MAX && slot < 0; i++) {
+            if (!relays[i].used) slot = i;
+        }
+        if (slot < 0) {
+            SRTLA_LOGE("SRTLA-JNI", "No free relay slot for '%s'", id);
+            return -1;
+        }
+        Relay& fresh = relays[slot];
+        memset(&fresh, 0, sizeof(fresh));
+        fresh.used = true;
+        copy_str(fresh.id, sizeof(fresh.id), id);
+        fresh.battery = -1;
+        fresh.thermal = -1;
+    }
+
+    Relay& r = relays[slot];
+    copy_str(r.name, sizeof(r.name), name);
+    copy_str(r.host, sizeof(r.host), host);
+    r.port = port;
+    r.fd = fd;
+    r.added_ms = now_ms();
+
+    if (virtual_ip_out && virtual_ip_len > 0) {
+        format_vip(slot, virtual_ip_out, virtual_ip_len);
+    }
+    return 0;
+}
+
+extern "C" int srtla_relay_remove(const char* id, char* virtual_ip_out, size_t virtual_ip_len) {
+    if (!id) return -1;
+    std::lock_guard<std::mutex> lock(relay_mutex);
+    int slot = find_locked(id);
+    if (slot < 0) return -1;
+    if (virtual_ip_out && virtual_ip_len > 0) {
+        format_vip(slot, virtual_ip_out, virtual_ip_len);
+    }
+    relays[slot].used = false;
+    return 0;
+}
+
+extern "C" int srtla_relay_set_status(const char* id, int battery, int thermal) {
+    if (!id) return -1;
+    std::lock_guard<std::mutex> lock(relay_mutex);
+    int slot = find_locked(id);
+    if (slot < 0) return -1;
+    relays[slot].battery = battery;
+    relays[slot].thermal = thermal;
+    relays[slot].status_ms = now_ms();
+    return 0;
+}
+
+extern "C" int srtla_relay_list(srtla_relay_info_t* out, int max) {
+    int64_t now = now_ms();
+    std::lock_guard<std::mutex> lock(relay_mutex);
+    int n = 0;
+    for (int i = 0; i < SRTLA_RELAY_MAX; i++) {
+        const Relay& r = relays[i];
+        if (!r.used) continue;
+        if (n < max) {
+            srtla_relay_info_t& info = out[n];
+            memset(&info, 0, sizeof(info));
+            copy_str(info.id, sizeof(info.id), r.id);
+            copy_str(info.name, sizeof(info.name), r.name);
+            format_vip(i, info.virtual_ip, sizeof(info.virtual_ip));
+            info.fd = r.fd;
+            info.battery = r.battery;
+            info.thermal = r.thermal;
+            info.status_age_ms = r.status_ms > 0 ? (int32_t)(now - r.status_ms) : -1;
+            int64_t seen = r.status_ms > 0 ? r.status_ms : r.added_ms;
+            info.alive = now - seen < SRTLA_RELAY_STATUS_TIMEOUT_MS ? 1 : 0;
+        }
+        n++;
+    }
+    return n;
+}
+
+extern "C" void srtla_relay_clear(void) {
+    std::lock_guard<std::mutex> lock(relay_mutex);
+    for (Relay& r : relays) r.used = false;
+}
@@ -0,0 +1,77 @@
+/*
+ * srtla_relay.h - Native registry of Moblink relay links
+ *
+ * Relays used to be tracked only in Kotlin, where SrtlaSender picked each
+ * relay's virtual IP. The relay manager keeps one entry per relay ID instead:
+ *
+ *   - srtla_relay_add() assigns the relay's virtual IP (10.0.100.N); re-adding
+ *     an ID keeps its virtual IP and takes the new socket
+ *   - srtla_relay_remove() frees the relay's slot
+ *   - srtla_relay_set_status() mirrors the relay's battery / thermal reports
+ *     so the stats snapshot carries them next to the link's counters
+ *
+ * Incremental join/leave is not done: the send loop still learns about relay
+ * links by rescanning the IPs file (notifyNetworkChange()), so a relay that
+ * joins or leaves still rescans every connection. The registry only names
+ * and describes relays.
+ *
+ * Relay sockets are still created and Wi-Fi-bound in Java (Network.bindSocket
+ * has no NDK equivalent on every supported API level); their fds are owned
+ * by the native sender once added, as before.
+ *
+ * Thread-safe (one mutex).
+ */
+
+#ifndef SRTLA_RELAY_H
+#define SRTLA_RELAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SRTLA_RELAY_MAX 254   /* 10.0.100.1 - 10.0.100.254 */
+#define SRTLA_RELAY_ID_LEN 64
+#define SRTLA_RELAY_NAME_LEN 48
+#define SRTLA_RELAY_VIP_LEN 16
+#define SRTLA_RELAY_HOST_LEN 64
+
+/* No status report for this long: not alive (Moblink polls every 10 s) */
+#define SRTLA_RELAY_STATUS_TIMEOUT_MS 25000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    char id[SRTLA_RELAY_ID_LEN];
+    char name[SRTLA_RELAY_NAME_LEN];
+    char virtual_ip[SRTLA_RELAY_VIP_LEN];
+    int fd;
+    int battery;             /* percent, -1 unknown */
+    int thermal;             /* ThermalState ordinal, -1 unknown */
+    int32_t status_age_ms;   /* since the last status report, -1 never */
+    int alive;               /* reported within SRTLA_RELAY_STATUS_TIMEOUT_MS,
+                                or added within it and not reported yet */
+} srtla_relay_info_t;
+
+/* Returns 0 and writes the assigned virtual IP, or -1 if all slots are taken. */
+int srtla_relay_add(const char* id, const char* name, const char* host, int port, int fd,
+                    char* virtual_ip_out, size_t virtual_ip_len);
+
+/* Returns 0 and writes the relay's virtual IP (may be NULL), or -1 for an
+ * unknown ID. */
+int srtla_relay_remove(const char* id, char* virtual_ip_out, size_t virtual_ip_len);
+
+/* battery / thermal -1 = unknown. Returns 0, or -1 for an unknown ID. */
+int srtla_relay_set_status(const char* id, int battery, int thermal);
+
+/* Copies up to max entries; returns the number of relays. */
+int srtla_relay_list(srtla_relay_info_t* out, int max);
+
+/* Session end: forget relays (the loop closes their sockets). */
+void srtla_relay_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_RELAY_H
@@ -0,0 +1,263 @@
+/*
+ * srtla_scheduler.cpp - Pluggable link scheduler for the SRTLA sender
+ *
+ * See srtla_scheduler.h for the policies and fork call sites.
+ */
+
+#include "srtla_scheduler.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+std::atomic<int> g_policy(SRTLA_SCHED_WINDOW);
+
+// Used for RTT-based policies until the link has an RTT sample
+const double DEFAULT_RTT_US = 100000.0;
+const double STRIDE_SCALE = 1000000.0;
+
+struct Link {
+    int window;
+    int in_flight;
+    uint32_t srtt_us;
+    double pass;
+    double cost;
+    int heap_pos;  // -1 when not in the heap
+    double quality;  // radio prior, 1.0 = no penalty
+};
+
+// Window the policies see: the ACK-driven window scaled by the radio prior
+double link_window(const Link& l) {
+    return (double)l.window * l.quality;
+}
+
+double link_rtt(const Link& l) {
+    return l.srtt_us > 0 ? (double)l.srtt_us : DEFAULT_RTT_US;
+}
+
+// WRR stride: inverse of the link's estimated packets per second
+double link_stride(const Link& l) {
+    double weight = link_window(l) * 1000000.0 / link_rtt(l);
+    return STRIDE_SCALE / weight;
+}
+
+}  // namespace
+
+struct srtla_sched {
+    int policy = SRTLA_SCHED_WINDOW;
+    std::vector<Link> links;
+    std::vector<int> heap;
+    // WRR virtual time: pass of the last picked link, used to admit new links
+    // without letting them burst until they catch up
+    double virtual_time = 0.0;
+
+    double compute_cost(const Link& l) const {
+        // As in srtla, the window only scores a link: in_flight may exceed it
+        // (that is what grows the window); only an unusable link is skipped
+        if (l.window <= 0) {
+            return INFINITY;
+        }
+        switch (policy) {
+            case SRTLA_SCHED_EARLIEST_DELIVERY: {
+                double rtt = link_rtt(l);
+                return rtt * 0.5 + (double)(l.in_flight + 1) * rtt / link_window(l);
+            }
+            case SRTLA_SCHED_WEIGHTED_RR:
+                return l.pass;
+            case SRTLA_SCHED_WINDOW:
+            default:
+                return (double)(l.in_flight + 1) / link_window(l);
+        }
+    }
+
+    bool less(int a, int b) const {
+        const Link& la = links[heap[a]];
+        const Link& lb = links[heap[b]];
+        if (la.cost != lb.cost) return la.cost < lb.cost;
+        return heap[a] < heap[b];
+    }
+
+    void swap_nodes(int a, int b) {
+        int ca = heap[a];
+        int cb = heap[b];
+        heap[a] = cb;
+        heap[b] = ca;
+        links[cb].heap_pos = a;
+        links[ca].heap_pos = b;
+    }
+
+    void sift_up(int i) {
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!less(i, parent)) break;
+            swap_nodes(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(int i) {
+        int n = (int)heap.size();
+        for (;;) {
+            int best = i;
+            int left = 2 * i + 1;
+            int right = left + 1;
+            if (left < n && less(left, best)) best = left;
+            if (right < n && less(right, best)) best = right;
+            if (best == i) break;
+            swap_nodes(i, best);
+            i = best;
+        }
+    }
+
+    void rekey(int conn_id) {
+        Link& l = links[conn_id];
+        l.cost = compute_cost(l);
+        sift_up(l.heap_pos);
+        sift_down(l.heap_pos);
+    }
+
+    void rebuild() {
+        virtual_time = 0.0;
+        for (int conn_id : heap) {
+            Link& l = links[conn_id];
+            l.pass = 0.0;
+            l.cost = compute_cost(l);
+        }
+        for (int i = (int)heap.size() / 2 - 1; i >= 0; i--) {
+            sift_down(i);
+        }
+    }
+
+    void sync_policy() {
+        int current = g_policy.load(std::memory_order_relaxed);
+        if (current != policy) {
+            policy = current;
+            rebuild();
+        }
+    }
+};
+
+extern "C" int srtla_sched_set_policy(int policy) {
+    if (policy < 0 || policy >= SRTLA_SCHED_POLICY_COUNT) {
+        return -1;
+    }
+    g_policy.store(policy, std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" int srtla_sched_get_policy(void) {
+    return g_policy.load(std::memory_order_relaxed);
+}
+
+extern "C" const char* srtla_sched_policy_name(int policy) {
+    switch (policy) {
+        case SRTLA_SCHED_WINDOW: return "window";
+        case SRTLA_SCHED_EARLIEST_DELIVERY: return "earliest-delivery";
+        case SRTLA_SCHED_WEIGHTED_RR: return "weighted-rr";
+        default: return "unknown";
+    }
+}
+
+extern "C" srtla_sched_t* srtla_sched_create(void) {
+    srtla_sched_t* s = new srtla_sched_t();
+    s->policy = g_policy.load(std::memory_order_relaxed);
+    return s;
+}
+
+extern "C" void srtla_sched_destroy(srtla_sched_t* s) {
+    delete s;
+}
+
+extern "C" void srtla_sched_update_link(srtla_sched_t* s, int conn_id, int window,
+                                        int in_flight, uint32_t srtt_us) {
+    if (conn_id < 0) return;
+    s->sync_policy();
+    if ((size_t)conn_id >= s->links.size()) {
+        s->links.resize(conn_id + 1, Link{0, 0, 0, 0.0, INFINITY, -1, 1.0});
+    }
+
+    Link& l = s->links[conn_id];
+    l.window = window;
+    l.in_flight = in_flight;
+    l.srtt_us = srtt_us;
+
+    if (l.heap_pos < 0) {
+        l.pass = s->virtual_time;
+        l.heap_pos = (int)s->heap.size();
+        s->heap.push_back(conn_id);
+    }
+    s->rekey(conn_id);
+}
+
+extern "C" void srtla_sched_set_link_quality(srtla_sched_t* s, int conn_id, double quality) {
+    if (conn_id < 0 || (size_t)conn_id >= s->links.size()) return;
+    if (!(quality >= SRTLA_SCHED_MIN_QUALITY)) quality = SRTLA_SCHED_MIN_QUALITY;
+    if (quality > 1.0) quality = 1.0;
+    Link& l = s->links[conn_id];
+    if (l.quality == quality) return;
+    s->sync_policy();
+    l.quality = quality;
+    if (l.heap_pos >= 0) s->rekey(conn_id);
+}
+
+extern "C" void srtla_sched_remove_link(srtla_sched_t* s, int conn_id) {
+    if (conn_id < 0 || (size_t)conn_id >= s->links.size()) return;
+    Link& l = s->links[conn_id];
+    int pos = l.heap_pos;
+    if (pos < 0) return;
+
+    int last = (int)s->heap.size() - 1;
+    if (pos != last) {
+        s->swap_nodes(pos, last);
+    }
+    s->heap.pop_back();
+    l.heap_pos = -1;
+    // The index may be reused by a different network
+    l.quality = 1.0;
+
+    if (pos != last) {
+        s->sift_up(pos);
+        s->sift_down(pos);
+    }
+}
+
+extern "C" int srtla_sched_pick(srtla_sched_t* s) {
+    s->sync_policy();
+    if (s->heap.empty()) return -1;
+    int conn_id = s->heap[0];
+    const Link& l = s->links[conn_id];
+    if (std::isinf(l.cost)) return -1;
+    if (s->policy == SRTLA_SCHED_WEIGHTED_RR) {
+        s->virtual_time = l.pass;
+    }
+    return conn_id;
+}
+
+extern "C" int srtla_sched_pick_backup(srtla_sched_t* s, int primary) {
+    const std::vector<int>& heap = s->heap;
+    int n = (int)heap.size();
+    int best = -1;
+    if (n > 0 && heap[0] != primary) {
+        best = 0;
+    } else {
+        // The second-cheapest link is one of the root's children
+        if (n > 1) best = 1;
+        if (n > 2 && s->less(2, 1)) best = 2;
+    }
+    if (best < 0 || std::isinf(s->links[heap[best]].cost)) return -1;
+    return heap[best];
+}
+
+extern "C" void srtla_sched_on_send(srtla_sched_t* s, int conn_id) {
+    if (conn_id < 0 || (size_t)conn_id >= s->links.size()) return;
+    Link& l = s->links[conn_id];
+    if (l.heap_pos < 0) return;
+    l.in_flight++;
+    if (s->policy == SRTLA_SCHED_WEIGHTED_RR) {
+        l.pass += link_stride(l);
+    }
+    s->rekey(conn_id);
+}
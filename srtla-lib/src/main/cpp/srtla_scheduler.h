@@ -0,0 +1,93 @@
+/*
+ * srtla_scheduler.h - Pluggable link scheduler for the SRTLA sender
+ *
+ * Replaces the linear "lowest in_flight/window score" scan in
+ * select_connection() with an indexed binary min-heap of links keyed by a
+ * per-policy cost. A pick reads the heap top (O(1)); recording a send or an
+ * updated window/RTT re-sifts one entry (O(log n)).
+ *
+ * Policies:
+ *   WINDOW            - classic SRTLA: cost = (in_flight + 1) / window
+ *   EARLIEST_DELIVERY - estimated arrival time of the next packet:
+ *                       srtt / 2 + (in_flight + 1) / window * srtt, so a 40 ms
+ *                       Wi-Fi link beats a 180 ms LTE link with the same window
+ *   WEIGHTED_RR       - stride scheduling with weight = window / srtt (packets
+ *                       per second), i.e. traffic split proportional to capacity
+ *
+ * A link with window <= 0 (e.g. timed out) is never picked, whatever the
+ * policy; as in srtla, a full window only raises a link's cost.
+ *
+ * Each link also carries a quality prior in [SRTLA_SCHED_MIN_QUALITY, 1]
+ * (srtla_radio.h: signal strength and its trend) that scales the window every
+ * policy sees, so load moves off a fading radio before its window collapses
+ * on losses. It defaults to 1 and never takes a link out on its own.
+ *
+ * The policy is process-wide and may be changed from any thread
+ * (srtla_sched_set_policy; only the host bench selects one so far, the app
+ * gets it exposed once the fork's select_connection() uses the scheduler);
+ * the scheduler notices on its next pick and re-keys every link. Everything
+ * else is loop-thread only.
+ *
+ * Fork call sites:
+ *   - conn added/updated (ACK, window change, RTT from srtla_seq_ring):
+ *       srtla_sched_update_link(s, idx, window, in_flight, srtt_us)
+ *   - conn removed: srtla_sched_remove_link(s, idx)
+ *   - housekeeping: srtla_sched_set_link_quality(s, idx, srtla_radio_quality(fd, now_ms))
+ *   - select_connection(): idx = srtla_sched_pick(s); then after sending
+ *       srtla_sched_on_send(s, idx)
+ *   - duplicated packets (srtla_dup.h): srtla_sched_pick_backup(s, idx)
+ */
+
+#ifndef SRTLA_SCHEDULER_H
+#define SRTLA_SCHEDULER_H
+
+#include <stdint.h>
+
+#define SRTLA_SCHED_MIN_QUALITY 0.05
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SRTLA_SCHED_WINDOW = 0,
+    SRTLA_SCHED_EARLIEST_DELIVERY = 1,
+    SRTLA_SCHED_WEIGHTED_RR = 2,
+    SRTLA_SCHED_POLICY_COUNT
+} srtla_sched_policy_t;
+
+/* Process-wide policy selection. Thread-safe. Returns 0, or -1 if unknown. */
+int srtla_sched_set_policy(int policy);
+int srtla_sched_get_policy(void);
+const char* srtla_sched_policy_name(int policy);
+
+typedef struct srtla_sched srtla_sched_t;
+
+srtla_sched_t* srtla_sched_create(void);
+void srtla_sched_destroy(srtla_sched_t* s);
+
+/* Insert or update a link. srtt_us == 0 means no RTT sample yet. */
+void srtla_sched_update_link(srtla_sched_t* s, int conn_id, int window,
+                             int in_flight, uint32_t srtt_us);
+void srtla_sched_remove_link(srtla_sched_t* s, int conn_id);
+
+/* Scale the link's window by quality (clamped to SRTLA_SCHED_MIN_QUALITY..1;
+ * reset to 1 when the link is removed). */
+void srtla_sched_set_link_quality(srtla_sched_t* s, int conn_id, double quality);
+
+/* Best link for the next packet, or -1 if no usable link exists. */
+int srtla_sched_pick(srtla_sched_t* s);
+
+/* Best usable link other than primary (the second-cheapest, read from the top
+ * of the heap in O(1)), or -1 if there is none. Does not change any state:
+ * backup copies are not accounted as in flight. */
+int srtla_sched_pick_backup(srtla_sched_t* s, int primary);
+
+/* Account one packet sent on conn_id (in_flight + 1, WRR pass advance). */
+void srtla_sched_on_send(srtla_sched_t* s, int conn_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_SCHEDULER_H
@@ -0,0 +1,440 @@
+/*
+ * srtla_selftest.cpp - On-device throughput self-test through the real sender
+ *
+ * See srtla_selftest.h for usage.
+ */
+
+#include "srtla_selftest.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <random>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// SRTLA protocol, as srtla_rec speaks it
+const uint16_t TYPE_KEEPALIVE = 0x9000;
+const uint16_t TYPE_ACK = 0x9100;
+const uint16_t TYPE_REG1 = 0x9200;
+const uint16_t TYPE_REG2 = 0x9201;
+const uint16_t TYPE_REG3 = 0x9202;
+const uint16_t TYPE_REG_NGP = 0x9211;
+const int ID_LEN = 256;
+const int RECV_ACK_INT = 10;
+
+// Self-test fields after the 16-byte SRT header
+const size_t SRT_HEADER_LEN = 16;
+const uint32_t MAGIC = 0x54535453;  // "STST"
+struct Stamp {
+    uint32_t magic;
+    uint32_t step;
+    uint32_t index;
+    int64_t send_ns;
+} __attribute__((packed));
+
+const int ECHO_RCVBUF = 4 * 1024 * 1024;
+const int GEN_SNDBUF = 1024 * 1024;
+
+struct Link {
+    bool used;
+    bool registered;
+    struct sockaddr_storage addr;
+    socklen_t len;
+    uint32_t acks[RECV_ACK_INT];
+    int ack_count;
+};
+
+// Echo receiver; links and group_id belong to its thread
+int echo_fd = -1;
+int echo_port = 0;
+std::thread echo_thread;
+std::atomic<bool> echo_stopping(false);
+std::atomic<int> registered_links(0);
+uint8_t group_id[ID_LEN];
+bool group_known = false;
+Link links[SRTLA_SELFTEST_MAX_LINKS];
+
+// Step being recorded, guarded by step_mutex; step_id 0 = none
+std::mutex step_mutex;
+uint32_t step_id = 0;
+uint32_t last_step_id = 0;
+std::vector<uint8_t> seen;
+std::vector<uint32_t> transit_us;
+uint64_t duplicates = 0;
+int64_t last_transit_ns = 0;
+bool has_last_transit = false;
+double jitter_ns = 0.0;
+
+// Continues across steps so the sender's sequence tracking never sees a wrap
+uint32_t srt_seq = 0;
+
+int64_t mono_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint16_t read_be16(const uint8_t* p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+void write_be16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+void write_be32(uint8_t* p, uint32_t v) {
+    uint32_t be = htonl(v);
+    memcpy(p, &be, sizeof(be));
+}
+
+uint32_t read_be32(const uint8_t* p) {
+    uint32_t be;
+    memcpy(&be, p, sizeof(be));
+    return ntohl(be);
+}
+
+bool same_addr(const Link& l, const struct sockaddr_storage& addr, socklen_t len) {
+    return l.len == len && memcmp(&l.addr, &addr, len) == 0;
+}
+
+Link* link_for(const struct sockaddr_storage& addr, socklen_t len) {
+    Link* free_slot = nullptr;
+    for (Link& l : links) {
+        if (l.used && same_addr(l, addr, len)) return &l;
+        if (!l.used && free_slot == nullptr) free_slot = &l;
+    }
+    if (free_slot == nullptr) return nullptr;
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    memcpy(&free_slot->addr, &addr, len);
+    free_slot->len = len;
+    return free_slot;
+}
+
+void reply(const uint8_t* data, size_t len, const struct sockaddr_storage& to, socklen_t to_len) {
+    sendto(echo_fd, data, len, 0, reinterpret_cast<const struct sockaddr*>(&to), to_len);
+}
+
+void reply_type(uint16_t type, const struct sockaddr_storage& to, socklen_t to_len) {
+    uint8_t pkt[2];
+    write_be16(pkt, type);
+    reply(pkt, sizeof(pkt), to, to_len);
+}
+
+void record(const uint8_t* pkt, ssize_t n, int64_t now_ns) {
+    if (n < (ssize_t)(SRT_HEADER_LEN + sizeof(Stamp))) return;
+    Stamp stamp;
+    memcpy(&stamp, pkt + SRT_HEADER_LEN, sizeof(stamp));
+    if (stamp.magic != MAGIC) return;
+
+    std::lock_guard<std::mutex> lock(step_mutex);
+    if (stamp.step != step_id || stamp.index >= seen.size()) return;
+    if (seen[stamp.index]) {
+        duplicates++;
+        return;
+    }
+    seen[stamp.index] = 1;
+    int64_t transit = now_ns - stamp.send_ns;
+    transit_us.push_back(transit > 0 ? (uint32_t)(transit / 1000) : 0);
+    if (has_last_transit) {
+        int64_t d = transit - last_transit_ns;
+        if (d < 0) d = -d;
+        jitter_ns += ((double)d - jitter_ns) / 16.0;
+    }
+    last_transit_ns = transit;
+    has_last_transit = true;
+}
+
+void ack(uint32_t seq, const struct sockaddr_storage& from, socklen_t from_len) {
+    Link* l = link_for(from, from_len);
+    if (l == nullptr) return;
+    l->acks[l->ack_count++] = seq;
+    if (l->ack_count < RECV_ACK_INT) return;
+    uint8_t pkt[4 + 4 * RECV_ACK_INT];
+    write_be32(pkt, (uint32_t)TYPE_ACK << 16);
+    for (int i = 0; i < RECV_ACK_INT; i++) write_be32(pkt + 4 + 4 * i, l->acks[i]);
+    l->ack_count = 0;
+    reply(pkt, sizeof(pkt), from, from_len);
+}
+
+void handle(uint8_t* pkt, ssize_t n, const struct sockaddr_storage& from, socklen_t from_len) {
+    if (n < 2) return;
+    if ((pkt[0] & 0x80) == 0) {
+        if (n < 4) return;
+        record(pkt, n, mono_ns());
+        ack(read_be32(pkt) & 0x7fffffff, from, from_len);
+        return;
+    }
+
+    uint16_t type = read_be16(pkt);
+    if (type == TYPE_KEEPALIVE) {
+        reply(pkt, (size_t)n, from, from_len);
+    } else if (type == TYPE_REG1 && n == 2 + ID_LEN) {
+        // A new group: the sender's half of the ID plus ours
+        static std::mt19937 rng(std::random_device{}());
+        memcpy(group_id, pkt + 2, ID_LEN / 2);
+        for (int i = ID_LEN / 2; i < ID_LEN; i++) group_id[i] = (uint8_t)rng();
+        group_known = true;
+        for (Link& l : links) l.used = false;
+        registered_links.store(0, std::memory_order_relaxed);
+        uint8_t out[2 + ID_LEN];
+        write_be16(out, TYPE_REG2);
+        memcpy(out + 2, group_id, ID_LEN);
+        reply(out, sizeof(out), from, from_len);
+    } else if (type == TYPE_REG2 && n == 2 + ID_LEN) {
+        if (!group_known || memcmp(pkt + 2, group_id, ID_LEN) != 0) {
+            reply_type(TYPE_REG_NGP, from, from_len);
+            return;
+        }
+        Link* l = link_for(from, from_len);
+        if (l == nullptr) return;
+        if (!l->registered) {
+            l->registered = true;
+            registered_links.fetch_add(1, std::memory_order_relaxed);
+        }
+        reply_type(TYPE_REG3, from, from_len);
+    }
+}
+
+void echo_main() {
+    pthread_setname_np(pthread_self(), "srtla-selftest");
+    uint8_t buf[2048];
+    while (!echo_stopping.load(std::memory_order_relaxed)) {
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(echo_fd, buf, sizeof(buf), 0,
+                             reinterpret_cast<struct sockaddr*>(&from), &from_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (echo_stopping.load(std::memory_order_relaxed)) break;
+        handle(buf, n, from, from_len);
+    }
+}
+
+struct sockaddr_in loopback(int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    return addr;
+}
+
+// Nanoseconds tid has run on a CPU; -1 if unknown
+int64_t thread_cpu_ns(int tid) {
+    if (tid <= 0) return -1;
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) return -1;
+    unsigned long long ns = 0;
+    int matched = fscanf(f, "%llu", &ns);
+    fclose(f);
+    return matched == 1 ? (int64_t)ns : -1;
+}
+
+uint64_t percentile(std::vector<uint32_t>& v, int permille) {
+    if (v.empty()) return 0;
+    size_t k = (v.size() - 1) * (size_t)permille / 1000;
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+}  // namespace
+
+extern "C" int srtla_selftest_echo_start(void) {
+    srtla_selftest_echo_stop();
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &ECHO_RCVBUF, sizeof(ECHO_RCVBUF));
+    struct sockaddr_in addr = loopback(0);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    echo_fd = fd;
+    echo_port = ntohs(addr.sin_port);
+    group_known = false;
+    memset(links, 0, sizeof(links));
+    registered_links.store(0, std::memory_order_relaxed);
+    echo_stopping.store(false, std::memory_order_relaxed);
+    echo_thread = std::thread(echo_main);
+    return echo_port;
+}
+
+extern "C" void srtla_selftest_echo_stop(void) {
+    if (echo_fd < 0) return;
+    echo_stopping.store(true, std::memory_order_relaxed);
+    // Unblock recvfrom() with a datagram of our own
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        struct sockaddr_in addr = loopback(echo_port);
+        uint8_t byte = 0;
+        sendto(fd, &byte, 1, 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        close(fd);
+    }
+    if (echo_thread.joinable()) echo_thread.join();
+    close(echo_fd);
+    echo_fd = -1;
+    echo_port = 0;
+    registered_links.store(0, std::memory_order_relaxed);
+}
+
+extern "C" int srtla_selftest_echo_links(void) {
+    return registered_links.load(std::memory_order_relaxed);
+}
+
+extern "C" int srtla_selftest_run_step(int port, int pps, int duration_ms, int forward_tid,
+                                       srtla_selftest_step_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (echo_fd < 0 || port <= 0 || port > 65535 || pps <= 0 || duration_ms < 100 ||
+        duration_ms > 60000) {
+        return -1;
+    }
+    int64_t total = (int64_t)pps * duration_ms / 1000;
+    if (total <= 0 || total > SRTLA_SELFTEST_MAX_STEP_PACKETS) return -1;
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &GEN_SNDBUF, sizeof(GEN_SNDBUF));
+    struct sockaddr_in to = loopback(port);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&to), sizeof(to)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(step_mutex);
+        id = ++last_step_id;
+        if (id == 0) id = ++last_step_id;
+        seen.assign((size_t)total, 0);
+        transit_us.clear();
+        transit_us.reserve((size_t)total);
+        duplicates = 0;
+        has_last_transit = false;
+        jitter_ns = 0.0;
+        step_id = id;
+    }
+
+    // Pace on exact deadlines; the old slack comes back after the step
+    int old_slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    int64_t cpu_start = thread_cpu_ns(forward_tid);
+
+    uint8_t pkt[SRTLA_SELFTEST_PACKET_LEN];
+    memset(pkt, 0, sizeof(pkt));
+    uint64_t sent = 0;
+    int64_t max_late_ns = 0;
+    int64_t start = mono_ns();
+    double interval_ns = 1e9 / pps;
+    for (int64_t i = 0; i < total; i++) {
+        int64_t deadline = start + (int64_t)(i * interval_ns);
+        int64_t now = mono_ns();
+        if (now < deadline) {
+            struct timespec ts = {(time_t)(deadline / 1000000000), (long)(deadline % 1000000000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+            now = mono_ns();
+        }
+        if (now - deadline > max_late_ns) max_late_ns = now - deadline;
+
+        // SRT data packet: seq, solo message, timestamp (us), dest socket 0
+        write_be32(pkt, srt_seq++ & 0x7fffffff);
+        write_be32(pkt + 4, 0xC0000000u | ((uint32_t)i & 0x03ffffff));
+        write_be32(pkt + 8, (uint32_t)((now - start) / 1000));
+        Stamp stamp = {MAGIC, id, (uint32_t)i, now};
+        memcpy(pkt + SRT_HEADER_LEN, &stamp, sizeof(stamp));
+        if (send(fd, pkt, sizeof(pkt), 0) == (ssize_t)sizeof(pkt)) sent++;
+    }
+    int64_t elapsed = mono_ns() - start;
+
+    usleep(SRTLA_SELFTEST_DRAIN_MS * 1000);
+    int64_t cpu_end = thread_cpu_ns(forward_tid);
+    prctl(PR_SET_TIMERSLACK, old_slack > 0 ? (unsigned long)old_slack : 0UL, 0, 0, 0);
+    close(fd);
+
+    std::vector<uint32_t> transit;
+    uint64_t dups;
+    double jitter;
+    {
+        std::lock_guard<std::mutex> lock(step_mutex);
+        step_id = 0;
+        transit.swap(transit_us);
+        dups = duplicates;
+        jitter = jitter_ns;
+    }
+
+    uint64_t delivered = transit.size();
+    out->target_pps = pps;
+    out->duration_ms = duration_ms;
+    out->sent = sent;
+    out->delivered = delivered;
+    out->duplicates = dups;
+    out->achieved_pps = elapsed > 0 ? (uint64_t)(sent * 1000000000.0 / elapsed) : 0;
+    out->delivered_pps = elapsed > 0 ? (uint64_t)(delivered * 1000000000.0 / elapsed) : 0;
+    out->p50_us = percentile(transit, 500);
+    out->p99_us = percentile(transit, 990);
+    out->max_us = transit.empty() ? 0 : *std::max_element(transit.begin(), transit.end());
+    out->jitter_us = (uint64_t)(jitter / 1000.0);
+    out->max_send_late_us = (uint64_t)(max_late_ns / 1000);
+    out->cpu_ns_per_packet = cpu_start >= 0 && cpu_end >= cpu_start && delivered > 0
+                                 ? (cpu_end - cpu_start) / (int64_t)delivered : -1;
+    out->sustained = delivered * 1000 >= (uint64_t)total * SRTLA_SELFTEST_SUSTAIN_PERMILLE &&
+                     out->p99_us < SRTLA_SELFTEST_SUSTAIN_P99_US;
+    return 0;
+}
+
+extern "C" int srtla_selftest_core_masks(uint64_t* little, uint64_t* big) {
+    *little = 0;
+    *big = 0;
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpus > 64) cpus = 64;
+    long freqs[64];
+    long min_freq = 0, max_freq = 0;
+    for (long cpu = 0; cpu < cpus; cpu++) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq",
+                 cpu);
+        freqs[cpu] = 0;
+        FILE* f = fopen(path, "r");
+        if (f == nullptr) continue;
+        if (fscanf(f, "%ld", &freqs[cpu]) != 1) freqs[cpu] = 0;
+        fclose(f);
+        if (freqs[cpu] <= 0) continue;
+        if (min_freq == 0 || freqs[cpu] < min_freq) min_freq = freqs[cpu];
+        if (freqs[cpu] > max_freq) max_freq = freqs[cpu];
+    }
+    if (max_freq == 0) return 0;
+
+    int clusters = 0;
+    long counted[64];
+    for (long cpu = 0; cpu < cpus; cpu++) {
+        if (freqs[cpu] <= 0) continue;
+        if (freqs[cpu] == min_freq) *little |= 1ULL << cpu;
+        if (freqs[cpu] == max_freq) *big |= 1ULL << cpu;
+        bool known = false;
+        for (int i = 0; i < clusters; i++) known = known || counted[i] == freqs[cpu];
+        if (!known) counted[clusters++] = freqs[cpu];
+    }
+    return clusters;
+}
@@ -0,0 +1,95 @@
+/*
+ * srtla_selftest.h - On-device throughput self-test through the real sender
+ *
+ * Whether a phone model sustains the target bitrate used to be learned live.
+ * The self-test answers it beforehand: the sender is started against a
+ * loopback echo receiver, and synthetic SRT traffic is paced into its listen
+ * port at stepped rates, through the full bonding path (link selection,
+ * windows, ACK handling), over loopback link sockets.
+ *
+ *   - echo receiver (its own thread, 127.0.0.1): answers REG1 with REG2 and
+ *     REG2 with REG3, returns keepalives, ACKs every RECV_ACK_INT data
+ *     packets per link as srtla_rec does, and records each self-test packet
+ *     it sees; nothing is forwarded to an SRT server
+ *   - generator (srtla_selftest_run_step(), on the caller's thread): sends
+ *     SRTLA_SELFTEST_PACKET_LEN-byte SRT data packets at a fixed rate to the
+ *     listen port; each carries its step, index and send time
+ *   - per step: packets delivered (unique) and duplicated, achieved rate, the
+ *     transit time from send to echo (p50, p99, max), RFC 3550 interarrival
+ *     jitter, and the forwarding thread's CPU time per delivered packet (from
+ *     /proc/self/task/<tid>/schedstat). A step is sustained if at least
+ *     SRTLA_SELFTEST_SUSTAIN_PERMILLE of the packets arrive and p99 stays under
+ *     SRTLA_SELFTEST_SUSTAIN_P99_US
+ *   - a step sent straight to the echo port (bypassing the sender) measures
+ *     the harness itself; its jitter is the baseline the sender's is compared
+ *     with
+ *
+ * srtla_selftest_core_masks() splits the CPUs into little and big clusters
+ * by their maximum frequency, so the caller can pin the forwarding thread
+ * (srtla_thread_configure) to each in turn. Sequencing the steps, JNI
+ * polling cost and storing results per build are done by the caller
+ * (SrtlaSelfTest.kt).
+ *
+ * The echo functions and run_step may be called from any one thread at a
+ * time; run_step blocks for its duration plus SRTLA_SELFTEST_DRAIN_MS.
+ */
+
+#ifndef SRTLA_SELFTEST_H
+#define SRTLA_SELFTEST_H
+
+#include <stdint.h>
+
+#define SRTLA_SELFTEST_PACKET_LEN        1332     /* SRT header + 7 TS packets */
+#define SRTLA_SELFTEST_PAYLOAD_LEN       1316
+#define SRTLA_SELFTEST_MAX_STEP_PACKETS  (1 << 20)
+#define SRTLA_SELFTEST_DRAIN_MS          300
+#define SRTLA_SELFTEST_SUSTAIN_PERMILLE  990
+#define SRTLA_SELFTEST_SUSTAIN_P99_US    20000
+#define SRTLA_SELFTEST_MAX_LINKS         16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t target_pps;
+    int32_t duration_ms;
+    uint64_t sent;
+    uint64_t delivered;          /* unique packets echoed */
+    uint64_t duplicates;
+    uint64_t achieved_pps;       /* sent rate the generator kept up */
+    uint64_t delivered_pps;
+    uint64_t p50_us;             /* transit, send to echo */
+    uint64_t p99_us;
+    uint64_t max_us;
+    uint64_t jitter_us;          /* RFC 3550 interarrival jitter */
+    uint64_t max_send_late_us;   /* generator behind its schedule */
+    int64_t cpu_ns_per_packet;   /* forwarding thread; -1 if unknown */
+    int32_t sustained;
+} srtla_selftest_step_t;
+
+/* Start the echo receiver on 127.0.0.1. Returns its port, or -1. A running
+ * echo is restarted. */
+int srtla_selftest_echo_start(void);
+void srtla_selftest_echo_stop(void);
+
+/* Link addresses that completed registration (REG3 sent to them). */
+int srtla_selftest_echo_links(void);
+
+/* Send pps packets per second to 127.0.0.1:port for duration_ms (the
+ * sender's listen port, or the echo port for the baseline) and fill out.
+ * forward_tid is the thread charged for CPU (0 = none). Returns 0, or -1 if
+ * the echo is not running or the arguments are out of range. */
+int srtla_selftest_run_step(int port, int pps, int duration_ms, int forward_tid,
+                            srtla_selftest_step_t* out);
+
+/* CPU masks of the slowest and the fastest cluster by cpuinfo_max_freq.
+ * Returns the number of distinct clusters; 0 if cpufreq is unreadable (both
+ * masks are then 0 = any CPU). */
+int srtla_selftest_core_masks(uint64_t* little, uint64_t* big);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_SELFTEST_H
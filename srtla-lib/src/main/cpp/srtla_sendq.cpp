@@ -0,0 +1,285 @@
+/*
+ * srtla_sendq.cpp - Bounded per-link send queues with deadline-based drop
+ *
+ * See srtla_sendq.h for usage.
+ */
+
+#include "srtla_sendq.h"
+#include "srtla_pool.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+
+#if defined(__ANDROID_API__) && __ANDROID_API__ < 21
+#define SRTLA_HAVE_MMSG 0
+#else
+#define SRTLA_HAVE_MMSG 1
+#endif
+
+namespace {
+
+const int DRAIN_BATCH = 32;
+
+struct Entry {
+    uint8_t* buf;
+    uint64_t queued_us;
+    uint16_t len;
+    bool control;
+    bool shared;   // a reference on a srtla_pool_shared buffer, not a copy
+};
+
+// Ring owned by the loop thread; counters are read from JNI
+struct Queue {
+    Entry entries[SRTLA_SENDQ_CAPACITY];
+    int head;
+    int count;
+    std::atomic<int> depth{0};
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> stale_drops{0};
+    std::atomic<uint64_t> overflow_drops{0};
+};
+
+Queue queues[SRTLA_SENDQ_MAX_LINKS];
+std::atomic<int> latency_ms(0);
+std::atomic<bool> mmsg_supported(SRTLA_HAVE_MMSG != 0);
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+Queue* queue_for(int link) {
+    return link >= 0 && link < SRTLA_SENDQ_MAX_LINKS ? &queues[link] : nullptr;
+}
+
+Entry& at(Queue& q, int i) {
+    return q.entries[(q.head + i) % SRTLA_SENDQ_CAPACITY];
+}
+
+void release(Entry& e) {
+    if (e.shared) {
+        srtla_pool_shared_unref(e.buf);
+    } else {
+        srtla_pool_free(SRTLA_POOL_PACKET, e.buf);
+    }
+    e.buf = nullptr;
+}
+
+void pop_head(Queue& q) {
+    release(q.entries[q.head]);
+    q.head = (q.head + 1) % SRTLA_SENDQ_CAPACITY;
+    q.count--;
+}
+
+// Remove entry i (not the head), keeping FIFO order behind it
+void remove_at(Queue& q, int i) {
+    release(at(q, i));
+    for (int j = i; j > 0; j--) at(q, j) = at(q, j - 1);
+    at(q, 0).buf = nullptr;
+    q.head = (q.head + 1) % SRTLA_SENDQ_CAPACITY;
+    q.count--;
+}
+
+void sync_depth(Queue& q) {
+    q.depth.store(q.count, std::memory_order_relaxed);
+}
+
+bool expired(const Entry& e, uint64_t now_us, uint32_t srtt_us, int latency) {
+    if (latency <= 0 || e.control) return false;
+    return e.queued_us + (uint64_t)latency * 1000 < now_us + srtt_us / 2;
+}
+
+// Free a slot in a full queue. Returns false if the packet must be refused.
+bool make_room(Queue& q, bool control) {
+    if (q.count < SRTLA_SENDQ_CAPACITY) return true;
+    // Make room by dropping the oldest data packet; a queue of nothing
+    // but control packets keeps them and refuses new data instead
+    int victim = -1;
+    for (int i = 0; i < q.count && victim < 0; i++) {
+        if (!at(q, i).control) victim = i;
+    }
+    if (victim < 0 && !control) {
+        bump(q.overflow_drops, 1);
+        return false;
+    }
+    if (victim < 0) victim = 0;
+    if (victim == 0) pop_head(q); else remove_at(q, victim);
+    bump(q.overflow_drops, 1);
+    return true;
+}
+
+void append(Queue& q, uint8_t* buf, int len, bool control, bool shared, uint64_t now_us) {
+    Entry& e = at(q, q.count);
+    e.buf = buf;
+    e.queued_us = now_us;
+    e.len = (uint16_t)len;
+    e.control = control;
+    e.shared = shared;
+    q.count++;
+    sync_depth(q);
+    bump(q.queued, 1);
+}
+
+// Returns the number of datagrams the kernel took, or -1 with errno set
+int send_run(int fd, const struct sockaddr* dst, socklen_t dst_len, Queue& q, int n) {
+#if SRTLA_HAVE_MMSG
+    if (mmsg_supported.load(std::memory_order_relaxed)) {
+        struct mmsghdr msgs[DRAIN_BATCH];
+        struct iovec iovs[DRAIN_BATCH];
+        memset(msgs, 0, sizeof(msgs[0]) * n);
+        for (int i = 0; i < n; i++) {
+            Entry& e = at(q, i);
+            iovs[i].iov_base = e.buf;
+            iovs[i].iov_len = e.len;
+            msgs[i].msg_hdr.msg_name = const_cast<struct sockaddr*>(dst);
+            msgs[i].msg_hdr.msg_namelen = dst_len;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int r = sendmmsg(fd, msgs, (unsigned)n, MSG_DONTWAIT);
+        if (r >= 0 || errno != ENOSYS) return r;
+        mmsg_supported.store(false, std::memory_order_relaxed);
+    }
+#endif
+    int sent = 0;
+    for (; sent < n; sent++) {
+        Entry& e = at(q, sent);
+        if (sendto(fd, e.buf, e.len, MSG_DONTWAIT, dst, dst_len) < 0) {
+            return sent > 0 ? sent : -1;
+        }
+    }
+    return sent;
+}
+
+}  // namespace
+
+extern "C" int srtla_sendq_set_latency_ms(int latency) {
+    if (latency < 0) return -1;
+    latency_ms.store(latency, std::memory_order_relaxed);
+    return 0;
+}
+
+extern "C" int srtla_sendq_get_latency_ms(void) {
+    return latency_ms.load(std::memory_order_relaxed);
+}
+
+extern "C" int srtla_sendq_push(int link, const uint8_t* data, int len, uint64_t now_us) {
+    Queue* q = queue_for(link);
+    if (q == nullptr || data == nullptr || len <= 0 || len > 0xffff) return -1;
+
+    bool control = (data[0] & 0x80) != 0;
+    if (!make_room(*q, control)) return -1;
+
+    uint8_t* buf = static_cast<uint8_t*>(srtla_pool_alloc(SRTLA_POOL_PACKET, (size_t)len));
+    if (buf == nullptr) {
+        sync_depth(*q);
+        return -1;
+    }
+    memcpy(buf, data, (size_t)len);
+    append(*q, buf, len, control, false, now_us);
+    return 0;
+}
+
+extern "C" int srtla_sendq_push_shared(int link, uint8_t* data, int len, uint64_t now_us) {
+    Queue* q = queue_for(link);
+    if (q == nullptr || data == nullptr || len <= 0 || len > 0xffff) return -1;
+
+    bool control = (data[0] & 0x80) != 0;
+    if (!make_room(*q, control)) return -1;
+
+    srtla_pool_shared_ref(data);
+    append(*q, data, len, control, true, now_us);
+    return 0;
+}
+
+extern "C" int srtla_sendq_drain(int link, int fd, const struct sockaddr* dst, socklen_t dst_len,
+                                 uint32_t srtt_us, uint64_t now_us,
+                                 srtla_sendq_sent_fn on_sent, void* arg) {
+    Queue* q = queue_for(link);
+    if (q == nullptr || fd < 0) return -1;
+    int latency = latency_ms.load(std::memory_order_relaxed);
+
+    int total = 0;
+    while (q->count > 0) {
+        // Stale data packets are only ever dropped from the head: everything
+        // behind a fresh packet was queued later, so it is fresher still
+        while (q->count > 0 && expired(q->entries[q->head], now_us, srtt_us, latency)) {
+            pop_head(*q);
+            bump(q->stale_drops, 1);
+        }
+        int n = 0;
+        while (n < q->count && n < DRAIN_BATCH &&
+               (n == 0 || !expired(at(*q, n), now_us, srtt_us, latency))) {
+            n++;
+        }
+        if (n == 0) break;
+
+        int r = send_run(fd, dst, dst_len, *q, n);
+        if (r < 0) {
+            sync_depth(*q);
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) return total;
+            return total > 0 ? total : -1;
+        }
+        for (int i = 0; i < r; i++) {
+            const Entry& e = q->entries[q->head];
+            if (on_sent != nullptr) on_sent(link, e.buf, e.len, arg);
+            pop_head(*q);
+        }
+        bump(q->sent, (uint64_t)r);
+        total += r;
+        if (r < n) break;  // socket buffer full
+    }
+    sync_depth(*q);
+    return total;
+}
+
+extern "C" int srtla_sendq_depth(int link) {
+    Queue* q = queue_for(link);
+    return q ? q->count : 0;
+}
+
+extern "C" void srtla_sendq_forget(int link) {
+    Queue* q = queue_for(link);
+    if (q == nullptr) return;
+    while (q->count > 0) pop_head(*q);
+    sync_depth(*q);
+}
+
+extern "C" void srtla_sendq_link_stats(int link, uint64_t now_us, srtla_sendq_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    Queue* q = queue_for(link);
+    if (q == nullptr) return;
+    out->queued = q->queued.load(std::memory_order_relaxed);
+    out->sent = q->sent.load(std::memory_order_relaxed);
+    out->stale_drops = q->stale_drops.load(std::memory_order_relaxed);
+    out->overflow_drops = q->overflow_drops.load(std::memory_order_relaxed);
+    out->depth = q->count;
+    if (q->count > 0 && now_us > q->entries[q->head].queued_us) {
+        out->oldest_ms = (int32_t)((now_us - q->entries[q->head].queued_us) / 1000);
+    }
+}
+
+extern "C" void srtla_sendq_get_totals(srtla_sendq_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    for (const Queue& q : queues) {
+        out->queued += q.queued.load(std::memory_order_relaxed);
+        out->sent += q.sent.load(std::memory_order_relaxed);
+        out->stale_drops += q.stale_drops.load(std::memory_order_relaxed);
+        out->overflow_drops += q.overflow_drops.load(std::memory_order_relaxed);
+        out->depth += q.depth.load(std::memory_order_relaxed);
+    }
+}
+
+extern "C" void srtla_sendq_reset(void) {
+    for (int link = 0; link < SRTLA_SENDQ_MAX_LINKS; link++) {
+        Queue& q = queues[link];
+        srtla_sendq_forget(link);
+        q.head = 0;
+        q.queued.store(0, std::memory_order_relaxed);
+        q.sent.store(0, std::memory_order_relaxed);
+        q.stale_drops.store(0, std::memory_order_relaxed);
+        q.overflow_drops.store(0, std::memory_order_relaxed);
+    }
+}
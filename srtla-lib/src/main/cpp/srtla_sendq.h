@@ -0,0 +1,108 @@
+/*
+ * srtla_sendq.h - Bounded per-link send queues with deadline-based drop
+ *
+ * When every link is saturated the sender used to keep handing packets to
+ * full socket buffers; what the kernel accepted went out seconds late, after
+ * the SRT receiver's latency window had closed, and was thrown away there.
+ * Each link now has a bounded FIFO in front of its socket, and every queued
+ * packet carries the time it entered:
+ *
+ *   - srtla_sendq_push() queues a packet for a link (copied into a
+ *     SRTLA_POOL_PACKET buffer, or referenced with srtla_sendq_push_shared()
+ *     when it is already a shared buffer). A full queue drops its oldest data packet
+ *     to make room, since that one is the closest to being useless.
+ *   - srtla_sendq_drain() sends from the head with sendmmsg() until the
+ *     socket would block. A data packet that can no longer arrive in time,
+ *     queued + SRT latency < now + srtt / 2, is dropped instead of sent.
+ *     SRT control packets (F bit set) are never dropped for age: a late ACK
+ *     or NAK is still useful, and keepalives are tiny.
+ *
+ * The latency is the SRT latency configured in the encoder, which the sender
+ * cannot see; srtla_sendq_set_latency_ms() sets it (0, the default, turns the
+ * deadline off and leaves only the queue bound). Packets dropped here are
+ * not recorded in srtla_seq_ring or counted in flight, so the link's window
+ * accounting only sees what was really sent.
+ *
+ * Drop counters are per link (srtla_sendq_link_stats()) and in total
+ * (srtla_sendq_get_totals()). They are not exposed to Java until the fork's
+ * data path pushes into the queues.
+ *
+ * Loop-thread only, except srtla_sendq_set_latency_ms() and
+ * srtla_sendq_get_totals(), which are safe from any thread.
+ *
+ * Fork call sites (srtla_send.c, loop thread; c is the conn index used for
+ * srtla_sched / srtla_metrics):
+ *   - data path, in place of srtla_tx_enqueue() for the picked conn:
+ *       srtla_sendq_push(c, buf, len, now_us)
+ *   - after each receive batch and in housekeeping, for every conn with
+ *     srtla_sendq_depth(c) > 0:
+ *       srtla_sendq_drain(c, c->fd, &srtla_addr, addr_len, srtt_us, now_us,
+ *                         on_sent, c)
+ *     where on_sent records the packet as a direct send did (seq ring,
+ *     in flight, srtla_metrics_sent)
+ *   - conn removed: srtla_sendq_forget(c)
+ */
+
+#ifndef SRTLA_SENDQ_H
+#define SRTLA_SENDQ_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define SRTLA_SENDQ_MAX_LINKS  32
+#define SRTLA_SENDQ_CAPACITY   128   /* packets per link; all links stay within the packet pool */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t queued;
+    uint64_t sent;
+    uint64_t stale_drops;      /* past their deadline */
+    uint64_t overflow_drops;   /* pushed out of a full queue */
+    int32_t depth;             /* packets waiting now */
+    int32_t oldest_ms;         /* age of the head packet, 0 if empty */
+} srtla_sendq_stats_t;
+
+/* Called for each packet a drain hands to the kernel, e.g. to record it in
+ * srtla_seq_ring and count it in flight. */
+typedef void (*srtla_sendq_sent_fn)(int link, const uint8_t* data, int len, void* arg);
+
+/* SRT latency in ms, 0 = no deadline. Returns 0, or -1 if negative. */
+int srtla_sendq_set_latency_ms(int latency_ms);
+int srtla_sendq_get_latency_ms(void);
+
+/* Returns 0, or -1 for a bad link / length or if no buffer was available. */
+int srtla_sendq_push(int link, const uint8_t* data, int len, uint64_t now_us);
+
+/* As srtla_sendq_push() for a srtla_pool_shared buffer: the queue takes a
+ * reference instead of a copy, and drops it once the packet is sent or
+ * dropped. For packets fanned out to several receiver groups. */
+int srtla_sendq_push_shared(int link, uint8_t* data, int len, uint64_t now_us);
+
+/* Send queued packets for link on fd until empty or the socket would block.
+ * on_sent may be NULL. Returns the number sent, or -1 on a socket error other
+ * than EAGAIN (the packets stay queued). */
+int srtla_sendq_drain(int link, int fd, const struct sockaddr* dst, socklen_t dst_len,
+                      uint32_t srtt_us, uint64_t now_us,
+                      srtla_sendq_sent_fn on_sent, void* arg);
+
+int srtla_sendq_depth(int link);
+
+/* Drop everything queued for link (not counted as stale or overflow). */
+void srtla_sendq_forget(int link);
+
+void srtla_sendq_link_stats(int link, uint64_t now_us, srtla_sendq_stats_t* out);
+
+/* Sums over all links since the last reset; depth is current, oldest_ms 0. */
+void srtla_sendq_get_totals(srtla_sendq_stats_t* out);
+
+/* Session start, before the send loop runs: empty all queues, zero the counters. */
+void srtla_sendq_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_SENDQ_H
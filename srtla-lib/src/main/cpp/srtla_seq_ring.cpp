@@ -0,0 +1,116 @@
+/*
+ * srtla_seq_ring.cpp - SRT sequence -> connection tracking for SRTLA ACKs
+ *
+ * See srtla_seq_ring.h for usage.
+ */
+
+#include "srtla_seq_ring.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+const int EMPTY_CONN = -1;
+
+struct SeqEntry {
+    uint32_t seq;
+    int32_t conn_id;
+    uint64_t sent_us;
+};
+
+struct LinkRtt {
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+    uint32_t min_rtt_us;
+    uint32_t samples;
+};
+
+uint32_t round_up_pow2(uint32_t n) {
+    uint32_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+}  // namespace
+
+struct srtla_seq_ring {
+    std::vector<SeqEntry> entries;
+    uint32_t mask;
+    std::vector<LinkRtt> links;
+
+    LinkRtt& link(int conn_id) {
+        if ((size_t)conn_id >= links.size()) {
+            links.resize(conn_id + 1, LinkRtt{0, 0, 0, 0});
+        }
+        return links[conn_id];
+    }
+};
+
+extern "C" srtla_seq_ring_t* srtla_seq_ring_create(int capacity) {
+    srtla_seq_ring_t* ring = new srtla_seq_ring_t();
+    uint32_t size = round_up_pow2(capacity > 0 ? (uint32_t)capacity : 1);
+    ring->entries.assign(size, SeqEntry{0, EMPTY_CONN, 0});
+    ring->mask = size - 1;
+    return ring;
+}
+
+extern "C" void srtla_seq_ring_destroy(srtla_seq_ring_t* ring) {
+    delete ring;
+}
+
+extern "C" void srtla_seq_ring_record(srtla_seq_ring_t* ring, uint32_t seq, int conn_id, uint64_t now_us) {
+    SeqEntry& e = ring->entries[seq & ring->mask];
+    e.seq = seq;
+    e.conn_id = conn_id;
+    e.sent_us = now_us;
+}
+
+extern "C" int srtla_seq_ring_resolve(srtla_seq_ring_t* ring, uint32_t seq, uint64_t now_us, uint32_t* rtt_us) {
+    SeqEntry& e = ring->entries[seq & ring->mask];
+    if (e.conn_id == EMPTY_CONN || e.seq != seq) {
+        return -1;
+    }
+
+    int conn_id = e.conn_id;
+    e.conn_id = EMPTY_CONN;
+
+    uint64_t elapsed = now_us > e.sent_us ? now_us - e.sent_us : 0;
+    uint32_t sample = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    if (rtt_us != nullptr) {
+        *rtt_us = sample;
+    }
+
+    // RFC 6298 smoothing: srtt += (sample - srtt) / 8, rttvar += (|err| - rttvar) / 4
+    LinkRtt& l = ring->link(conn_id);
+    if (l.samples == 0) {
+        l.srtt_us = sample;
+        l.rttvar_us = sample / 2;
+        l.min_rtt_us = sample;
+    } else {
+        int64_t err = (int64_t)sample - l.srtt_us;
+        l.srtt_us = (uint32_t)((int64_t)l.srtt_us + err / 8);
+        int64_t abs_err = err < 0 ? -err : err;
+        l.rttvar_us = (uint32_t)((int64_t)l.rttvar_us + (abs_err - (int64_t)l.rttvar_us) / 4);
+        if (sample < l.min_rtt_us) l.min_rtt_us = sample;
+    }
+    l.samples++;
+    return conn_id;
+}
+
+extern "C" int srtla_seq_ring_link_rtt(const srtla_seq_ring_t* ring, int conn_id,
+                                       uint32_t* srtt_us, uint32_t* min_rtt_us) {
+    if (conn_id < 0 || (size_t)conn_id >= ring->links.size() || ring->links[conn_id].samples == 0) {
+        return 0;
+    }
+    const LinkRtt& l = ring->links[conn_id];
+    if (srtt_us) *srtt_us = l.srtt_us;
+    if (min_rtt_us) *min_rtt_us = l.min_rtt_us;
+    return 1;
+}
+
+extern "C" void srtla_seq_ring_reset_link(srtla_seq_ring_t* ring, int conn_id) {
+    if (conn_id >= 0 && (size_t)conn_id < ring->links.size()) {
+        ring->links[conn_id] = LinkRtt{0, 0, 0, 0};
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * srtla_seq_ring.h - SRT sequence -> connection tracking for SRTLA ACKs
+ *
+ * A fixed-size, power-of-two ring indexed by SRT sequence number. Sending a
+ * data packet records which connection carried it and when; each entry of an
+ * SRTLA ACK batch then resolves straight to its owning connection in O(1)
+ * instead of searching per-connection packet logs, so in-flight accounting
+ * stays exact under loss and NAK storms cost no more than normal ACKs.
+ *
+ * An entry remembers its full sequence number, so a slot reused by a later
+ * packet (ring wrapped) or an already-acknowledged sequence resolves to -1
+ * rather than to the wrong connection. Resolving an entry clears it, which
+ * keeps duplicate ACKs from decrementing in-flight twice.
+ *
+ * The send timestamps also give a per-link RTT sample on every ACK; the ring
+ * keeps a smoothed estimate (RFC 6298 style) and the minimum per connection.
+ *
+ * Not thread-safe: owned by the send loop thread.
+ */
+
+#ifndef SRTLA_SEQ_RING_H
+#define SRTLA_SEQ_RING_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct srtla_seq_ring srtla_seq_ring_t;
+
+/* capacity is rounded up to a power of two; it should cover the largest
+ * expected number of packets in flight across all links. */
+srtla_seq_ring_t* srtla_seq_ring_create(int capacity);
+void srtla_seq_ring_destroy(srtla_seq_ring_t* ring);
+
+/* Record that seq was sent on connection conn_id (>= 0) at now_us. */
+void srtla_seq_ring_record(srtla_seq_ring_t* ring, uint32_t seq, int conn_id, uint64_t now_us);
+
+/* Resolve an acknowledged seq. Returns the owning conn_id and stores the RTT
+ * sample in *rtt_us (if non-NULL), or returns -1 if seq is unknown. */
+int srtla_seq_ring_resolve(srtla_seq_ring_t* ring, uint32_t seq, uint64_t now_us, uint32_t* rtt_us);
+
+/* Smoothed and minimum RTT for a connection, in microseconds.
+ * Returns 0 if no sample has been taken yet. */
+int srtla_seq_ring_link_rtt(const srtla_seq_ring_t* ring, int conn_id,
+                            uint32_t* srtt_us, uint32_t* min_rtt_us);
+
+/* Forget RTT state for a connection, e.g. when its slot is reused. */
+void srtla_seq_ring_reset_link(srtla_seq_ring_t* ring, int conn_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_SEQ_RING_H
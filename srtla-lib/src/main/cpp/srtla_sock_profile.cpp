@@ -0,0 +1,84 @@
+/*
+ * srtla_sock_profile.cpp - Per-link socket tuning (buffers, DSCP)
+ *
+ * See srtla_sock_profile.h for usage.
+ */
+
+#include "srtla_sock_profile.h"
+#include "srtla_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <sys/socket.h>
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+namespace {
+
+struct Profile {
+    const char* name;
+    int min_buf;          // bytes
+    int max_buf;
+    uint64_t default_bps;
+    uint32_t default_rtt_us;
+};
+
+// Cellular and relayed links get small buffers: their own queues are deep
+// already and anything more only adds latency
+const Profile PROFILES[SRTLA_LINK_TYPE_COUNT] = {
+    {"unknown",  64 * 1024, 212992,      10000000,  80000},
+    {"wifi",     64 * 1024, 1024 * 1024, 30000000,  30000},
+    {"cellular", 32 * 1024, 256 * 1024,  10000000,  80000},
+    {"ethernet", 64 * 1024, 2048 * 1024, 100000000, 10000},
+    {"relay",    32 * 1024, 256 * 1024,  8000000,   120000},
+};
+
+std::atomic<int> busy_poll_us(0);
+
+int clamp_buf(const Profile& p, uint64_t bdp_bytes) {
+    uint64_t buf = bdp_bytes * 2;
+    if (buf < (uint64_t)p.min_buf) return p.min_buf;
+    if (buf > (uint64_t)p.max_buf) return p.max_buf;
+    return (int)buf;
+}
+
+void set_buffers(int fd, int buf) {
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf, sizeof(buf)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf)) != 0) {
+        SRTLA_LOGW("SRTLA-JNI", "FD %d: setting %d byte buffers failed: %s", fd, buf, strerror(errno));
+    }
+}
+
+}  // namespace
+
+extern "C" void srtla_sock_apply_profile(int fd, int link_type) {
+    if (fd < 0) return;
+    if (link_type < 0 || link_type >= SRTLA_LINK_TYPE_COUNT) link_type = SRTLA_LINK_UNKNOWN;
+    const Profile& p = PROFILES[link_type];
+
+    uint64_t bdp = p.default_bps / 8 * p.default_rtt_us / 1000000;
+    int buf = clamp_buf(p, bdp);
+    set_buffers(fd, buf);
+
+    int tos = SRTLA_SOCK_TOS_AF41;
+    if (setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) != 0) {
+        SRTLA_LOGW("SRTLA-JNI", "FD %d: setting IP_TOS failed: %s", fd, strerror(errno));
+    }
+
+    int busy = busy_poll_us.load(std::memory_order_relaxed);
+    if (busy > 0 && setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy, sizeof(busy)) != 0) {
+        SRTLA_LOGW("SRTLA-JNI", "FD %d: SO_BUSY_POLL failed: %s", fd, strerror(errno));
+    }
+
+    SRTLA_LOGI("SRTLA-JNI", "FD %d: %s profile, %d byte buffers", fd, p.name, buf);
+}
+
+extern "C" void srtla_sock_set_busy_poll(int usec) {
+    busy_poll_us.store(usec > 0 ? usec : 0, std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+/*
+ * srtla_sock_profile.h - Per-link socket tuning (buffers, DSCP)
+ *
+ * createUdpSocketNative used to give every socket the same 208 KB buffers.
+ * On a shallow cellular or relayed link a burst from the local encoder then
+ * queues in the socket, not in SRT, and shows up as a latency spike. A
+ * profile per link type sets, at registration:
+ *
+ *   - SO_SNDBUF / SO_RCVBUF from a default bandwidth-delay product for the
+ *     link type, clamped to the profile's min/max
+ *   - IP_TOS: DSCP AF41 (interactive video) on every link
+ *   - SO_BUSY_POLL, only if enabled with srtla_sock_set_busy_poll()
+ *
+ * The profile is static: buffers are not re-sized from measured link
+ * bandwidth or RTT, and no pacing rate is set.
+ *
+ * Thread-safe.
+ */
+
+#ifndef SRTLA_SOCK_PROFILE_H
+#define SRTLA_SOCK_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Link types; the first values match SrtlaSender.getNetworkTypeId(). */
+typedef enum {
+    SRTLA_LINK_UNKNOWN = 0,
+    SRTLA_LINK_WIFI = 1,
+    SRTLA_LINK_CELLULAR = 2,
+    SRTLA_LINK_ETHERNET = 3,
+    SRTLA_LINK_RELAY = 4,      /* Moblink relay: another phone's uplink */
+    SRTLA_LINK_TYPE_COUNT
+} srtla_link_type_t;
+
+/* DSCP AF41 in the IP_TOS byte */
+#define SRTLA_SOCK_TOS_AF41  0x88
+
+/* Apply the link type's profile to a freshly registered socket. */
+void srtla_sock_apply_profile(int fd, int link_type);
+
+/* SO_BUSY_POLL in microseconds for sockets profiled from now on; 0 = off
+ * (default). Trades CPU for receive latency on the ACK path. */
+void srtla_sock_set_busy_poll(int usec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_SOCK_PROFILE_H
@@ -0,0 +1,143 @@
+/*
+ * srtla_stats_publish.cpp - Double-buffered seqlock stats region
+ *
+ * See srtla_stats_publish.h for the writer/reader contract.
+ */
+
+#include "srtla_stats_publish.h"
+#include "srtla_events.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+const int INITIAL_SLOT_CAPACITY = 16;
+
+struct StatsSlot {
+    std::atomic<uint32_t> seq{0};
+    int64_t published_at_ms = 0;
+    std::atomic<int> conn_count{0};
+    srtla_group_stats_t group{};
+    std::atomic<srtla_conn_stats_t*> conns{nullptr};
+    int capacity = 0;
+};
+
+StatsSlot slots[2];
+std::atomic<int> current_slot(-1);
+std::atomic<uint64_t> publish_count(0);
+
+// Writer-thread-only state for the block being built
+int write_slot = 0;
+int write_count = 0;
+
+// Arrays replaced by a slot resize. A lagging reader may still be copying from
+// one (its sequence check then fails), so they are kept until unload rather
+// than freed; with doubling growth this is bounded by the peak link count.
+std::vector<std::unique_ptr<srtla_conn_stats_t[]>> slot_storage;
+
+void grow_slot(StatsSlot& slot) {
+    int new_capacity = slot.capacity > 0 ? slot.capacity * 2 : INITIAL_SLOT_CAPACITY;
+    std::unique_ptr<srtla_conn_stats_t[]> storage(new srtla_conn_stats_t[new_capacity]);
+    srtla_conn_stats_t* old = slot.conns.load(std::memory_order_relaxed);
+    if (old != nullptr && write_count > 0) {
+        memcpy(storage.get(), old, write_count * sizeof(srtla_conn_stats_t));
+    }
+    slot.conns.store(storage.get(), std::memory_order_relaxed);
+    slot.capacity = new_capacity;
+    slot_storage.push_back(std::move(storage));
+}
+
+const int MAX_READ_ATTEMPTS = 16;
+
+int64_t monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+}  // namespace
+
+extern "C" void srtla_stats_publish_begin(void) {
+    int cur = current_slot.load(std::memory_order_relaxed);
+    write_slot = cur < 0 ? 0 : cur ^ 1;
+    write_count = 0;
+
+    StatsSlot& slot = slots[write_slot];
+    // Odd sequence marks the slot as being written
+    slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+extern "C" void srtla_stats_publish_conn(const srtla_conn_stats_t* stats) {
+    if (stats == nullptr) {
+        return;
+    }
+    StatsSlot& slot = slots[write_slot];
+    if (write_count >= slot.capacity) {
+        grow_slot(slot);
+    }
+    slot.conns.load(std::memory_order_relaxed)[write_count++] = *stats;
+}
+
+extern "C" void srtla_stats_publish_end(const srtla_group_stats_t* group) {
+    StatsSlot& slot = slots[write_slot];
+    slot.conn_count.store(write_count, std::memory_order_relaxed);
+    slot.published_at_ms = monotonic_ms();
+    if (group != nullptr) {
+        slot.group = *group;
+    } else {
+        memset(&slot.group, 0, sizeof(slot.group));
+    }
+
+    slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    current_slot.store(write_slot, std::memory_order_release);
+    publish_count.fetch_add(1, std::memory_order_relaxed);
+
+    // Let the event dispatcher diff the new block (lock-free after the first call)
+    srtla_events_notify();
+}
+
+bool srtla_stats_read(srtla_stats_view* out) {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        int idx = current_slot.load(std::memory_order_acquire);
+        if (idx < 0) {
+            return false;
+        }
+
+        const StatsSlot& slot = slots[idx];
+        uint32_t seq_before = slot.seq.load(std::memory_order_acquire);
+        if (seq_before & 1) {
+            continue;  // writer lapped us and is filling this slot
+        }
+
+        int count = slot.conn_count.load(std::memory_order_relaxed);
+        const srtla_conn_stats_t* conns = slot.conns.load(std::memory_order_relaxed);
+        if (count < 0 || (count > 0 && conns == nullptr)) {
+            continue;
+        }
+        if (out->conns.size() < (size_t)count) {
+            out->conns.resize(count);
+        }
+        out->conn_count = count;
+        out->published_at_ms = slot.published_at_ms;
+        out->group = slot.group;
+        if (count > 0) {
+            memcpy(out->conns.data(), conns, count * sizeof(srtla_conn_stats_t));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == seq_before) {
+            out->publish_count = publish_count.load(std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void srtla_stats_reset() {
+    current_slot.store(-1, std::memory_order_release);
+}
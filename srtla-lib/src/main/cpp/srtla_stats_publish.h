@@ -0,0 +1,87 @@
+/*
+ * srtla_stats_publish.h - Lock-free stats publication from the SRTLA send loop
+ *
+ * The send loop publishes a per-connection stats block once per housekeeping
+ * pass; JNI readers copy the latest block without touching live conn_t state
+ * and without ever blocking the forwarding thread.
+ *
+ * The region is double-buffered: the writer always fills the slot readers are
+ * not pointed at, guarded by that slot's sequence counter, then flips the
+ * current index. A reader only retries if it is slower than a full publish
+ * period. There is no connection cap: a slot grows (by doubling) the first
+ * time a publish pass holds more connections than it has room for.
+ *
+ * Writer side (exactly one thread):
+ *
+ *     srtla_stats_publish_begin();
+ *     for each conn: srtla_stats_publish_conn(&conn_stats);
+ *     srtla_stats_publish_end(&group_stats);
+ *
+ * The fork's loop does not publish yet, and nothing in this tree defines
+ * SRTLA_SENDER_PUBLISHES_STATS, so the writer is the JNI stats dispatcher: on
+ * each detection pass (at least once per SRTLA_EVENTS_IDLE_CHECK_MS) it walks
+ * the fork's srtla_get_* getters once and publishes the result. The seqlock
+ * therefore only protects the JNI readers from each other and from that
+ * writer. The getters themselves still read live conn_t state without
+ * synchronisation while the send loop mutates it, now from the dispatcher
+ * thread (and from a JNI reader before the first publication of a session);
+ * that race goes away only once the send loop publishes from its
+ * housekeeping pass and is built with SRTLA_SENDER_PUBLISHES_STATS, which
+ * compiles the dispatcher's writer out.
+ */
+
+#ifndef SRTLA_STATS_PUBLISH_H
+#define SRTLA_STATS_PUBLISH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRTLA_STATS_TYPE_LEN 16
+#define SRTLA_STATS_IP_LEN 64
+
+typedef struct {
+    char type[SRTLA_STATS_TYPE_LEN];
+    char ip[SRTLA_STATS_IP_LEN];
+    double bitrate_mbps;
+    int32_t load_percent;
+    int32_t window_size;
+    int32_t in_flight;
+    int32_t rtt_ms;          /* -1 when unknown; the fork's per-conn RTT */
+} srtla_conn_stats_t;
+
+typedef struct {
+    int32_t active_conn_count;
+    int32_t is_reconnecting;
+} srtla_group_stats_t;
+
+void srtla_stats_publish_begin(void);
+void srtla_stats_publish_conn(const srtla_conn_stats_t* stats);
+void srtla_stats_publish_end(const srtla_group_stats_t* group);
+
+#ifdef __cplusplus
+}
+
+#include <vector>
+
+// Reader side (JNI wrapper). Reuse one view per thread so conns keeps its
+// capacity and steady-state reads do not allocate.
+struct srtla_stats_view {
+    uint64_t publish_count;
+    int64_t published_at_ms;
+    int conn_count;
+    srtla_group_stats_t group;
+    std::vector<srtla_conn_stats_t> conns;
+};
+
+// Copy the latest published block. Returns false if the send loop has not
+// published anything since the last reset.
+bool srtla_stats_read(srtla_stats_view* out);
+
+// Forget the published block, e.g. when the sender is stopped.
+void srtla_stats_reset();
+#endif
+
+#endif  // SRTLA_STATS_PUBLISH_H
@@ -0,0 +1,131 @@
+/*
+ * srtla_stats_snapshot.h - Binary layout of the getStatsSnapshot() buffer
+ *
+ * The snapshot is written into a caller-owned direct ByteBuffer so the 1 Hz
+ * stats poll needs a single JNI call and no jstring/jobjectArray allocation.
+ * All values are native-endian; Java reads them with ByteOrder.nativeOrder().
+ *
+ * Layout (keep in sync with StatsSnapshot.java, bump the version on change):
+ *
+ *   Header (SNAPSHOT_HEADER_SIZE bytes)
+ *     0  u32  magic              SNAPSHOT_MAGIC
+ *     4  u32  version            SNAPSHOT_VERSION
+ *     8  u32  total_size         bytes written, header included
+ *    12  u32  conn_count         number of entries in every per-connection array
+ *    16  i32  active_conn_count  as reported by the sender
+ *    20  i32  total_in_flight
+ *    24  i32  total_window
+ *    28  i32  retry_count
+ *    32  u32  flags              SNAPSHOT_FLAG_*
+ *    36  u32  reserved
+ *    40  f64  total_bitrate_mbps
+ *    48  i64  timestamp_ms       CLOCK_MONOTONIC time the snapshot was taken
+ *    56  u64  reserved
+ *
+ *   Per-connection arrays (struct-of-arrays, each section 8-byte aligned)
+ *     f64   bitrate_mbps[conn_count]
+ *     i32   load_percent[conn_count]
+ *     i32   window_size[conn_count]
+ *     i32   in_flight[conn_count]
+ *     i32   rtt_ms[conn_count]          smoothed RTT, -1 while unknown
+ *     u8    active[conn_count]
+ *     char  type[conn_count][SNAPSHOT_TYPE_LEN]   NUL-terminated
+ *     char  ip[conn_count][SNAPSHOT_IP_LEN]       NUL-terminated
+ *
+ *   Relay section (8-byte aligned, after the ip array; srtla_relay.h)
+ *     u32   relay_count
+ *     u32   relay_record_size  SNAPSHOT_RELAY_SIZE
+ *     SnapshotRelay relays[relay_count]
+ */
+
+#ifndef SRTLA_STATS_SNAPSHOT_H
+#define SRTLA_STATS_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace srtla_snapshot {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x534E4150;  // "SNAP"
+constexpr uint32_t SNAPSHOT_VERSION = 7;
+
+constexpr size_t SNAPSHOT_HEADER_SIZE = 64;
+constexpr size_t SNAPSHOT_TYPE_LEN = 16;
+constexpr size_t SNAPSHOT_IP_LEN = 64;
+constexpr size_t SNAPSHOT_RELAY_SIZE = 152;
+
+constexpr uint32_t SNAPSHOT_FLAG_RUNNING         = 1u << 0;
+constexpr uint32_t SNAPSHOT_FLAG_CONNECTED       = 1u << 1;
+constexpr uint32_t SNAPSHOT_FLAG_EVER_CONNECTED  = 1u << 2;
+constexpr uint32_t SNAPSHOT_FLAG_RECONNECTING    = 1u << 3;
+constexpr uint32_t SNAPSHOT_FLAG_RETRYING        = 1u << 4;
+constexpr uint32_t SNAPSHOT_FLAG_HAS_STATS       = 1u << 5;  // getAllStats() would not be empty
+
+constexpr uint32_t SNAPSHOT_RELAY_ALIVE          = 1u << 0;  // status within the timeout
+constexpr uint32_t SNAPSHOT_RELAY_LINKED         = 1u << 1;  // its connection is active
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t conn_count;
+    int32_t active_conn_count;
+    int32_t total_in_flight;
+    int32_t total_window;
+    int32_t retry_count;
+    uint32_t flags;
+    uint32_t reserved0;
+    double total_bitrate_mbps;
+    int64_t timestamp_ms;
+    uint64_t reserved1;
+};
+static_assert(sizeof(SnapshotHeader) == SNAPSHOT_HEADER_SIZE, "snapshot header layout changed");
+
+struct SnapshotRelay {
+    char id[64];
+    char name[48];
+    char virtual_ip[16];
+    int32_t battery;          // percent, -1 unknown
+    int32_t thermal;          // ThermalState ordinal, -1 unknown
+    int32_t status_age_ms;    // -1 if it never reported
+    int32_t conn_index;       // index into the per-connection arrays, -1 if none
+    uint32_t flags;           // SNAPSHOT_RELAY_*
+    uint32_t reserved;
+};
+static_assert(sizeof(SnapshotRelay) == SNAPSHOT_RELAY_SIZE, "snapshot relay layout changed");
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+// Section offsets for a snapshot holding n connections.
+struct SnapshotLayout {
+    size_t bitrate;
+    size_t load;
+    size_t window;
+    size_t in_flight;
+    size_t rtt;
+    size_t active;
+    size_t type;
+    size_t ip;
+    size_t relays;
+    size_t total;
+
+    // n connections and r relays
+    static SnapshotLayout for_count(size_t n, size_t r) {
+        SnapshotLayout l{};
+        l.bitrate   = SNAPSHOT_HEADER_SIZE;
+        l.load      = align8(l.bitrate + n * sizeof(double));
+        l.window    = align8(l.load + n * sizeof(int32_t));
+        l.in_flight = align8(l.window + n * sizeof(int32_t));
+        l.rtt       = align8(l.in_flight + n * sizeof(int32_t));
+        l.active    = align8(l.rtt + n * sizeof(int32_t));
+        l.type      = align8(l.active + n);
+        l.ip        = align8(l.type + n * SNAPSHOT_TYPE_LEN);
+        l.relays    = align8(l.ip + n * SNAPSHOT_IP_LEN);
+        l.total     = align8(l.relays + 2 * sizeof(uint32_t) + r * SNAPSHOT_RELAY_SIZE);
+        return l;
+    }
+};
+
+}  // namespace srtla_snapshot
+
+#endif  // SRTLA_STATS_SNAPSHOT_H
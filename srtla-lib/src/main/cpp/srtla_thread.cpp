@@ -0,0 +1,212 @@
+/*
+ * srtla_thread.cpp - Priority, affinity and scheduling latency of native threads
+ *
+ * See srtla_thread.h for usage.
+ */
+
+#include "srtla_thread.h"
+#include "srtla_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const ROLE_NAMES[SRTLA_THREAD_ROLE_COUNT] = {"forward", "housekeeping"};
+
+struct RoleConfig {
+    int nice;
+    int fifo_priority;
+    uint64_t cpu_mask;
+};
+
+// Guarded by config_mutex
+struct RoleState {
+    RoleConfig wanted;
+    pid_t tid;
+    RoleConfig applied;
+    bool fifo_refused;
+};
+
+// Single writer (the role's thread), read from JNI
+struct Latency {
+    std::atomic<int> last_cpu{-1};
+    std::atomic<uint64_t> migrations{0};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> total_us{0};
+    std::atomic<uint64_t> max_us{0};
+    std::atomic<uint64_t> buckets[SRTLA_THREAD_LATENCY_BUCKETS];
+};
+
+std::mutex config_mutex;
+RoleState roles[SRTLA_THREAD_ROLE_COUNT];
+Latency latency[SRTLA_THREAD_ROLE_COUNT];
+
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+bool valid_role(int role) {
+    return role >= 0 && role < SRTLA_THREAD_ROLE_COUNT;
+}
+
+// Caller holds config_mutex
+void apply_locked(int role) {
+    RoleState& st = roles[role];
+    if (st.tid == 0) return;
+    const RoleConfig& want = st.wanted;
+
+    if (setpriority(PRIO_PROCESS, st.tid, want.nice) == 0) {
+        st.applied.nice = want.nice;
+    } else {
+        SRTLA_LOGW("SRTLA-JNI", "%s thread: nice %d refused: %s",
+                   ROLE_NAMES[role], want.nice, strerror(errno));
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    st.fifo_refused = false;
+    if (want.fifo_priority > 0) {
+        param.sched_priority = want.fifo_priority;
+        if (sched_setscheduler(st.tid, SCHED_FIFO, &param) == 0) {
+            st.applied.fifo_priority = want.fifo_priority;
+        } else {
+            st.fifo_refused = true;
+            SRTLA_LOGW("SRTLA-JNI", "%s thread: SCHED_FIFO %d refused (%s), staying at nice %d",
+                       ROLE_NAMES[role], want.fifo_priority, strerror(errno), st.applied.nice);
+        }
+    } else if (st.applied.fifo_priority > 0) {
+        if (sched_setscheduler(st.tid, SCHED_OTHER, &param) == 0) {
+            st.applied.fifo_priority = 0;
+        }
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+        if (want.cpu_mask == 0 || (want.cpu_mask & (1ull << cpu))) CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(st.tid, sizeof(set), &set) == 0) {
+        st.applied.cpu_mask = want.cpu_mask;
+    } else {
+        SRTLA_LOGW("SRTLA-JNI", "%s thread: CPU mask 0x%llx refused: %s", ROLE_NAMES[role],
+                   (unsigned long long)want.cpu_mask, strerror(errno));
+    }
+
+    SRTLA_LOGI("SRTLA-JNI", "%s thread %d: nice %d, %s, CPU mask 0x%llx", ROLE_NAMES[role],
+               (int)st.tid, st.applied.nice,
+               st.applied.fifo_priority > 0 ? "SCHED_FIFO" : "SCHED_OTHER",
+               (unsigned long long)st.applied.cpu_mask);
+}
+
+int bucket_for(uint64_t us) {
+    int b = 0;
+    while (b < SRTLA_THREAD_LATENCY_BUCKETS - 1 && us >= (1ull << b)) b++;
+    return b;
+}
+
+}  // namespace
+
+extern "C" int srtla_thread_configure(int role, int nice, int fifo_priority, uint64_t cpu_mask) {
+    if (!valid_role(role) || nice < -20 || nice > 19 || fifo_priority < 0 || fifo_priority > 99) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(config_mutex);
+    roles[role].wanted = RoleConfig{nice, fifo_priority, cpu_mask};
+    apply_locked(role);
+    return 0;
+}
+
+extern "C" void srtla_thread_enter(int role, const char* name) {
+    if (!valid_role(role)) return;
+    if (name) pthread_setname_np(pthread_self(), name);
+    std::lock_guard<std::mutex> lock(config_mutex);
+    RoleState& st = roles[role];
+    st.tid = gettid();
+    st.applied = RoleConfig{getpriority(PRIO_PROCESS, 0), 0, 0};
+    const RoleConfig& want = st.wanted;
+    // Nothing asked for: leave the inherited scheduling alone
+    if (want.nice != 0 || want.fifo_priority != 0 || want.cpu_mask != 0) {
+        apply_locked(role);
+    }
+}
+
+extern "C" void srtla_thread_leave(int role) {
+    if (!valid_role(role)) return;
+    std::lock_guard<std::mutex> lock(config_mutex);
+    roles[role].tid = 0;
+}
+
+extern "C" void srtla_thread_record_latency(int role, int64_t late_ns) {
+    if (!valid_role(role)) return;
+    Latency& l = latency[role];
+    uint64_t us = late_ns > 0 ? (uint64_t)late_ns / 1000 : 0;
+
+    int cpu = sched_getcpu();
+    int last = l.last_cpu.load(std::memory_order_relaxed);
+    if (cpu >= 0 && cpu != last) {
+        if (last >= 0) bump(l.migrations, 1);
+        l.last_cpu.store(cpu, std::memory_order_relaxed);
+    }
+
+    bump(l.samples, 1);
+    bump(l.total_us, us);
+    if (us > l.max_us.load(std::memory_order_relaxed)) {
+        l.max_us.store(us, std::memory_order_relaxed);
+    }
+    bump(l.buckets[bucket_for(us)], 1);
+}
+
+extern "C" void srtla_thread_get_stats(int role, srtla_thread_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->last_cpu = -1;
+    if (!valid_role(role)) return;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex);
+        const RoleState& st = roles[role];
+        out->tid = st.tid;
+        out->nice = st.applied.nice;
+        out->fifo_priority = st.applied.fifo_priority;
+        out->fifo_refused = st.fifo_refused ? 1 : 0;
+        out->cpu_mask = st.applied.cpu_mask;
+    }
+    const Latency& l = latency[role];
+    out->last_cpu = l.last_cpu.load(std::memory_order_relaxed);
+    out->migrations = l.migrations.load(std::memory_order_relaxed);
+    out->samples = l.samples.load(std::memory_order_relaxed);
+    out->total_us = l.total_us.load(std::memory_order_relaxed);
+    out->max_us = l.max_us.load(std::memory_order_relaxed);
+    for (int b = 0; b < SRTLA_THREAD_LATENCY_BUCKETS; b++) {
+        out->buckets[b] = l.buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+extern "C" uint64_t srtla_thread_latency_quantile(const srtla_thread_stats_t* stats, double q) {
+    uint64_t total = 0;
+    for (int b = 0; b < SRTLA_THREAD_LATENCY_BUCKETS; b++) total += stats->buckets[b];
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < SRTLA_THREAD_LATENCY_BUCKETS - 1; b++) {
+        seen += stats->buckets[b];
+        if (seen >= rank) return (1ull << b) < stats->max_us ? (1ull << b) : stats->max_us;
+    }
+    return stats->max_us;
+}
+
+extern "C" void srtla_thread_reset_stats(void) {
+    for (Latency& l : latency) {
+        l.last_cpu.store(-1, std::memory_order_relaxed);
+        l.migrations.store(0, std::memory_order_relaxed);
+        l.samples.store(0, std::memory_order_relaxed);
+        l.total_us.store(0, std::memory_order_relaxed);
+        l.max_us.store(0, std::memory_order_relaxed);
+        for (auto& b : l.buckets) b.store(0, std::memory_order_relaxed);
+    }
+}
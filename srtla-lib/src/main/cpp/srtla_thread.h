@@ -0,0 +1,86 @@
+/*
+ * srtla_thread.h - Priority, affinity and scheduling latency of native threads
+ *
+ * The sender used to run at the default priority, competing with the
+ * encoder, the UI thread and the Moblink pollers, and free to be migrated
+ * between little and big cores. Each native thread now has a role:
+ *
+ *   - SRTLA_THREAD_FORWARD: the send loop (srtla_thread_func), which owns
+ *     the packet path and its housekeeping
+ *   - SRTLA_THREAD_HOUSEKEEPING: the "srtla-events" dispatcher, which runs
+ *     stats change detection and the Java callbacks off the packet path
+ *
+ * A role's config (nice value, optional SCHED_FIFO priority, optional CPU
+ * mask) is applied when its thread calls srtla_thread_enter(), and
+ * immediately to a thread already running. SCHED_FIFO needs a privilege most
+ * app processes lack; when refused, the thread keeps SCHED_OTHER with its nice
+ * value and the refusal is visible in the stats.
+ *
+ * Scheduling latency is how late a thread runs after it should have: the
+ * reactor reports housekeeping timer expiry to run and srtla_reactor_wakeup()
+ * to run for the forwarding thread; the dispatcher reports how late its timed
+ * waits return. Samples go into power-of-two microsecond buckets, and the CPU
+ * the thread ran on is sampled with each one to count migrations, so
+ * throttling and core parking show up as a shift in p99. The forwarding
+ * thread is only sampled when the send loop waits in the reactor; a sender
+ * built that way defines SRTLA_SENDER_USES_REACTOR, otherwise its latency is
+ * reported as not measured.
+ *
+ * All functions are thread-safe. srtla_thread_record_latency() is only
+ * called by the role's own thread.
+ */
+
+#ifndef SRTLA_THREAD_H
+#define SRTLA_THREAD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SRTLA_THREAD_FORWARD = 0,
+    SRTLA_THREAD_HOUSEKEEPING = 1,
+    SRTLA_THREAD_ROLE_COUNT
+} srtla_thread_role_t;
+
+#define SRTLA_THREAD_LATENCY_BUCKETS 24   /* bucket i: < 2^i us; last is open */
+
+typedef struct {
+    int32_t tid;                 /* 0 when the thread is not running */
+    int32_t nice;                /* as applied */
+    int32_t fifo_priority;       /* as applied; 0 = SCHED_OTHER */
+    int32_t fifo_refused;        /* 1 if SCHED_FIFO was asked for and refused */
+    uint64_t cpu_mask;           /* as applied; 0 = any CPU */
+    int32_t last_cpu;            /* -1 when unknown */
+    uint64_t migrations;         /* CPU changes between samples */
+    uint64_t samples;
+    uint64_t total_us;
+    uint64_t max_us;
+    uint64_t buckets[SRTLA_THREAD_LATENCY_BUCKETS];
+} srtla_thread_stats_t;
+
+/* nice -20..19, fifo_priority 0 (off) or 1..99, cpu_mask bit i = CPU i
+ * (0 = no restriction). Returns 0, or -1 if out of range. */
+int srtla_thread_configure(int role, int nice, int fifo_priority, uint64_t cpu_mask);
+
+/* From the role's thread when it starts / ends; name is at most 15 chars. */
+void srtla_thread_enter(int role, const char* name);
+void srtla_thread_leave(int role);
+
+void srtla_thread_record_latency(int role, int64_t late_ns);
+
+void srtla_thread_get_stats(int role, srtla_thread_stats_t* out);
+
+/* Upper bound (us) of the bucket holding quantile q (0..1), capped at max_us;
+ * 0 without samples. */
+uint64_t srtla_thread_latency_quantile(const srtla_thread_stats_t* stats, double q);
+
+void srtla_thread_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_THREAD_H
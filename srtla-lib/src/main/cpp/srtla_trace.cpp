@@ -0,0 +1,163 @@
+/*
+ * srtla_trace.cpp - Opt-in binary session trace in a memory-mapped ring file
+ *
+ * See srtla_trace.h for usage.
+ */
+
+#include "srtla_trace.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t capacity;
+    std::atomic<uint64_t> next;
+    int64_t start_mono_ns;
+    int64_t start_real_ns;
+};
+
+static_assert(sizeof(srtla_trace_record_t) == 32, "trace record layout changed");
+static_assert(sizeof(Header) <= SRTLA_TRACE_HEADER_SIZE, "trace header too large");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "header layout");
+
+std::mutex control_mutex;   // start/stop
+
+// Published by start, cleared by stop before it waits for writers to leave
+std::atomic<Header*> header(nullptr);
+std::atomic<int> writers(0);
+
+void* mapping = nullptr;
+size_t mapping_len = 0;
+srtla_trace_record_t* records = nullptr;
+uint32_t mask = 0;
+int64_t start_ns = 0;
+
+int64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void stop_locked() {
+    Header* h = header.exchange(nullptr, std::memory_order_acq_rel);
+    if (h == nullptr) return;
+    // An emit that saw the header before the exchange is still writing
+    while (writers.load(std::memory_order_acquire) != 0) sched_yield();
+    msync(mapping, mapping_len, MS_SYNC);
+    munmap(mapping, mapping_len);
+    mapping = nullptr;
+    mapping_len = 0;
+    records = nullptr;
+}
+
+}  // namespace
+
+extern "C" int srtla_trace_start(const char* path, int count) {
+    if (path == nullptr || path[0] == '\0') {
+        errno = EINVAL;
+        return -1;
+    }
+    uint32_t capacity = 1;
+    uint32_t wanted = count > 0 ? (uint32_t)count : SRTLA_TRACE_DEFAULT_RECORDS;
+    if (wanted > SRTLA_TRACE_MAX_RECORDS) wanted = SRTLA_TRACE_MAX_RECORDS;
+    while (capacity < wanted) capacity <<= 1;
+
+    std::lock_guard<std::mutex> lock(control_mutex);
+    stop_locked();
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) return -1;
+    size_t len = SRTLA_TRACE_HEADER_SIZE + (size_t)capacity * sizeof(srtla_trace_record_t);
+    if (ftruncate(fd, (off_t)len) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    void* base = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = err;
+        return -1;
+    }
+
+    // The file is sparse and zero-filled, so every slot starts with seq 0,
+    // which no record index produces
+    Header* h = static_cast<Header*>(base);
+    h->magic = SRTLA_TRACE_MAGIC;
+    h->version = SRTLA_TRACE_VERSION;
+    h->record_size = sizeof(srtla_trace_record_t);
+    h->capacity = capacity;
+    h->next.store(0, std::memory_order_relaxed);
+    h->start_mono_ns = clock_ns(CLOCK_MONOTONIC);
+    h->start_real_ns = clock_ns(CLOCK_REALTIME);
+
+    mapping = base;
+    mapping_len = len;
+    records = reinterpret_cast<srtla_trace_record_t*>(static_cast<uint8_t*>(base) +
+                                                      SRTLA_TRACE_HEADER_SIZE);
+    mask = capacity - 1;
+    start_ns = h->start_mono_ns;
+    header.store(h, std::memory_order_release);
+
+    srtla_trace_emit(SRTLA_TRACE_SESSION, SRTLA_TRACE_NO_LINK, 1, 0, 0);
+    return 0;
+}
+
+extern "C" void srtla_trace_stop(void) {
+    std::lock_guard<std::mutex> lock(control_mutex);
+    srtla_trace_emit(SRTLA_TRACE_SESSION, SRTLA_TRACE_NO_LINK, 0, 0, 0);
+    stop_locked();
+}
+
+extern "C" int srtla_trace_active(void) {
+    return header.load(std::memory_order_relaxed) != nullptr ? 1 : 0;
+}
+
+extern "C" void srtla_trace_emit(int type, int link, uint32_t a, uint32_t b, int64_t c) {
+    if (header.load(std::memory_order_relaxed) == nullptr) return;
+    srtla_trace_emit_at(clock_ns(CLOCK_MONOTONIC) - start_ns, type, link, a, b, c);
+}
+
+extern "C" void srtla_trace_emit_at(int64_t t_ns, int type, int link, uint32_t a, uint32_t b,
+                                    int64_t c) {
+    if (header.load(std::memory_order_relaxed) == nullptr) return;
+
+    writers.fetch_add(1, std::memory_order_acq_rel);
+    Header* h = header.load(std::memory_order_acquire);
+    if (h != nullptr) {
+        uint64_t index = h->next.fetch_add(1, std::memory_order_relaxed);
+        srtla_trace_record_t* r = &records[index & mask];
+        // Invalidate first so a reader never pairs the old seq with new fields
+        __atomic_store_n(&r->seq, 0u, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+        r->t_ns = t_ns;
+        r->type = (uint8_t)type;
+        r->link = link >= 0 && link < SRTLA_TRACE_NO_LINK ? (uint8_t)link : SRTLA_TRACE_NO_LINK;
+        r->reserved = 0;
+        r->a = a;
+        r->b = b;
+        r->c = c;
+        __atomic_store_n(&r->seq, (uint32_t)index + 1, __ATOMIC_RELEASE);
+    }
+    writers.fetch_sub(1, std::memory_order_release);
+}
+
+extern "C" uint64_t srtla_trace_count(void) {
+    std::lock_guard<std::mutex> lock(control_mutex);
+    Header* h = header.load(std::memory_order_relaxed);
+    return h != nullptr ? h->next.load(std::memory_order_relaxed) : 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * srtla_trace.h - Opt-in binary session trace in a memory-mapped ring file
+ *
+ * When a stream goes bad in the field the log ring holds a few hundred
+ * lines. The tracer writes fixed-size records to a ring file mapped into
+ * memory (MAP_SHARED), so the kernel keeps the pages even if the app is
+ * killed and the file can be pulled afterwards and decoded with
+ * bench/srtla_trace_decode.
+ *
+ * On the device a trace captures the session around the send loop, not the
+ * loop's own decisions:
+ *   - SESSION: trace start and stop
+ *   - RETRY: each srtla_start_android() attempt, its result, the backoff
+ *     wait and the first connection (srtla_thread_func)
+ *   - SOCKET: link socket registration, re-registration of a virtual IP and
+ *     notifyNetworkChange() rescans (JNI)
+ * PICK, ACK, NAK and WINDOW are written only by srtla_bench --trace, on its
+ * simulated clock; the fork's send loop has no emitters for them. IDLE is
+ * written by srtla_idle, which is not in the library until the fork's loop
+ * calls it.
+ *
+ * Emitting a record is a relaxed check, a vDSO clock read, a fetch_add to
+ * claim a slot and a handful of stores: no lock, no syscall, no allocation, safe from
+ * any thread. When tracing is off srtla_trace_emit() returns after the check.
+ *
+ * File layout (native-endian; keep in sync with srtla_trace_decode.cpp):
+ *
+ *   Header (SRTLA_TRACE_HEADER_SIZE bytes)
+ *     0  u32  magic          SRTLA_TRACE_MAGIC
+ *     4  u32  version        SRTLA_TRACE_VERSION
+ *     8  u32  record_size    sizeof(srtla_trace_record_t)
+ *    12  u32  capacity       records in the ring
+ *    16  u64  next           records ever claimed; slot = index % capacity
+ *    24  i64  start_mono_ns  CLOCK_MONOTONIC at start (records are relative)
+ *    32  i64  start_real_ns  CLOCK_REALTIME at start, to match wall-clock reports
+ *   Records follow at offset SRTLA_TRACE_HEADER_SIZE.
+ *
+ * A record is valid when its seq equals (index & 0xffffffff) + 1; a slot
+ * being rewritten, or never written, does not match and is skipped.
+ */
+
+#ifndef SRTLA_TRACE_H
+#define SRTLA_TRACE_H
+
+#include <stdint.h>
+
+#define SRTLA_TRACE_MAGIC        0x54545253u   /* "SRTT" */
+#define SRTLA_TRACE_VERSION      1
+#define SRTLA_TRACE_HEADER_SIZE  4096
+#define SRTLA_TRACE_DEFAULT_RECORDS  (1 << 16)   /* 2 MB file */
+#define SRTLA_TRACE_MAX_RECORDS      (1 << 22)
+
+#define SRTLA_TRACE_NO_LINK  0xff
+
+/* Record types; a, b, c as listed */
+#define SRTLA_TRACE_SESSION  1   /* a: 1 start / 0 stop */
+#define SRTLA_TRACE_PICK     2   /* a: srt seq, b: len (srtla_bench only) */
+#define SRTLA_TRACE_ACK      3   /* a: srt seq, b: rtt_us (srtla_bench only) */
+#define SRTLA_TRACE_NAK      4   /* a: srt seq (srtla_bench only) */
+#define SRTLA_TRACE_WINDOW   5   /* a: old window, b: new window (srtla_bench only) */
+#define SRTLA_TRACE_RETRY    8   /* a: SRTLA_TRACE_RETRY_*, b: attempt, c: value */
+#define SRTLA_TRACE_SOCKET   9   /* a: SRTLA_TRACE_SOCKET_*, b: fd, c: other fd */
+#define SRTLA_TRACE_IDLE    11   /* a: SRTLA_TRACE_IDLE_*, c: value (srtla_idle only) */
+
+#define SRTLA_TRACE_RETRY_ATTEMPT    1   /* c: 1 after a session that connected */
+#define SRTLA_TRACE_RETRY_RETURNED   2   /* c: srtla_start_android() result */
+#define SRTLA_TRACE_RETRY_CONNECTED  3
+#define SRTLA_TRACE_RETRY_WAIT       4   /* c: delay ms */
+
+#define SRTLA_TRACE_SOCKET_ADD       1
+#define SRTLA_TRACE_SOCKET_SUPERSEDE 3   /* b: new fd, c: old fd (re-registration) */
+#define SRTLA_TRACE_SOCKET_RESCAN    4   /* notifyNetworkChange() */
+
+#define SRTLA_TRACE_IDLE_ENTER       1   /* c: ms since the last SRT packet */
+#define SRTLA_TRACE_IDLE_LEAVE       2   /* c: ms idle */
+#define SRTLA_TRACE_IDLE_FORWARD     3   /* c: wake-to-forward us */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int64_t t_ns;      /* since start_mono_ns */
+    uint32_t seq;      /* (index & 0xffffffff) + 1 once complete */
+    uint8_t type;      /* SRTLA_TRACE_* */
+    uint8_t link;      /* conn index, SRTLA_TRACE_NO_LINK if none */
+    uint16_t reserved;
+    uint32_t a;
+    uint32_t b;
+    int64_t c;
+} srtla_trace_record_t;
+
+/* Map path as a ring of records (rounded up to a power of two, capped at
+ * SRTLA_TRACE_MAX_RECORDS; <= 0 = default). A running trace is stopped
+ * first. Returns 0, or -1 with errno set. */
+int srtla_trace_start(const char* path, int records);
+
+/* Flush and unmap; the file stays for decoding. */
+void srtla_trace_stop(void);
+
+int srtla_trace_active(void);
+
+void srtla_trace_emit(int type, int link, uint32_t a, uint32_t b, int64_t c);
+
+/* As srtla_trace_emit() with the record time given, in ns since start; for
+ * replay tools that run on a simulated clock. */
+void srtla_trace_emit_at(int64_t t_ns, int type, int link, uint32_t a, uint32_t b, int64_t c);
+
+/* Records emitted since start (including overwritten ones). */
+uint64_t srtla_trace_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SRTLA_TRACE_H
@@ -2,6 +2,9 @@ package com.dimadesu.bondbunny;
 
 import android.util.Log;
 
+import java.nio.ByteBuffer;
+import java.util.concurrent.CopyOnWriteArrayList;
+
 /**
  * JNI wrapper for native SRTLA functionality
  * Provides a single point of access to native methods
@@ -20,6 +23,11 @@ public class NativeSrtlaJni {
     }
     
     // Native methods - these will use the existing JNI implementation
+    // startSrtlaNative returns 0, START_FAILED (already running, or the thread could
+    // not be created) or START_PREVIOUS_NOT_EXITED: a previous sender that stop had
+    // to detach is still running, and no new one can start until it exits
+    public static final int START_FAILED = -1;
+    public static final int START_PREVIOUS_NOT_EXITED = -2;
     public static native int startSrtlaNative(String listenPort, String srtlaHost, 
                                              String srtlaPort, String ipsFile);
     public static native int stopSrtlaNative();
@@ -51,38 +59,96 @@ public class NativeSrtlaJni {
     public static native boolean isConnected();
     public static native boolean isRetrying();
     
+    // Single-call binary snapshot of every per-connection field plus group counters.
+    // Fills a direct ByteBuffer (see StatsSnapshot); returns bytes written, 0 for an
+    // unusable buffer, or -(required size) if the buffer is too small.
+    public static native int getStatsSnapshot(ByteBuffer buffer);
+    
+    private static final StatsSnapshot sharedSnapshot = new StatsSnapshot();
+    
     // Helper method to get all connection bitrate data in one call
-    public static ConnectionBitrateData[] getAllConnectionBitrates() {
+    public static synchronized ConnectionBitrateData[] getAllConnectionBitrates() {
         try {
-            double[] bitrates = getConnectionBitrates();
-            String[] types = getConnectionTypes();
-            String[] ips = getConnectionIPs();
-            int[] loads = getConnectionLoadPercentages();
-            int[] windows = getConnectionWindowSizes();
-            int[] inflight = getConnectionInFlightPackets();
-            boolean[] activeStatus = getConnectionActiveStatus();
-            
-            if (bitrates == null || types == null || ips == null || loads == null || 
-                windows == null || inflight == null || activeStatus == null) {
+            if (!sharedSnapshot.refresh()) {
                 return new ConnectionBitrateData[0];
             }
-            
-            int count = Math.min(Math.min(Math.min(bitrates.length, types.length), 
-                                         Math.min(ips.length, loads.length)),
-                                Math.min(Math.min(windows.length, inflight.length), activeStatus.length));
-            
-            ConnectionBitrateData[] result = new ConnectionBitrateData[count];
-            for (int i = 0; i < count; i++) {
-                result[i] = new ConnectionBitrateData(bitrates[i], types[i], ips[i], loads[i], 
-                                                     windows[i], inflight[i], activeStatus[i]);
-            }
-            
-            return result;
+            return sharedSnapshot.toConnectionBitrateData();
         } catch (Exception e) {
             Log.e(TAG, "Error getting connection bitrate data", e);
             return new ConnectionBitrateData[0];
         }
     }
+
+    // Self-test (srtla_selftest.h): a loopback SRTLA echo receiver to start the sender
+    // against (returns its port, -1 on failure), and the links registered with it
+    public static native int startSelfTestEcho();
+    public static native void stopSelfTestEcho();
+    public static native int getSelfTestEchoLinks();
+    // Pace pps synthetic SRT packets for durationMs into 127.0.0.1:port (the listen port,
+    // or the echo port for a baseline without the sender). Blocks. Returns {targetPps,
+    // durationMs, sent, delivered, duplicates, achievedPps, deliveredPps, p50Us, p99Us,
+    // maxUs, jitterUs, maxSendLateUs, cpuNsPerPacket (-1 = unknown), sustained (0/1)},
+    // or null if the echo is not running or the arguments are out of range.
+    public static native long[] runSelfTestStep(int port, int pps, int durationMs,
+                                                boolean throughSender);
+    // {clusters (0 = unknown), littleCpuMask, bigCpuMask} by maximum CPU frequency
+    public static native long[] getCoreClusters();
+
+    // Native thread roles (srtla_thread.h): the forwarding loop and the housekeeping /
+    // stats event thread. nice -20..19, fifoPriority 0 (SCHED_OTHER) or 1..99 (usually
+    // refused for apps, then nice still applies), cpuMask bit i = CPU i, 0 = any.
+    // Returns false if out of range.
+    public static final int THREAD_FORWARD = 0;
+    public static final int THREAD_HOUSEKEEPING = 1;
+    public static native boolean setThreadConfig(int role, int nice, int fifoPriority, long cpuMask);
+    // {tid, nice, fifoPriority, fifoRefused, cpuMask, lastCpu, migrations, samples,
+    //  meanLatencyUs, p50LatencyUs, p99LatencyUs, maxLatencyUs}; latency = wakeup to run.
+    // Percentiles are power-of-two bucket bounds. The samples and latency fields are
+    // -1 (not measured) for THREAD_FORWARD unless the send loop waits in the reactor.
+    public static native long[] getThreadStats(int role);
+
+    // Native logging: recent events from the in-memory ring (oldest first), and the
+    // minimum android.util.Log priority forwarded to logcat (default Log.INFO)
+    public static native String dumpNativeLog();
+    public static native void setNativeLogLevel(int level);
+
+    
+    // Native stats change events (bit mask, values match srtla_events.h). Delivered
+    // coalesced on the native "srtla-events" thread; listeners must not block.
+    public static final int EVENT_CONNECTION_UP = 0x01;
+    public static final int EVENT_CONNECTION_DOWN = 0x02;
+    public static final int EVENT_WINDOW_COLLAPSE = 0x04;
+    public static final int EVENT_RECONNECT = 0x08;
+    public static final int EVENT_THROUGHPUT = 0x10;
+    public static final int EVENT_CONNECTED = 0x20;
+    public static final int EVENT_STOPPED = 0x40;
+    
+    public interface StatsEventListener {
+        void onStatsEvent(int events);
+    }
+    
+    private static final CopyOnWriteArrayList<StatsEventListener> statsEventListeners =
+            new CopyOnWriteArrayList<>();
+    
+    public static void addStatsEventListener(StatsEventListener listener) {
+        statsEventListeners.addIfAbsent(listener);
+    }
+    
+    public static void removeStatsEventListener(StatsEventListener listener) {
+        statsEventListeners.remove(listener);
+    }
+    
+    // Called from native code (srtla_events.cpp) - do not rename
+    @SuppressWarnings("unused")
+    private static void onNativeStatsEvent(int events) {
+        for (StatsEventListener listener : statsEventListeners) {
+            try {
+                listener.onStatsEvent(events);
+            } catch (Exception e) {
+                Log.e(TAG, "Stats event listener failed", e);
+            }
+        }
+    }
     
     // Network change notification
     public static native void notifyNetworkChange();
@@ -91,6 +157,16 @@ public class NativeSrtlaJni {
     public static native void setNetworkSocket(String virtualIP, String realIP, 
                                              int networkType, int socketFD);
 
+    // Native relay manager: adopts a pre-bound relay socket and returns the relay's virtual
+    // IP (null if all relay slots are taken); re-adding a relayId replaces its socket. The
+    // caller still rewrites the IPs file and calls notifyNetworkChange(). Status: battery
+    // percent and ThermalState ordinal, -1 = unknown; mirrored into the stats snapshot
+    // (StatsSnapshot.getRelay*).
+    public static native String addRelay(String relayId, String name, String relayIP,
+                                         int relayPort, int socketFD);
+    public static native boolean removeRelay(String relayId);
+    public static native void setRelayStatus(String relayId, int battery, int thermal);
+
     // Moblink relay support: pre-bound socket whose destination is the relay's tunnel endpoint
     public static native void setRelaySocket(String virtualIP, String relayIP,
                                              int relayPort, int socketFD,
@@ -99,4 +175,12 @@ public class NativeSrtlaJni {
     // Socket helpers (used by SrtlaSender)
     public static native int createUdpSocketNative();
     public static native void closeSocketNative(int socketFD);
+    // SO_BUSY_POLL (microseconds) for sockets registered from now on; 0 = off (default)
+    public static native void setSocketBusyPoll(int usec);
+
+    // Binary session trace into a memory-mapped ring file (records <= 0 = default size);
+    // the file survives the process and is decoded offline
+    public static native boolean startTrace(String path, int records);
+    public static native void stopTrace();
+    public static native boolean isTraceActive();
 }
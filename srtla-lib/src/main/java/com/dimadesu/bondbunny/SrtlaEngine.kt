@@ -7,6 +7,7 @@ import com.dimadesu.bondbunny.moblink.MoblinkStreamerListener
 import com.dimadesu.bondbunny.moblink.ThermalState
 import android.os.Build
 import android.provider.Settings
+import java.io.File
 import java.util.Locale
 
 /**
@@ -80,6 +81,12 @@ class SrtlaEngine(private val context: Context) {
 
         /** Called whenever the relay list changes (connect, disconnect, tunnel, status). */
         fun onRelaysChanged(relays: List<RelayInfo>) {}
+
+        /**
+         * Coalesced native stats change events while SRTLA runs: a mask of
+         * `NativeSrtlaJni.EVENT_*` bits. Called on the native event thread — don't block.
+         */
+        fun onStatsEvent(events: Int) {}
     }
 
     // -------------------------------------------------------------------------
@@ -90,6 +97,10 @@ class SrtlaEngine(private val context: Context) {
     @Volatile private var moblinkStreamer: MoblinkStreamer? = null
     private val listeners = java.util.concurrent.CopyOnWriteArrayList<Listener>()
 
+    private val statsEventListener = NativeSrtlaJni.StatsEventListener { events ->
+        listeners.forEach { it.onStatsEvent(events) }
+    }
+
     /** SRTLA receiver address — saved for Moblink tunnel activation. */
     @Volatile private var srtlaHost: String = ""
     @Volatile private var srtlaPort: Int = 0
@@ -101,6 +112,41 @@ class SrtlaEngine(private val context: Context) {
     /** True when the native SRTLA thread is running. */
     val isRunning: Boolean get() = NativeSrtlaJni.isRunningSrtlaNative()
 
+    /**
+     * Record connection attempts and retries, socket registrations and re-registrations
+     * and network change rescans into [file] (app storage,
+     * default `filesDir/srtla-trace.bin`) as a ring of [records] fixed-size entries. The
+     * send loop's own decisions (link picks, ACK/NAKs, windows) are not captured. Decode
+     * it offline with bench/srtla_trace_decode.
+     * The file keeps the events even if the process dies; a new trace overwrites it.
+     */
+    fun startTrace(file: File = File(context.filesDir, "srtla-trace.bin"), records: Int = 0): Boolean {
+        Log.i(TAG, "Starting session trace: ${file.absolutePath}")
+        return NativeSrtlaJni.startTrace(file.absolutePath, records)
+    }
+
+    fun stopTrace() = NativeSrtlaJni.stopTrace()
+
+    val isTraceActive: Boolean get() = NativeSrtlaJni.isTraceActive()
+
+    /**
+     * Find out what this phone sustains before going live: runs the real sender against
+     * a loopback echo receiver and paces synthetic SRT traffic through it at [rates]
+     * packets per second, [stepMs] each, on little and big cores (see [SrtlaSelfTest]).
+     * Blocks for up to a minute or so; call from a background thread. Returns null while
+     * SRTLA is running. Each run is stored per app build, see [selfTestHistory].
+     */
+    fun runSelfTest(
+        rates: IntArray = SrtlaSelfTest.DEFAULT_RATES,
+        stepMs: Int = SrtlaSelfTest.DEFAULT_STEP_MS,
+    ): SrtlaSelfTest.Report? {
+        Log.i(TAG, "Starting self-test: ${rates.joinToString()} pps, $stepMs ms per step")
+        return SrtlaSelfTest(context).run(rates = rates, stepMs = stepMs)
+    }
+
+    /** Stored self-test runs by app build (`versionName-versionCode`), oldest first. */
+    fun selfTestHistory(): Map<String, List<SrtlaSelfTest.Report>> = SrtlaSelfTest(context).history()
+
     /** Internal relay map keyed by relay ID. Guarded by [relayLock]. */
     private val relayLock = Any()
     private val relayMap = LinkedHashMap<String, RelayInfo>()
@@ -215,6 +261,7 @@ class SrtlaEngine(private val context: Context) {
 
         val s = SrtlaSender(context)
         sender = s
+        NativeSrtlaJni.addStatsEventListener(statsEventListener)
 
         s.start(host, port, listenPort, object : SrtlaSender.Listener {
             override fun onStatus(message: String) {
@@ -255,6 +302,7 @@ class SrtlaEngine(private val context: Context) {
 
         sender?.stop()
         sender = null
+        NativeSrtlaJni.removeStatsEventListener(statsEventListener)
         srtlaHost = ""
         srtlaPort = 0
     }
@@ -325,6 +373,7 @@ class SrtlaEngine(private val context: Context) {
                 relayMap[relayId] = (existing ?: RelayInfo(relayId, name, null, null, false))
                     .copy(battery = batteryPercentage, thermal = thermalState)
             }
+            NativeSrtlaJni.setRelayStatus(relayId, batteryPercentage ?: -1, thermalState?.ordinal ?: -1)
             publishRelays()
         }
 
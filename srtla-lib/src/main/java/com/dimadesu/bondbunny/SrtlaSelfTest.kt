@@ -0,0 +1,273 @@
+package com.dimadesu.bondbunny
+
+import android.content.Context
+import android.os.Build
+import android.util.Log
+import java.io.File
+import java.nio.ByteBuffer
+import kotlinx.serialization.Serializable
+import kotlinx.serialization.encodeToString
+import kotlinx.serialization.json.Json
+
+/**
+ * On-device throughput self-test (native side: srtla_selftest.h).
+ *
+ * Starts the native sender against a loopback SRTLA echo receiver over [LINKS] loopback
+ * link sockets, then paces synthetic SRT packets into its listen port at stepped rates,
+ * so the whole bonding path (link selection, windows, ACKs) carries the load.
+ * Each step reports delivery, transit time and jitter, and the forwarding thread's CPU
+ * time per packet; the rate ladder runs once with that thread pinned to the little
+ * cores and once on the big cores (once on any core if the CPU is not heterogeneous)
+ * and stops at the first step that is not sustained. A step sent straight to the echo
+ * measures the harness, so the jitter the sender adds can be told apart. While each
+ * step runs, the stats getters the UI polls are timed to give the JNI polling cost.
+ *
+ * Results are appended to `filesDir/selftest/<versionName>-<versionCode>.jsonl`, one
+ * run per line, so releases can be compared on the same phones ([history]).
+ *
+ * Blocking; call from a background thread while no stream is running.
+ */
+class SrtlaSelfTest internal constructor(private val context: Context) {
+
+    companion object {
+        private const val TAG = "SrtlaSelfTest"
+
+        /** Packet rates tried in order. Payloads are 1316 bytes: 1000 pps is ~10.5 Mbps. */
+        @JvmField
+        val DEFAULT_RATES = intArrayOf(500, 1000, 2000, 4000, 8000, 16000)
+        const val DEFAULT_STEP_MS = 3000
+        const val DEFAULT_LISTEN_PORT = 6099
+
+        private const val LINKS = 2
+        private const val PAYLOAD_BITS = 1316 * 8
+        private const val REGISTER_TIMEOUT_MS = 10_000L
+        private const val POLL_INTERVAL_MS = 100L
+        private const val RESULTS_DIR = "selftest"
+
+        private val json = Json { ignoreUnknownKeys = true }
+    }
+
+    /** One rate step. Times in microseconds; [cpuNsPerPacket] is -1 if unknown. */
+    @Serializable
+    data class Step(
+        val cores: String,
+        val targetPps: Long,
+        val sent: Long,
+        val delivered: Long,
+        val duplicates: Long,
+        val achievedPps: Long,
+        val deliveredPps: Long,
+        val p50Us: Long,
+        val p99Us: Long,
+        val maxUs: Long,
+        val jitterUs: Long,
+        val addedJitterUs: Long,
+        val maxSendLateUs: Long,
+        val cpuNsPerPacket: Long,
+        val sustained: Boolean,
+        /** Mean cost of one getAllStats() / getStatsSnapshot() call during the step. */
+        val pollAllStatsUs: Double,
+        val pollSnapshotUs: Double,
+    )
+
+    /** One self-test run; [maxSustainedPps] and [maxSustainedMbps] are keyed by core class. */
+    @Serializable
+    data class Report(
+        val build: String,
+        val device: String,
+        val soc: String,
+        val os: String,
+        val timestampMs: Long,
+        val coreClusters: Int,
+        val baselineJitterUs: Long,
+        val maxSustainedPps: Map<String, Long>,
+        val maxSustainedMbps: Map<String, Double>,
+        val steps: List<Step>,
+    )
+
+    /**
+     * Run the self-test with the sender listening on [listenPort]. Returns null if SRTLA
+     * is already running or the loopback setup fails. The forwarding thread's affinity
+     * is restored afterwards.
+     */
+    fun run(
+        listenPort: Int = DEFAULT_LISTEN_PORT,
+        rates: IntArray = DEFAULT_RATES,
+        stepMs: Int = DEFAULT_STEP_MS,
+    ): Report? {
+        if (rates.isEmpty()) return null
+        if (NativeSrtlaJni.isRunningSrtlaNative()) {
+            Log.w(TAG, "SRTLA is running, not starting the self-test")
+            return null
+        }
+        val echoPort = NativeSrtlaJni.startSelfTestEcho()
+        if (echoPort < 0) return null
+        val threadConfig = NativeSrtlaJni.getThreadStats(NativeSrtlaJni.THREAD_FORWARD)
+
+        try {
+            if (!startSender(listenPort, echoPort)) return null
+
+            val baseline = NativeSrtlaJni.runSelfTestStep(echoPort, rates.first(), stepMs, false)
+                ?: return null
+            val baselineJitterUs = baseline[10]
+            Log.i(TAG, "Harness baseline: jitter $baselineJitterUs us, p99 ${baseline[8]} us")
+
+            val clusters = NativeSrtlaJni.getCoreClusters()
+            val phases = if (clusters[0] >= 2) {
+                listOf("little" to clusters[1], "big" to clusters[2])
+            } else {
+                listOf("any" to 0L)
+            }
+
+            val steps = ArrayList<Step>()
+            val maxPps = LinkedHashMap<String, Long>()
+            for ((cores, mask) in phases) {
+                NativeSrtlaJni.setThreadConfig(NativeSrtlaJni.THREAD_FORWARD,
+                    threadConfig[1].toInt(), threadConfig[2].toInt(), mask)
+                maxPps[cores] = 0L
+                for (rate in rates) {
+                    val step = runStep(cores, listenPort, rate, stepMs, baselineJitterUs) ?: break
+                    steps.add(step)
+                    Log.i(TAG, "$cores $rate pps: ${step.deliveredPps} delivered, p99 ${step.p99Us} us, " +
+                        "${step.cpuNsPerPacket} ns/packet, sustained ${step.sustained}")
+                    if (!step.sustained) break
+                    maxPps[cores] = maxOf(maxPps.getValue(cores), step.deliveredPps)
+                }
+            }
+
+            val report = Report(
+                build = buildTag(),
+                device = "${Build.MANUFACTURER} ${Build.MODEL}",
+                soc = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) Build.SOC_MODEL else Build.HARDWARE,
+                os = "Android ${Build.VERSION.RELEASE} (API ${Build.VERSION.SDK_INT})",
+                timestampMs = System.currentTimeMillis(),
+                coreClusters = clusters[0].toInt(),
+                baselineJitterUs = baselineJitterUs,
+                maxSustainedPps = maxPps,
+                maxSustainedMbps = maxPps.mapValues { it.value * PAYLOAD_BITS / 1e6 },
+                steps = steps,
+            )
+            store(report)
+            return report
+        } finally {
+            NativeSrtlaJni.setThreadConfig(NativeSrtlaJni.THREAD_FORWARD,
+                threadConfig[1].toInt(), threadConfig[2].toInt(), threadConfig[4])
+            NativeSrtlaJni.stopSrtlaNative()
+            NativeSrtlaJni.stopSelfTestEcho()
+        }
+    }
+
+    /** Stored runs by build tag (`versionName-versionCode`), oldest first. */
+    fun history(): Map<String, List<Report>> {
+        val dir = File(context.filesDir, RESULTS_DIR)
+        val files = dir.listFiles { f -> f.name.endsWith(".jsonl") } ?: return emptyMap()
+        return files.sortedBy { it.lastModified() }.associate { file ->
+            file.name.removeSuffix(".jsonl") to file.readLines().mapNotNull { line ->
+                runCatching { json.decodeFromString<Report>(line) }.getOrNull()
+            }
+        }
+    }
+
+    // Loopback links to the echo, registered like network sockets; native owns them after stop
+    private fun startSender(listenPort: Int, echoPort: Int): Boolean {
+        val ipsFile = File(context.filesDir, "srtla_selftest_virtual_ips.txt")
+        val virtualIps = (1..LINKS).map { "10.0.99.$it" }
+        for ((i, virtualIp) in virtualIps.withIndex()) {
+            val fd = NativeSrtlaJni.createUdpSocketNative()
+            if (fd < 0) return false
+            NativeSrtlaJni.setNetworkSocket(virtualIp, "127.0.0.1", 1 + i % 2, fd)
+        }
+        ipsFile.writeText(virtualIps.joinToString("\n", postfix = "\n"))
+
+        if (NativeSrtlaJni.startSrtlaNative(listenPort.toString(), "127.0.0.1",
+                echoPort.toString(), ipsFile.absolutePath) != 0) {
+            return false
+        }
+        val deadline = System.currentTimeMillis() + REGISTER_TIMEOUT_MS
+        while (System.currentTimeMillis() < deadline) {
+            if (NativeSrtlaJni.isConnected() && NativeSrtlaJni.getSelfTestEchoLinks() >= LINKS) {
+                return true
+            }
+            Thread.sleep(POLL_INTERVAL_MS)
+        }
+        Log.w(TAG, "Links did not register with the echo receiver in time")
+        return false
+    }
+
+    private fun runStep(cores: String, listenPort: Int, rate: Int, stepMs: Int,
+                        baselineJitterUs: Long): Step? {
+        val poller = Poller()
+        poller.start()
+        val v = try {
+            NativeSrtlaJni.runSelfTestStep(listenPort, rate, stepMs, true)
+        } finally {
+            poller.finish()
+        }
+        if (v == null) return null
+        return Step(
+            cores = cores,
+            targetPps = v[0], sent = v[2], delivered = v[3], duplicates = v[4],
+            achievedPps = v[5], deliveredPps = v[6],
+            p50Us = v[7], p99Us = v[8], maxUs = v[9],
+            jitterUs = v[10], addedJitterUs = maxOf(0L, v[10] - baselineJitterUs),
+            maxSendLateUs = v[11], cpuNsPerPacket = v[12], sustained = v[13] != 0L,
+            pollAllStatsUs = poller.allStatsUs, pollSnapshotUs = poller.snapshotUs,
+        )
+    }
+
+    // Times the UI's stats getters at the UI's pace while a step runs
+    private class Poller : Thread("srtla-selftest-poll") {
+        @Volatile private var running = true
+        private var allStatsNs = 0L
+        private var snapshotNs = 0L
+        private var polls = 0
+        private var buffer = ByteBuffer.allocateDirect(16 * 1024)
+
+        val allStatsUs: Double get() = if (polls > 0) allStatsNs / 1000.0 / polls else 0.0
+        val snapshotUs: Double get() = if (polls > 0) snapshotNs / 1000.0 / polls else 0.0
+
+        override fun run() {
+            while (running) {
+                var t = System.nanoTime()
+                NativeSrtlaJni.getAllStats()
+                allStatsNs += System.nanoTime() - t
+                t = System.nanoTime()
+                val written = NativeSrtlaJni.getStatsSnapshot(buffer)
+                snapshotNs += System.nanoTime() - t
+                if (written < 0) buffer = ByteBuffer.allocateDirect(-written)
+                polls++
+                try {
+                    Thread.sleep(POLL_INTERVAL_MS)
+                } catch (e: InterruptedException) {
+                    break
+                }
+            }
+        }
+
+        fun finish() {
+            running = false
+            interrupt()
+            join()
+        }
+    }
+
+    private fun store(report: Report) {
+        val dir = File(context.filesDir, RESULTS_DIR)
+        if (!dir.isDirectory && !dir.mkdirs()) {
+            Log.w(TAG, "Cannot create ${dir.absolutePath}, result not stored")
+            return
+        }
+        File(dir, "${report.build}.jsonl").appendText(json.encodeToString(report) + "\n")
+    }
+
+    private fun buildTag(): String {
+        val info = context.packageManager.getPackageInfo(context.packageName, 0)
+        val code = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.P) {
+            info.longVersionCode
+        } else {
+            @Suppress("DEPRECATION")
+            info.versionCode.toLong()
+        }
+        return "${info.versionName ?: "unknown"}-$code".replace(Regex("[^A-Za-z0-9._-]"), "_")
+    }
+}
@@ -71,15 +71,9 @@ public class SrtlaSender {
     // Current Wi-Fi network, used to bind Moblink relay sockets (relays live on the LAN)
     private volatile Network wifiNetwork;
 
-    // Moblink relay tracking: relayId -> allocated relay virtual IP
+    // Moblink relay tracking: relayId -> relay virtual IP (assigned by the native relay manager)
     private final Map<String, String> relayIdToVirtualIp = new ConcurrentHashMap<>();
 
-    // Allocated relay virtual-IP slots (10.0.100.N)
-    private final java.util.Set<Integer> usedRelaySlots =
-            java.util.concurrent.ConcurrentHashMap.newKeySet();
-
-    private static final String RELAY_IP_PREFIX = "10.0.100.";
-
     public SrtlaSender(Context context) {
         this.context = context.getApplicationContext();
         this.connectivityManager =
@@ -108,7 +102,6 @@ public class SrtlaSender {
         virtualConnections.clear();
         networkState.clear();
         relayIdToVirtualIp.clear();
-        usedRelaySlots.clear();
 
         setupDedicatedNetworkCallbacks();
 
@@ -142,6 +135,10 @@ public class SrtlaSender {
                 Log.w(TAG, "Native SRTLA start returned 0 but process is not running");
                 if (listener != null) listener.onError("Service failed to start. Native code returned 0");
             }
+        } else if (result == NativeSrtlaJni.START_PREVIOUS_NOT_EXITED) {
+            Log.e(TAG, "Native SRTLA refused to start: the previous session has not exited");
+            if (listener != null) listener.onError("Previous session is still shutting down. "
+                    + "Try again, or restart the app if this persists");
         } else {
             Log.e(TAG, "Native SRTLA failed to start with code: " + result);
             if (listener != null) listener.onError("Service failed to start (code: " + result + ")");
@@ -489,9 +486,10 @@ public class SrtlaSender {
 
     /**
      * Add (or replace) a Moblink relay as an extra SRTLA bonding link. The relay is reachable on
-     * the local network at {@code relayHost:relayPort}; its socket is bound to Wi-Fi and registered
-     * with the native sender using a custom destination so its packets go to the relay (which
-     * forwards them to the SRTLA receiver). Safe to call from any thread.
+     * the local network at {@code relayHost:relayPort}; its socket is bound to Wi-Fi and handed to
+     * the native relay manager, which assigns its virtual IP, and the sender picks the link up
+     * with the relay as destination (it forwards to the SRTLA receiver). Safe to call from any
+     * thread.
      */
     public synchronized void addMoblinkRelay(String relayId, String relayName,
                                               String relayHost, int relayPort) {
@@ -500,25 +498,26 @@ public class SrtlaSender {
             return;
         }
 
-        // Replace any existing tunnel for this relay (e.g. relay re-tunnelled with a new port).
-        removeMoblinkRelay(relayId);
-
-        String virtualIp = allocateRelayVirtualIp();
-        if (virtualIp == null) {
-            Log.e(TAG, "No free relay virtual IP slots for relay " + relayId);
-            return;
-        }
-
         int socket = createRelaySocket();
         if (socket < 0) {
             Log.e(TAG, "Failed to create relay socket for " + relayId);
-            freeRelayVirtualIp(virtualIp);
             return;
         }
 
+        // Re-adding a known relay (e.g. re-tunnelled with a new port) replaces its socket
+        // natively and keeps its virtual IP.
+        String virtualIp = NativeSrtlaJni.addRelay(relayId, relayName, relayHost, relayPort, socket);
+        if (virtualIp == null) {
+            Log.e(TAG, "No free relay slot for relay " + relayId);
+            NativeSrtlaJni.closeSocketNative(socket);
+            return;
+        }
+
+        String previous = relayIdToVirtualIp.put(relayId, virtualIp);
+        if (previous != null && !previous.equals(virtualIp)) {
+            virtualConnections.remove(previous);
+        }
         virtualConnections.put(virtualIp, socket);
-        relayIdToVirtualIp.put(relayId, virtualIp);
-        NativeSrtlaJni.setRelaySocket(virtualIp, relayHost, relayPort, socket, relayName);
         Log.i(TAG, "Added Moblink relay " + relayId + " '" + relayName + "': " + virtualIp + " -> "
                 + relayHost + ":" + relayPort + " (fd " + socket + ")");
 
@@ -535,12 +534,13 @@ public class SrtlaSender {
             return;
         }
         virtualConnections.remove(virtualIp);
-        freeRelayVirtualIp(virtualIp);
+        NativeSrtlaJni.removeRelay(relayId);
         Log.i(TAG, "Removed Moblink relay " + relayId + " (" + virtualIp + ")");
 
         refreshIpsFile("removing relay " + relayId);
     }
 
+    // The native sender picks relay changes up by rescanning the IPs file
     private void refreshIpsFile(String reason) {
         if (!NativeSrtlaJni.isRunningSrtlaNative()) {
             return;
@@ -569,25 +569,6 @@ public class SrtlaSender {
         return NativeSrtlaJni.createUdpSocketNative();
     }
 
-    private String allocateRelayVirtualIp() {
-        for (int i = 1; i <= 254; i++) {
-            if (usedRelaySlots.add(i)) {
-                return RELAY_IP_PREFIX + i;
-            }
-        }
-        return null;
-    }
-
-    private void freeRelayVirtualIp(String virtualIp) {
-        if (virtualIp != null && virtualIp.startsWith(RELAY_IP_PREFIX)) {
-            try {
-                usedRelaySlots.remove(Integer.parseInt(virtualIp.substring(RELAY_IP_PREFIX.length())));
-            } catch (NumberFormatException ignored) {
-                // not a relay slot
-            }
-        }
-    }
-
     // -------------------------------------------------------------------------
     // Network wait / IPs file
     // -------------------------------------------------------------------------
@@ -652,7 +633,6 @@ public class SrtlaSender {
         virtualConnections.clear();
         networkState.clear();
         relayIdToVirtualIp.clear();
-        usedRelaySlots.clear();
         wifiNetwork = null;
         Log.i(TAG, "Virtual connections cleanup complete - native code handles socket cleanup");
     }
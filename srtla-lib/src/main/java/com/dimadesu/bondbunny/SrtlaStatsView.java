@@ -3,6 +3,7 @@ package com.dimadesu.bondbunny;
 import android.content.Context;
 import android.os.Handler;
 import android.os.Looper;
+import android.os.SystemClock;
 import android.util.AttributeSet;
 import android.util.Log;
 import android.view.LayoutInflater;
@@ -14,9 +15,14 @@ import com.dimadesu.bondbunny.moblink.ThermalState;
 import com.dimadesu.bondbunny.srtlalib.R;
 
 import java.util.List;
+import java.util.Locale;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 /**
- * Self-contained view that polls native SRTLA stats every second and renders them.
+ * Self-contained view that renders native SRTLA stats. It refreshes on native stats
+ * events (link up/down, window collapse, reconnect, throughput changes), at most a
+ * few times per second, and still polls once a second while streaming, since
+ * bitrate, in-flight and RTT move without raising an event.
  *
  * <p>Embed directly in any layout:</p>
  * <pre>
@@ -33,6 +39,14 @@ public class SrtlaStatsView extends LinearLayout {
 
     private static final String TAG = "SrtlaStatsView";
 
+    // Refresh interval when no native events arrive: the 1 Hz stats refresh while
+    // streaming, a slow check for a start while stopped
+    private static final long STREAMING_POLL_MS = 1000;
+    private static final long STOPPED_POLL_MS = 5000;
+    // Events can arrive every SRTLA_EVENTS_COALESCE_MS (50 ms); the view redraws at
+    // most this often, the events in between folded into one refresh
+    private static final long MIN_EVENT_REFRESH_MS = 250;
+
     private TextView textTotalBitrate;
     private LinearLayout connectionsContainer;
     private TextView textNoConnections;
@@ -44,6 +58,20 @@ public class SrtlaStatsView extends LinearLayout {
 
     private final Handler uiHandler = new Handler(Looper.getMainLooper());
     private Runnable statsUpdateRunnable;
+    // Last update (uptime ms), written on the UI thread
+    private volatile long lastUpdateMs;
+    private final AtomicBoolean eventRefreshPending = new AtomicBoolean(false);
+    private final Runnable eventRefreshRunnable = () -> {
+        eventRefreshPending.set(false);
+        refreshNow();
+    };
+    private final NativeSrtlaJni.StatsEventListener statsEventListener = events -> {
+        if (eventRefreshPending.compareAndSet(false, true)) {
+            long wait = lastUpdateMs + MIN_EVENT_REFRESH_MS - SystemClock.uptimeMillis();
+            uiHandler.postDelayed(eventRefreshRunnable, Math.max(0, wait));
+        }
+    };
+    private final StatsSnapshot statsSnapshot = new StatsSnapshot();
     private OnServiceStoppedListener onServiceStoppedListener;
 
     /**
@@ -170,10 +198,13 @@ public class SrtlaStatsView extends LinearLayout {
 
             @Override
             public void run() {
+                lastUpdateMs = SystemClock.uptimeMillis();
+                long nextPollMs = STOPPED_POLL_MS;
                 try {
                     boolean isRunning = NativeSrtlaJni.isRunningSrtlaNative();
                     if (isRunning) {
                         wasRunning = true;
+                        nextPollMs = STREAMING_POLL_MS;
                         updateConnectionStats();
                     } else {
                         updateConnectionStats();
@@ -189,16 +220,29 @@ public class SrtlaStatsView extends LinearLayout {
                     Log.e(TAG, "Error in stats update loop", e);
                     clearConnectionsDisplay();
                 }
-                uiHandler.postDelayed(this, 1000); // Keep polling
+                uiHandler.postDelayed(this, nextPollMs); // Keep polling
             }
         };
+        NativeSrtlaJni.addStatsEventListener(statsEventListener);
         uiHandler.post(statsUpdateRunnable);
     }
+
+    // Run an update now and restart the fallback poll from here. UI thread only
+    private void refreshNow() {
+        Runnable runnable = statsUpdateRunnable;
+        if (runnable == null) return;
+        uiHandler.removeCallbacks(runnable);
+        runnable.run();
+    }
     
     public void stopStatsUpdates() {
         Log.i(TAG, "stopStatsUpdates called - nativeRunning=" + NativeSrtlaJni.isRunningSrtlaNative());
+        NativeSrtlaJni.removeStatsEventListener(statsEventListener);
+        uiHandler.removeCallbacks(eventRefreshRunnable);
+        eventRefreshPending.set(false);
         if (statsUpdateRunnable != null) {
             uiHandler.removeCallbacks(statsUpdateRunnable);
+            statsUpdateRunnable = null;
         }
         // Always clear stats when explicitly stopping updates
         Log.i(TAG, "Clearing stats display");
@@ -212,25 +256,14 @@ public class SrtlaStatsView extends LinearLayout {
     private void updateConnectionStats() {
         // Check if native SRTLA is running and show its stats instead
         if (NativeSrtlaJni.isRunningSrtlaNative()) {
-            // First check connection status
-            boolean isConnected = NativeSrtlaJni.isConnected();
-            boolean isRetrying = NativeSrtlaJni.isRetrying();
-            int retryCount = NativeSrtlaJni.getRetryCount();
-            
-            // Log the current state for debugging
-            Log.i(TAG, String.format("updateConnectionStats: connected=%b, retrying=%b, retryCount=%d", 
-                  isConnected, isRetrying, retryCount));
-            
-            // Get stats - this might return empty string if retrying/connecting
-            String nativeStats = NativeSrtlaJni.getAllStats();
-            boolean hasStats = nativeStats != null && !nativeStats.isEmpty() && nativeStats.contains("Total bitrate:");
+            // First check connection status (one JNI call for all status flags)
+            statsSnapshot.refresh();
+            boolean isConnected = statsSnapshot.isConnected();
+            boolean isRetrying = statsSnapshot.isRetrying();
+            int retryCount = statsSnapshot.getRetryCount();
             
-            // Log stats state for debugging
-            Log.i(TAG, String.format("Stats check: hasStats=%b, statsLen=%d, isEmpty=%b, hasTotalBitrate=%b",
-                  hasStats, 
-                  nativeStats != null ? nativeStats.length() : -1,
-                  nativeStats == null || nativeStats.isEmpty(),
-                  nativeStats != null && nativeStats.contains("Total bitrate:")));
+            // Same state checks getAllStats() applies, without building its text
+            boolean hasStats = statsSnapshot.hasStats();
             
             // Check retry state first - regardless of isConnected (handles server stops)
             if (isRetrying || retryCount > 0) {
@@ -242,8 +275,6 @@ public class SrtlaStatsView extends LinearLayout {
                 // Clear connection list
                 connectionsContainer.removeAllViews();
                 textNoConnections.setVisibility(View.GONE);
-                
-                Log.i(TAG, "Showing retry UI: " + statusMessage);
             } else if (!isConnected && !hasStats) {
                 // Show initial connecting status (not connected, no stats yet)
                 String statusMessage = "Connecting to SRTLA receiver...";
@@ -253,12 +284,9 @@ public class SrtlaStatsView extends LinearLayout {
                 // Clear connection list
                 connectionsContainer.removeAllViews();
                 textNoConnections.setVisibility(View.GONE);
-                
-                Log.i(TAG, "Showing connecting UI");
             } else if (hasStats) {
                 // We have actual stats to display (even if bitrate is 0)
-                parseAndDisplayConnections(nativeStats);
-                Log.i(TAG, "Displaying stats");
+                displayConnections();
             } else {
                 // Connected but no stats yet - give it a moment
                 // This can happen briefly when connections are established but stats not ready
@@ -267,8 +295,6 @@ public class SrtlaStatsView extends LinearLayout {
                 
                 connectionsContainer.removeAllViews();
                 textNoConnections.setVisibility(View.GONE);
-                
-                Log.i(TAG, "Waiting for stats (connected=" + isConnected + ", hasStats=" + hasStats + ")");
             }
         } else {
             // Service not running - clear display
@@ -276,127 +302,57 @@ public class SrtlaStatsView extends LinearLayout {
         }
     }
 
-    private void parseAndDisplayConnections(String statsText) {
-        // Handle empty or no-connection state
-        if (statsText == null || statsText.isEmpty() || !statsText.contains("Total bitrate:")) {
-            // Don't clear if we're showing a retry/connecting status
-            if (textTotalBitrate != null && textTotalBitrate.getVisibility() == View.VISIBLE) {
-                String text = textTotalBitrate.getText().toString();
-                if (text.contains("Connecting") || text.contains("Reconnecting")) {
-                    // Keep the status message, just clear the connection list
-                    connectionsContainer.removeAllViews();
-                    textNoConnections.setVisibility(View.GONE);
-                    return;
-                }
-            }
-            
-            clearConnectionsDisplay();
-            return;
-        }
-        
+    private void displayConnections() {
+        int count = statsSnapshot.getConnectionCount();
         // Clear existing views
         connectionsContainer.removeAllViews();
-        textNoConnections.setVisibility(android.view.View.GONE);
-        
-        // Parse the stats text to extract connection information
-        // Format: "Total bitrate: X.X Mbps\n\nWIFI\n  Bitrate: ... \n  Window: ...\n  Packets in-flight: ...\n\n..."
-        String[] sections = statsText.split("\n\n");
-        android.view.LayoutInflater inflater = android.view.LayoutInflater.from(getContext());
+        textNoConnections.setVisibility(View.GONE);
         
-        // Extract and display total bitrate from first section
-        if (sections.length > 0 && sections[0].startsWith("Total bitrate:")) {
-            textTotalBitrate.setText(sections[0]);
-            textTotalBitrate.setVisibility(android.view.View.VISIBLE);
-        }
+        textTotalBitrate.setText(String.format(Locale.US, "Total bitrate: %.2f Mbps",
+                statsSnapshot.getTotalBitrateMbps()));
+        textTotalBitrate.setVisibility(View.VISIBLE);
         
-        for (String section : sections) {
-            if (section.trim().isEmpty() || section.startsWith("Total bitrate:")) {
-                continue; // Skip empty sections and total bitrate line
-            }
+        LayoutInflater inflater = LayoutInflater.from(getContext());
+        for (int i = 0; i < count; i++) {
+            String networkType = statsSnapshot.getConnectionType(i);
+            int windowSize = statsSnapshot.getWindowSize(i);
+            int inFlight = statsSnapshot.getInFlightPackets(i);
+            int rttMs = statsSnapshot.getRttMs(i);
+            boolean isActive = statsSnapshot.isActive(i);
             
-            // Parse connection section
-            try {
-                String[] lines = section.trim().split("\n");
-                if (lines.length < 5) continue; // Need at least 5 lines: type, bitrate, window, in-flight, rtt
-                
-                // First line is network type
-                String networkType = lines[0].trim();
-                
-                // Parse bitrate line: "  Bitrate: 45.2 Mbps 45%"
-                String bitrateLine = lines[1].trim();
-                String bitrate = "N/A";
-                String load = "N/A";
-                if (bitrateLine.startsWith("Bitrate:")) {
-                    String bitrateData = bitrateLine.substring(8).trim(); // Remove "Bitrate:"
-                    String[] bitrateParts = bitrateData.split(" ");
-                    if (bitrateParts.length >= 2) {
-                        bitrate = bitrateParts[0] + " " + bitrateParts[1]; // e.g., "45.2 Mbps"
-                    }
-                    if (bitrateParts.length >= 3) {
-                        load = bitrateParts[2]; // e.g., "45%"
-                    }
-                }
-                
-                // Parse window line: "  Window: 15234"
-                String windowLine = lines[2].trim();
-                int windowSize = 0;
-                if (windowLine.startsWith("Window:")) {
-                    windowSize = Integer.parseInt(windowLine.substring(7).trim());
-                }
-                
-                // Parse in-flight line: "  Packets in-flight: 125"
-                String inFlightLine = lines[3].trim();
-                int inFlight = 0;
-                if (inFlightLine.startsWith("Packets in-flight:")) {
-                    inFlight = Integer.parseInt(inFlightLine.substring(18).trim());
-                }
-                
-                // Parse RTT line: "  RTT: 45 ms" or "  RTT: N/A"
-                String rttLine = lines[4].trim();
-                String rtt = "N/A";
-                if (rttLine.startsWith("RTT:")) {
-                    rtt = rttLine.substring(4).trim(); // e.g., "45 ms" or "N/A"
-                }
-                
-                // Determine if connection is active (has bitrate > 0 or in-flight packets)
-                boolean isActive = inFlight > 0 || (bitrate != null && !bitrate.equals("0.00 Mbps") && !bitrate.equals("N/A"));
-                
-                // Create connection item view
-                android.view.View connectionView = inflater.inflate(R.layout.connection_item, connectionsContainer, false);
-                
-                // Set network type with display formatting
-                TextView networkTypeView = connectionView.findViewById(R.id.connection_network_type);
-                String displayName = networkType.equals("WIFI") ? "WI-FI" : networkType;
-                networkTypeView.setText(displayName);
-                
-                // Set status
-                TextView statusView = connectionView.findViewById(R.id.connection_status);
-                if (isActive) {
-                    statusView.setText("ACTIVE");
-                    statusView.setTextColor(android.graphics.Color.parseColor("#28a745"));
-                } else {
-                    statusView.setText("INACTIVE");
-                    statusView.setTextColor(android.graphics.Color.parseColor("#dc3545"));
-                }
-                
-                // Set window bar
-                WindowBarView windowBar = connectionView.findViewById(R.id.window_bar);
-                windowBar.setWindowData(windowSize, isActive);
-                
-                // Set stats text
-                TextView statsTextView = connectionView.findViewById(R.id.connection_stats_text);
-                String statsDisplay = String.format(
-                    "Bitrate: %s  %s\nPackets in-flight: %,d\nRTT: %s\nWindow: %,d / 60,000",
-                    bitrate, load, inFlight, rtt, windowSize
-                );
-                statsTextView.setText(statsDisplay);
-                
-                // Add view to container
-                connectionsContainer.addView(connectionView);
-                
-            } catch (Exception e) {
-                Log.e(TAG, "Error parsing connection section: " + section, e);
+            // Create connection item view
+            View connectionView = inflater.inflate(R.layout.connection_item, connectionsContainer, false);
+            
+            // Set network type with display formatting
+            TextView networkTypeView = connectionView.findViewById(R.id.connection_network_type);
+            String displayName = networkType.equals("WIFI") ? "WI-FI" : networkType;
+            networkTypeView.setText(displayName);
+            
+            // Set status
+            TextView statusView = connectionView.findViewById(R.id.connection_status);
+            if (isActive) {
+                statusView.setText("ACTIVE");
+                statusView.setTextColor(android.graphics.Color.parseColor("#28a745"));
+            } else {
+                statusView.setText("INACTIVE");
+                statusView.setTextColor(android.graphics.Color.parseColor("#dc3545"));
             }
+            
+            // Set window bar
+            WindowBarView windowBar = connectionView.findViewById(R.id.window_bar);
+            windowBar.setWindowData(windowSize, isActive);
+            
+            // Set stats text
+            TextView statsTextView = connectionView.findViewById(R.id.connection_stats_text);
+            String statsDisplay = String.format(Locale.US,
+                "Bitrate: %.2f Mbps  %d%%\nPackets in-flight: %,d\nRTT: %s\nWindow: %,d / 60,000",
+                statsSnapshot.getBitrateMbps(i), statsSnapshot.getLoadPercentage(i), inFlight,
+                rttMs >= 0 ? rttMs + " ms" : "N/A", windowSize
+            );
+            statsTextView.setText(statsDisplay);
+            
+            // Add view to container
+            connectionsContainer.addView(connectionView);
         }
         
         // If no connections were added, show the "no connections" message
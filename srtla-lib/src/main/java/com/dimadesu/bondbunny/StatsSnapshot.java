@@ -0,0 +1,188 @@
+package com.dimadesu.bondbunny;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Reusable reader for the binary stats snapshot filled by
+ * {@link NativeSrtlaJni#getStatsSnapshot(ByteBuffer)}.
+ *
+ * <p>One {@link #refresh()} is a single JNI call that captures every per-connection field
+ * plus the group counters from the same native walk, so the values are consistent with
+ * each other. The backing direct buffer is reused across refreshes and only grows when
+ * the connection count outgrows it.</p>
+ *
+ * <p>Layout is defined in {@code srtla_stats_snapshot.h}; keep the two in sync.</p>
+ *
+ * <p>Not thread-safe: use one instance per polling thread.</p>
+ */
+public class StatsSnapshot {
+
+    private static final int MAGIC = 0x534E4150; // "SNAP"
+    private static final int VERSION = 7;
+
+    private static final int HEADER_SIZE = 64;
+    private static final int TYPE_LEN = 16;
+    private static final int IP_LEN = 64;
+    private static final int RELAY_ID_LEN = 64;
+    private static final int RELAY_NAME_LEN = 48;
+    private static final int RELAY_VIP_LEN = 16;
+
+    public static final int FLAG_RUNNING        = 1;
+    public static final int FLAG_CONNECTED      = 1 << 1;
+    public static final int FLAG_EVER_CONNECTED = 1 << 2;
+    public static final int FLAG_RECONNECTING   = 1 << 3;
+    public static final int FLAG_RETRYING       = 1 << 4;
+    public static final int FLAG_HAS_STATS      = 1 << 5;  // getAllStats() would not be empty
+
+    public static final int RELAY_ALIVE  = 1;       // status report within the timeout
+    public static final int RELAY_LINKED = 1 << 1;  // its connection is active
+
+    // Enough for a handful of connections; grown on demand.
+    private static final int INITIAL_CAPACITY = 4096;
+
+    private ByteBuffer buffer = allocate(INITIAL_CAPACITY);
+    private boolean valid = false;
+
+    // Section offsets for the current connection count
+    private int connCount;
+    private int bitrateOffset;
+    private int loadOffset;
+    private int windowOffset;
+    private int inFlightOffset;
+    private int rttOffset;
+    private int activeOffset;
+    private int typeOffset;
+    private int ipOffset;
+    private int relayCount;
+    private int relayOffset;
+    private int relaySize;
+
+    private static ByteBuffer allocate(int capacity) {
+        return ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+    }
+
+    private static int align8(int n) {
+        return (n + 7) & ~7;
+    }
+
+    /**
+     * Pull a fresh snapshot from native code.
+     *
+     * @return true if the snapshot was read successfully
+     */
+    public boolean refresh() {
+        int written = NativeSrtlaJni.getStatsSnapshot(buffer);
+        if (written < 0) {
+            // Buffer too small for the current connection count; grow once and retry
+            buffer = allocate(align8(-written) * 2);
+            written = NativeSrtlaJni.getStatsSnapshot(buffer);
+        }
+        valid = written >= HEADER_SIZE
+                && buffer.getInt(0) == MAGIC
+                && buffer.getInt(4) == VERSION;
+        if (!valid) {
+            connCount = 0;
+            relayCount = 0;
+            return false;
+        }
+
+        connCount = buffer.getInt(12);
+        bitrateOffset  = HEADER_SIZE;
+        loadOffset     = align8(bitrateOffset + connCount * 8);
+        windowOffset   = align8(loadOffset + connCount * 4);
+        inFlightOffset = align8(windowOffset + connCount * 4);
+        rttOffset      = align8(inFlightOffset + connCount * 4);
+        activeOffset   = align8(rttOffset + connCount * 4);
+        typeOffset     = align8(activeOffset + connCount);
+        ipOffset       = align8(typeOffset + connCount * TYPE_LEN);
+        int relaySection = align8(ipOffset + connCount * IP_LEN);
+        relayCount = buffer.getInt(relaySection);
+        relaySize = buffer.getInt(relaySection + 4);
+        relayOffset = relaySection + 8;
+        return true;
+    }
+
+    public boolean isValid() { return valid; }
+
+    // -------------------------------------------------------------------------
+    // Group counters
+    // -------------------------------------------------------------------------
+
+    public int getConnectionCount() { return connCount; }
+    public int getActiveConnectionCount() { return valid ? buffer.getInt(16) : 0; }
+    public int getTotalInFlightPackets() { return valid ? buffer.getInt(20) : 0; }
+    public int getTotalWindowSize() { return valid ? buffer.getInt(24) : 0; }
+    public int getRetryCount() { return valid ? buffer.getInt(28) : 0; }
+    public int getFlags() { return valid ? buffer.getInt(32) : 0; }
+    public double getTotalBitrateMbps() { return valid ? buffer.getDouble(40) : 0.0; }
+    public long getTimestampMs() { return valid ? buffer.getLong(48) : 0L; }
+
+    public boolean isRunning() { return (getFlags() & FLAG_RUNNING) != 0; }
+    public boolean isConnected() { return (getFlags() & FLAG_CONNECTED) != 0; }
+    public boolean isRetrying() { return (getFlags() & FLAG_RETRYING) != 0; }
+    public boolean isReconnecting() { return (getFlags() & FLAG_RECONNECTING) != 0; }
+    /** Same state check as a non-empty {@link NativeSrtlaJni#getAllStats()}. */
+    public boolean hasStats() { return (getFlags() & FLAG_HAS_STATS) != 0; }
+
+    // -------------------------------------------------------------------------
+    // Per-connection fields
+    // -------------------------------------------------------------------------
+
+    public double getBitrateMbps(int i) { return buffer.getDouble(bitrateOffset + i * 8); }
+    public int getLoadPercentage(int i) { return buffer.getInt(loadOffset + i * 4); }
+    public int getWindowSize(int i) { return buffer.getInt(windowOffset + i * 4); }
+    public int getInFlightPackets(int i) { return buffer.getInt(inFlightOffset + i * 4); }
+    /** Smoothed RTT in ms, -1 while unknown. */
+    public int getRttMs(int i) { return buffer.getInt(rttOffset + i * 4); }
+    public boolean isActive(int i) { return buffer.get(activeOffset + i) != 0; }
+    public String getConnectionType(int i) { return readString(typeOffset + i * TYPE_LEN, TYPE_LEN); }
+    public String getConnectionIP(int i) { return readString(ipOffset + i * IP_LEN, IP_LEN); }
+
+    // -------------------------------------------------------------------------
+    // Moblink relays (native relay manager)
+    // -------------------------------------------------------------------------
+
+    public int getRelayCount() { return relayCount; }
+    public String getRelayId(int r) { return readString(relayRecord(r), RELAY_ID_LEN); }
+    public String getRelayName(int r) { return readString(relayRecord(r) + RELAY_ID_LEN, RELAY_NAME_LEN); }
+    public String getRelayVirtualIP(int r) {
+        return readString(relayRecord(r) + RELAY_ID_LEN + RELAY_NAME_LEN, RELAY_VIP_LEN);
+    }
+    /** Battery percent, -1 if unknown. */
+    public int getRelayBattery(int r) { return buffer.getInt(relayFields(r)); }
+    /** ThermalState ordinal, -1 if unknown. */
+    public int getRelayThermal(int r) { return buffer.getInt(relayFields(r) + 4); }
+    /** Milliseconds since the relay's last status report, -1 if it never reported. */
+    public int getRelayStatusAgeMs(int r) { return buffer.getInt(relayFields(r) + 8); }
+    /** Index of the relay's connection in the per-connection arrays, -1 if none. */
+    public int getRelayConnectionIndex(int r) { return buffer.getInt(relayFields(r) + 12); }
+    public int getRelayFlags(int r) { return buffer.getInt(relayFields(r) + 16); }
+
+    private int relayRecord(int r) { return relayOffset + r * relaySize; }
+    private int relayFields(int r) { return relayRecord(r) + RELAY_ID_LEN + RELAY_NAME_LEN + RELAY_VIP_LEN; }
+
+    private String readString(int offset, int maxLen) {
+        int len = 0;
+        while (len < maxLen && buffer.get(offset + len) != 0) {
+            len++;
+        }
+        byte[] bytes = new byte[len];
+        for (int i = 0; i < len; i++) {
+            bytes[i] = buffer.get(offset + i);
+        }
+        return new String(bytes, StandardCharsets.UTF_8);
+    }
+
+    /** Convert the current snapshot into the legacy per-connection data objects. */
+    public ConnectionBitrateData[] toConnectionBitrateData() {
+        ConnectionBitrateData[] result = new ConnectionBitrateData[connCount];
+        for (int i = 0; i < connCount; i++) {
+            result[i] = new ConnectionBitrateData(getBitrateMbps(i), getConnectionType(i),
+                    getConnectionIP(i), getLoadPercentage(i), getWindowSize(i),
+                    getInFlightPackets(i), isActive(i));
+        }
+        return result;
+    }
+}